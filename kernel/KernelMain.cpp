@@ -9,6 +9,7 @@
 #include <arch/amd64/smp.h>
 #include <init.h>
 #include <arch.h>
+#include <mem/VMSubstrate.h>
 
 // NOLINTBEGIN
 extern "C" void (*__init_array_start[])(void) __attribute__((weak));
@@ -67,6 +68,36 @@ namespace kernel{
         }
     }
 
+    // Page table reclamation check - with a page held in the arena's first leaf table, each
+    // run of maxPagesPerRun pages fills a new leaf table of its own. Freeing the runs must
+    // drop those tables' liveCounts to 0, and the sweep must release exactly those tables
+    // while keeping the first.
+    bool pageTableReclaimTest() {
+        constexpr size_t runCount = 3;
+        constexpr size_t runPages = mm::VMSubstrate::maxPagesPerRun;
+        void* anchor = mm::VMSubstrate::allocPage();
+        assert(anchor != nullptr, "Arena could not map a page");
+        uint64_t* runs[runCount];
+        for (size_t r = 0; r < runCount; r++) {
+            runs[r] = static_cast<uint64_t*>(mm::VMSubstrate::allocPages(runPages));
+            assert(runs[r] != nullptr, "Arena could not map a full page run");
+            for (size_t page = 0; page < runPages; page++) {
+                runs[r][page * arch::smallPageSize / sizeof(uint64_t)] = r * runPages + page;
+            }
+        }
+        for (size_t r = 0; r < runCount; r++) {
+            for (size_t page = 0; page < runPages; page++) {
+                assert(runs[r][page * arch::smallPageSize / sizeof(uint64_t)] == r * runPages + page,
+                       "Page run read back the wrong contents");
+            }
+            mm::VMSubstrate::freePageRun(runs[r], runPages);
+        }
+        assert(mm::VMSubstrate::reclaimPageTables() == runCount, "Emptied leaf tables were not reclaimed");
+        assert(mm::VMSubstrate::reclaimPageTables() == 0, "Sweep ran again with nothing emptied");
+        mm::VMSubstrate::freePage(anchor);
+        return true;
+    }
+
     bool enqueueShutdown() {
         arch::amd64::sti();
         klog() << "Enqueuing shutdown\n";
@@ -77,12 +108,25 @@ namespace kernel{
         return true;
     }
 
+    [[noreturn]] void idleLoop() {
+        for (;;) {
+            // Spend idle time returning pages other CPUs freed to us and stocking the
+            // page allocator's emergency reserve and pre-zeroed lists. Catching up on TLB
+            // flushes keeps a halted CPU from holding back other CPUs' deferred frees, and
+            // releases our own once the others have caught up.
+            mm::PageAllocator::catchUpTlbFlush();
+            (void)mm::PageAllocator::releaseDeferredFrees();
+            mm::PageAllocator::drainRemoteFrees();
+            (void)mm::PageAllocator::refillReserve();
+            mm::PageAllocator::zeroIdlePages();
+            asm volatile("hlt");
+        }
+    }
+
     extern "C" [[noreturn]] void kernel_main() {
         klog() << "\n"; // newline to separate from the "Booting from ROM.." message from qemu
         init::kinit(true, KERNEL_INIT_LOG_LEVEL, false);
-
-        for (;;)
-            asm volatile("hlt");
+        idleLoop();
         //asm volatile("outw %0, %1" ::"a"((uint16_t)0x2000), "Nd"((uint16_t)0x604)); //Quit qemu
     }
 }
\ No newline at end of file
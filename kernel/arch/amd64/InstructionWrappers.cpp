@@ -14,6 +14,12 @@ namespace arch::amd64 {
                      : "a"(leaf));
     }
 
+    void cpuid(uint32_t &eax, uint32_t &ebx, uint32_t &ecx, uint32_t &edx, uint32_t leaf, uint32_t subleaf) {
+        asm volatile("cpuid"
+                     : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+                     : "a"(leaf), "c"(subleaf));
+    }
+
     void outb(uint16_t port, uint8_t out)
     {
         asm volatile("outb %0, %1" ::"a"(out), "Nd"(port));
@@ -35,6 +35,14 @@ namespace arch::amd64{
                      "mov %rax, %cr3");
     }
 
+    // Toggling CR4.PGE drops every translation, global ones included.
+    void flushGlobalTLB(){
+        uint64_t cr4;
+        asm volatile("mov %%cr4, %0" : "=r"(cr4));
+        asm volatile("mov %0, %%cr4" :: "r"(cr4 & ~(uint64_t{1} << 7)) : "memory");
+        asm volatile("mov %0, %%cr4" :: "r"(cr4) : "memory");
+    }
+
     bool supportsFSGSBASE() {
         uint32_t eax, ebx, ecx, edx;
         eax = 0x07;
@@ -225,4 +233,32 @@ namespace arch {
         // EBX[15:8] is the CLFLUSH line size in 8-byte units
         return ((ebx >> 8) & 0xFF) * 8;
     }
+
+    Optional<CacheGeometry> getCacheGeometry(size_t level) {
+        uint32_t eax, ebx, ecx, edx;
+        //Intel describes its caches in leaf 4. AMD leaves that empty and uses leaf 0x8000001D instead,
+        //in the same format, when TOPOEXT (leaf 0x80000001 ECX bit 22) is set.
+        uint32_t leaf = 0;
+        arch::amd64::cpuid(eax, ebx, ecx, edx, 0);
+        if (eax >= 4) {
+            arch::amd64::cpuid(eax, ebx, ecx, edx, 4, 0);
+            if ((eax & 0x1F) != 0) leaf = 4;
+        }
+        if (leaf == 0) {
+            arch::amd64::cpuid(eax, ebx, ecx, edx, 0x80000000);
+            if (eax < 0x8000001D) return {};
+            arch::amd64::cpuid(eax, ebx, ecx, edx, 0x80000001);
+            if (!(ecx & (1u << 22))) return {};
+            leaf = 0x8000001D;
+        }
+        for (uint32_t subleaf = 0; ; subleaf++) {
+            arch::amd64::cpuid(eax, ebx, ecx, edx, leaf, subleaf);
+            const uint32_t type = eax & 0x1F; //0 = no more caches, 1 = data, 2 = instruction, 3 = unified
+            if (type == 0) return {};
+            if (type == 2 || ((eax >> 5) & 0x7) != level) continue;
+            //EBX[11:0] line size, EBX[21:12] physical line partitions, EBX[31:22] ways, ECX sets; all minus one
+            return CacheGeometry{(ebx & 0xFFF) + 1, ((ebx >> 22) & 0x3FF) + 1, static_cast<size_t>(ecx) + 1,
+                                 ((ebx >> 12) & 0x3FF) + 1};
+        }
+    }
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <arch/amd64/interrupts/APIC.h>
 #include <arch/amd64/amd64.h>
 #include <mem/VMSubstrate.h>
+#include <mem/FlushPlanner.h>
+#include <mem/mm.h>
 #include <arch/amd64/smp.h>
 #include <core/ds/Trees.h>
 #include <arch/amd64/interrupts/AuxiliaryDomains.h>
@@ -516,6 +518,64 @@ namespace arch::amd64::interrupts{
         }
     };
 
+    // Inter-processor interrupts this kernel sends itself. Each one arrives on a fixed vector
+    // through the LAPIC, which also takes its EOI.
+    constexpr uint8_t LAPIC_TLB_SHOOTDOWN_VECTOR = 0xFD;
+
+    CRClass(IPIDomain, public InterruptDomain, public InterruptEmitter) {
+    public:
+        size_t getEmitterCount() const override {
+            return 1;
+        }
+
+        static managed::InterruptSourceHandle tlbShootdownHandle();
+    };
+
+    SharedPtr<IPIDomain> ipiDomain;
+
+    managed::InterruptSourceHandle IPIDomain::tlbShootdownHandle() {
+        return {static_pointer_cast<InterruptDomain>(ipiDomain), 0};
+    }
+
+    void serviceTlbShootdown(InterruptFrame& frame) {
+        (void)frame;
+        kernel::mm::FlushPlanner::serviceShootdowns(getCurrentProcessorID());
+    }
+
+    // The FlushPlanner never targets the sending CPU, so a set of everyone else goes out as a
+    // single broadcast.
+    void sendTlbShootdown(const kernel::mm::ProcessorSet& targets) {
+        if (targets.count() + 1 == processorCount()) {
+            lapicDomain->issueIPISync({STANDARD, false, LAPIC_TLB_SHOOTDOWN_VECTOR, 0, OTHER_CPUS});
+            return;
+        }
+        targets.forEach([](ProcessorID cpu) {
+            lapicDomain->issueIPISync({STANDARD, false, LAPIC_TLB_SHOOTDOWN_VECTOR, cpu, SPECIFIC_LAPIC});
+        });
+    }
+
+    // The page allocator's fallback when a deferred-free queue fills and some CPU is not
+    // flushing on its own. A full flush reports itself to the page allocator on every CPU.
+    void shootdownAllTLBs() {
+        kernel::mm::FlushPlanner planner;
+        planner.invalidateAll();
+        planner.targetAllProcessors();
+        planner.flush();
+    }
+
+    Atomic<size_t> shootdownReadyCount;
+
+    // Shootdown rounds wait for every target, so the sender is only installed once every CPU
+    // takes interrupts. Until then FlushPlanner invalidates locally, as it did before SMP.
+    bool enableShootdownIPIs() {
+        sti();
+        if (shootdownReadyCount.add_fetch(1, ACQ_REL) == processorCount()) {
+            kernel::mm::FlushPlanner::setShootdownSender(sendTlbShootdown);
+            kernel::mm::PageAllocator::setTlbShootdown(shootdownAllTLBs);
+        }
+        return true;
+    }
+
     using namespace kernel::timing;
 
     constexpr uint32_t LAPIC_TIMER_INITIAL_COUNT_REGISTER = 0x380;
@@ -622,6 +682,10 @@ namespace arch::amd64::interrupts{
         spuriousInterruptDomain = make_shared<SpuriousInterruptDomain>();
         topology::registerDomain(spuriousInterruptDomain);
         topology::connectSingleOutputExclusive(spuriousInterruptDomain, getCPUInterruptVectors(), LAPIC_SPURIOUS_INTERRUPT_VECTOR);
+        ipiDomain = make_shared<IPIDomain>();
+        topology::registerDomain(ipiDomain);
+        topology::connectSingleOutputExclusive(ipiDomain, lapicDomain, LAPIC_TLB_SHOOTDOWN_VECTOR);
+        managed::registerHandler(IPIDomain::tlbShootdownHandle(), serviceTlbShootdown);
         localDeviceEmitters = make_shared<LAPICLocalDeviceEmitters>();
         localDeviceRouter = make_shared<LAPICLocalDeviceRoutingDomain>(*lapicDomain);
         topology::registerDomain(localDeviceEmitters);
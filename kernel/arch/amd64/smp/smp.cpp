@@ -3,6 +3,7 @@
 //
 
 #include <acpi.h>
+#include <kernel.h>
 #include <init.h>
 #include <timing/timing.h>
 #include <arch/amd64/smp.h>
@@ -135,7 +136,8 @@ namespace arch::amd64::smp{
 using namespace kernel;
 
 
-extern "C" void smpEntry() {
+extern "C" [[noreturn]] void smpEntry() {
     ++upCount;
     kernel::init::kinit(false, KERNEL_INIT_LOG_LEVEL, false);
+    kernel::idleLoop();
 }
\ No newline at end of file
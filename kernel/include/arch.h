@@ -55,6 +55,9 @@ namespace arch{
     inline void flushTLB() {
         amd64::flushTLB();
     }
+    inline void flushGlobalTLB() {
+        amd64::flushGlobalTLB();
+    }
     inline void invlpg(mm::virt_addr addr) {
         amd64::invlpg(addr.value);
     }
@@ -78,10 +81,12 @@ namespace arch{
 
     constexpr size_t smallPageSize = 1ull << pageTableDescriptor.getVirtualAddressBitCount(pageTableDescriptor.LEVEL_COUNT); //4KiB
     constexpr size_t bigPageSize = 1ull << pageTableDescriptor.getVirtualAddressBitCount(pageTableDescriptor.LEVEL_COUNT - 1); //2MiB
+    constexpr size_t giganticPageSize = 1ull << pageTableDescriptor.getVirtualAddressBitCount(pageTableDescriptor.LEVEL_COUNT - 2); //1GiB
     constexpr size_t maxMemorySupported = 1ull << 1ull << pageTableDescriptor.getVirtualAddressBitCount(); //256 TiB
 #else
     constexpr size_t smallPageSize = 1ull << 12;
     constexpr size_t bigPageSize = 1ull << 21;
+    constexpr size_t giganticPageSize = 1ull << 30;
     constexpr size_t maxMemorySupported = 1ull << 48;
 #endif
     //Guaranteed to be between 0 and (the total number of logical processors - 1)
@@ -264,5 +269,19 @@ namespace arch{
 #endif
 
     size_t getCacheLineSize();
+
+    struct CacheGeometry {
+        size_t lineSize;
+        size_t associativity;
+        size_t setCount;
+        //Lines that share one tag; each set of each way holds this many.
+        size_t partitions = 1;
+        //Bytes one way covers, so the span after which addresses map to the same set again.
+        [[nodiscard]] size_t waySizeBytes() const { return lineSize * partitions * setCount; }
+        [[nodiscard]] size_t sizeBytes() const { return waySizeBytes() * associativity; }
+    };
+    //Geometry of the data or unified cache at the given level (1 = L1), as reported by the CPU.
+    //Empty if the CPU does not describe a cache at that level.
+    Optional<CacheGeometry> getCacheGeometry(size_t level);
 }
 #endif //CROCOS_ARCH_H
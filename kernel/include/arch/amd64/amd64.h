@@ -10,7 +10,6 @@
 
 #include "kernel.h"
 #include <core/ds/Vector.h>
-#include <mem/FlushPlanner.h>
 #include <arch/memmap.h>
 
 struct mboot_mmap_entry;
@@ -93,6 +92,8 @@ namespace arch::amd64 {
     //the registers EAX-EDX. The last parameter is the value to load into EAX (the "leaf" per the
     // Intel manual) before calling CPUID.
     void cpuid(uint32_t &eax, uint32_t &ebx, uint32_t &ecx, uint32_t &edx, uint32_t leaf);
+    //Same as above, for leaves that take a subleaf in ECX.
+    void cpuid(uint32_t &eax, uint32_t &ebx, uint32_t &ecx, uint32_t &edx, uint32_t leaf, uint32_t subleaf);
 
     //Simple wrapper for the outb instruction to print out a string on the serial port
     void serialOutputString(const char* str);
@@ -255,6 +256,7 @@ namespace arch::amd64 {
     };
 
     void flushTLB();
+    void flushGlobalTLB();
 
     class MultibootMMapIterator {
         mboot_mmap_entry* currentEntry;
@@ -85,6 +85,9 @@ namespace arch::amd64::interrupts{
     };
 
     uint64_t enableAPICOnAP();
+    // Per-CPU: start taking interrupts, including TLB shootdown IPIs. Once every CPU has,
+    // FlushPlanner shootdowns go out as IPIs.
+    bool enableShootdownIPIs();
     void setupAPICs(acpi::MADT& madt);
     SharedPtr<LAPIC> getLAPICDomain();
     SharedPtr<IOAPIC> getFirstIOAPIC();
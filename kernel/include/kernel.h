@@ -19,6 +19,8 @@ namespace kernel{
     bool heapEarlyInit();
     void* kmalloc(size_t size, std::align_val_t = std::align_val_t{1});
     void kfree(void* ptr);
+    // What every CPU runs once initialization is done.
+    [[noreturn]] void idleLoop();
 }
 
 #include <assert.h>
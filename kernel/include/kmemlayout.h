@@ -19,7 +19,7 @@ namespace kernel::mm{
     // PML4[511] -> PDPT: kernel zones, each getKernelMemRegionSize() bytes (1 GiB default)
     //   PDPT[511] = zone 0  (KERNEL_ZONE)                 kernel image
     //   PDPT[510] = zone 1  (TEMPORARY_AND_PAGE_TABLE_ZONE) bootstrap-only temp mapping
-    //   PDPT[509] = zone 2+ (PAGE_ALLOCATOR_ZONE_START)   page allocator buffers (one per domain)
+    //   PDPT[509] = zone 2+ (PAGE_ALLOCATOR_ZONE_START)   page allocator buffers (metadata radix, then one per domain; a large one spans several zones)
     //
     // PML4[VMM_SUBSTRATE_ROOT_INDEX] -> subtable: VMSubstrate internal structures (512 GiB)
     constexpr size_t KERNEL_ZONE = 0;
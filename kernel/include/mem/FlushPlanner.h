@@ -5,9 +5,125 @@
 #ifndef CROCOS_FLUSHPLANNER_H
 #define CROCOS_FLUSHPLANNER_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <arch.h>
+#include <mem/MemTypes.h>
+
 namespace kernel::mm{
+    // A set of processors, one bit per ProcessorID.
+    class ProcessorSet{
+        static constexpr size_t wordCount = arch::MAX_PROCESSOR_COUNT / 64;
+        uint64_t words[wordCount]{};
+    public:
+        void add(arch::ProcessorID cpu){
+            words[cpu / 64] |= uint64_t{1} << (cpu % 64);
+        }
+        void remove(arch::ProcessorID cpu){
+            words[cpu / 64] &= ~(uint64_t{1} << (cpu % 64));
+        }
+        [[nodiscard]] bool contains(arch::ProcessorID cpu) const{
+            return (words[cpu / 64] >> (cpu % 64)) & 1;
+        }
+        // Add processors [0, count).
+        void addFirst(size_t count){
+            for (size_t cpu = 0; cpu < count; cpu++) add(static_cast<arch::ProcessorID>(cpu));
+        }
+        void addAll(const ProcessorSet& other){
+            for (size_t w = 0; w < wordCount; w++) words[w] |= other.words[w];
+        }
+        void clear(){
+            for (auto& word : words) word = 0;
+        }
+        [[nodiscard]] bool empty() const{
+            for (const auto word : words) if (word != 0) return false;
+            return true;
+        }
+        [[nodiscard]] size_t count() const{
+            size_t total = 0;
+            for (const auto word : words) total += static_cast<size_t>(__builtin_popcountll(word));
+            return total;
+        }
+        template <typename Fn>
+        void forEach(Fn&& fn) const{
+            for (size_t w = 0; w < wordCount; w++){
+                for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1){
+                    fn(static_cast<arch::ProcessorID>(w * 64 + static_cast<size_t>(__builtin_ctzll(bits))));
+                }
+            }
+        }
+    };
+
+    // Collects the TLB invalidations a batch of page-table edits needs and carries them out in
+    // one round. Adjacent pages coalesce into ranges. Past fullFlushThreshold pages, or once
+    // the ranges no longer fit, the round becomes a full flush instead. On flush() the calling
+    // CPU invalidates directly, and every other target CPU is sent one shootdown request
+    // through the registered ShootdownSender. flush() returns once all of them have acted on it,
+    // so unmapping N pages costs one round rather than N.
     class FlushPlanner{
     public:
+        static constexpr size_t rangeCapacity = 8;
+        static constexpr size_t fullFlushThreshold = 32;
+
+        struct Range{
+            virt_addr start;
+            size_t pageCount;
+        };
+
+        FlushPlanner() = default;
+        FlushPlanner(const FlushPlanner&) = delete;
+        FlushPlanner& operator=(const FlushPlanner&) = delete;
+        // Anything still queued is flushed.
+        ~FlushPlanner();
+
+        // Queue invalidation of pageCount small pages starting at addr.
+        void invalidate(virt_addr addr, size_t pageCount = 1);
+        // Make the next round a full flush.
+        void invalidateAll();
+        // CPUs that may hold the translations being invalidated. The calling CPU is always
+        // covered and need not be added.
+        void addTarget(arch::ProcessorID cpu);
+        void addTargets(const ProcessorSet& cpus);
+        void targetAllProcessors();
+
+        // Carry out everything queued and reset the planner.
+        void flush();
+
+        [[nodiscard]] bool hasPendingInvalidations() const{
+            return fullFlush || rangeCount > 0;
+        }
+        [[nodiscard]] bool isFullFlush() const{
+            return fullFlush;
+        }
+        [[nodiscard]] size_t queuedRangeCount() const{
+            return rangeCount;
+        }
+        [[nodiscard]] const Range& queuedRange(size_t index) const{
+            return ranges[index];
+        }
+
+        // Delivers a shootdown to every CPU in targets, each of which must then call
+        // serviceShootdowns for itself (typically from an IPI handler). Without a sender
+        // flush() only invalidates locally, leaving remote CPUs to the lazy freshness checks.
+        using ShootdownSender = void(*)(const ProcessorSet& targets);
+        static void setShootdownSender(ShootdownSender sender);
+        // Carry out the shootdowns queued for cpu. The shootdown IPI handler calls this for the
+        // CPU it runs on; a CPU waiting on its own round calls it too, so two CPUs shooting each
+        // other down with interrupts off still make progress.
+        static void serviceShootdowns(arch::ProcessorID cpu);
+
+#ifdef CROCOS_TESTING
+        // In test builds local invalidation only counts what it would have done.
+        struct LocalFlushStats{
+            size_t pagesInvalidated;
+            size_t fullFlushes;
+        };
+        static LocalFlushStats localFlushStats(arch::ProcessorID cpu);
+        // Shootdown rounds sent, i.e. flush() calls that reached at least one other CPU.
+        static size_t shootdownRoundCount();
+        static void resetFlushStats();
+#endif
+
         //This is *never* to be used outside the page table manager. The only reason this is not private
         //and setting the PTM as a friend is to avoid awkward use of ifdefs when porting to other architectures
         //and sticking the PTM in other namespaces
@@ -19,7 +135,14 @@ namespace kernel::mm{
             return previousPlanner;
         }
     private:
-        FlushPlanner* previousPlanner;
+        void reset();
+
+        FlushPlanner* previousPlanner = nullptr;
+        Range ranges[rangeCapacity];
+        size_t rangeCount = 0;
+        size_t pageCount = 0;
+        bool fullFlush = false;
+        ProcessorSet targets;
     };
 }
 
@@ -82,7 +82,8 @@ namespace kernel::mm{
 
     enum class PageSize{
         BIG,
-        SMALL
+        SMALL,
+        GIGANTIC
     };
 }
 
@@ -91,9 +92,16 @@ struct PageRef {
 
     static PageRef small(kernel::mm::phys_addr addr);
     static PageRef big(kernel::mm::phys_addr addr);
+    static PageRef gigantic(kernel::mm::phys_addr addr);
+    // A run of `count` contiguous pages of one size starting at addr. Small runs must stay within
+    // one big page; big runs within one gigantic page. Only produced by run-aware allocator APIs.
+    static PageRef smallRun(kernel::mm::phys_addr addr, size_t count);
+    static PageRef bigRun(kernel::mm::phys_addr addr, size_t count);
 
     [[nodiscard]] kernel::mm::PageSize size() const;
     [[nodiscard]] kernel::mm::phys_addr addr() const;
+    // Number of pages of size() the ref covers; 1 for everything but runs.
+    [[nodiscard]] size_t runLength() const;
 
     bool operator==(const PageRef& other) const { return other.value == value; }
 } __attribute__((packed));
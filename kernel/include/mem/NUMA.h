@@ -504,6 +504,9 @@ private:
 // Lightweight structure derived from NUMATopology at boot time.
 // All fields are precomputed; every query is O(1).
 
+// Largest per-domain interleave weight; the highest-bandwidth target of an initiator gets it.
+constexpr uint32_t INTERLEAVE_WEIGHT_MAX = 32;
+
 class NUMAPolicy {
 public:
     NUMAPolicy() = delete;
@@ -533,11 +536,19 @@ public:
     // Quality level of the precomputed fallback ordering (latency-based).
     DataQualityLevel orderingQuality() const;
 
+    // Returns the interleave weight of every target domain for the given initiator,
+    // indexed by DomainID.  Weights scale with read bandwidth (write bandwidth if only
+    // that was reported) from initiator to target, from 1 up to INTERLEAVE_WEIGHT_MAX.
+    // Targets without a measurement get 1, unreachable targets 0; with no bandwidth
+    // data at all every domain weighs 1.  O(1).
+    Span<const uint32_t> interleaveWeights(DomainID initiator) const;
+
 private:
     // Flat arrays allocated in the constructor; freed in the destructor.
     DomainID*        cpuHomeDomain  = nullptr; // [cpuCount]
     ClockDomainID*   cpuClockDomain = nullptr; // [cpuCount]
     DomainID*        fallbackOrder  = nullptr; // [domainCount * domainCount]
+    uint32_t*        interleaveWeight = nullptr; // [domainCount * domainCount]
     size_t           cpuCount       = 0;
     size_t           domainCount    = 0;
     DataQualityLevel quality        = DataQualityLevel::Inferred;
@@ -36,6 +36,10 @@ public:
     T* allocate();
     template<typename T>
     T* allocate(FunctionRef<void(T&)> init, size_t count, size_t alignment = alignof(T));
+    // Like allocate(count, alignment), but skips zeroing the memory. The caller must
+    // initialize each object before it is used.
+    template<typename T>
+    T* allocateUninitialized(size_t count, size_t alignment = alignof(T));
     [[nodiscard]] size_t bytesNeeded() const;
     [[nodiscard]] size_t bytesRemaining() const;
     [[nodiscard]] bool isFake() const {return measuring;}
@@ -56,6 +60,15 @@ struct OccupancyTransition {
     [[nodiscard]] bool becameAvailable() const { return before == OccupancyState::Full  && after != OccupancyState::Full; }
 };
 
+// ==================== Page Coloring ====================
+
+// Color cursor threaded through a COLORED allocation (see mm::PageAllocator::pageColorCount).
+// next always lies in [0, colorCount), and colorCount is a power of two.
+struct PageColoring {
+    size_t colorCount = 1;
+    size_t next = 0;
+};
+
 // ==================== Small Page Allocator ====================
 
 class SmallPageAllocator {
@@ -83,15 +96,25 @@ class SmallPageAllocator {
     // Flush any remaining allocBitmap pages into freeBitmap before handing this
     // big page back to the NUMAPool, so the next alloc CPU finds them in freeBitmap.
     void flushAllocBitmap();
+    // alloc() for a coloring with more than one color: one page at a time, each of the first
+    // free color at or after coloring.next, which then moves past it.
+    size_t allocColored(PageAllocationCallback cb, size_t count, OccupancyTransition& transition, PageColoring& coloring);
 
 public:
     explicit SmallPageAllocator(kernel::mm::phys_addr base);
 
     [[nodiscard]] bool isPageFree(PageRef page) const;
-    size_t alloc(PageAllocationCallback cb, size_t count, OccupancyTransition& transition);
+    // With `runs` set, each span of adjacent free pages is reported as one PageRef::smallRun.
+    // free() accepts runs either way. A coloring overrides runs; see allocColored.
+    size_t alloc(PageAllocationCallback cb, size_t count, OccupancyTransition& transition, bool runs = false,
+                 PageColoring* coloring = nullptr);
     void free(PageRef* pages, size_t count, OccupancyTransition& transition);
     size_t alloc(PageAllocationCallback cb, size_t count) { OccupancyTransition t; return alloc(cb, count, t); }
     void free(PageRef* pages, size_t count) { OccupancyTransition t; free(pages, count, t); }
+    // Claim `count` free pages forming one physically contiguous run whose first page
+    // index is a multiple of alignPages. Drains freeBitmap first so every free page is
+    // visible to the search. Returns the run's base address, or empty if no run fits.
+    [[nodiscard]] Optional<kernel::mm::phys_addr> allocRun(size_t count, size_t alignPages, OccupancyTransition& transition);
     [[nodiscard]] bool isFull() const;
     [[nodiscard]] bool isEmpty() const;
     [[nodiscard]] bool hasReservedPages() const { return reservedCount > 0; }
@@ -115,6 +138,21 @@ public:
 
 class NUMAPool;
 
+// Expected lifetime of the small pages a partially used big page is serving. Each class has
+// its own partial-page set, so long-lived pages pack together and short-lived churn can drain
+// its big pages back to whole free pages instead of leaving them pinned by a few survivors.
+enum class PageLifetime : uint8_t {
+    Short,
+    Long,
+    Count
+};
+
+[[nodiscard]] inline PageLifetime lifetimeFor(AllocFlags flags) {
+    assert(!(flags.has(AllocBehavior::LONG_LIVED) && flags.has(AllocBehavior::SHORT_LIVED)),
+           "LONG_LIVED and SHORT_LIVED are mutually exclusive");
+    return flags.has(AllocBehavior::LONG_LIVED) ? PageLifetime::Long : PageLifetime::Short;
+}
+
 class alignas(64) BigPageMetadata {
     [[no_unique_address]] SmallPageAllocator subpageAllocator;
     NUMAPool* ownerPool;
@@ -125,25 +163,37 @@ class alignas(64) BigPageMetadata {
     // that is guaranteed to return NotPresent anyway.
     // Only valid transitions: SIZE_MAX → pid and pid → SIZE_MAX (never pid → pid directly).
     Atomic<size_t> allocHolder{static_cast<size_t>(-1)};
+    // Lifetime class of the small pages carved from this page; selects which of the owning
+    // pool's partial-page sets it joins. Stamped only while the page is empty and claimed, so
+    // it is stable for as long as the page sits in a set. Whole-page allocation resets it.
+    Atomic<uint8_t> lifetimeClass{static_cast<uint8_t>(PageLifetime::Short)};
 
 public:
     BigPageMetadata(NUMAPool& pool, kernel::mm::phys_addr baseAddr);
 
-    [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, OccupancyTransition& transition);
+    [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, OccupancyTransition& transition, bool runs = false,
+                                       PageColoring* coloring = nullptr);
     void freePages(PageRef* pages, size_t count, OccupancyTransition& transition);
     [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb) { OccupancyTransition t; return allocatePages(smallPageCount, cb, t); }
     void freePages(PageRef* pages, size_t count) { OccupancyTransition t; freePages(pages, count, t); }
+    // Contiguous variant of allocatePages; see SmallPageAllocator::allocRun.
+    [[nodiscard]] Optional<kernel::mm::phys_addr> allocateRun(size_t smallPageCount, size_t alignPages, OccupancyTransition& transition);
+    [[nodiscard]] Optional<kernel::mm::phys_addr> allocateRun(size_t smallPageCount, size_t alignPages) { OccupancyTransition t; return allocateRun(smallPageCount, alignPages, t); }
 
     [[nodiscard]] bool isFull() const;
     [[nodiscard]] bool isEmpty() const;
 
-    void allocAll() {subpageAllocator.allocAll();}
+    void allocAll() {subpageAllocator.allocAll(); setLifetime(PageLifetime::Short);}
     void freeAll() {subpageAllocator.freeAll();}
 
     // Reserve a small page so it is never handed to callers (init-time only).
     void reservePage(kernel::mm::phys_addr addr) { subpageAllocator.reservePage(addr); }
     [[nodiscard]] bool hasReservedSubpages() const { return subpageAllocator.hasReservedPages(); }
 
+    [[nodiscard]] PageLifetime lifetime() const { return static_cast<PageLifetime>(lifetimeClass.load(RELAXED)); }
+    // Must be called on an empty page this CPU has claimed, before carving small pages from it.
+    void setLifetime(PageLifetime cls) { lifetimeClass.store(static_cast<uint8_t>(cls), RELAXED); }
+
     [[nodiscard]] NUMAPool& getOwnerPool() const { return *ownerPool; }
     void returnPage(bool evictedAsFull = false);
     [[nodiscard]] kernel::mm::phys_addr baseAddr() const {return subpageAllocator.baseAddr;}
@@ -155,15 +205,50 @@ public:
     }
     void releaseAllocHolder() { allocHolder.store(static_cast<size_t>(-1), RELEASE); }
     [[nodiscard]] bool hasAllocHolder() const { return allocHolder.load(ACQUIRE) != static_cast<size_t>(-1); }
+    [[nodiscard]] bool isAllocHolder(arch::ProcessorID pid) const { return allocHolder.load(ACQUIRE) == static_cast<size_t>(pid); }
+    // Reads the holder once. Returns false when no CPU holds the page.
+    [[nodiscard]] bool getAllocHolder(arch::ProcessorID& out) const {
+        const size_t holder = allocHolder.load(ACQUIRE);
+        if (holder == static_cast<size_t>(-1)) return false;
+        out = static_cast<arch::ProcessorID>(holder);
+        return true;
+    }
 
-#ifdef CROCOS_TESTING
     // Number of subpages that are currently free (not allocated or reserved).
     [[nodiscard]] size_t freeSubpageCount() const { return subpageAllocator.freePageCount(); }
     // True when the given small-page ref is currently allocated in this big page.
     [[nodiscard]] bool isSubpageAllocated(PageRef page) const { return !subpageAllocator.isPageFree(page); }
-#endif
 };
 
+// ==================== Metadata Radix ====================
+
+// Two-level table from physical big-page number to BigPageMetadata*. The root has one slot
+// per leafSpan of physical address space up to the highest usable address; a leaf holds the
+// metadata pointers for one leafSpan and exists only where usable memory does. The tables
+// live in bootstrap memory, so copies of a MetadataRadix share them.
+struct MetadataRadix {
+    constexpr static size_t leafEntries = 512;
+    constexpr static size_t leafSpan = leafEntries * arch::bigPageSize;
+
+    BigPageMetadata*** root = nullptr;
+    size_t rootEntries = 0;
+
+    [[nodiscard]] bool valid() const { return root != nullptr; }
+    // Metadata for the big page containing addr, or nullptr if no pool has registered it.
+    [[nodiscard]] BigPageMetadata* lookup(kernel::mm::phys_addr addr) const {
+        const size_t bigPageNumber = addr.value / arch::bigPageSize;
+        const size_t rootIndex = bigPageNumber / leafEntries;
+        if (rootIndex >= rootEntries || root[rootIndex] == nullptr) return nullptr;
+        return root[rootIndex][bigPageNumber % leafEntries];
+    }
+    // Point every big page of pool at its metadata (init-time only).
+    void insert(NUMAPool& pool);
+};
+
+// Allocate an empty radix covering every big page in ranges. In measuring mode the result is
+// invalid, but the allocator still accounts for an upper bound on the bytes needed.
+MetadataRadix createMetadataRadix(BootstrapAllocator& alloc, const Vector<kernel::mm::phys_memory_range>& ranges);
+
 struct SubrangeInfo {
     kernel::mm::phys_addr rangeStart;  // big-page-aligned start of merged range
     kernel::mm::phys_addr rangeEnd;    // big-page-aligned end of merged range
@@ -172,73 +257,458 @@ struct SubrangeInfo {
 
 class NUMAPool {
     BigPageMetadata* bigPageMetadataBuffer;
+    // One PageFrame per small page, smallPagesPerBigPage per entry of bigPageMetadataBuffer
+    // and in the same order. Zeroed chunk by chunk alongside the metadata.
+    kernel::mm::PageFrame* frameBuffer;
     HighReliabilityRingBuffer<BigPageMetadata*, false, true> freeBigPages;
+    // Partial pages serving short-lived (default) small allocations.
     AtomicBitPool paPages;
+    // Partial pages serving LONG_LIVED small allocations. Kept apart from paPages so that
+    // pages pinned by long-lived data do not soak up short-lived churn, and vice versa.
+    AtomicBitPool longLivedPAPages;
     kernel::numa::DomainID associatedDomain;
     SubrangeInfo* subrangeInfo;
     size_t subrangeCount;
     size_t bigPageCount;
+    // Serializes multi-big-page contiguous allocations against each other. Ordinary
+    // allocation never takes it; claimed pages are fenced off via allocHolder instead.
+    Spinlock contiguousLock;
+    // Empty big pages whose contents are known to be zero. A free big page sits in exactly
+    // one of freeBigPages and zeroedBigPages; ordinary allocations drain freeBigPages first.
+    HighReliabilityRingBuffer<BigPageMetadata*, false, true> zeroedBigPages;
+    // Known-zero small pages carved from a zeroed big page. Like magazine pages, they count
+    // as allocated in their SmallPageAllocator while they wait here.
+    HighReliabilityRingBuffer<PageRef, false, true> zeroedSmallPages;
+    // Held by whichever CPU is currently refilling the zeroed lists.
+    Spinlock zeroingLock;
+    // Allocator-wide address lookup; findMetadata falls back to scanning subranges until set.
+    MetadataRadix metadataRadix;
+    // LIFO stack of recently emptied big pages in front of freeBigPages, kept as a circular
+    // array so the oldest entry can be pushed out to the ring when a new one arrives. Pages
+    // leave in the reverse order they were freed, while still warm in cache and TLB, and
+    // freeBigPages is left holding the cold pages the zeroing worker draws from. A free
+    // big page sits in exactly one of the stack, freeBigPages and zeroedBigPages. hotLock
+    // is only try-acquired on the allocation and free paths; on contention they fall
+    // through to the ring.
+    constexpr static size_t hotBigPageCapacity = 16;
+    BigPageMetadata* hotBigPages[hotBigPageCapacity];
+    size_t hotBigPageStart = 0;
+    size_t hotBigPageCount = 0;
+    Spinlock hotLock;
+    // Gigantic tier: the first BigPageMetadata of each gigantic-page-aligned group of
+    // bigPagesPerGiganticPage big pages that lies in one subrange and is entirely free.
+    // Pages of a listed group appear in no other free list. Groups are split into
+    // freeBigPages when the big-page lists run dry, and re-formed lazily: a gigantic
+    // request that finds the list empty claims a group whose pages are all free again.
+    HighReliabilityRingBuffer<BigPageMetadata*, false, true> freeGiganticPages;
+    // Index of the big page each CPU last took from this pool, or SIZE_MAX before its first.
+    // Partial-page lookups search outward from it, so one CPU's small pages stay physically
+    // clustered. Each CPU writes only its own slot, once per big page it takes.
+    size_t localityHints[arch::MAX_PROCESSOR_COUNT];
+    // paPages lookups that ran out of retries while other CPUs were flipping bits. Bumped
+    // only on that slow path, so a shared counter is cheap enough.
+    Atomic<uint64_t> paPagesContention{0};
+    // The sorted ranges the pool was built from. Initializing a big page reserves the parts
+    // of it that none of them cover.
+    const kernel::mm::phys_memory_range* originalRanges;
+    size_t originalRangeCount;
+    // Metadata is initialized in chunks that end at a gigantic-page boundary or at the end of a
+    // subrange. Chunks are claimed in index order by advancing deferredCursor. Once a chunk is
+    // built and published, initializedBigPages advances past it, but only after every earlier
+    // chunk has finished. Metadata below initializedBigPages is therefore always safe to scan.
+    // Pages above it may still be claimed, and they may already be published.
+    Atomic<size_t> deferredCursor{0};
+    Atomic<size_t> initializedBigPages{0};
+    // Free big page counts at which the low-watermark callbacks fire, and re-arm once the pool
+    // has recovered. belowLowWatermark is set from the first crossing until recovery;
+    // lowWatermarkPending stays set from the crossing until the callbacks have run.
+    size_t lowWatermark;
+    size_t highWatermark;
+    Atomic<bool> belowLowWatermark{false};
+    Atomic<bool> lowWatermarkPending{false};
+    constexpr static size_t lowWatermarkCallbackCapacity = 8;
+    kernel::mm::PageAllocator::LowWatermarkCallback lowWatermarkCallbacks[lowWatermarkCallbackCapacity]{};
+    Atomic<size_t> lowWatermarkCallbackCount{0};
+    Spinlock lowWatermarkLock;
 
     void fixupAfterReserveRange();
+    // Construct the metadata for big pages [first, end), all in one subrange, and reserve the
+    // parts of each page that lie outside the original ranges.
+    void constructBigPages(size_t first, size_t end);
+    [[nodiscard]] const SubrangeInfo& subrangeOf(size_t index) const;
+    // End of the chunk starting at big page index start.
+    [[nodiscard]] size_t deferredChunkEnd(size_t start) const;
+    // The partial-page set holding pages of the given lifetime class.
+    [[nodiscard]] AtomicBitPool& partialPages(PageLifetime cls) {
+        return cls == PageLifetime::Long ? longLivedPAPages : paPages;
+    }
+    // Take a page from the partial-page set for cls near pid's locality hint, counting
+    // contended lookups. A CPU without a hint yet falls back to getAny.
+    AtomicBitPool::GetResult getPAPage(PageLifetime cls, size_t pid, size_t& outIndex, size_t maxRetries);
+    // Publish the free big pages in [first, end): whole free groups on freeGiganticPages, the
+    // rest on freeBigPages. Pages with reserved subpages are left out.
+    void publishFreeBigPages(size_t first, size_t end);
+    // Move one group from freeGiganticPages to freeBigPages. Returns false if there was none.
+    bool splitGiganticPage();
+    [[nodiscard]] Optional<kernel::mm::phys_addr> allocateContiguousBigPages(size_t smallPageCount, size_t alignment);
+    bool claimFreeBigPageRun(BigPageMetadata* first, size_t runLength);
+    // Read up to count empty big pages, taking from the hot stack, then freeBigPages, then
+    // zeroedBigPages, so known-zero pages are left for ZEROED requests, and splitting gigantic
+    // groups only once all three are empty. cb receives (index, metadata).
+    template<typename Callback>
+    size_t takeFreeBigPages(size_t count, Callback cb);
+    bool takeFreeBigPage(BigPageMetadata*& out);
+    // Pop up to count (at most hotBigPageCapacity) pages off the hot stack into out, most
+    // recently freed first. Returns 0 without waiting if the stack is busy.
+    size_t takeHotBigPages(BigPageMetadata** out, size_t count);
+    // Publish a newly emptied big page, on the hot stack if it is free to take.
+    void pushFreeBigPage(BigPageMetadata& metadata);
+    [[nodiscard]] size_t zeroedBigPageTarget() const;
+    // Compare approximateFreeBigPages against the watermarks after big pages were taken.
+    void checkWatermarks();
 public:
+    // Capacity of the zeroed small-page list, in small pages.
+    constexpr static size_t zeroedSmallPageCapacity = 2 * kernel::mm::PageAllocator::smallPagesPerBigPage;
+
     NUMAPool(BigPageMetadata* metadataBuffer,
+             kernel::mm::PageFrame* frames,
              BigPageMetadata** freeBuffer,
              Atomic<size_t>* wgc,
             Atomic<size_t>* rgc,
+             BigPageMetadata** zeroedBuffer,
+             Atomic<size_t>* zeroedWgc,
+             Atomic<size_t>* zeroedRgc,
+             PageRef* zeroedSmallBuffer,
+             Atomic<size_t>* zeroedSmallWgc,
+             Atomic<size_t>* zeroedSmallRgc,
+             BigPageMetadata** giganticBuffer,
+             Atomic<size_t>* giganticWgc,
+             Atomic<size_t>* giganticRgc,
+             size_t giganticCapacity,
              AtomicBitPool&& paPagesBitPool,
+             AtomicBitPool&& longLivedBitPool,
              SubrangeInfo* subrangeBuffer,
              size_t numSubranges,
              size_t totalBigPageCount,
-             kernel::numa::DomainID domain);
+             kernel::numa::DomainID domain,
+             const kernel::mm::phys_memory_range* sortedRanges,
+             size_t sortedRangeCount,
+             size_t eagerBigPages);
 
     // Returns the BigPageMetadata for the big page containing addr,
     // or nullptr if addr is not within any subrange of this pool.
     BigPageMetadata* findMetadata(kernel::mm::phys_addr addr);
+    void setMetadataRadix(const MetadataRadix& radix) { metadataRadix = radix; }
 
     // Returns the pool-global index of a BigPageMetadata (its position in metadataBuffer).
     size_t metadataIndex(const BigPageMetadata* meta) const { return static_cast<size_t>(meta - bigPageMetadataBuffer); }
+    // The PageFrame for the small page containing addr, which must lie in the big page meta
+    // describes. meta must belong to this pool.
+    [[nodiscard]] kernel::mm::PageFrame* frameFor(const BigPageMetadata* meta, kernel::mm::phys_addr addr) const {
+        const size_t subpage = (addr.value - meta->baseAddr().value) / arch::smallPageSize;
+        return &frameBuffer[metadataIndex(meta) * kernel::mm::PageAllocator::smallPagesPerBigPage + subpage];
+    }
 
-    [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, BigPageMetadata*& paPageRemaining, AllocFlags flags = {});
+    // Small pages are carved by coloring when it is given (see SmallPageAllocator::alloc).
+    [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, BigPageMetadata*& paPageRemaining,
+                                       AllocFlags flags = {}, PageColoring* coloring = nullptr);
+    // pages must be grouped by big page, with big pages in ascending address order.
     void freePages(PageRef* pages, size_t count);
     void returnPage(BigPageMetadata& metadata, bool evictedAsFull = false);
 
-    // Reserve all small pages within range that fall in this pool.
-    // Must be called before any allocation (init-time only).
+    // Move up to count empty big pages from the hot stack and freeBigPages into out, marking
+    // each as held by pid so contiguous scans leave it alone. Zeroed pages are not taken.
+    // The pages stay free in their SmallPageAllocators while a LocalPool caches them.
+    [[nodiscard]] size_t takeBigPagesForCache(BigPageMetadata** out, size_t count, arch::ProcessorID pid);
+    // Hand cached empty big pages back to freeBigPages with one bulk write.
+    void returnCachedBigPages(BigPageMetadata* const* pages, size_t count);
+
+    // Hand out up to count gigantic pages, each as one PageRef::gigantic. Listed groups go
+    // first; after that, groups whose big pages have all come free individually are claimed
+    // the way a contiguous run is. Returns the number of gigantic pages delivered.
+    [[nodiscard]] size_t allocateGiganticPages(size_t count, PageAllocationCallback cb);
+
+    // Allocate smallPageCount physically contiguous small pages whose base is aligned to
+    // `alignment` bytes. Runs that fit in one big page are carved from a partial page or a
+    // fresh big page (whose remainder is handed back via paPageRemaining, as in
+    // allocatePages); longer runs are built from adjacent free big pages in one subrange.
+    [[nodiscard]] Optional<kernel::mm::phys_addr> allocateContiguous(size_t smallPageCount, size_t alignment,
+                                                                     BigPageMetadata*& paPageRemaining);
+
+    // Hand out up to smallPageCount pages from the pre-zeroed lists: whole zeroed big pages
+    // first, then zeroed small pages unless bigOnly. Returns the number of small pages
+    // delivered, which may fall short (or, for bigOnly, overshoot to a big-page multiple).
+    [[nodiscard]] size_t allocateZeroedPages(size_t smallPageCount, PageAllocationCallback cb, bool bigOnly);
+    // Zero up to maxBigPages of the oldest free big pages with zeroFn, moving them to the
+    // zeroed lists until those reach their targets. Returns the number of big pages zeroed.
+    // Returns 0 immediately if another CPU is already refilling this pool.
+    size_t refillZeroedPages(kernel::mm::PageAllocator::PageZeroer zeroFn, size_t maxBigPages);
+
+    // Reserve all small pages within range that fall in this pool. Any deferred chunks the range
+    // touches are initialized first. Must be called before any allocation (init-time only).
     void reserveRange(kernel::mm::phys_memory_range range);
 
+    // Claim the next uninitialized chunk of big pages, then build and publish it. Any number
+    // of CPUs may call this concurrently with allocation. Returns false once every chunk has
+    // been claimed.
+    bool initializeDeferredChunk();
+    [[nodiscard]] bool hasDeferredBigPages() const { return deferredCursor.load(RELAXED) < bigPageCount; }
+    // Length of the prefix of big pages whose metadata has been built.
+    [[nodiscard]] size_t getInitializedBigPageCount() const { return initializedBigPages.load(ACQUIRE); }
+
     kernel::numa::DomainID domain() const { return associatedDomain; }
 
     const SubrangeInfo* getSubranges()    const { return subrangeInfo; }
     size_t              getSubrangeCount() const { return subrangeCount; }
 
+    // Free big pages on the hot stack, the free and zeroed rings, and inside listed gigantic
+    // groups. Big pages cached by a LocalPool are not included.
+    [[nodiscard]] size_t countFreeBigPages();
+    // Sum of freeSubpageCount() across every initialized BigPageMetadata in this pool.
+    // Correctly accounts for pages in freeBigPages, paPages, or cached in a LocalPool.
+    [[nodiscard]] size_t countTotalFreePages() const;
+    // Free big pages on the free, zeroed and gigantic lists plus big pages whose metadata is
+    // not built yet, without taking any lock. Ignores the hot stack, so it may read up to
+    // hotBigPageCapacity low.
+    [[nodiscard]] size_t approximateFreeBigPages() const;
+    // Default watermarks are derived from the pool size; see PA_LOW_WATERMARK_FRACTION.
+    void setWatermarks(size_t lowBigPages, size_t highBigPages);
+    bool addLowWatermarkCallback(kernel::mm::PageAllocator::LowWatermarkCallback callback);
+    // Run the callbacks if the pool crossed its low watermark since they last ran. Returns
+    // true if they ran. Only one caller runs them per crossing.
+    bool runLowWatermarkCallbacks();
+    [[nodiscard]] uint64_t getPAPagesContention() const { return paPagesContention.load(RELAXED); }
+    // Stalled reads summed over this pool's free-list rings.
+    [[nodiscard]] uint64_t getRingStallCount() const {
+        return freeBigPages.stallCount() + zeroedBigPages.stallCount() + zeroedSmallPages.stallCount()
+             + freeGiganticPages.stallCount();
+    }
+
 #ifdef CROCOS_TESTING
-    // Number of free big pages currently in the freeBigPages ring buffer.
-    [[nodiscard]] size_t getFreeBigPageCount() const { return freeBigPages.availableToRead(); }
-    // Number of indices currently set in paPages.  Quiescent state only.
-    [[nodiscard]] size_t getPAPagesCount()     const { return paPages.countSet(); }
+    // Number of free big pages on the hot stack, in the freeBigPages and zeroedBigPages ring
+    // buffers, and inside listed gigantic groups.
+    [[nodiscard]] size_t getFreeBigPageCount() const {
+        return hotBigPageCount + freeBigPages.availableToRead() + zeroedBigPages.availableToRead()
+             + freeGiganticPages.availableToRead() * kernel::mm::PageAllocator::bigPagesPerGiganticPage;
+    }
+    // Number of whole groups on the gigantic free list.
+    [[nodiscard]] size_t getFreeGiganticPageCount() const { return freeGiganticPages.availableToRead(); }
+    // Number of free big pages on the hot stack.  Quiescent state only.
+    [[nodiscard]] size_t getHotBigPageCount() const { return hotBigPageCount; }
+    // Number of free big pages known to be zero.
+    [[nodiscard]] size_t getZeroedBigPageCount() const { return zeroedBigPages.availableToRead(); }
+    // Number of small pages waiting in the zeroed small-page list.
+    [[nodiscard]] size_t getZeroedSmallPageCount() const { return zeroedSmallPages.availableToRead(); }
+    // Number of indices currently set in either partial-page set.  Quiescent state only.
+    [[nodiscard]] size_t getPAPagesCount()     const { return paPages.countSet() + longLivedPAPages.countSet(); }
+    [[nodiscard]] size_t getPAPagesCount(PageLifetime cls) const {
+        return cls == PageLifetime::Long ? longLivedPAPages.countSet() : paPages.countSet();
+    }
     [[nodiscard]] size_t getTotalBigPageCount()const { return bigPageCount; }
-    // Returns true if the given pool-global big-page index is currently in paPages.
-    [[nodiscard]] bool   isInPAPages(size_t i) const { return paPages.isSet(i); }
+    // Returns true if the given pool-global big-page index is currently in either partial-page set.
+    [[nodiscard]] bool   isInPAPages(size_t i) const { return paPages.isSet(i) || longLivedPAPages.isSet(i); }
     // Quiescent-state invariant check: all paPages entries must be partial pages.
     [[nodiscard]] bool   checkInvariants()     const;
-    // Sum of freeSubpageCount() across every BigPageMetadata in this pool.
-    // Correctly accounts for pages in freeBigPages, paPages, or cached in a LocalPool.
-    [[nodiscard]] size_t countTotalFreePages() const;
 #endif
 };
 
+// Per-CPU allocation events, kept by each LocalPool; see kernel::mm::AllocationCounters.
+enum class AllocEvent : size_t {
+    FastPathHit,
+    Fallback,
+    MagazineRefill,
+    BigPageCacheRefill,
+    RemoteDomainPages,
+    RemoteFreesPosted,
+    ReservePages,
+    ReserveShortfall,
+    Count
+};
+
 class LocalPool {
+public:
+    constexpr static size_t magazineCapacity = 64;
+    // Pages moved per magazine refill or spill.
+    constexpr static size_t magazineBatch = magazineCapacity / 2;
+    constexpr static size_t remoteFreeCapacity = 256;
+    constexpr static size_t bigPageCacheCapacity = 16;
+    // Big pages moved per cache refill or spill.
+    constexpr static size_t bigPageCacheBatch = bigPageCacheCapacity / 2;
+    // The emergency reserve is topped back up to capacity once it drops below this.
+    constexpr static size_t reserveCapacity = 64;
+    constexpr static size_t reserveLowWatermark = reserveCapacity / 4;
+    constexpr static size_t deferredFreeCapacity = 256;
+private:
+    struct DeferredFree {
+        PageRef page;
+        uint64_t generation;
+    };
+
     BigPageMetadata* paPage1 = nullptr;
     BigPageMetadata* paPage2 = nullptr;
+    // Partial page serving this CPU's LONG_LIVED small allocations. Kept out of the
+    // paPage1/paPage2 slots so the two lifetime classes never share a big page.
+    BigPageMetadata* longLivedPage = nullptr;
     const kernel::numa::NUMATopology* topology;
     NUMAPool* homePool = nullptr;
     const arch::ProcessorID pid;
+    // Stack of single small pages sitting in front of paPage1/paPage2. Pages in the
+    // magazine count as allocated in their SmallPageAllocator, so pushing and popping
+    // is plain non-atomic stack traffic on the owning CPU.
+    PageRef magazine[magazineCapacity];
+    size_t magazineCount = 0;
+    // Inbox of small pages that other CPUs freed into big pages this CPU holds. Each run is
+    // posted with a single enqueue and freed by this CPU before it leaves the allocation it
+    // was in, so the holder's bitmaps are written from here while they are hot.
+    PageRef remoteFreeStorage[remoteFreeCapacity];
+    MPMCRingBuffer<PageRef, false> remoteFrees{remoteFreeStorage, remoteFreeCapacity};
+    // Allocations this CPU is currently inside. Other CPUs only post to remoteFrees while it
+    // is nonzero, since a CPU outside any allocation may not come back to drain for a long time.
+    Atomic<uint32_t> allocationDepth{0};
+    // Stack of whole empty big pages from the home pool for BIG_PAGE_ONLY requests. Unlike
+    // magazine pages these stay free in their SmallPageAllocator; allocHolder marks them as
+    // ours until they are handed out or spilled back to freeBigPages.
+    BigPageMetadata* bigPageCache[bigPageCacheCapacity];
+    size_t bigPageCacheCount = 0;
+    // FIFO of pages this CPU unmapped, each waiting until every CPU has flushed past its
+    // generation. Generations never decrease from head to tail, so the ready entries are
+    // always a prefix. Owning CPU only.
+    DeferredFree deferredFrees[deferredFreeCapacity];
+    size_t deferredFreeHead = 0;
+    size_t deferredFreeCount = 0;
+    // Latest TLB flush generation this CPU has flushed past. Written only by this CPU but
+    // scanned by every CPU releasing deferred frees, so it gets a line of its own.
+    alignas(64) Atomic<uint64_t> flushedGeneration{0};
+    // Only this CPU writes its counters, so a bump is a relaxed load and store rather than a
+    // locked add. Other CPUs read them for statistics and may see them slightly behind.
+    alignas(64) Atomic<uint64_t> events[static_cast<size_t>(AllocEvent::Count)]{};
+    // Domain that the next INTERLEAVE request from this CPU starts its stripes at.
+    size_t interleaveCursor = 0;
+    // Emergency reserve of small pages for ATOMIC_RESERVE requests, counted as allocated
+    // like magazine pages. Unlike the rest of the pool it may be popped from an interrupt
+    // that lands in the middle of this CPU's own push or pop, so both sides move
+    // reserveCount with a compare-exchange and a pop re-reads its slot if it loses.
+    PageRef reserve[reserveCapacity];
+    Atomic<size_t> reserveCount{0};
+    // Set while this CPU is refilling its reserve, so the refill's own allocation does not
+    // start another one.
+    bool reserveRefilling = false;
+    // This CPU's cursor for COLORED requests; colorCount stays 1 while coloring is off.
+    PageColoring coloring;
+
+    // Serve LONG_LIVED small pages from longLivedPage only.
+    [[nodiscard]] size_t allocateLongLived(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags,
+                                           PageColoring* pageColoring);
 public:
     explicit LocalPool(const kernel::numa::NUMATopology* topo = nullptr, NUMAPool* home = nullptr, arch::ProcessorID proc_id = 0)
         : topology(topo), homePool(home), pid(proc_id) {}
 
-    [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags = {});
+    [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags = {},
+                                       PageColoring* pageColoring = nullptr);
+    // Try to carve an aligned run out of a cached page belonging to the given domain.
+    [[nodiscard]] Optional<kernel::mm::phys_addr> allocateContiguous(size_t smallPageCount, size_t alignPages,
+                                                                     kernel::numa::DomainID domain);
     void tryGivePAPage(BigPageMetadata& page);
+
+    [[nodiscard]] bool magazineEmpty() const { return magazineCount == 0; }
+    [[nodiscard]] bool magazineFull()  const { return magazineCount == magazineCapacity; }
+    [[nodiscard]] size_t magazineSize() const { return magazineCount; }
+    PageRef popMagazine() {
+        assert(magazineCount > 0, "Popped from empty page magazine");
+        return magazine[--magazineCount];
+    }
+    void pushMagazine(PageRef page) {
+        assert(magazineCount < magazineCapacity, "Pushed to full page magazine");
+        assert(page.size() == kernel::mm::PageSize::SMALL, "Only small pages belong in the page magazine");
+        magazine[magazineCount++] = page;
+    }
+    // Move up to `count` of the least recently pushed pages into out; returns how many moved.
+    size_t drainMagazine(PageRef* out, size_t count);
+    [[nodiscard]] bool magazineContains(PageRef page) const {
+        for (size_t i = 0; i < magazineCount; i++) {
+            if (magazine[i].addr() == page.addr()) return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool bigPageCacheEmpty() const { return bigPageCacheCount == 0; }
+    [[nodiscard]] bool bigPageCacheFull() const { return bigPageCacheCount == bigPageCacheCapacity; }
+    [[nodiscard]] size_t bigPageCacheSize() const { return bigPageCacheCount; }
+    BigPageMetadata* popBigPageCache() {
+        assert(bigPageCacheCount > 0, "Popped from empty big page cache");
+        return bigPageCache[--bigPageCacheCount];
+    }
+    void pushBigPageCache(BigPageMetadata& page) {
+        assert(bigPageCacheCount < bigPageCacheCapacity, "Pushed to full big page cache");
+        assert(page.isAllocHolder(pid), "Cached big pages must be held by the caching CPU");
+        bigPageCache[bigPageCacheCount++] = &page;
+    }
+    // Move up to `count` of the least recently pushed big pages into out; returns how many moved.
+    size_t drainBigPageCache(BigPageMetadata** out, size_t count);
+
+    [[nodiscard]] size_t reserveSize() const { return reserveCount.load(RELAXED); }
+    [[nodiscard]] bool reserveLow() const { return reserveSize() < reserveLowWatermark; }
+    bool popReserve(PageRef& out);
+    // Owning CPU only, outside interrupt context.
+    void pushReserve(PageRef page);
+    // False if a refill is already under way further up this CPU's stack.
+    [[nodiscard]] bool beginReserveRefill() {
+        if (reserveRefilling) return false;
+        reserveRefilling = true;
+        return true;
+    }
+    void endReserveRefill() { reserveRefilling = false; }
+
+    // Queue a run of pages freed on another CPU. Returns false if the inbox lacks room.
+    bool postRemoteFrees(const PageRef* pages, size_t count) {
+        return remoteFrees.tryBulkWrite(count, [&](size_t index, PageRef& slot) { slot = pages[index]; });
+    }
+    [[nodiscard]] bool hasRemoteFrees() const { return !remoteFrees.empty(); }
+    // Owner only. leaveAllocation returns true when it left the outermost allocation.
+    void enterAllocation() { allocationDepth.store(allocationDepth.load(RELAXED) + 1, RELAXED); }
+    bool leaveAllocation() {
+        const uint32_t depth = allocationDepth.load(RELAXED) - 1;
+        allocationDepth.store(depth, RELEASE);
+        return depth == 0;
+    }
+    [[nodiscard]] bool isAllocating() const { return allocationDepth.load(RELAXED) != 0; }
+    // Move up to `count` queued remote frees into out; returns how many moved.
+    size_t takeRemoteFrees(PageRef* out, size_t count) {
+        return remoteFrees.bulkReadBestEffort(count, [&](size_t index, const PageRef& page) { out[index] = page; });
+    }
+
+    [[nodiscard]] bool hasDeferredFrees() const { return deferredFreeCount != 0; }
+    [[nodiscard]] bool deferredFreesFull() const { return deferredFreeCount == deferredFreeCapacity; }
+    [[nodiscard]] size_t deferredFreeSize() const { return deferredFreeCount; }
+    void pushDeferredFree(PageRef page, uint64_t generation) {
+        assert(deferredFreeCount < deferredFreeCapacity, "Pushed to full deferred-free queue");
+        deferredFrees[(deferredFreeHead + deferredFreeCount++) % deferredFreeCapacity] = {page, generation};
+    }
+    // Move up to count of the oldest queued pages stamped at or before generation into out;
+    // returns how many moved.
+    size_t takeDeferredFrees(PageRef* out, size_t count, uint64_t generation);
+    [[nodiscard]] uint64_t oldestDeferredGeneration() const {
+        assert(deferredFreeCount > 0, "No deferred frees queued");
+        return deferredFrees[deferredFreeHead].generation;
+    }
+    // Owning CPU only.
+    void noteTlbFlush(uint64_t generation) {
+        if (generation > flushedGeneration.load(RELAXED)) flushedGeneration.store(generation, RELEASE);
+    }
+    [[nodiscard]] uint64_t getFlushedGeneration() const { return flushedGeneration.load(ACQUIRE); }
+
+    // Record count occurrences of event. Must run on the CPU that owns this pool.
+    void countEvent(AllocEvent event, uint64_t count = 1) {
+        auto& counter = events[static_cast<size_t>(event)];
+        counter.store(counter.load(RELAXED) + count, RELAXED);
+    }
+    [[nodiscard]] uint64_t getEventCount(AllocEvent event) const { return events[static_cast<size_t>(event)].load(RELAXED); }
+    [[nodiscard]] kernel::mm::AllocationCounters readCounters() const;
+
+    // Rotates through [0, domainCount) across calls. Must run on the owning CPU.
+    size_t nextInterleaveStart(size_t domainCount) { return interleaveCursor++ % domainCount; }
+
+    [[nodiscard]] PageColoring& pageColoring() { return coloring; }
 };
 
 // ==================== New Page Allocator ====================
@@ -270,6 +740,39 @@ struct PageAllocatorImpl {
     // Sentinel DomainID{} (UINT16_MAX) means no pool was found (should not occur
     // after createPageAllocator completes successfully).
     kernel::numa::DomainID cpuNearestPool[arch::MAX_PROCESSOR_COUNT];
+    // When set, single small-page allocations and frees are served from the calling
+    // CPU's LocalPool magazine. Off by default so that freed pages flow straight back to
+    // their pools; initPageAllocator enables it once the allocator is live.
+    bool magazinesEnabled = false;
+    // Clears physical memory for ZEROED allocations and the idle zeroing worker.
+    // nullptr until some subsystem that can map physical pages registers one.
+    kernel::mm::PageAllocator::PageZeroer pageZeroer = nullptr;
+    // When set, small pages freed into a big page that another CPU holds for allocation are
+    // queued on that CPU's remote-free inbox instead of being written into its bitmaps.
+    // Off by default; initPageAllocator enables it once the allocator is live.
+    bool remoteFreesEnabled = false;
+    // When set, a CPU whose emergency reserve fell below LocalPool::reserveLowWatermark tops
+    // it up on its next slow-path allocation. Off by default; initPageAllocator enables it.
+    bool reservesEnabled = false;
+    // When set, BIG_PAGE_ONLY requests for at most LocalPool::bigPageCacheBatch big pages,
+    // and single big-page frees, go through the calling CPU's big-page cache. Off by
+    // default; initPageAllocator enables it once the allocator is live.
+    bool bigPageCachesEnabled = false;
+    // When set, freePages first releases whatever the calling CPU queued with
+    // freePagesAfterTlbFlush that every CPU has since flushed past. Off by default;
+    // initPageAllocator enables it once the allocator is live.
+    bool deferredFreesEnabled = false;
+    // Makes every CPU flush its TLB and report it; run when a deferred-free queue fills with
+    // nothing ready. nullptr until whoever drives TLB shootdowns registers one.
+    kernel::mm::PageAllocator::TlbShootdown tlbShootdown = nullptr;
+    // Number of cache colors COLORED requests rotate through; 1 leaves coloring off. Set
+    // through setPageColors, which initPageAllocator calls with the L2's geometry.
+    size_t pageColors = 1;
+    // Direct address lookup shared with every NUMAPool. When invalid (no radix was passed to
+    // createPageAllocator), findMetadata binary-searches domainTable instead.
+    MetadataRadix metadataRadix{};
+    // Number of valid entries in localPools.
+    size_t processorCount = 0;
 
     // Returns the nearest non-null NUMAPool for the given CPU, using the
     // precomputed cpuNearestPool table.  Asserts if no pool was found.
@@ -285,18 +788,142 @@ struct PageAllocatorImpl {
     // Looks up the BigPageMetadata for the big page containing addr.
     // Returns nullptr if addr is outside all known ranges.
     BigPageMetadata* findMetadata(kernel::mm::phys_addr addr);
+    // The PageFrame for the small page containing addr; see kernel::mm::PageAllocator::frameFor.
+    [[nodiscard]] kernel::mm::PageFrame* frameFor(kernel::mm::phys_addr addr);
 private:
-    [[nodiscard]] inline size_t allocateFast(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags);
-    [[nodiscard]] inline size_t allocateFallback(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags);
+    [[nodiscard]] inline size_t allocateFast(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags,
+                                             PageColoring* coloring = nullptr);
+    [[nodiscard]] inline size_t allocateFallback(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags,
+                                                 PageColoring* coloring = nullptr);
+    // Serve a COLORED request through the fast and fallback paths, with small pages taken by coloring.
+    [[nodiscard]] size_t allocateColored(size_t smallPageCount, PageAllocationCallback cb, PageColoring& coloring, AllocFlags flags);
+    [[nodiscard]] size_t allocateFromMagazine(PageAllocationCallback cb, AllocFlags flags);
+    bool freeToMagazine(PageRef page);
+    // Asserts that every frame describing pages was cleared by whoever last set state on it.
+    void assertFramesCleared(const PageRef* pages, size_t count);
+    [[nodiscard]] size_t allocateFromBigPageCache(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags);
+    bool freeToBigPageCache(PageRef page);
+    // Serve an INTERLEAVE request: each pool with a nonzero weight in the policy's interleave
+    // weights for initiator gets a big-page-aligned stripe of the request sized by that weight.
+    // Stripes a pool cannot fill are covered in the ordinary fallback order.
+    [[nodiscard]] size_t allocateInterleaved(size_t smallPageCount, PageAllocationCallback cb,
+                                             kernel::numa::DomainID initiator, AllocFlags flags);
+    // Serve a GIGANTIC_PAGE_ONLY request from the pools in the policy's order from targetDomain.
+    [[nodiscard]] size_t allocateGigantic(size_t smallPageCount, PageAllocationCallback cb,
+                                          kernel::numa::DomainID targetDomain, AllocFlags flags);
+    // Post runs of ordered pages held by other CPUs to their inboxes and compact the rest to
+    // the front of pages. Returns the number of pages left to free here.
+    size_t postRemoteFrees(PageRef* pages, size_t count);
+    // Free pages ordered as NUMAPool::freePages expects straight into their owning pools.
+    void freeSortedPages(PageRef* pages, size_t count);
+    void drainOwnRemoteFrees();
+    // Lowest TLB flush generation every CPU has flushed past. Only rescans the CPUs when the
+    // last known value is below needed.
+    [[nodiscard]] uint64_t generationFlushedEverywhere(uint64_t needed) const;
+    // Flush cpu's own TLB, globals included, and report it. Must run on cpu.
+    void flushOwnTlb(arch::ProcessorID cpu);
+    // Serve a ZEROED request: pre-zeroed pages from preferred first, then pages from
+    // allocDirty that are cleared with pageZeroer before cb sees them.
+    [[nodiscard]] size_t allocateZeroed(size_t smallPageCount, PageAllocationCallback cb, NUMAPool& preferred,
+                                        FunctionRef<size_t(size_t, PageAllocationCallback, AllocFlags)> allocDirty,
+                                        AllocFlags flags);
+    // Serve an ATOMIC_RESERVE request from the calling CPU's reserve alone.
+    [[nodiscard]] size_t allocateFromReserve(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags);
+    // Refill the calling CPU's reserve if it ran low and run any pending low-watermark
+    // callbacks. Called at the top of the allocation slow paths.
+    void serviceReserveAndWatermarks();
+    // Body of both allocatePageRuns overloads; allocate is the matching allocatePages overload.
+    [[nodiscard]] size_t collectPageRuns(size_t smallPageCount, PageRef* runs, size_t maxRuns, size_t& runCount,
+                                         FunctionRef<size_t(size_t, PageAllocationCallback, AllocFlags)> allocate,
+                                         AllocFlags flags);
 public:
     [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags = {});
     [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, kernel::numa::DomainID targetDomain, AllocFlags flags = {});
     [[nodiscard]] size_t allocatePages(size_t smallPageCount, PageAllocationCallback cb, arch::ProcessorID targetProc, AllocFlags flags = {});
+    // COLORED allocation driven by cursor (see mm::PageAllocator::allocateColoredPages).
+    [[nodiscard]] size_t allocateColoredPages(size_t smallPageCount, PageAllocationCallback cb,
+                                              kernel::mm::PageAllocator::PageColorCursor& cursor, AllocFlags flags = {});
+    // Use colors cache colors (a power of two, at most smallPagesPerBigPage; 1 turns coloring
+    // off). Each CPU's cursor starts at its own evenly spaced offset, so CPUs sharing an outer
+    // cache begin on different colors. Call while no CPU is allocating.
+    void setPageColors(size_t colors);
+    // Reorders pages in place (see mm::PageAllocator::freePages).
     void freePages(PageRef* pages, size_t count);
+    // Allocate smallPageCount small pages as at most maxRuns run-length PageRefs (see
+    // mm::PageAllocator::allocatePageRuns). Sets runCount; returns the small pages covered.
+    [[nodiscard]] size_t allocatePageRuns(size_t smallPageCount, PageRef* runs, size_t maxRuns, size_t& runCount,
+                                          AllocFlags flags = {});
+    [[nodiscard]] size_t allocatePageRuns(size_t smallPageCount, PageRef* runs, size_t maxRuns, size_t& runCount,
+                                          kernel::numa::DomainID targetDomain, AllocFlags flags = {});
+    // Free refs from allocatePageRuns, runs and single pages alike. runs is left untouched.
+    void freePageRuns(const PageRef* runs, size_t count);
+
+    // Allocate smallPageCount physically contiguous small pages whose base address is a
+    // multiple of alignment (a power of two, at least smallPageSize). Domains are tried in
+    // the policy's fallback order from targetDomain. Panics on failure unless GRACEFUL_OOM.
+    [[nodiscard]] Optional<kernel::mm::phys_addr> allocateContiguous(size_t smallPageCount, size_t alignment,
+                                                                     kernel::numa::DomainID targetDomain,
+                                                                     AllocFlags flags = {});
+    // Free a run obtained from allocateContiguous. Whole big pages inside the run are
+    // released as big pages, everything else page by page.
+    void freeContiguous(kernel::mm::phys_addr base, size_t smallPageCount);
+    // Return every page in cpu's magazine to its pool. Must run on cpu, or while
+    // cpu is not allocating.
+    void flushMagazine(arch::ProcessorID cpu);
+    // Return every big page in cpu's big-page cache to its pool. Same rules as flushMagazine.
+    void flushBigPageCache(arch::ProcessorID cpu);
+    // Top cpu's reserve back up to LocalPool::reserveCapacity if it is below its low
+    // watermark. Must run on cpu outside interrupt context. Returns the pages added.
+    size_t refillReserve(arch::ProcessorID cpu);
+    // Return every page in cpu's reserve to its pool. Same rules as flushMagazine.
+    void flushReserve(arch::ProcessorID cpu);
+    // Register callback on every pool, the unowned pool included. False if any pool was full.
+    bool addLowWatermarkCallback(kernel::mm::PageAllocator::LowWatermarkCallback callback);
+    // Run the low-watermark callbacks of every pool that crossed its watermark since they last ran.
+    void runLowWatermarkCallbacks();
+    // Free every page waiting in cpu's remote-free inbox. Happens when cpu leaves the
+    // allocation the pages were posted during; call directly only on cpu itself or while
+    // cpu is not allocating.
+    void drainRemoteFrees(arch::ProcessorID cpu);
+    // Brackets an allocation on the current CPU, opening its inbox to other CPUs' frees for
+    // the duration. Leaving the outermost one drains whatever was posted meanwhile.
+    struct AllocationScope {
+        PageAllocatorImpl& impl;
+        // nullptr when remote frees are off, so there is nothing to open or drain.
+        LocalPool* localPool = nullptr;
+        arch::ProcessorID cpu;
+        explicit AllocationScope(PageAllocatorImpl& impl);
+        ~AllocationScope();
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator=(const AllocationScope&) = delete;
+    };
+    // Deferred freeing across TLB flushes; see the matching functions in mm::PageAllocator.
+    [[nodiscard]] static uint64_t tlbFlushGeneration();
+    void noteTlbFlush(arch::ProcessorID cpu, uint64_t generation);
+    [[nodiscard]] size_t freePagesAfterTlbFlush(const PageRef* pages, size_t count);
+    // Flush cpu's TLB if anything was queued since its last reported flush.
+    void catchUpTlbFlush(arch::ProcessorID cpu);
+    // Free what cpu has queued that every CPU has flushed past. Same rules as drainRemoteFrees.
+    size_t releaseDeferredFrees(arch::ProcessorID cpu);
+    // Run the zeroing worker over every pool, nearest first, spending at most maxBigPages
+    // zeroing operations in total. Returns the number of big pages zeroed.
+    size_t zeroFreePages(size_t maxBigPages);
 
     // Reserve all small pages in range across all pools (init-time only).
     void reserveRange(kernel::mm::phys_memory_range range);
 
+    // Build one deferred metadata chunk. Tries preferred first, then (unless preferredOnly)
+    // every other pool and the unowned pool. Returns the pool that grew, or nullptr if there
+    // was nothing left to build.
+    NUMAPool* initializeDeferredChunk(NUMAPool& preferred, bool preferredOnly = false);
+    // Build deferred metadata until none is left. cpu's nearest pool goes first, so each CPU
+    // starts on its own domain's memory.
+    void initializeDeferredPages(arch::ProcessorID cpu);
+
+    // Gather free-page counts and event counters from every pool and CPU. Walks every
+    // BigPageMetadata, so it is meant for diagnostics rather than allocation decisions.
+    [[nodiscard]] kernel::mm::MemoryStatistics getStatistics();
+
 #ifdef CROCOS_TESTING
     // Sum of free subpages across all NUMAPools (and the unowned pool, if present).
     // Includes pages cached in LocalPools, since their SmallPageAllocators track occupancy
@@ -309,9 +936,12 @@ public:
 #endif
 };
 
+// Only the first eagerBigPages big pages (rounded up to a whole chunk) get their metadata
+// built here. The rest is left for NUMAPool::initializeDeferredChunk.
 NUMAPool*         createNumaPool(BootstrapAllocator& alloc,
                                  const Vector<kernel::mm::phys_memory_range>& ranges,
-                                 kernel::numa::DomainID domain = kernel::numa::DomainID{0});
+                                 kernel::numa::DomainID domain = kernel::numa::DomainID{0},
+                                 size_t eagerBigPages = static_cast<size_t>(-1));
 LocalPool*        createLocalPool(BootstrapAllocator& alloc,
                                   const kernel::numa::NUMATopology* topology = nullptr,
                                   NUMAPool* homePool = nullptr, arch::ProcessorID procId = 0);
@@ -321,10 +951,13 @@ LocalPool*        createLocalPool(BootstrapAllocator& alloc,
 // lookup via numaPools[domainID] in the hot allocation path.
 // processorCount is the number of valid logical CPU IDs ([0, processorCount)).
 // It is used to populate cpuNearestPool when numaPolicy is provided.
+// metadataRadix, when valid, must cover every range of every pool (see createMetadataRadix);
+// each pool is inserted into it and it then backs all address-to-metadata lookups.
 PageAllocatorImpl createPageAllocator(Vector<NUMAPool*>&& perDomainAllocs, LocalPool** localPools,
                                       size_t processorCount,
                                       NUMAPool* unownedPool = nullptr,
-                                      const kernel::numa::NUMAPolicy* numaPolicy = nullptr);
+                                      const kernel::numa::NUMAPolicy* numaPolicy = nullptr,
+                                      MetadataRadix metadataRadix = {});
 
 // Global page allocator instance, set by initPageAllocator().
 extern PageAllocatorImpl* gPageAllocator;
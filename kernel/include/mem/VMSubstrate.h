@@ -14,16 +14,47 @@ namespace kernel::mm::VMSubstrate {
     // Returns the base virtual address of the arena at the given index.
     virt_addr arenaVirtualBase(size_t index);
     void* allocPage();
+    // Frees never wait on other CPUs: the unmapping is invalidated in the calling CPU's TLB,
+    // and the physical page goes back to the page allocator once every CPU has flushed past it.
     void freePage(void*);
+    // As freePage for many pages, with one local flush and one deferred free per batch.
+    void freePages(void* const* pages, size_t count);
+
+    // Runs are mapped within one leaf page table, less the entries holding its bitmaps.
+    constexpr size_t maxPagesPerRun = 480;
+    // Maps count virtually adjacent small pages with one tree walk. Release with freePageRun.
+    void* allocPages(size_t count);
+    void freePageRun(void* first, size_t count);
+    // Maps one PageAllocator big page with a single upper-level entry, so it costs one TLB entry.
+    // Returns nullptr once every big-page slot in the arena holds a page table.
+    void* allocBigPage();
+    void freeBigPage(void*);
 
     void ensureTLBEntryFresh(void*);
 
+    // Hands the page tables of the calling CPU's arena that have emptied back to the page
+    // allocator, which frees them once every CPU has flushed its TLB. Allocations here do this
+    // on their own; idle loops can call it too. Returns the number of tables released.
+    size_t reclaimPageTables();
+
+    // Lock-free per-CPU heap on the calling CPU's arena; results are 16-byte aligned. nullptr
+    // when size exceeds what one page run can hold or the arena is full. vmsfree may be called
+    // from any CPU and hands the object back to the arena it came from.
     void* vmsmalloc(size_t size);
     void vmsfree(void*);
+    // Boot-time check of the heap on the calling CPU's arena. Asserts on failure.
+    bool heapSelfCheck();
 
     // Maps a physical MMIO page into the current CPU's arena with cache-disable semantics.
     // paddr must be page-aligned.  The returned virtual address is permanently mapped.
     void* mapMMIOPage(phys_addr paddr);
+    // As mapMMIOPage, for count adjacent pages from paddr (at most maxPagesPerRun), or for one
+    // big page at a big-page-aligned paddr. mapMMIOBigPage returns nullptr as allocBigPage does.
+    void* mapMMIOPages(phys_addr paddr, size_t count);
+    void* mapMMIOBigPage(phys_addr paddr);
+    // Boot-time check of the run, big-page and MMIO mappings on the calling CPU's arena.
+    // Asserts on failure.
+    bool mappingSelfCheck();
 
     template <typename T>
     struct SafePtr {
@@ -45,7 +76,9 @@ namespace kernel::mm::VMSubstrate {
 
     template <typename T, typename... Ts>
     SafePtr<T> make(Ts&&... args) {
+        static_assert(alignof(T) <= 16, "vmsmalloc only aligns objects to 16 bytes");
         auto* mem = vmsmalloc(sizeof(T));
+        if (!mem) return nullptr;
         return new (mem) T(forward<Ts>(args)...);
     }
 
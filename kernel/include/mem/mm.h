@@ -16,24 +16,87 @@
 // ==================== Allocation Behavior Flags ====================
 
 enum class AllocBehavior : uint32_t {
-    BIG_PAGE_ONLY     = 1u << 0,  // Only allocate big (2MiB) pages; never fall back to small pages
-    LOCAL_DOMAIN_ONLY = 1u << 1,  // Only allocate from the calling CPU's local pool; never go to NUMA pool
-    GRACEFUL_OOM      = 1u << 2,  // Return a short count instead of panicking when memory is exhausted
+    BIG_PAGE_ONLY      = 1u << 0,  // Only allocate big (2MiB) pages; never fall back to small pages
+    LOCAL_DOMAIN_ONLY  = 1u << 1,  // Only allocate from the calling CPU's local pool; never go to NUMA pool
+    GRACEFUL_OOM       = 1u << 2,  // Return a short count instead of panicking when memory is exhausted
+    ZEROED             = 1u << 3,  // Every returned page reads as zero; served from pre-zeroed pages when possible
+    GIGANTIC_PAGE_ONLY = 1u << 4,  // Only allocate gigantic (1GiB) pages, each a whole aligned group of big pages
+    INTERLEAVE         = 1u << 5,  // Spread the request over all domains in proportion to their bandwidth from the caller
+    LONG_LIVED         = 1u << 6,  // Small pages expected to outlive typical churn; packed into big pages of their own
+    SHORT_LIVED        = 1u << 7,  // Explicitly transient small pages; the default lifetime class when neither is set
+    PAGE_RUNS          = 1u << 8,  // The callback accepts run-length PageRefs (PageRef::runLength) for adjacent small pages
+    ATOMIC_RESERVE     = 1u << 9,  // Small pages from the calling CPU's emergency reserve only; bounded time, interrupt safe, never panics
+    COLORED            = 1u << 10, // Small pages walk the cache colors from the calling CPU's color cursor (see pageColorCount)
 };
 template<> struct is_flags_enum<AllocBehavior> { static constexpr bool value = true; };
 using AllocFlags = Flags<AllocBehavior>;
 
 namespace kernel::mm{
 
+    // Page allocator events on one CPU since boot. Each CPU bumps only its own copy.
+    struct AllocationCounters{
+        uint64_t fastPathHits;        //requests served by the local pool, magazine or big-page cache alone
+        uint64_t fallbacks;           //entries into the NUMA-pool fallback path
+        uint64_t magazineRefills;
+        uint64_t bigPageCacheRefills;
+        uint64_t remoteDomainPages;   //small pages handed out from a domain other than the one targeted
+        uint64_t remoteFreesPosted;   //small pages queued on another CPU's remote-free inbox
+        uint64_t reservePages;        //small pages handed out to ATOMIC_RESERVE requests
+        uint64_t reserveShortfalls;   //ATOMIC_RESERVE requests the reserve could not fully serve
+    };
+
+    // Snapshot of the page allocator. Per-domain vectors are indexed by DomainID and read
+    // without stopping other CPUs, so entries may be a few operations apart from each other.
     struct MemoryStatistics{
         Vector<size_t> freeBigPageCount;
         Vector<size_t> freeSmallPageCount; //includes sub-pages of big pages
-        size_t globalPoolSize;
+        Vector<uint64_t> paPagesContention; //partial-page lookups that gave up under contention
+        Vector<uint64_t> ringStalls; //free-list reads that had to wait on an in-flight write
+        size_t globalPoolSize; //free small pages with no NUMA affinity
+        Vector<AllocationCounters> perCpu;
+        AllocationCounters total;
+    };
+
+    enum class PageFrameFlag : uint8_t {
+        SHARED        = 1u << 0,  // mapped by more than one backing region or address space
+        COPY_ON_WRITE = 1u << 1,  // every mapping is read-only; the first writer copies the page
+        PINNED        = 1u << 2,  // must stay at this physical address (DMA, page tables)
+        DIRTY         = 1u << 3,  // written since the contents were last cleaned or copied
     };
 
+    // State of one small physical frame while it is mapped or shared, so shared and COW pages
+    // need no heap object of their own. Every frame has one, in an array beside the page
+    // allocator's per-big-page metadata; a big or gigantic page is described by the frame of its
+    // first small page. A frame reads as all zeros while its page is free and when it is handed
+    // out. Whoever sets state on it must clear it again before freeing the page.
+    struct PageFrame {
+        Atomic<uint32_t> refCount;
+        Atomic<uint16_t> mapCount;
+        Atomic<uint8_t> flags;
+        // Free for the page's holder, e.g. the CPU or subsystem that claimed it. Not atomic.
+        uint8_t ownerHint;
+
+        void addRef() { refCount.fetch_add(1, RELAXED); }
+        // True when this dropped the last reference, after which the caller owns the page.
+        [[nodiscard]] bool dropRef() { return refCount.fetch_sub(1, ACQ_REL) == 1; }
+        void addMapping() { mapCount.fetch_add(1, RELAXED); }
+        // True when this removed the last mapping.
+        [[nodiscard]] bool removeMapping() { return mapCount.fetch_sub(1, ACQ_REL) == 1; }
+        void setFlag(PageFrameFlag flag) { flags.fetch_or(static_cast<uint8_t>(flag), RELEASE); }
+        void clearFlag(PageFrameFlag flag) { flags.fetch_and(static_cast<uint8_t>(~static_cast<uint8_t>(flag)), RELEASE); }
+        [[nodiscard]] bool hasFlag(PageFrameFlag flag) const { return flags.load(ACQUIRE) & static_cast<uint8_t>(flag); }
+        // True when the frame reads as it must while its page is free.
+        [[nodiscard]] bool isClear() const {
+            return refCount.load(ACQUIRE) == 0 && mapCount.load(ACQUIRE) == 0 && flags.load(ACQUIRE) == 0 && ownerHint == 0;
+        }
+    };
+    static_assert(sizeof(PageFrame) == 8, "PageFrame must stay 8 bytes; there is one per small page of RAM");
+
     namespace PageAllocator{
         // Page count constants used throughout the allocator.
         constexpr size_t smallPagesPerBigPage = arch::bigPageSize / arch::smallPageSize;
+        constexpr size_t bigPagesPerGiganticPage = arch::giganticPageSize / arch::bigPageSize;
+        constexpr size_t smallPagesPerGiganticPage = arch::giganticPageSize / arch::smallPageSize;
         constexpr size_t bigPagesInMaxMemory = arch::maxMemorySupported / arch::bigPageSize;
 
         // ---- Single-page allocation (returns phys_addr) ----
@@ -46,8 +109,12 @@ namespace kernel::mm{
         phys_addr allocateBigPage(numa::DomainID targetDomain);
         phys_addr allocateBigPage(arch::ProcessorID targetProc);
 
+        phys_addr allocateGiganticPage();
+        phys_addr allocateGiganticPage(numa::DomainID targetDomain);
+
         // ---- Bulk allocation (callback receives one PageRef per page) ----
-        // count is in small pages normally; in big pages when BIG_PAGE_ONLY is set.
+        // count is in small pages normally; in big pages when BIG_PAGE_ONLY is set, and in
+        // gigantic pages when GIGANTIC_PAGE_ONLY is set.
         // Returns the number of pages allocated. With default flags this always equals
         // count (panics on OOM). Pass GRACEFUL_OOM to get a short count instead.
 
@@ -55,14 +122,139 @@ namespace kernel::mm{
         size_t allocatePages(size_t count, FunctionRef<void(PageRef)> cb, numa::DomainID targetDomain, AllocFlags flags = {});
         size_t allocatePages(size_t count, FunctionRef<void(PageRef)> cb, arch::ProcessorID targetProc, AllocFlags flags = {});
 
+        // ---- Run-length allocation ----
+        // Allocate count small pages into at most maxRuns PageRefs, each covering runLength()
+        // physically adjacent pages of one size, with no per-page callback. Whole big pages
+        // are taken wherever count allows, so a 1 GiB request fits in a handful of runs.
+        // Sets runCount and returns the number of small pages the runs cover. When runs fills
+        // up first the count is short even without GRACEFUL_OOM; free or keep what was written.
+
+        size_t allocatePageRuns(size_t count, PageRef* runs, size_t maxRuns, size_t& runCount, AllocFlags flags = {});
+        size_t allocatePageRuns(size_t count, PageRef* runs, size_t maxRuns, size_t& runCount, numa::DomainID targetDomain, AllocFlags flags = {});
+        // Free what allocatePageRuns returned. Single-page refs may be mixed in.
+        void freePageRuns(const PageRef* runs, size_t count);
+
+        // ---- Cache coloring ----
+        // A small page's color is its frame number modulo pageColorCount(), the number of small
+        // pages one way of the L2 spans. Pages of different colors never compete for the same
+        // cache sets. COLORED requests take colors in rotation from a cursor, falling forward to
+        // the next color a candidate big page still has free, so a working set of up to
+        // pageColorCount() pages lands in distinct sets instead of wherever the lowest free
+        // pages happen to map. Each CPU has its own cursor; a subsystem whose pages should be
+        // spread among themselves rather than among everything else the CPU allocates, such as
+        // page tables, keeps a PageColorCursor of its own. Whole big pages cover every color and
+        // are handed out as usual.
+
+        // Colors for a cache of the given geometry: the small pages one way spans, rounded
+        // down to a power of two and capped at smallPagesPerBigPage.
+        size_t colorsForCache(const arch::CacheGeometry& cache);
+        // 1 while coloring is off, in which case COLORED has no effect.
+        size_t pageColorCount();
+        // Only a hint: CPUs sharing a cursor may occasionally hand out the same color twice.
+        struct PageColorCursor {
+            Atomic<size_t> next{0};
+        };
+        // COLORED allocation that advances cursor instead of the calling CPU's cursor. Requests
+        // that also set BIG_PAGE_ONLY, GIGANTIC_PAGE_ONLY, ZEROED, INTERLEAVE or ATOMIC_RESERVE
+        // are served as by allocatePages.
+        size_t allocateColoredPages(size_t count, FunctionRef<void(PageRef)> cb, PageColorCursor& cursor, AllocFlags flags = {});
+
+        // ---- Per-frame descriptors ----
+        // Constant-time lookup of the PageFrame for the small frame containing addr, which must
+        // lie in a page the allocator has handed out. For a big or gigantic page pass any
+        // address in its first small page. nullptr for memory the allocator does not manage.
+
+        PageFrame* frameFor(phys_addr addr);
+
+        // ---- Physically contiguous allocation ----
+        // count small pages starting at an address aligned to `alignment` bytes (a power of
+        // two, at least smallPageSize). Runs longer than a big page are built from adjacent
+        // free big pages. Returns empty only when GRACEFUL_OOM is set.
+
+        Optional<phys_addr> allocateContiguous(size_t count, size_t alignment, numa::DomainID targetDomain, AllocFlags flags = {});
+        void freeContiguous(phys_addr base, size_t count);
+
         // ---- Single-page free ----
 
         void freeSmallPage(phys_addr);
         void freeBigPage(phys_addr);
+        void freeGiganticPage(phys_addr);
 
-        // ---- Bulk free (pages array is sorted in place) ----
+        // ---- Bulk free (pages array is reordered in place) ----
+        // Small pages belonging to a big page that another CPU is in the middle of allocating
+        // from are queued for that CPU and become free before its allocation returns.
+        // Arrays already in ascending address order (e.g. from an in-order unmap) skip the sort;
+        // anything else is radix-sorted, so the cost stays linear in count. Big runs from
+        // allocatePageRuns are taken too, and go through freePageRuns.
 
         void freePages(PageRef* pages, size_t count);
+        // Free the pages other CPUs have queued for the calling CPU.
+        void drainRemoteFrees();
+
+        // ---- Deferred freeing across TLB flushes ----
+        // A page unmapped from memory other CPUs may have translations cached for can only be
+        // reused once each of them has flushed. Rather than a shootdown per unmap, the
+        // unmapping CPU queues the pages stamped with a new TLB flush generation, and its later
+        // freePages calls release them in bulk once every CPU has reported a flush at or past
+        // that generation.
+
+        // The generation a flush starting now will cover. Read it before flushing and pass it to
+        // noteTlbFlush once the flush is done.
+        uint64_t tlbFlushGeneration();
+        // Record that the calling CPU's TLB holds nothing that was unmapped before generation was
+        // read. The flush must drop global translations too, so a CR3 reload alone does not count.
+        void noteTlbFlush(uint64_t generation);
+        // Free pages (single pages or runs) once every CPU has flushed past this call. Every
+        // mapping of them must already be gone. When the calling CPU's queue is full with nothing
+        // ready, it flushes its own TLB and waits briefly for the others, then runs the registered
+        // TlbShootdown. Returns the number of refs taken; with no TlbShootdown registered that
+        // can fall short, and the rest are still the caller's to free.
+        [[nodiscard]] size_t freePagesAfterTlbFlush(const PageRef* pages, size_t count);
+        // Flush the calling CPU's TLB if pages were queued since it last reported a flush. Idle
+        // CPUs call this so they do not hold deferred frees back.
+        void catchUpTlbFlush();
+        // Free whatever the calling CPU queued that every CPU has since flushed past. Returns
+        // the number of refs released.
+        size_t releaseDeferredFrees();
+        // Makes every CPU flush its TLB and call noteTlbFlush before returning.
+        using TlbShootdown = void(*)();
+        void setTlbShootdown(TlbShootdown shootdown);
+
+        // ---- Page zeroing ----
+        // ZEROED allocations and the background zeroing worker clear physical memory through
+        // a zeroer registered by whichever subsystem can map arbitrary physical pages.
+
+        using PageZeroer = void(*)(phys_addr base, size_t bytes);
+        void setPageZeroer(PageZeroer zeroer);
+        // Zero up to maxBigPages free big pages into the pre-zeroed lists. Meant for idle
+        // time; returns the number of big pages zeroed (0 once every pool is stocked).
+        size_t zeroIdlePages(size_t maxBigPages = 1);
+
+        // ---- Emergency reserve and watermarks ----
+        // Every CPU keeps a small stack of pages that only ATOMIC_RESERVE requests draw from.
+        // Once it falls below its low watermark it is topped up from ordinary memory on that
+        // CPU's next slow-path allocation, or by refillReserve from idle time.
+
+        // Top up the calling CPU's reserve if it is below its low watermark. Returns the number
+        // of pages added. Not for interrupt context.
+        size_t refillReserve();
+        // Called once each time a domain's free big pages drop below its low watermark (a small
+        // fraction of the domain), so subsystems can trim caches before memory runs out. Runs
+        // later on whichever CPU next takes the allocation slow path or refills its reserve, in
+        // ordinary context, and may allocate and free. Returns false if no slot is left.
+        using LowWatermarkCallback = void(*)(numa::DomainID domain, size_t freeBigPages);
+        bool addLowWatermarkCallback(LowWatermarkCallback callback);
+
+        // ---- Deferred initialization ----
+        // initPageAllocator builds metadata for only the first part of each pool. Every CPU
+        // calls this once during SMP bring-up to build the rest, starting with its own domain.
+        // It returns once nothing is left to build.
+
+        void initializeDeferredPages();
+
+        // ---- Statistics ----
+
+        MemoryStatistics getStatistics();
     }
 
     namespace vm {
@@ -97,24 +289,16 @@ namespace kernel::mm{
         private:
             enum PageType {
                 PRESENT_EXCLUSIVELY_OWNED,  // No refcounting needed, directly stores phys_addr
-                PRESENT_SHARED,             // Uses a heap-allocated RefCountedPage*
+                PRESENT_SHARED,             // Refcounted through the page's PageFrame
                 LAZY,
                 VACANT,
-                COPY_ON_WRITE
-            };
-
-            struct RefCountedPage {
-                phys_addr presentPageAddr;
-                uint64_t refCount;
+                COPY_ON_WRITE               // Shared, with PageFrameFlag::COPY_ON_WRITE set on its frame
             };
 
             struct BackingPage {
                 PageType type;
                 PageSize size;
-                union {
-                    phys_addr exclusivePageAddr;   // Used for PRESENT_EXCLUSIVELY_OWNED
-                    RefCountedPage* sharedPage;    // Used for PRESENT_SHARED & COW
-                };
+                phys_addr pageAddr;   // Used for the PRESENT_* types and COPY_ON_WRITE
 
                 ~BackingPage();
             };
@@ -0,0 +1,198 @@
+//
+// Batched TLB shootdowns for FlushPlanner.
+//
+
+#include <mem/FlushPlanner.h>
+#include <mem/mm.h>
+#include <core/atomic.h>
+#include <assert.h>
+
+namespace kernel::mm{
+    namespace{
+        // The round a CPU has in flight. Only its owner writes the ranges, and only while
+        // pending is zero, so targets read them without further synchronization.
+        struct ShootdownRequest{
+            FlushPlanner::Range ranges[FlushPlanner::rangeCapacity];
+            size_t rangeCount;
+            bool fullFlush;
+            alignas(arch::CACHE_LINE_SIZE) Atomic<size_t> pending;
+        };
+
+        // Bit i of a CPU's inbox is set while CPU i has a request waiting for it.
+        struct alignas(arch::CACHE_LINE_SIZE) ShootdownInbox{
+            Atomic<uint64_t> initiators[arch::MAX_PROCESSOR_COUNT / 64];
+        };
+
+        ShootdownRequest requests[arch::MAX_PROCESSOR_COUNT];
+        ShootdownInbox inboxes[arch::MAX_PROCESSOR_COUNT];
+        FlushPlanner::ShootdownSender shootdownSender = nullptr;
+
+#ifdef CROCOS_TESTING
+        Atomic<size_t> testPagesInvalidated[arch::MAX_PROCESSOR_COUNT];
+        Atomic<size_t> testFullFlushes[arch::MAX_PROCESSOR_COUNT];
+        Atomic<size_t> testShootdownRounds;
+#endif
+
+        void invalidateLocally(arch::ProcessorID cpu, const FlushPlanner::Range* ranges, size_t rangeCount, bool fullFlush){
+#ifdef CROCOS_TESTING
+            if (fullFlush){
+                testFullFlushes[cpu].add_fetch(1, RELAXED);
+                return;
+            }
+            size_t pages = 0;
+            for (size_t i = 0; i < rangeCount; i++) pages += ranges[i].pageCount;
+            testPagesInvalidated[cpu].add_fetch(pages, RELAXED);
+#else
+            (void)cpu;
+            if (fullFlush){
+                // Substrate and kernel mappings are global, so a CR3 reload would leave them.
+                // A full flush also covers every page queued with freePagesAfterTlbFlush before
+                // it started, so it is reported to the page allocator.
+                const uint64_t generation = PageAllocator::tlbFlushGeneration();
+                arch::flushGlobalTLB();
+                PageAllocator::noteTlbFlush(generation);
+                return;
+            }
+            for (size_t i = 0; i < rangeCount; i++){
+                for (size_t page = 0; page < ranges[i].pageCount; page++){
+                    arch::invlpg(ranges[i].start + page * arch::smallPageSize);
+                }
+            }
+#endif
+        }
+    }
+
+    FlushPlanner::~FlushPlanner(){
+        if (hasPendingInvalidations()){
+            flush();
+        }
+    }
+
+    void FlushPlanner::invalidate(virt_addr addr, size_t count){
+        if (fullFlush || count == 0){
+            return;
+        }
+        pageCount += count;
+        if (pageCount > fullFlushThreshold){
+            invalidateAll();
+            return;
+        }
+        // Unmaps mostly walk forward, so only the newest range is checked for adjacency.
+        if (rangeCount > 0){
+            Range& last = ranges[rangeCount - 1];
+            const virt_addr lastEnd = last.start + last.pageCount * arch::smallPageSize;
+            if (addr == lastEnd){
+                last.pageCount += count;
+                return;
+            }
+            if (addr + count * arch::smallPageSize == last.start){
+                last.start = addr;
+                last.pageCount += count;
+                return;
+            }
+        }
+        if (rangeCount == rangeCapacity){
+            invalidateAll();
+            return;
+        }
+        ranges[rangeCount++] = Range{addr, count};
+    }
+
+    void FlushPlanner::invalidateAll(){
+        fullFlush = true;
+        rangeCount = 0;
+    }
+
+    void FlushPlanner::addTarget(arch::ProcessorID cpu){
+        targets.add(cpu);
+    }
+
+    void FlushPlanner::addTargets(const ProcessorSet& cpus){
+        targets.addAll(cpus);
+    }
+
+    void FlushPlanner::targetAllProcessors(){
+        targets.addFirst(arch::processorCount());
+    }
+
+    void FlushPlanner::reset(){
+        rangeCount = 0;
+        pageCount = 0;
+        fullFlush = false;
+        targets.clear();
+    }
+
+    void FlushPlanner::flush(){
+        if (!hasPendingInvalidations()){
+            reset();
+            return;
+        }
+        const arch::ProcessorID self = arch::getCurrentProcessorID();
+        targets.remove(self);
+        const ShootdownSender sender = shootdownSender;
+        if (targets.empty() || sender == nullptr){
+            invalidateLocally(self, ranges, rangeCount, fullFlush);
+            reset();
+            return;
+        }
+
+        ShootdownRequest& request = requests[self];
+        assert(request.pending.load(ACQUIRE) == 0, "FlushPlanner: previous shootdown round still in flight");
+        for (size_t i = 0; i < rangeCount; i++) request.ranges[i] = ranges[i];
+        request.rangeCount = rangeCount;
+        request.fullFlush = fullFlush;
+        request.pending.store(targets.count(), RELEASE);
+        const uint64_t selfBit = uint64_t{1} << (self % 64);
+        targets.forEach([&](arch::ProcessorID cpu){
+            inboxes[cpu].initiators[self / 64].fetch_or(selfBit, RELEASE);
+        });
+        sender(targets);
+
+        // Do our own share while the targets do theirs.
+        invalidateLocally(self, ranges, rangeCount, fullFlush);
+        while (request.pending.load(ACQUIRE) != 0){
+            serviceShootdowns(self);
+            tight_spin();
+        }
+#ifdef CROCOS_TESTING
+        testShootdownRounds.add_fetch(1, RELAXED);
+#endif
+        reset();
+    }
+
+    void FlushPlanner::setShootdownSender(ShootdownSender sender){
+        shootdownSender = sender;
+    }
+
+    void FlushPlanner::serviceShootdowns(arch::ProcessorID cpu){
+        auto& inbox = inboxes[cpu];
+        for (size_t w = 0; w < arch::MAX_PROCESSOR_COUNT / 64; w++){
+            if (inbox.initiators[w].load(RELAXED) == 0){
+                continue;
+            }
+            for (uint64_t bits = inbox.initiators[w].exchange(0, ACQ_REL); bits != 0; bits &= bits - 1){
+                ShootdownRequest& request = requests[w * 64 + static_cast<size_t>(__builtin_ctzll(bits))];
+                invalidateLocally(cpu, request.ranges, request.rangeCount, request.fullFlush);
+                request.pending.sub_fetch(1, RELEASE);
+            }
+        }
+    }
+
+#ifdef CROCOS_TESTING
+    FlushPlanner::LocalFlushStats FlushPlanner::localFlushStats(arch::ProcessorID cpu){
+        return {testPagesInvalidated[cpu].load(RELAXED), testFullFlushes[cpu].load(RELAXED)};
+    }
+
+    size_t FlushPlanner::shootdownRoundCount(){
+        return testShootdownRounds.load(RELAXED);
+    }
+
+    void FlushPlanner::resetFlushStats(){
+        for (size_t cpu = 0; cpu < arch::MAX_PROCESSOR_COUNT; cpu++){
+            testPagesInvalidated[cpu].store(0, RELAXED);
+            testFullFlushes[cpu].store(0, RELAXED);
+        }
+        testShootdownRounds.store(0, RELAXED);
+    }
+#endif
+}
@@ -15,6 +15,11 @@ extern uint32_t phys_end;
 
 static PageAllocatorImpl gPageAllocatorImpl;
 
+// Big pages per pool whose metadata initPageAllocator builds on the bootstrap CPU; the rest
+// is built in parallel by initDeferredPageMetadata once the APs are up. One gigantic page's
+// worth is plenty to get through bring-up, and allocation builds more on demand if not.
+constexpr size_t PA_EAGER_BIG_PAGES = kernel::mm::PageAllocator::bigPagesPerGiganticPage;
+
 namespace kernel::mm{
     template<size_t level>
     void unmapIdentity(arch::PageTable<level>& pageTable) {
@@ -83,6 +88,31 @@ namespace kernel::mm{
     // Shared zone counter across all reservePageAllocatorBufferForRange overloads.
     static size_t gMappedPageAllocatorBuffers = 0;
 
+    // Map one piece of a page allocator buffer into the given zone, building its page tables in
+    // the table stack at ptPhysicalBase. Returns the offset within the zone where the piece begins.
+    static size_t mapPageAllocatorBufferIntoZone(const phys_memory_range piece, const phys_addr ptPhysicalBase, const size_t zone) {
+        assert(zone < arch::pageTableDescriptor.entryCount[pageTableLevelForKMemRegion() - 1], "Out of kernel zones for page allocator buffers");
+        PageTableInitializationResult data;
+        {
+            TempWindow<arch::PageTable<arch::pageTableDescriptor.LEVEL_COUNT - 1>> tempWindow(ptPhysicalBase);
+            // This runs before the page allocator exists, so there is no ZEROED allocation to
+            // ask for. The window's slots are virtually contiguous: map them all, clear once.
+            const size_t numPages = requiredTableSizeForPageAllocator / arch::smallPageSize;
+            for (size_t i = 0; i < numPages; i++) {
+                (void)tempWindow[i];
+            }
+            virt_addr pageTableBase = tempWindow.virtualBase();
+            memset(pageTableBase.as_ptr<void>(), 0, requiredTableSizeForPageAllocator);
+            data = initializePageTable<pageTableLevelForKMemRegion(), true>(pageTableBase, piece, ptPhysicalBase);
+
+            auto ptentry = KMemRegionEntryType::subtableEntry(data.pageTableAddress);
+            ptentry.markPresent();
+            ptentry.enableWrite();
+            getPageTableEntryForZone(zone) = ptentry;
+        } // TempWindow destructor clears temp zone and flushes TLB, activating the new zone entry
+        return data.mappedAddressStartOffset;
+    }
+
     // Reserve and map a page allocator buffer for a physical memory range.
     //
     // This function carves out space at the top of the physical range for:
@@ -93,6 +123,11 @@ namespace kernel::mm{
     // sets up the page tables to map the buffer into the next available page
     // allocator zone, and returns a virtual pointer to the mapped buffer.
     //
+    // A buffer too big for one zone (a pool's PageFrame array alone is 1/512 of its memory)
+    // spans several consecutive zones instead. It then starts on a big page, so that every
+    // piece begins at the start of its zone and the pieces meet without gaps: zones grow
+    // downward, so the lowest piece goes in the highest-numbered zone.
+    //
     // Returns: Virtual address of the mapped buffer
     void* reservePageAllocatorBufferForRange(phys_memory_range& range, size_t requiredBufferSize) {
         klog() << "[PA] reserving " << requiredBufferSize << " bytes for page allocator\n";
@@ -100,35 +135,38 @@ namespace kernel::mm{
             range.end &= ~(arch::smallPageSize - 1);
             range.start.value = roundUpToNearestMultiple(range.start.value, arch::smallPageSize);
 
-            range.end -= requiredTableSizeForPageAllocator;
+            constexpr size_t zoneSize = getKernelMemRegionSize();
+            const size_t alignedBufferSize = roundUpToNearestMultiple(requiredBufferSize, arch::smallPageSize);
+            const size_t zoneCount = 2 * alignedBufferSize <= zoneSize
+                ? 1 : divideAndRoundUp(alignedBufferSize + arch::bigPageSize, zoneSize);
+            const size_t firstZone = PAGE_ALLOCATOR_ZONE_START + gMappedPageAllocatorBuffers;
+
+            range.end -= zoneCount * requiredTableSizeForPageAllocator;
             const auto ptPhysicalBase = range.end;
 
-            const size_t alignedBufferSize = roundUpToNearestMultiple(requiredBufferSize, arch::smallPageSize);
-            assert(2 * alignedBufferSize <= getKernelMemRegionSize(), "Memory range is too big");
-
-            phys_memory_range bufferRange(range.end - alignedBufferSize, range.end);
-            range.end -= alignedBufferSize;
-
-            virt_addr pageTableBase;
-            PageTableInitializationResult data;
-            {
-                TempWindow<arch::PageTable<arch::pageTableDescriptor.LEVEL_COUNT - 1>> tempWindow(ptPhysicalBase);
-                const size_t numPages = requiredTableSizeForPageAllocator / arch::smallPageSize;
-                for (size_t i = 0; i < numPages; i++) {
-                    memset(&tempWindow[i], 0, arch::smallPageSize);
-                }
-                pageTableBase = tempWindow.virtualBase();
-                data = initializePageTable<pageTableLevelForKMemRegion(), true>(pageTableBase, bufferRange, ptPhysicalBase);
-
-                auto ptentry = KMemRegionEntryType::subtableEntry(data.pageTableAddress);
-                ptentry.markPresent();
-                ptentry.enableWrite();
-                getPageTableEntryForZone(PAGE_ALLOCATOR_ZONE_START + gMappedPageAllocatorBuffers) = ptentry;
-            } // TempWindow destructor clears temp zone and flushes TLB, activating the new zone entry
-
-            auto mappedAddress = getKernelMemRegionStart(PAGE_ALLOCATOR_ZONE_START + gMappedPageAllocatorBuffers) + data.mappedAddressStartOffset;
-            gMappedPageAllocatorBuffers++;
-            return mappedAddress.as_ptr<void>();
+            if (zoneCount == 1) {
+                phys_memory_range bufferRange(range.end - alignedBufferSize, range.end);
+                range.end -= alignedBufferSize;
+                const size_t offset = mapPageAllocatorBufferIntoZone(bufferRange, ptPhysicalBase, firstZone);
+                gMappedPageAllocatorBuffers++;
+                return (getKernelMemRegionStart(firstZone) + offset).as_ptr<void>();
+            }
+
+            const phys_addr bufferStart{roundDownToNearestMultiple((range.end - alignedBufferSize).value,
+                                                                   static_cast<uint64_t>(arch::bigPageSize))};
+            assert(bufferStart.value >= range.start.value, "Memory range is too small for its page allocator buffer");
+            const phys_addr bufferEnd = range.end;
+            range.end = bufferStart;
+
+            for (size_t piece = 0; piece < zoneCount; piece++) {
+                const phys_addr pieceStart = bufferStart + piece * zoneSize;
+                const phys_memory_range pieceRange(pieceStart, min(pieceStart + zoneSize, bufferEnd));
+                const size_t offset = mapPageAllocatorBufferIntoZone(pieceRange, ptPhysicalBase + piece * requiredTableSizeForPageAllocator,
+                                                                     firstZone + zoneCount - 1 - piece);
+                assert(offset == 0, "Page allocator buffer piece must start at its zone's start");
+            }
+            gMappedPageAllocatorBuffers += zoneCount;
+            return getKernelMemRegionStart(firstZone + zoneCount - 1).as_ptr<void>();
         }
         static_assert(supportsSimpleBootstrapPageAllocatorMapping, "Page allocator buffer mapping not supported on this architecture with the simple mapping construction");
     }
@@ -144,6 +182,20 @@ namespace kernel::mm{
             }
         }
 
+        // ---- Metadata radix: carved before any pool claims its ranges ----
+        // Carving only shrinks a range, so the radix measured here still covers every pool.
+        MetadataRadix metadataRadix;
+        {
+            BootstrapAllocator measuringAlloc;
+            createMetadataRadix(measuringAlloc, usableRanges);
+            phys_memory_range* largestRange = &usableRanges[0];
+            for (size_t i = 1; i < usableRanges.size(); i++)
+                if (usableRanges[i].getSize() > largestRange->getSize()) largestRange = &usableRanges[i];
+            void* buffer = reservePageAllocatorBufferForRange(*largestRange, measuringAlloc.bytesNeeded());
+            BootstrapAllocator realAlloc(buffer, measuringAlloc.bytesNeeded());
+            metadataRadix = createMetadataRadix(realAlloc, usableRanges);
+        }
+
         // Per-processor LocalPool pointer table (indexed by ProcessorID).
         static LocalPool* localPools[arch::MAX_PROCESSOR_COUNT] = {};
 
@@ -169,7 +221,7 @@ namespace kernel::mm{
                 // pool with no NUMA policy so createPageAllocator's invariants hold.
                 auto& ranges = partition.unownedRanges;
                 BootstrapAllocator measuringAlloc;
-                createNumaPool(measuringAlloc, ranges);
+                createNumaPool(measuringAlloc, ranges, numa::DomainID{0}, PA_EAGER_BIG_PAGES);
                 for (size_t cpu = 0; cpu < processorCount; cpu++)
                     createLocalPool(measuringAlloc, nullptr);
                 phys_memory_range* largestRange = &ranges[0];
@@ -177,7 +229,7 @@ namespace kernel::mm{
                     if (ranges[i].getSize() > largestRange->getSize()) largestRange = &ranges[i];
                 void* buffer = reservePageAllocatorBufferForRange(*largestRange, measuringAlloc.bytesNeeded());
                 BootstrapAllocator realAlloc(buffer, measuringAlloc.bytesNeeded());
-                NUMAPool* singlePool = createNumaPool(realAlloc, ranges);
+                NUMAPool* singlePool = createNumaPool(realAlloc, ranges, numa::DomainID{0}, PA_EAGER_BIG_PAGES);
                 numaPools.push(singlePool);
                 for (size_t cpu = 0; cpu < processorCount; cpu++)
                     localPools[cpu] = createLocalPool(realAlloc, nullptr, singlePool, static_cast<arch::ProcessorID>(cpu));
@@ -192,7 +244,7 @@ namespace kernel::mm{
 
                     // ---- Measure required memory ----
                     BootstrapAllocator measuringAlloc;
-                    createNumaPool(measuringAlloc, ranges, domainId);
+                    createNumaPool(measuringAlloc, ranges, domainId, PA_EAGER_BIG_PAGES);
                     for (size_t cpu = 0; cpu < processorCount; cpu++) {
                         if (partition.processorDomain[cpu] == domainId)
                             createLocalPool(measuringAlloc, topology);
@@ -206,7 +258,7 @@ namespace kernel::mm{
 
                     // ---- Construct pools ----
                     BootstrapAllocator realAlloc(buffer, measuringAlloc.bytesNeeded());
-                    NUMAPool* domainPool = createNumaPool(realAlloc, ranges, domainId);
+                    NUMAPool* domainPool = createNumaPool(realAlloc, ranges, domainId, PA_EAGER_BIG_PAGES);
                     numaPools.push(domainPool);
                     for (size_t cpu = 0; cpu < processorCount; cpu++) {
                         if (partition.processorDomain[cpu] == domainId)
@@ -219,20 +271,20 @@ namespace kernel::mm{
                 // ---- Unowned ranges (no NUMA affinity) ----
                 if (!partition.unownedRanges.empty()) {
                     BootstrapAllocator measuringAlloc;
-                    createNumaPool(measuringAlloc, partition.unownedRanges);
+                    createNumaPool(measuringAlloc, partition.unownedRanges, numa::DomainID{0}, PA_EAGER_BIG_PAGES);
                     phys_memory_range* largestRange = &partition.unownedRanges[0];
                     for (size_t i = 1; i < partition.unownedRanges.size(); i++)
                         if (partition.unownedRanges[i].getSize() > largestRange->getSize())
                             largestRange = &partition.unownedRanges[i];
                     void* buffer = reservePageAllocatorBufferForRange(*largestRange, measuringAlloc.bytesNeeded());
                     BootstrapAllocator realAlloc(buffer, measuringAlloc.bytesNeeded());
-                    unownedPool = createNumaPool(realAlloc, partition.unownedRanges);
+                    unownedPool = createNumaPool(realAlloc, partition.unownedRanges, numa::DomainID{0}, PA_EAGER_BIG_PAGES);
                 }
             }
         } else {
             // Non-NUMA path: single pool for all memory.
             BootstrapAllocator measuringAlloc;
-            createNumaPool(measuringAlloc, usableRanges);
+            createNumaPool(measuringAlloc, usableRanges, numa::DomainID{0}, PA_EAGER_BIG_PAGES);
             for (size_t cpu = 0; cpu < processorCount; cpu++)
                 createLocalPool(measuringAlloc, topology);
             phys_memory_range* largestRange = &usableRanges[0];
@@ -240,13 +292,14 @@ namespace kernel::mm{
                 if (usableRanges[i].getSize() > largestRange->getSize()) largestRange = &usableRanges[i];
             void* buffer = reservePageAllocatorBufferForRange(*largestRange, measuringAlloc.bytesNeeded());
             BootstrapAllocator realAlloc(buffer, measuringAlloc.bytesNeeded());
-            NUMAPool* singlePool = createNumaPool(realAlloc, usableRanges);
+            NUMAPool* singlePool = createNumaPool(realAlloc, usableRanges, numa::DomainID{0}, PA_EAGER_BIG_PAGES);
             numaPools.push(singlePool);
             for (size_t cpu = 0; cpu < processorCount; cpu++)
                 localPools[cpu] = createLocalPool(realAlloc, topology, singlePool, static_cast<arch::ProcessorID>(cpu));
         }
 
-        gPageAllocatorImpl = createPageAllocator(move(numaPools), localPools, processorCount, unownedPool, allocPolicy);
+        gPageAllocatorImpl = createPageAllocator(move(numaPools), localPools, processorCount, unownedPool, allocPolicy,
+                                                 metadataRadix);
         gPageAllocator = &gPageAllocatorImpl;
         klog() << "[PA] initPageAllocator complete, gPageAllocator=" << (void*)gPageAllocator << " localPools[0]=" << (void*)localPools[0] << "\n";
 
@@ -256,6 +309,25 @@ namespace kernel::mm{
         gPageAllocator->reserveRange(kernelRange);
         klog() << "[PA] reserveRange done\n";
 
+        gPageAllocatorImpl.magazinesEnabled = true;
+        gPageAllocatorImpl.remoteFreesEnabled = true;
+        gPageAllocatorImpl.bigPageCachesEnabled = true;
+        gPageAllocatorImpl.reservesEnabled = true;
+        gPageAllocatorImpl.deferredFreesEnabled = true;
+        // Color by the L2: it is private to the core and indexed directly by physical address,
+        // whereas most LLCs pick a slice by hashing the address, which page colors cannot steer.
+        if (const auto l2 = arch::getCacheGeometry(2); l2.occupied()) {
+            gPageAllocatorImpl.setPageColors(PageAllocator::colorsForCache(*l2));
+            klog() << "[PA] " << PageAllocator::pageColorCount() << " page colors\n";
+        }
+
+        return true;
+    }
+
+    bool initDeferredPageMetadata() {
+        PageAllocator::initializeDeferredPages();
+        // Stock this CPU's emergency reserve before anything on it can ask for ATOMIC_RESERVE pages.
+        (void)PageAllocator::refillReserve();
         return true;
     }
 }
@@ -604,6 +604,38 @@ NUMAPolicy::NUMAPolicy(const NUMATopology& topology) {
                         : DomainID(static_cast<uint16_t>(j)); // identity fallback
             }
         }
+
+        // Precompute interleave weights from the bandwidth matrix, one row per initiator.
+        interleaveWeight = static_cast<uint32_t*>(
+            operator new(sizeof(uint32_t) * domainCount * domainCount));
+        const auto& bandwidth = topology.readBandwidthMatrix.occupied()
+                                    ? topology.readBandwidthMatrix
+                                    : topology.writeBandwidthMatrix;
+        for (size_t i = 0; i < domainCount; i++) {
+            uint32_t* row = interleaveWeight + i * domainCount;
+            uint64_t maxBandwidth = 0;
+            if (bandwidth.occupied()) {
+                for (size_t j = 0; j < domainCount; j++) {
+                    const uint64_t v = (*bandwidth)[i, j];
+                    if (v < DISTANCE_NO_DATA && v > maxBandwidth) maxBandwidth = v;
+                }
+            }
+            for (size_t j = 0; j < domainCount; j++) {
+                if (maxBandwidth == 0) {
+                    row[j] = 1;
+                    continue;
+                }
+                const uint64_t v = (*bandwidth)[i, j];
+                if (v == DISTANCE_UNREACHABLE) {
+                    row[j] = 0;
+                } else if (v == DISTANCE_NO_DATA) {
+                    row[j] = 1;
+                } else {
+                    const uint64_t scaled = (v * INTERLEAVE_WEIGHT_MAX + maxBandwidth / 2) / maxBandwidth;
+                    row[j] = static_cast<uint32_t>(scaled > 0 ? scaled : 1);
+                }
+            }
+        }
     }
 }
 
@@ -611,6 +643,7 @@ NUMAPolicy::NUMAPolicy(NUMAPolicy&& other) noexcept
     : cpuHomeDomain(other.cpuHomeDomain),
       cpuClockDomain(other.cpuClockDomain),
       fallbackOrder(other.fallbackOrder),
+      interleaveWeight(other.interleaveWeight),
       cpuCount(other.cpuCount),
       domainCount(other.domainCount),
       quality(other.quality)
@@ -618,6 +651,7 @@ NUMAPolicy::NUMAPolicy(NUMAPolicy&& other) noexcept
     other.cpuHomeDomain  = nullptr;
     other.cpuClockDomain = nullptr;
     other.fallbackOrder  = nullptr;
+    other.interleaveWeight = nullptr;
 }
 
 NUMAPolicy& NUMAPolicy::operator=(NUMAPolicy&& other) noexcept {
@@ -625,15 +659,18 @@ NUMAPolicy& NUMAPolicy::operator=(NUMAPolicy&& other) noexcept {
     operator delete(cpuHomeDomain);
     operator delete(cpuClockDomain);
     operator delete(fallbackOrder);
+    operator delete(interleaveWeight);
     cpuHomeDomain  = other.cpuHomeDomain;
     cpuClockDomain = other.cpuClockDomain;
     fallbackOrder  = other.fallbackOrder;
+    interleaveWeight = other.interleaveWeight;
     cpuCount       = other.cpuCount;
     domainCount    = other.domainCount;
     quality        = other.quality;
     other.cpuHomeDomain  = nullptr;
     other.cpuClockDomain = nullptr;
     other.fallbackOrder  = nullptr;
+    other.interleaveWeight = nullptr;
     return *this;
 }
 
@@ -641,6 +678,7 @@ NUMAPolicy::~NUMAPolicy() {
     if (cpuHomeDomain)  operator delete(cpuHomeDomain);
     if (cpuClockDomain) operator delete(cpuClockDomain);
     if (fallbackOrder)  operator delete(fallbackOrder);
+    if (interleaveWeight) operator delete(interleaveWeight);
 }
 
 // ============================================================================
@@ -674,6 +712,14 @@ bool NUMAPolicy::shareClockDomain(arch::ProcessorID a, arch::ProcessorID b) cons
 
 DataQualityLevel NUMAPolicy::orderingQuality() const { return quality; }
 
+Span<const uint32_t> NUMAPolicy::interleaveWeights(DomainID initiator) const {
+    assert(initiator != DomainID::null() &&
+           static_cast<size_t>(initiator.value) < domainCount,
+           "NUMAPolicy::interleaveWeights: invalid domain ID");
+    return { interleaveWeight + static_cast<size_t>(initiator.value) * domainCount,
+             domainCount };
+}
+
 // ============================================================================
 // Global policy singleton
 // ============================================================================
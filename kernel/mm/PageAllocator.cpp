@@ -10,6 +10,76 @@
 
 constexpr size_t PA_BITPOOL_RELAXED_RETRIES = 16;
 constexpr size_t PA_BITPOOL_DETERMINED_RETRIES = 1000000;
+// How many partially allocated pages a contiguous allocation inspects before
+// giving up on them and carving the run out of a fresh big page instead.
+constexpr size_t PA_CONTIGUOUS_PROBES = 4;
+// Entries beyond the run length a multi-big-page contiguous allocation pulls off each free ring
+// while claiming one candidate run, and how many candidate runs it tries before falling back to a listed
+// gigantic group. Together they bound the ring traffic of one allocation.
+constexpr size_t PA_CONTIGUOUS_RING_SCAN = 256;
+constexpr size_t PA_CONTIGUOUS_CLAIM_ATTEMPTS = 4;
+// The idle zeroing worker keeps 1/PA_ZEROED_BIG_PAGE_FRACTION of a pool's big pages pre-zeroed.
+constexpr size_t PA_ZEROED_BIG_PAGE_FRACTION = 16;
+// Pages a ZEROED allocation collects from the allocator before zeroing and delivering them.
+constexpr size_t PA_ZEROED_BATCH = 64;
+// A pool's low-watermark callbacks fire when its free big pages drop below
+// 1/PA_LOW_WATERMARK_FRACTION of its big pages, and re-arm once it is back to twice that.
+constexpr size_t PA_LOW_WATERMARK_FRACTION = 64;
+// Pages pulled out of a remote-free inbox per sort-and-free pass.
+constexpr size_t PA_REMOTE_FREE_BATCH = 64;
+// Refs freePageRuns expands big runs into before each sort-and-free pass.
+constexpr size_t PA_RUN_FREE_BATCH = 64;
+// Deferred frees released per freePageRuns pass.
+constexpr size_t PA_DEFERRED_FREE_BATCH = 64;
+// Spins a full deferred-free queue waits for other CPUs' flushes before asking for a shootdown.
+constexpr size_t PA_DEFERRED_FREE_WAIT_SPINS = 4096;
+// Partial-page set updates buffered before one addMany/removeMany hands them over.
+constexpr size_t PA_BITPOOL_BATCH = 64;
+
+namespace {
+// Collects indices bound for one AtomicBitPool and applies them a batch at a time, so indices
+// sharing a bitmap word cost one atomic op. Whatever is still buffered is applied on destruction.
+// applied, when given, sees every index once its batch has been applied.
+class BitPoolBatch {
+    AtomicBitPool& pool;
+    bool removing;
+    FunctionRef<void(size_t)> applied;
+    size_t indices[PA_BITPOOL_BATCH];
+    size_t count = 0;
+public:
+    BitPoolBatch(AtomicBitPool& target, bool remove, const FunctionRef<void(size_t)>& onApplied = {})
+        : pool(target), removing(remove), applied(onApplied) {}
+    BitPoolBatch(const BitPoolBatch&) = delete;
+    ~BitPoolBatch() { flush(); }
+
+    void push(size_t index) {
+        if (count == PA_BITPOOL_BATCH) {
+            flush();
+        }
+        indices[count++] = index;
+    }
+
+    void flush() {
+        if (count == 0) return;
+        (void)(removing ? pool.removeMany(indices, count) : pool.addMany(indices, count));
+        if (applied) {
+            for (size_t i = 0; i < count; i++) applied(indices[i]);
+        }
+        count = 0;
+    }
+};
+}
+
+// Put pages in the order the free path consumes them: pages of one big page adjacent, big pages
+// ascending. Order within a big page does not matter, so the key is just the big-page number.
+// Input that already satisfies this is detected in one pass and left alone.
+static void orderPagesForFree(PageRef* pages, const size_t count) {
+    const auto bigPageNumber = [](const PageRef& page) { return page.addr().value / arch::bigPageSize; };
+    size_t i = 1;
+    while (i < count && bigPageNumber(pages[i - 1]) <= bigPageNumber(pages[i])) i++;
+    if (i >= count) return;
+    algorithm::radixSort(pages, count, bigPageNumber);
+}
 
 constexpr size_t bigPagesInRange(const kernel::mm::phys_memory_range range) {
     const auto alignedTop = roundUpToNearestMultiple(range.end.value, static_cast<uint64_t>(arch::bigPageSize));
@@ -35,6 +105,16 @@ T* BootstrapAllocator::allocate() {
 
 template<typename T>
 T* BootstrapAllocator::allocate(const size_t count, size_t alignment) {
+    T* result = allocateUninitialized<T>(count, alignment);
+    if (!measuring) {
+        const size_t paddedObjSize = roundUpToNearestMultiple(sizeof(T), alignof(T));
+        memset(static_cast<void *>(result), 0, paddedObjSize * (count - 1) + sizeof(T));
+    }
+    return result;
+}
+
+template<typename T>
+T* BootstrapAllocator::allocateUninitialized(const size_t count, size_t alignment) {
     const auto addr = reinterpret_cast<size_t>(current);
     const size_t aligned = roundUpToNearestMultiple(addr, alignment);
     const size_t paddedObjSize = roundUpToNearestMultiple(sizeof(T), alignof(T));
@@ -48,7 +128,6 @@ T* BootstrapAllocator::allocate(const size_t count, size_t alignment) {
     current = reinterpret_cast<uint8_t *>(aligned);
     T* result = static_cast<T *>(static_cast<void*>(current));
     current += size;
-    memset(static_cast<void *>(result), 0, size);
 
     assert(current <= end, "Bootstrap allocator overflow");
     return result;
@@ -74,11 +153,30 @@ size_t BootstrapAllocator::bytesRemaining() const {
 }
 
 // ======================= PageRef ========================
+// Run lengths live in the bits below the page address: small runs store count - 1 in bits [1, 12),
+// big runs store it in bits [12, 21) with bit 0 set. Bit 1 stays clear for big runs so they never
+// look gigantic.
+static_assert(mm::PageAllocator::smallPagesPerBigPage * 2 <= arch::smallPageSize, "Can't smuggle run length in bottom of PageRef");
+static_assert(mm::PageAllocator::bigPagesPerGiganticPage * arch::smallPageSize <= arch::bigPageSize,
+              "Can't smuggle big page run length in bottom of PageRef");
+
+constexpr uint64_t pageRefRunMask = arch::smallPageSize - 2; //mask off all lower bits except for bottom
+constexpr uint64_t bigPageRefRunMask = arch::bigPageSize - arch::smallPageSize;
+constexpr size_t bigPageRefRunShift = log2floor(arch::smallPageSize);
+
 mm::phys_addr PageRef::addr() const {
+    if ((value & 3) == 1) return mm::phys_addr{value & ~(arch::bigPageSize - 1)};
     return mm::phys_addr{value & ~(arch::smallPageSize - 1)};
 }
 
+size_t PageRef::runLength() const {
+    if ((value & 3) == 3) return 1;
+    if (value & 1) return ((value & bigPageRefRunMask) >> bigPageRefRunShift) + 1;
+    return ((value & pageRefRunMask) >> 1) + 1;
+}
+
 mm::PageSize PageRef::size() const {
+    if ((value & 3) == 3) return mm::PageSize::GIGANTIC;
     return (value & 1) ? mm::PageSize::BIG : mm::PageSize::SMALL;
 }
 
@@ -92,9 +190,24 @@ PageRef PageRef::big(mm::phys_addr addr) {
     return {addr.value | 1};
 }
 
-static_assert(mm::PageAllocator::smallPagesPerBigPage * 2 <= arch::smallPageSize, "Can't smuggle run length in bottom of PageRef");
+PageRef PageRef::gigantic(mm::phys_addr addr) {
+    assert(addr.value % arch::giganticPageSize == 0, "Physical address is not gigantic page aligned");
+    return {addr.value | 3};
+}
 
-constexpr uint64_t pageRefRunMask = arch::smallPageSize - 2; //mask off all lower bits except for bottom
+PageRef PageRef::smallRun(mm::phys_addr addr, size_t count) {
+    assert(addr.value % arch::smallPageSize == 0, "Physical address is not small page aligned");
+    assert(count > 0 && (addr.value % arch::bigPageSize) / arch::smallPageSize + count <= mm::PageAllocator::smallPagesPerBigPage,
+           "Small page run must stay within one big page");
+    return {addr.value | ((count - 1) << 1)};
+}
+
+PageRef PageRef::bigRun(mm::phys_addr addr, size_t count) {
+    assert(addr.value % arch::bigPageSize == 0, "Physical address is not big page aligned");
+    assert(count > 0 && (addr.value % arch::giganticPageSize) / arch::bigPageSize + count <= mm::PageAllocator::bigPagesPerGiganticPage,
+           "Big page run must stay within one gigantic page");
+    return {addr.value | 1 | ((count - 1) << bigPageRefRunShift)};
+}
 
 // ==================== SmallPageAllocator ====================
 
@@ -121,6 +234,9 @@ void SmallPageAllocator::freeAll() {
     assert(reservedCount == 0, "Can't free all from page with reserved subpages");
     for (auto& w : allocBitmap) w = ~0ull;
     for (auto& w : freeBitmap)  w.store(0, RELEASE);
+    // A page last exhausted by small allocations still has allocHint past the end;
+    // without the reset, alloc() would skip the whole allocBitmap we just filled.
+    allocHint = 0;
     allocatedCount.store(0, RELEASE);
 }
 
@@ -140,9 +256,27 @@ void SmallPageAllocator::flushAllocBitmap() {
     allocHint = 0;
 }
 
-size_t SmallPageAllocator::alloc(PageAllocationCallback cb, size_t count, OccupancyTransition& transition) {
+// Mask covering `n` bits starting at bit `first` of a single bitmap word (first + n <= 64).
+static uint64_t bitRunMask(const size_t first, const size_t n) {
+    return (n == 64 ? ~0ull : ((1ull << n) - 1)) << first;
+}
+
+size_t SmallPageAllocator::alloc(PageAllocationCallback cb, size_t count, OccupancyTransition& transition, bool runs,
+                                 PageColoring* coloring) {
+    if (coloring != nullptr && coloring->colorCount > 1) {
+        return allocColored(cb, count, transition, *coloring);
+    }
     size_t allocated = 0;
     const size_t maxAlloc = mm::PageAllocator::smallPagesPerBigPage - reservedCount;
+    // With runs, the span being built; it is reported once the next span does not continue it.
+    size_t runStart = 0;
+    size_t runLength = 0;
+    const auto flushRun = [&] {
+        if (runLength > 0) {
+            cb(PageRef::smallRun(fromPageIndex(static_cast<SmallPageIndex>(runStart)), runLength));
+            runLength = 0;
+        }
+    };
 
     // Pass 0: scan allocBitmap starting at allocHint (zero atomics).
     // Pass 1: drain freeBitmap into allocBitmap, reset allocHint, scan again.
@@ -163,6 +297,20 @@ size_t SmallPageAllocator::alloc(PageAllocationCallback cb, size_t count, Occupa
         for (size_t w = allocHint; w < bitmapWordCount && allocated < count; w++) {
             while (allocBitmap[w] && allocated < count) {
                 const int bit = __builtin_ctzll(allocBitmap[w]);
+                if (runs) {
+                    // Take the whole span of set bits starting at `bit`, capped by what is still wanted.
+                    const uint64_t clear = ~(allocBitmap[w] >> bit);
+                    const size_t span = min(clear ? static_cast<size_t>(__builtin_ctzll(clear)) : 64u - bit, count - allocated);
+                    allocBitmap[w] &= ~bitRunMask(static_cast<size_t>(bit), span);
+                    const size_t index = w * 64 + static_cast<size_t>(bit);
+                    if (index != runStart + runLength) {
+                        flushRun();
+                        runStart = index;
+                    }
+                    runLength += span;
+                    allocated += span;
+                    continue;
+                }
                 allocBitmap[w] &= allocBitmap[w] - 1;  // clear lowest set bit
                 cb(PageRef::small(fromPageIndex(static_cast<SmallPageIndex>(w * 64u + static_cast<unsigned>(bit)))));
                 allocated++;
@@ -170,6 +318,7 @@ size_t SmallPageAllocator::alloc(PageAllocationCallback cb, size_t count, Occupa
             if (!allocBitmap[w] && w == allocHint) allocHint = static_cast<uint8_t>(w + 1);
         }
     }
+    flushRun();
 
     const auto prevAllocated = allocatedCount.fetch_add(static_cast<SmallPageCount>(allocated), ACQ_REL);
     transition.before = stateFromCount(prevAllocated, maxAlloc);
@@ -177,17 +326,77 @@ size_t SmallPageAllocator::alloc(PageAllocationCallback cb, size_t count, Occupa
     return allocated;
 }
 
+size_t SmallPageAllocator::allocColored(PageAllocationCallback cb, size_t count, OccupancyTransition& transition,
+                                        PageColoring& coloring) {
+    const size_t maxAlloc = mm::PageAllocator::smallPagesPerBigPage - reservedCount;
+    const size_t colors = coloring.colorCount;
+    assert(colors > 1 && colors <= mm::PageAllocator::smallPagesPerBigPage && (colors & (colors - 1)) == 0,
+           "Page color count must be a power of two no larger than a big page");
+
+    // Picking a color needs every free page in view, so pull freeBitmap in first.
+    size_t available = 0;
+    for (size_t w = 0; w < bitmapWordCount; w++) {
+        if (const uint64_t freed = freeBitmap[w].exchange(0ull, ACQ_REL)) {
+            allocBitmap[w] |= freed;
+        }
+        available += static_cast<size_t>(__builtin_popcountll(allocBitmap[w]));
+    }
+    allocHint = 0;
+
+    // Page i has color i % colors. Below 64 colors, a color owns every colors-th bit of every
+    // word; from 64 up it owns one bit in every (colors / 64)-th word.
+    const uint64_t pattern = colors < 64 ? ~0ull / ((1ull << colors) - 1) : 1ull;
+    const size_t wordStride = colors < 64 ? 1 : colors / 64;
+    const auto takeColor = [&](const size_t color) {
+        const uint64_t mask = pattern << (color % 64);
+        for (size_t w = colors < 64 ? 0 : color / 64; w < bitmapWordCount; w += wordStride) {
+            if (const uint64_t candidates = allocBitmap[w] & mask) {
+                const uint64_t bit = candidates & -candidates;
+                allocBitmap[w] &= ~bit;
+                cb(PageRef::small(fromPageIndex(static_cast<SmallPageIndex>(w * 64 + static_cast<size_t>(__builtin_ctzll(bit))))));
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const size_t wanted = min(count, available);
+    for (size_t allocated = 0; allocated < wanted; allocated++) {
+        size_t color = coloring.next;
+        while (!takeColor(color)) {
+            color = (color + 1) & (colors - 1);
+        }
+        coloring.next = (color + 1) & (colors - 1);
+    }
+
+    const auto prevAllocated = allocatedCount.fetch_add(static_cast<SmallPageCount>(wanted), ACQ_REL);
+    transition.before = stateFromCount(prevAllocated, maxAlloc);
+    transition.after  = stateFromCount(static_cast<size_t>(prevAllocated) + wanted, maxAlloc);
+    return wanted;
+}
+
 void SmallPageAllocator::free(PageRef* pages, size_t count, OccupancyTransition& transition) {
     const size_t maxAlloc = mm::PageAllocator::smallPagesPerBigPage - reservedCount;
 
     uint64_t pending[bitmapWordCount] = {};
+    size_t freed = 0;
     for (size_t i = 0; i < count; i++) {
         const auto addrRaw = pages[i].addr().value;
         assert((addrRaw & ~(arch::bigPageSize - 1)) == baseAddr.value,
                "Tried to free small page in wrong small page allocator");
-        const SmallPageIndex pageIndex =
-            static_cast<SmallPageIndex>((addrRaw / arch::smallPageSize) % mm::PageAllocator::smallPagesPerBigPage);
-        pending[pageIndex / 64] |= 1ull << (pageIndex % 64);
+        const size_t pageIndex = (addrRaw / arch::smallPageSize) % mm::PageAllocator::smallPagesPerBigPage;
+        const size_t run = pages[i].runLength();
+        if (run == 1) {
+            pending[pageIndex / 64] |= 1ull << (pageIndex % 64);
+        } else {
+            for (size_t idx = pageIndex; idx < pageIndex + run;) {
+                const size_t n = min(64 - idx % 64, pageIndex + run - idx);
+                assert(!(pending[idx / 64] & bitRunMask(idx % 64, n)), "Double free: page appears twice in batch");
+                pending[idx / 64] |= bitRunMask(idx % 64, n);
+                idx += n;
+            }
+        }
+        freed += run;
     }
 
     for (size_t w = 0; w < bitmapWordCount; w++) {
@@ -197,9 +406,62 @@ void SmallPageAllocator::free(PageRef* pages, size_t count, OccupancyTransition&
         assert(!(old & pending[w]), "Double free: page is already in freeBitmap");
     }
 
-    const auto prevAllocated = allocatedCount.fetch_sub(static_cast<SmallPageCount>(count), ACQ_REL);
+    const auto prevAllocated = allocatedCount.fetch_sub(static_cast<SmallPageCount>(freed), ACQ_REL);
     transition.before = stateFromCount(prevAllocated, maxAlloc);
-    transition.after  = stateFromCount(static_cast<size_t>(prevAllocated) - count, maxAlloc);
+    transition.after  = stateFromCount(static_cast<size_t>(prevAllocated) - freed, maxAlloc);
+}
+
+Optional<mm::phys_addr> SmallPageAllocator::allocRun(size_t count, size_t alignPages, OccupancyTransition& transition) {
+    assert(count > 0 && count <= mm::PageAllocator::smallPagesPerBigPage, "Contiguous run must fit in one big page");
+    assert(alignPages > 0 && (alignPages & (alignPages - 1)) == 0, "Run alignment must be a power of two");
+    const size_t maxAlloc = mm::PageAllocator::smallPagesPerBigPage - reservedCount;
+
+    // A run may straddle pages sitting in either bitmap, so pull everything into allocBitmap first.
+    for (size_t w = 0; w < bitmapWordCount; w++) {
+        if (const uint64_t freed = freeBitmap[w].exchange(0ull, ACQ_REL)) {
+            allocBitmap[w] |= freed;
+        }
+    }
+    allocHint = 0;
+
+    // Length of the free prefix of [first, first + count), stopping at the first allocated page.
+    const auto freePrefix = [&](const size_t first) {
+        size_t len = 0;
+        while (len < count) {
+            const size_t idx = first + len;
+            const size_t n = min(64 - idx % 64, count - len);
+            const uint64_t mask = bitRunMask(idx % 64, n);
+            const uint64_t holes = ~allocBitmap[idx / 64] & mask;
+            if (holes) {
+                return len + static_cast<size_t>(__builtin_ctzll(holes)) - idx % 64;
+            }
+            len += n;
+        }
+        return len;
+    };
+
+    size_t first = 0;
+    while (first + count <= mm::PageAllocator::smallPagesPerBigPage) {
+        const size_t len = freePrefix(first);
+        if (len == count) {
+            for (size_t idx = first; idx < first + count;) {
+                const size_t n = min(64 - idx % 64, first + count - idx);
+                allocBitmap[idx / 64] &= ~bitRunMask(idx % 64, n);
+                idx += n;
+            }
+            const auto prevAllocated = allocatedCount.fetch_add(static_cast<SmallPageCount>(count), ACQ_REL);
+            transition.before = stateFromCount(prevAllocated, maxAlloc);
+            transition.after  = stateFromCount(static_cast<size_t>(prevAllocated) + count, maxAlloc);
+            return fromPageIndex(static_cast<SmallPageIndex>(first));
+        }
+        // Nothing starting at or before the allocated page can work; resume at the next aligned slot after it.
+        first = roundUpToNearestMultiple(first + len + 1, alignPages);
+    }
+
+    const auto current = static_cast<size_t>(allocatedCount.load(ACQUIRE));
+    transition.before = stateFromCount(current, maxAlloc);
+    transition.after  = transition.before;
+    return {};
 }
 
 bool SmallPageAllocator::isPageFree(PageRef page) const {
@@ -259,12 +521,13 @@ bool SmallPageAllocator::checkInvariants() const {
 BigPageMetadata::BigPageMetadata(NUMAPool& pool, mm::phys_addr baseAddr)
     : subpageAllocator(baseAddr), ownerPool(&pool) {}
 
-size_t BigPageMetadata::allocatePages(size_t smallPageCount, PageAllocationCallback cb, OccupancyTransition& transition) {
+size_t BigPageMetadata::allocatePages(size_t smallPageCount, PageAllocationCallback cb, OccupancyTransition& transition, bool runs,
+                                      PageColoring* coloring) {
     assert(allocHolder.load() != SIZE_MAX, "Allocating from big page without setting alloc holder");
     assert(allocHolder.load() == static_cast<size_t>(arch::getCurrentProcessorID()), "Two CPUs allocating from same page simultaneously");
     size_t allocated = 0;
     while (allocated < smallPageCount) {
-        allocated += subpageAllocator.alloc(cb, smallPageCount - allocated, transition);
+        allocated += subpageAllocator.alloc(cb, smallPageCount - allocated, transition, runs, coloring);
         if (transition.becameFull()) {
             break;
         }
@@ -272,6 +535,11 @@ size_t BigPageMetadata::allocatePages(size_t smallPageCount, PageAllocationCallb
     return allocated;
 }
 
+Optional<mm::phys_addr> BigPageMetadata::allocateRun(size_t smallPageCount, size_t alignPages, OccupancyTransition& transition) {
+    assert(allocHolder.load() == static_cast<size_t>(arch::getCurrentProcessorID()), "Allocating run from big page without holding it");
+    return subpageAllocator.allocRun(smallPageCount, alignPages, transition);
+}
+
 void BigPageMetadata::freePages(PageRef *pages, size_t count, OccupancyTransition& transition) {
     subpageAllocator.free(pages, count, transition);
 }
@@ -287,52 +555,328 @@ bool BigPageMetadata::isFull() const {
 // ==================== NUMAPool ====================
 
 NUMAPool::NUMAPool(BigPageMetadata* metadataBuffer,
+                   mm::PageFrame* frames,
                    BigPageMetadata** freeBuffer,
                    Atomic<size_t>* wgc,
                    Atomic<size_t>* rgc,
+                   BigPageMetadata** zeroedBuffer,
+                   Atomic<size_t>* zeroedWgc,
+                   Atomic<size_t>* zeroedRgc,
+                   PageRef* zeroedSmallBuffer,
+                   Atomic<size_t>* zeroedSmallWgc,
+                   Atomic<size_t>* zeroedSmallRgc,
+                   BigPageMetadata** giganticBuffer,
+                   Atomic<size_t>* giganticWgc,
+                   Atomic<size_t>* giganticRgc,
+                   size_t giganticCapacity,
                    AtomicBitPool&& paPagesBitPool,
+                   AtomicBitPool&& longLivedBitPool,
                    SubrangeInfo* subrangeBuffer,
                    size_t numSubranges,
                    size_t totalBigPageCount,
-                   kernel::numa::DomainID domain)
+                   kernel::numa::DomainID domain,
+                   const mm::phys_memory_range* sortedRanges,
+                   size_t sortedRangeCount,
+                   size_t eagerBigPages)
     : bigPageMetadataBuffer(metadataBuffer),
+      frameBuffer(frames),
       freeBigPages(freeBuffer, totalBigPageCount, wgc, rgc),
       paPages(move(paPagesBitPool)),
+      longLivedPAPages(move(longLivedBitPool)),
       associatedDomain(domain),
       subrangeInfo(subrangeBuffer),
       subrangeCount(numSubranges),
-      bigPageCount(totalBigPageCount)
+      bigPageCount(totalBigPageCount),
+      zeroedBigPages(zeroedBuffer, totalBigPageCount, zeroedWgc, zeroedRgc),
+      zeroedSmallPages(zeroedSmallBuffer, zeroedSmallPageCapacity, zeroedSmallWgc, zeroedSmallRgc),
+      freeGiganticPages(giganticBuffer, giganticCapacity, giganticWgc, giganticRgc),
+      originalRanges(sortedRanges),
+      originalRangeCount(sortedRangeCount),
+      lowWatermark(totalBigPageCount / PA_LOW_WATERMARK_FRACTION),
+      highWatermark(2 * (totalBigPageCount / PA_LOW_WATERMARK_FRACTION))
 {
-    // Separate fully-free pages from partially-reserved pages.
-    // Pages with reserved subpages cannot be handed out as whole big pages, so
-    // they belong in the PA bitpool for small-page allocation rather than in the
-    // free ring buffer.
-    size_t freePagesCount = 0;
-    for (size_t i = 0; i < totalBigPageCount; i++) {
-        if (!bigPageMetadataBuffer[i].hasReservedSubpages()) {
-            freePagesCount++;
+    for (auto& hint : localityHints) {
+        hint = SIZE_MAX;
+    }
+    // Build enough metadata to boot on. Whatever is left over is built later by
+    // initializeDeferredChunk, either on the APs or on demand when allocation runs short.
+    const size_t eager = min(eagerBigPages, totalBigPageCount);
+    while (initializedBigPages.load(RELAXED) < eager) {
+        initializeDeferredChunk();
+    }
+}
+
+const SubrangeInfo& NUMAPool::subrangeOf(const size_t index) const {
+    assert(index < bigPageCount, "subrangeOf: big page index out of range");
+    for (size_t si = 0; si + 1 < subrangeCount; si++) {
+        const SubrangeInfo& sr = subrangeInfo[si];
+        const size_t pagesInRange = (sr.rangeEnd.value - sr.rangeStart.value) / arch::bigPageSize;
+        if (index < metadataIndex(sr.metadataBase) + pagesInRange) {
+            return sr;
+        }
+    }
+    return subrangeInfo[subrangeCount - 1];
+}
+
+size_t NUMAPool::deferredChunkEnd(const size_t start) const {
+    const SubrangeInfo& sr = subrangeOf(start);
+    const size_t srFirst = metadataIndex(sr.metadataBase);
+    const size_t srEnd = srFirst + (sr.rangeEnd.value - sr.rangeStart.value) / arch::bigPageSize;
+    const uint64_t startAddr = sr.rangeStart.value + (start - srFirst) * arch::bigPageSize;
+    const uint64_t nextGroup = roundUpToNearestMultiple(startAddr + 1, static_cast<uint64_t>(arch::giganticPageSize));
+    return min(srEnd, start + static_cast<size_t>((nextGroup - startAddr) / arch::bigPageSize));
+}
+
+// Reserve all small pages in [reserveStart, reserveEnd) within the given BigPageMetadata.
+// reserveStart and reserveEnd must lie within the big page's bounds.
+static void reserveSmallPageRange(BigPageMetadata& meta, mm::phys_addr reserveStart, mm::phys_addr reserveEnd) {
+    assert(reserveStart.value % arch::smallPageSize == 0, "reserveStart not small-page aligned");
+    assert(reserveEnd.value   % arch::smallPageSize == 0, "reserveEnd not small-page aligned");
+    for (mm::phys_addr p = reserveStart; p.value < reserveEnd.value; p += arch::smallPageSize) {
+        meta.reservePage(p);
+    }
+}
+
+void NUMAPool::constructBigPages(const size_t first, const size_t end) {
+    const SubrangeInfo& sr = subrangeOf(first);
+    const size_t srFirst = metadataIndex(sr.metadataBase);
+    // The metadata buffer comes from the bootstrap allocator uninitialized, and the
+    // constructors expect zeroed memory.
+    memset(static_cast<void*>(&bigPageMetadataBuffer[first]), 0, (end - first) * sizeof(BigPageMetadata));
+    // PageFrame is all zeros for a free page, so a memset is all its construction needs.
+    constexpr size_t framesPerBigPage = mm::PageAllocator::smallPagesPerBigPage;
+    memset(static_cast<void*>(&frameBuffer[first * framesPerBigPage]), 0, (end - first) * framesPerBigPage * sizeof(mm::PageFrame));
+    for (size_t i = first; i < end; i++) {
+        const mm::phys_addr bigPageStart{sr.rangeStart.value + (i - srFirst) * arch::bigPageSize};
+        const mm::phys_addr bigPageEnd{bigPageStart.value + arch::bigPageSize};
+        BigPageMetadata& meta = *new (&bigPageMetadataBuffer[i]) BigPageMetadata(*this, bigPageStart);
+
+        // Reserve whatever the original ranges leave uncovered: alignment slack at either
+        // end of a merged range, and the gaps between ranges that share a big page.
+        mm::phys_addr prevEnd = bigPageStart;
+        for (size_t ri = 0; ri < originalRangeCount; ri++) {
+            const mm::phys_memory_range& orig = originalRanges[ri];
+            if (orig.start.value >= bigPageEnd.value) break;
+            if (orig.end.value <= prevEnd.value) continue;
+            if (orig.start.value > prevEnd.value) {
+                reserveSmallPageRange(meta, prevEnd, orig.start);
+            }
+            prevEnd = mm::phys_addr{min(orig.end.value, bigPageEnd.value)};
+        }
+        if (prevEnd.value < bigPageEnd.value) {
+            reserveSmallPageRange(meta, prevEnd, bigPageEnd);
         }
     }
+}
 
-    // Publish only fully-free big pages in the ring buffer.
-    size_t freeIdx = 0;
-    freeBigPages.bulkWrite(freePagesCount, [&](size_t, BigPageMetadata*& slot) {
-        while (bigPageMetadataBuffer[freeIdx].hasReservedSubpages()) {
-            freeIdx++;
+bool NUMAPool::initializeDeferredChunk() {
+    size_t start = deferredCursor.load(RELAXED);
+    size_t end;
+    do {
+        if (start >= bigPageCount) {
+            // Everything is claimed. Wait for chunks still being built, so a caller that came
+            // here for memory can see their pages once this returns.
+            if (initializedBigPages.load(ACQUIRE) == bigPageCount) {
+                return false;
+            }
+            while (initializedBigPages.load(ACQUIRE) != bigPageCount) {
+                tight_spin();
+            }
+            return true;
         }
-        slot = &bigPageMetadataBuffer[freeIdx++];
+        end = deferredChunkEnd(start);
+    } while (!deferredCursor.compare_exchange(start, end, RELAXED, RELAXED));
+
+    constructBigPages(start, end);
+    // Pages with reserved subpages cannot be handed out whole, so they go straight to the
+    // partial-page set instead of the free lists.
+    publishFreeBigPages(start, end);
+    {
+        BitPoolBatch reserved(paPages, false);
+        for (size_t i = start; i < end; i++) {
+            const BigPageMetadata& meta = bigPageMetadataBuffer[i];
+            if (meta.hasReservedSubpages() && !meta.isFull()) {
+                reserved.push(i);
+            }
+        }
+    }
+
+    // Chunks can finish out of order. Extend the prefix in claim order so it never covers
+    // metadata that is still being built.
+    while (initializedBigPages.load(ACQUIRE) != start) {
+        tight_spin();
+    }
+    initializedBigPages.store(end, RELEASE);
+    return true;
+}
+
+template<typename Callback>
+size_t NUMAPool::takeFreeBigPages(size_t count, Callback cb) {
+    BigPageMetadata* hot[hotBigPageCapacity];
+    const size_t hotCount = takeHotBigPages(hot, count);
+    for (size_t i = 0; i < hotCount; i++) {
+        cb(i, hot[i]);
+    }
+    if (hotCount == count) {
+        return hotCount;
+    }
+    const size_t dirty = hotCount + freeBigPages.bulkReadBestEffort(count - hotCount, [&](size_t index, BigPageMetadata* const& metadata) {
+        cb(hotCount + index, metadata);
+    });
+    if (dirty == count) {
+        checkWatermarks();
+        return dirty;
+    }
+    size_t taken = dirty + zeroedBigPages.bulkReadBestEffort(count - dirty, [&](size_t index, BigPageMetadata* const& metadata) {
+        cb(dirty + index, metadata);
     });
+    while (taken < count && splitGiganticPage()) {
+        const size_t before = taken;
+        taken += freeBigPages.bulkReadBestEffort(count - taken, [&](size_t index, BigPageMetadata* const& metadata) {
+            cb(before + index, metadata);
+        });
+    }
+    checkWatermarks();
+    return taken;
+}
+
+bool NUMAPool::takeFreeBigPage(BigPageMetadata*& out) {
+    if (takeHotBigPages(&out, 1) == 1) {
+        return true;
+    }
+    if (freeBigPages.tryRead(out) || zeroedBigPages.tryRead(out)) {
+        checkWatermarks();
+        return true;
+    }
+    // Another CPU may grab pages of the group we split before we read one; try again then.
+    while (splitGiganticPage()) {
+        if (freeBigPages.tryRead(out)) {
+            checkWatermarks();
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t NUMAPool::takeHotBigPages(BigPageMetadata** out, size_t count) {
+    if (count == 0 || !hotLock.try_acquire()) {
+        return 0;
+    }
+    const size_t taken = min(min(count, hotBigPageCount), hotBigPageCapacity);
+    for (size_t i = 0; i < taken; i++) {
+        out[i] = hotBigPages[(hotBigPageStart + --hotBigPageCount) % hotBigPageCapacity];
+    }
+    hotLock.release();
+    return taken;
+}
 
-    // Mark partially-reserved pages in the PA bitpool so they are available
-    // for small-page allocation.
-    for (size_t i = 0; i < totalBigPageCount; i++) {
-        if (bigPageMetadataBuffer[i].hasReservedSubpages()) {
-            paPages.add(i);
+void NUMAPool::pushFreeBigPage(BigPageMetadata& metadata) {
+    BigPageMetadata* toRing = &metadata;
+    if (hotLock.try_acquire()) {
+        toRing = nullptr;
+        if (hotBigPageCount == hotBigPageCapacity) {
+            // Make room by pushing the coldest entry out to the ring.
+            toRing = hotBigPages[hotBigPageStart];
+            hotBigPageStart = (hotBigPageStart + 1) % hotBigPageCapacity;
+            hotBigPageCount--;
         }
+        hotBigPages[(hotBigPageStart + hotBigPageCount++) % hotBigPageCapacity] = &metadata;
+        hotLock.release();
+    }
+    if (toRing != nullptr) {
+        freeBigPages.write(toRing);
+    }
+}
+
+size_t NUMAPool::approximateFreeBigPages() const {
+    return freeBigPages.availableToRead() + zeroedBigPages.availableToRead()
+         + freeGiganticPages.availableToRead() * mm::PageAllocator::bigPagesPerGiganticPage
+         + (bigPageCount - min(deferredCursor.load(RELAXED), bigPageCount));
+}
+
+void NUMAPool::checkWatermarks() {
+    const size_t free = approximateFreeBigPages();
+    if (free < lowWatermark) {
+        // Relaxed load first so a pool sitting below the watermark costs no locked operation.
+        if (!belowLowWatermark.load(RELAXED) && !belowLowWatermark.exchange(true, ACQ_REL)) {
+            lowWatermarkPending.store(true, RELEASE);
+        }
+    } else if (free >= highWatermark && belowLowWatermark.load(RELAXED)) {
+        belowLowWatermark.store(false, RELEASE);
+    }
+}
+
+void NUMAPool::setWatermarks(const size_t lowBigPages, const size_t highBigPages) {
+    assert(lowBigPages <= highBigPages, "Low watermark above high watermark");
+    lowWatermark = lowBigPages;
+    highWatermark = highBigPages;
+}
+
+bool NUMAPool::addLowWatermarkCallback(const mm::PageAllocator::LowWatermarkCallback callback) {
+    LockGuard guard(lowWatermarkLock);
+    const size_t count = lowWatermarkCallbackCount.load(RELAXED);
+    if (count == lowWatermarkCallbackCapacity) {
+        return false;
+    }
+    lowWatermarkCallbacks[count] = callback;
+    lowWatermarkCallbackCount.store(count + 1, RELEASE);
+    return true;
+}
+
+bool NUMAPool::runLowWatermarkCallbacks() {
+    if (!lowWatermarkPending.load(RELAXED) || !lowWatermarkPending.exchange(false, ACQ_REL)) {
+        return false;
+    }
+    const size_t free = approximateFreeBigPages();
+    const size_t count = lowWatermarkCallbackCount.load(ACQUIRE);
+    for (size_t i = 0; i < count; i++) {
+        lowWatermarkCallbacks[i](associatedDomain, free);
+    }
+    return true;
+}
+
+size_t NUMAPool::zeroedBigPageTarget() const {
+    return max(static_cast<size_t>(1), bigPageCount / PA_ZEROED_BIG_PAGE_FRACTION);
+}
+
+AtomicBitPool::GetResult NUMAPool::getPAPage(PageLifetime cls, size_t pid, size_t& outIndex, size_t maxRetries) {
+    const size_t hint = localityHints[pid];
+    const auto result = hint == SIZE_MAX ? partialPages(cls).getAny(pid, outIndex, maxRetries)
+                                         : partialPages(cls).getNear(hint, outIndex, maxRetries);
+    if (result == AtomicBitPool::GetResult::Success) {
+        localityHints[pid] = outIndex;
+    } else if (result == AtomicBitPool::GetResult::Contended) {
+        paPagesContention.add_fetch(1, RELAXED);
+    }
+    return result;
+}
+
+size_t NUMAPool::countFreeBigPages() {
+    size_t hot;
+    {
+        LockGuard guard(hotLock);
+        hot = hotBigPageCount;
+    }
+    return hot + freeBigPages.availableToRead() + zeroedBigPages.availableToRead()
+         + freeGiganticPages.availableToRead() * mm::PageAllocator::bigPagesPerGiganticPage;
+}
+
+size_t NUMAPool::countTotalFreePages() const {
+    size_t total = 0;
+    const size_t initialized = initializedBigPages.load(ACQUIRE);
+    for (size_t i = 0; i < initialized; i++) {
+        total += bigPageMetadataBuffer[i].freeSubpageCount();
     }
+    return total;
 }
 
 BigPageMetadata* NUMAPool::findMetadata(mm::phys_addr addr) {
+    if (metadataRadix.valid()) {
+        // Compare against our own buffer instead of asking the metadata for its owner; the
+        // radix also points at big pages whose metadata has not been built yet.
+        BigPageMetadata* meta = metadataRadix.lookup(addr);
+        return (meta >= bigPageMetadataBuffer && meta < bigPageMetadataBuffer + bigPageCount) ? meta : nullptr;
+    }
     const uint64_t addrAligned = roundDownToNearestMultiple(addr.value, static_cast<uint64_t>(arch::bigPageSize));
     for (size_t i = 0; i < subrangeCount; i++) {
         const SubrangeInfo& sr = subrangeInfo[i];
@@ -351,7 +895,22 @@ void BigPageMetadata::returnPage(bool evictedAsFull) {
 }
 
 void NUMAPool::reserveRange(mm::phys_memory_range range) {
-    for (size_t i = 0; i < bigPageCount; i++) {
+    // Reserving writes metadata, so first build every chunk up to the last big page the
+    // range touches.
+    size_t touchedEnd = 0;
+    for (size_t si = 0; si < subrangeCount; si++) {
+        const SubrangeInfo& sr = subrangeInfo[si];
+        if (range.end.value <= sr.rangeStart.value || range.start.value >= sr.rangeEnd.value) continue;
+        const uint64_t lastByte = min(range.end.value, sr.rangeEnd.value) - 1;
+        touchedEnd = max(touchedEnd, metadataIndex(sr.metadataBase)
+                                     + static_cast<size_t>((lastByte - sr.rangeStart.value) / arch::bigPageSize) + 1);
+    }
+    while (initializedBigPages.load(ACQUIRE) < touchedEnd) {
+        initializeDeferredChunk();
+    }
+
+    const size_t initialized = initializedBigPages.load(ACQUIRE);
+    for (size_t i = 0; i < initialized; i++) {
         auto& meta = bigPageMetadataBuffer[i];
         const mm::phys_addr bigStart = meta.baseAddr();
         const mm::phys_addr bigEnd{bigStart.value + arch::bigPageSize};
@@ -370,38 +929,93 @@ void NUMAPool::reserveRange(mm::phys_memory_range range) {
     fixupAfterReserveRange();
 }
 
+void NUMAPool::publishFreeBigPages(const size_t first, const size_t end) {
+    constexpr auto groupSize = mm::PageAllocator::bigPagesPerGiganticPage;
+    for (size_t si = 0; si < subrangeCount; si++) {
+        const SubrangeInfo& sr = subrangeInfo[si];
+        const size_t srFirst = metadataIndex(sr.metadataBase);
+        const size_t stop = min(end, srFirst + static_cast<size_t>((sr.rangeEnd.value - sr.rangeStart.value) / arch::bigPageSize));
+        size_t i = max(first, srFirst);
+        while (i < stop) {
+            BigPageMetadata& meta = bigPageMetadataBuffer[i];
+            // Each aligned window is checked once; a window with any reserved subpage falls
+            // back to page-by-page publishing.
+            if (meta.baseAddr().value % arch::giganticPageSize == 0 && i + groupSize <= stop) {
+                bool wholeGroupFree = true;
+                for (size_t k = 0; k < groupSize && wholeGroupFree; k++) {
+                    wholeGroupFree = !bigPageMetadataBuffer[i + k].hasReservedSubpages();
+                }
+                if (wholeGroupFree) {
+                    freeGiganticPages.write(&meta);
+                    i += groupSize;
+                    continue;
+                }
+            }
+            if (!meta.hasReservedSubpages()) {
+                freeBigPages.write(&meta);
+            }
+            i++;
+        }
+    }
+}
+
+bool NUMAPool::splitGiganticPage() {
+    BigPageMetadata* group = nullptr;
+    if (!freeGiganticPages.tryRead(group)) {
+        return false;
+    }
+    freeBigPages.bulkWrite(mm::PageAllocator::bigPagesPerGiganticPage, [&](size_t index, BigPageMetadata*& slot) {
+        slot = &group[index];
+    });
+    return true;
+}
+
 void NUMAPool::fixupAfterReserveRange() {
-    // Drain freeBigPages (discard — we rebuild from metadata below).
+    // Init-time only, so no chunk is being built concurrently and every published page lies
+    // below initializedBigPages.
+    const size_t initialized = initializedBigPages.load(ACQUIRE);
+    // Drain the hot stack and every free ring (discard — we rebuild from metadata below).
+    {
+        LockGuard guard(hotLock);
+        hotBigPageCount = 0;
+    }
     freeBigPages.bulkReadBestEffort(bigPageCount, [](size_t, BigPageMetadata*) {});
-
-    // Rebuild freeBigPages and paPages from the current metadata state.
-    size_t newFreeCount = 0;
-    for (size_t i = 0; i < bigPageCount; i++) {
-        auto& meta = bigPageMetadataBuffer[i];
-        if (!meta.hasReservedSubpages()) {
-            newFreeCount++;
-        } else if (!meta.isFull()) {
-            (void)paPages.add(i);   // Idempotent: OK if already present.
-        } else {
-            (void)paPages.remove(i); // All subpages reserved; remove if present.
+    zeroedBigPages.bulkReadBestEffort(bigPageCount, [](size_t, BigPageMetadata*) {});
+    freeGiganticPages.bulkReadBestEffort(bigPageCount, [](size_t, BigPageMetadata*) {});
+
+    // Rebuild the partial-page sets from the current metadata state.
+    {
+        BitPoolBatch adds[] = {{partialPages(PageLifetime::Short), false}, {partialPages(PageLifetime::Long), false}};
+        BitPoolBatch removes[] = {{partialPages(PageLifetime::Short), true}, {partialPages(PageLifetime::Long), true}};
+        for (size_t i = 0; i < initialized; i++) {
+            auto& meta = bigPageMetadataBuffer[i];
+            const auto cls = static_cast<size_t>(meta.lifetime());
+            if (!meta.hasReservedSubpages()) {
+                continue;
+            } else if (!meta.isFull()) {
+                adds[cls].push(i);      // Idempotent: OK if already present.
+            } else {
+                removes[cls].push(i);   // All subpages reserved; remove if present.
+            }
         }
     }
 
-    size_t freeIdx = 0;
-    freeBigPages.bulkWrite(newFreeCount, [&](size_t, BigPageMetadata*& slot) {
-        while (bigPageMetadataBuffer[freeIdx].hasReservedSubpages()) freeIdx++;
-        slot = &bigPageMetadataBuffer[freeIdx++];
-    });
+    // Groups that gained a reserved subpage are published page by page this time.
+    publishFreeBigPages(0, initialized);
 }
 
 #ifdef CROCOS_TESTING
 #include <kernel.h>
 bool NUMAPool::checkInvariants() const {
     size_t emptyInPA = 0;
-    for (size_t i = 0; i < bigPageCount; i++) {
+    const size_t initialized = initializedBigPages.load(ACQUIRE);
+    for (size_t i = 0; i < initialized; i++) {
         if (isInPAPages(i)) {
             const BigPageMetadata& meta = bigPageMetadataBuffer[i];
             if (meta.isFull()) return false;
+            // A page sits in exactly one partial-page set, the one matching its lifetime class.
+            if (paPages.isSet(i) && longLivedPAPages.isSet(i)) return false;
+            if (longLivedPAPages.isSet(i) != (meta.lifetime() == PageLifetime::Long)) return false;
             if (meta.isEmpty()) emptyInPA++;
         }
     }
@@ -410,14 +1024,6 @@ bool NUMAPool::checkInvariants() const {
     if (getFreeBigPageCount() + getPAPagesCount() > bigPageCount) return false;
     return true;
 }
-
-size_t NUMAPool::countTotalFreePages() const {
-    size_t total = 0;
-    for (size_t i = 0; i < bigPageCount; i++) {
-        total += bigPageMetadataBuffer[i].freeSubpageCount();
-    }
-    return total;
-}
 #endif
 
 
@@ -491,22 +1097,12 @@ size_t computeMergedRanges(const Vector<mm::phys_memory_range>& ranges,
     return count;
 }
 
-// Reserve all small pages in [reserveStart, reserveEnd) within the given BigPageMetadata.
-// reserveStart and reserveEnd must lie within the big page's bounds.
-void reserveSmallPageRange(BigPageMetadata& meta,
-                            mm::phys_addr reserveStart, mm::phys_addr reserveEnd) {
-    assert(reserveStart.value % arch::smallPageSize == 0, "reserveStart not small-page aligned");
-    assert(reserveEnd.value   % arch::smallPageSize == 0, "reserveEnd not small-page aligned");
-    for (mm::phys_addr p = reserveStart; p.value < reserveEnd.value; p += arch::smallPageSize) {
-        meta.reservePage(p);
-    }
-}
-
 } // namespace
 
 NUMAPool* createNumaPool(BootstrapAllocator& alloc,
                           const Vector<mm::phys_memory_range>& ranges,
-                          kernel::numa::DomainID domain) {
+                          kernel::numa::DomainID domain,
+                          size_t eagerBigPages) {
     // --- Phase 1: compute merged ranges (same in both measure and real mode) ---
     TempMergedRange merged[MAX_RANGES_PER_DOMAIN];
     mm::phys_memory_range sorted[MAX_RANGES_PER_DOMAIN];
@@ -519,7 +1115,13 @@ NUMAPool* createNumaPool(BootstrapAllocator& alloc,
     // --- Phase 2: allocate all structures from the bootstrap allocator ---
     NUMAPool* poolPtr = alloc.allocate<NUMAPool>();
 
-    BigPageMetadata* metadata = alloc.allocate<BigPageMetadata>(totalBigPageCount);
+    // Left uninitialized: each chunk is zeroed as it is built, which for deferred chunks
+    // happens after boot.
+    BigPageMetadata* metadata = alloc.allocateUninitialized<BigPageMetadata>(totalBigPageCount);
+    // Per-frame descriptors, 8 bytes per small page, zeroed with the metadata chunk they belong to.
+    mm::PageFrame* frames = alloc.allocateUninitialized<mm::PageFrame>(totalBigPageCount * mm::PageAllocator::smallPagesPerBigPage);
+    // The pool keeps the sorted input ranges so deferred chunks can reserve the gaps between them.
+    mm::phys_memory_range* originalRanges = alloc.allocate<mm::phys_memory_range>(ranges.size());
 
     BigPageMetadata** freeBuffer = alloc.allocate<BigPageMetadata*>(totalBigPageCount);
 
@@ -527,83 +1129,73 @@ NUMAPool* createNumaPool(BootstrapAllocator& alloc,
     Atomic<size_t>* wgc = alloc.allocate<Atomic<size_t>>(totalBigPageCount);
     Atomic<size_t>* rgc = alloc.allocate<Atomic<size_t>>(totalBigPageCount);
 
+    // Pre-zeroed big and small page lists, with their own gen counters.
+    BigPageMetadata** zeroedBuffer = alloc.allocate<BigPageMetadata*>(totalBigPageCount);
+    Atomic<size_t>* zeroedWgc = alloc.allocate<Atomic<size_t>>(totalBigPageCount);
+    Atomic<size_t>* zeroedRgc = alloc.allocate<Atomic<size_t>>(totalBigPageCount);
+    PageRef* zeroedSmallBuffer = alloc.allocate<PageRef>(NUMAPool::zeroedSmallPageCapacity);
+    Atomic<size_t>* zeroedSmallWgc = alloc.allocate<Atomic<size_t>>(NUMAPool::zeroedSmallPageCapacity);
+    Atomic<size_t>* zeroedSmallRgc = alloc.allocate<Atomic<size_t>>(NUMAPool::zeroedSmallPageCapacity);
+
+    // Gigantic free list, sized for every aligned group that fits inside a merged range.
+    size_t giganticCapacity = 0;
+    for (size_t i = 0; i < mergedCount; i++) {
+        const uint64_t firstGroup = roundUpToNearestMultiple(merged[i].start.value, static_cast<uint64_t>(arch::giganticPageSize));
+        if (firstGroup < merged[i].end.value) {
+            giganticCapacity += (merged[i].end.value - firstGroup) / arch::giganticPageSize;
+        }
+    }
+    giganticCapacity = max(giganticCapacity, static_cast<size_t>(1));
+    BigPageMetadata** giganticBuffer = alloc.allocate<BigPageMetadata*>(giganticCapacity);
+    Atomic<size_t>* giganticWgc = alloc.allocate<Atomic<size_t>>(giganticCapacity);
+    Atomic<size_t>* giganticRgc = alloc.allocate<Atomic<size_t>>(giganticCapacity);
+
     // BitPool backing storage, cache-line aligned.
     const size_t bitPoolBytes = AtomicBitPool::requiredBufferSize(totalBigPageCount, arch::CACHE_LINE_SIZE);
     void* bitPoolStorage = alloc.allocate<uint8_t>(bitPoolBytes, arch::CACHE_LINE_SIZE);
+    void* longLivedBitPoolStorage = alloc.allocate<uint8_t>(bitPoolBytes, arch::CACHE_LINE_SIZE);
 
     SubrangeInfo* subranges = alloc.allocate<SubrangeInfo>(mergedCount);
 
     // --- Phase 3: populate structures (real mode only) ---
     if (!alloc.isFake()) {
         size_t metaIdx = 0;
-
         for (size_t mi = 0; mi < mergedCount; mi++) {
-            const TempMergedRange& mr = merged[mi];
-            BigPageMetadata* rangeMetaBase = &metadata[metaIdx];
-
-            // Construct BigPageMetadata for each big page in this merged range.
-            for (size_t bpIdx = 0; bpIdx < mr.bigPageCount; bpIdx++) {
-                mm::phys_addr bigPageBase{mr.start.value + bpIdx * arch::bigPageSize};
-                new (&metadata[metaIdx + bpIdx]) BigPageMetadata(*poolPtr, bigPageBase);
-            }
-
-            // Reserve pages in each big page based on which portions are outside
-            // any original range (alignment gaps) or in gaps between original ranges.
-            for (size_t bpIdx = 0; bpIdx < mr.bigPageCount; bpIdx++) {
-                mm::phys_addr bigPageStart{mr.start.value + bpIdx * arch::bigPageSize};
-                mm::phys_addr bigPageEnd  {bigPageStart.value + arch::bigPageSize};
-                BigPageMetadata& meta = metadata[metaIdx + bpIdx];
-
-                // Walk original ranges within this merged range, tracking covered intervals.
-                mm::phys_addr prevEnd = bigPageStart; // last covered address within this big page
-
-                for (size_t ri = mr.firstOrigIdx; ri <= mr.lastOrigIdx; ri++) {
-                    const mm::phys_memory_range& orig = sorted[ri];
-
-                    // Clamp original range to this big page's extent.
-                    const mm::phys_addr origClampedStart{
-                        orig.start.value > bigPageStart.value ? orig.start.value : bigPageStart.value};
-                    const mm::phys_addr origClampedEnd{
-                        orig.end.value < bigPageEnd.value ? orig.end.value : bigPageEnd.value};
-
-                    if (origClampedStart.value >= bigPageEnd.value) break;  // past this big page
-                    if (origClampedEnd.value   <= bigPageStart.value) continue; // before this big page
-
-                    // Reserve the gap between prevEnd and the start of this original range.
-                    if (prevEnd.value < origClampedStart.value) {
-                        reserveSmallPageRange(meta, prevEnd, origClampedStart);
-                    }
-                    if (origClampedEnd.value > prevEnd.value) {
-                        prevEnd = origClampedEnd;
-                    }
-                }
-
-                // Reserve tail gap (from last covered address to end of big page).
-                if (prevEnd.value < bigPageEnd.value) {
-                    reserveSmallPageRange(meta, prevEnd, bigPageEnd);
-                }
-            }
-
-            // Populate SubrangeInfo for this merged range.
-            subranges[mi].rangeStart   = mr.start;
-            subranges[mi].rangeEnd     = mr.end;
-            subranges[mi].metadataBase = rangeMetaBase;
-
-            metaIdx += mr.bigPageCount;
+            subranges[mi].rangeStart   = merged[mi].start;
+            subranges[mi].rangeEnd     = merged[mi].end;
+            subranges[mi].metadataBase = &metadata[metaIdx];
+            metaIdx += merged[mi].bigPageCount;
+        }
+        for (size_t i = 0; i < ranges.size(); i++) {
+            originalRanges[i] = sorted[i];
         }
 
-        // Construct the AtomicBitPool and move it into the NUMAPool constructor.
+        // Construct the AtomicBitPools and move them into the NUMAPool constructor.
         AtomicBitPool paPages(totalBigPageCount, bitPoolStorage, arch::CACHE_LINE_SIZE);
+        AtomicBitPool longLivedPAPages(totalBigPageCount, longLivedBitPoolStorage, arch::CACHE_LINE_SIZE);
 
         // Initialize Atomic gen counters to 0 (they're raw memory from BootstrapAllocator).
         for (size_t i = 0; i < totalBigPageCount; i++) {
             new (&wgc[i]) Atomic<size_t>(0);
             new (&rgc[i]) Atomic<size_t>(0);
+            new (&zeroedWgc[i]) Atomic<size_t>(0);
+            new (&zeroedRgc[i]) Atomic<size_t>(0);
+        }
+        for (size_t i = 0; i < NUMAPool::zeroedSmallPageCapacity; i++) {
+            new (&zeroedSmallWgc[i]) Atomic<size_t>(0);
+            new (&zeroedSmallRgc[i]) Atomic<size_t>(0);
+        }
+        for (size_t i = 0; i < giganticCapacity; i++) {
+            new (&giganticWgc[i]) Atomic<size_t>(0);
+            new (&giganticRgc[i]) Atomic<size_t>(0);
         }
 
-        new (poolPtr) NUMAPool(metadata, freeBuffer, wgc, rgc,
-                               move(paPages), subranges, mergedCount,
-                               totalBigPageCount, domain);
+        new (poolPtr) NUMAPool(metadata, frames, freeBuffer, wgc, rgc,
+                               zeroedBuffer, zeroedWgc, zeroedRgc,
+                               zeroedSmallBuffer, zeroedSmallWgc, zeroedSmallRgc,
+                               giganticBuffer, giganticWgc, giganticRgc, giganticCapacity,
+                               move(paPages), move(longLivedPAPages), subranges, mergedCount,
+                               totalBigPageCount, domain, originalRanges, ranges.size(), eagerBigPages);
     }
 
     return poolPtr;
@@ -613,10 +1205,60 @@ LocalPool* createLocalPool(BootstrapAllocator& alloc, const kernel::numa::NUMATo
     return alloc.allocate<LocalPool>([&](LocalPool& lp) { new(&lp) LocalPool(topology, homePool, pid); }, 1);
 }
 
+// ==================== MetadataRadix ====================
+
+MetadataRadix createMetadataRadix(BootstrapAllocator& alloc, const Vector<mm::phys_memory_range>& ranges) {
+    constexpr size_t leafSpan = MetadataRadix::leafSpan;
+
+    size_t rootEntries = 0;
+    for (const auto& range : ranges) {
+        rootEntries = max(rootEntries, static_cast<size_t>(divideAndRoundUp(range.end.value, static_cast<uint64_t>(leafSpan))));
+    }
+    assert(rootEntries * MetadataRadix::leafEntries <= mm::PageAllocator::bigPagesInMaxMemory,
+           "createMetadataRadix: range ends beyond the largest supported physical address");
+
+    MetadataRadix radix;
+    radix.root = alloc.allocate<BigPageMetadata**>([](BigPageMetadata**& slot) { slot = nullptr; }, rootEntries);
+    radix.rootEntries = rootEntries;
+
+    // A leaf per leafSpan window touched by any range. Measuring cannot see which windows are
+    // already backed, so it charges windows shared between ranges once per range.
+    for (const auto& range : ranges) {
+        const size_t first = static_cast<size_t>(range.start.value / leafSpan);
+        const size_t last = static_cast<size_t>(divideAndRoundUp(range.end.value, static_cast<uint64_t>(leafSpan)));
+        for (size_t rootIndex = first; rootIndex < last; rootIndex++) {
+            if (!alloc.isFake() && radix.root[rootIndex] != nullptr) continue;
+            BigPageMetadata** leaf = alloc.allocate<BigPageMetadata*>([](BigPageMetadata*& slot) { slot = nullptr; },
+                                                                      MetadataRadix::leafEntries);
+            if (!alloc.isFake()) radix.root[rootIndex] = leaf;
+        }
+    }
+
+    if (alloc.isFake()) return {};
+    return radix;
+}
+
+void MetadataRadix::insert(NUMAPool& pool) {
+    for (size_t i = 0; i < pool.getSubrangeCount(); i++) {
+        const SubrangeInfo& sr = pool.getSubranges()[i];
+        const size_t firstBigPage = static_cast<size_t>(sr.rangeStart.value / arch::bigPageSize);
+        const size_t bigPageCount = static_cast<size_t>((sr.rangeEnd.value - sr.rangeStart.value) / arch::bigPageSize);
+        for (size_t j = 0; j < bigPageCount; j++) {
+            const size_t bigPageNumber = firstBigPage + j;
+            assert(bigPageNumber / leafEntries < rootEntries && root[bigPageNumber / leafEntries] != nullptr,
+                   "MetadataRadix::insert: pool memory outside the ranges the radix was built for");
+            root[bigPageNumber / leafEntries][bigPageNumber % leafEntries] = &sr.metadataBase[j];
+        }
+    }
+}
+
 // ==================== PageAllocatorImpl ====================
 
 BigPageMetadata* PageAllocatorImpl::findMetadata(mm::phys_addr addr) {
-    // Binary search the domain table for the subrange containing addr.
+    if (metadataRadix.valid()) {
+        return metadataRadix.lookup(addr);
+    }
+    // No radix: binary search the domain table for the subrange containing addr.
     size_t lo = 0, hi = domainTableSize;
     while (lo < hi) {
         size_t mid = lo + (hi - lo) / 2;
@@ -631,6 +1273,15 @@ BigPageMetadata* PageAllocatorImpl::findMetadata(mm::phys_addr addr) {
     return nullptr;
 }
 
+mm::PageFrame* PageAllocatorImpl::frameFor(mm::phys_addr addr) {
+    const BigPageMetadata* meta = findMetadata(addr);
+    if (meta == nullptr) {
+        return nullptr;
+    }
+    // The page was handed out, so its metadata is built and ownerPool is valid.
+    return meta->getOwnerPool().frameFor(meta, addr);
+}
+
 // Static storage for the domain lookup table. Built once at boot.
 static NUMADomainEntry gDomainTable[512];
 static NUMAPool*       gNumaPoolStorage[arch::MAX_PROCESSOR_COUNT];
@@ -638,7 +1289,8 @@ static NUMAPool*       gNumaPoolStorage[arch::MAX_PROCESSOR_COUNT];
 PageAllocatorImpl createPageAllocator(Vector<NUMAPool*>&& numaPools, LocalPool** localPools,
                                        size_t processorCount,
                                        NUMAPool* unownedPool,
-                                       const kernel::numa::NUMAPolicy* numaPolicy) {
+                                       const kernel::numa::NUMAPolicy* numaPolicy,
+                                       MetadataRadix metadataRadix) {
     // Copy pool pointers into stable static storage.
     // numDomains == maxDomainID + 1; slots for empty domains hold nullptr.
     const size_t numDomains = numaPools.size();
@@ -670,6 +1322,18 @@ PageAllocatorImpl createPageAllocator(Vector<NUMAPool*>&& numaPools, LocalPool**
 
     PageAllocatorImpl impl{gNumaPoolStorage, numDomains, localPools, gDomainTable, tableSize, unownedPool, numaPolicy, {}};
 
+    // Register the same pools the domain table lists; the unowned pool stays out of both.
+    if (metadataRadix.valid()) {
+        for (size_t pi = 0; pi < numDomains; pi++) {
+            NUMAPool* pool = gNumaPoolStorage[pi];
+            if (pool == nullptr) continue;
+            metadataRadix.insert(*pool);
+            pool->setMetadataRadix(metadataRadix);
+        }
+        impl.metadataRadix = metadataRadix;
+    }
+    impl.processorCount = processorCount;
+
     // Precompute cpuNearestPool: for each CPU, record the nearest non-null pool.
     if (numaPolicy != nullptr) {
         // Walk the policy's domain fallback order for each CPU.
@@ -718,14 +1382,43 @@ void PageAllocatorImpl::reserveRange(mm::phys_memory_range range) {
 }
 
 size_t PageAllocatorImpl::allocatePages(size_t smallPageCount, PageAllocationCallback cb, kernel::numa::DomainID targetDomain, AllocFlags flags) {
+    // The reserve is per CPU, so the target domain does not apply.
+    if (flags.has(AllocBehavior::ATOMIC_RESERVE)) {
+        return allocateFromReserve(smallPageCount, cb, flags);
+    }
+    AllocationScope scope(*this);
+    serviceReserveAndWatermarks();
+    if (flags.has(AllocBehavior::GIGANTIC_PAGE_ONLY)) {
+        return allocateGigantic(smallPageCount, cb, targetDomain, flags);
+    }
+    if (flags.has(AllocBehavior::ZEROED)) {
+        NUMAPool& preferred = (targetDomain.value < numDomains && numaPools[targetDomain.value] != nullptr)
+            ? *numaPools[targetDomain.value]
+            : nearestPool(arch::getCurrentProcessorID());
+        auto allocDirty = [&](size_t count, PageAllocationCallback dirtyCb, AllocFlags dirtyFlags) {
+            return allocatePages(count, dirtyCb, targetDomain, dirtyFlags);
+        };
+        return allocateZeroed(smallPageCount, cb, preferred, allocDirty, flags);
+    }
+    if (flags.has(AllocBehavior::INTERLEAVE) && numaPolicy != nullptr && !flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY)) {
+        return allocateInterleaved(smallPageCount, cb, targetDomain, flags);
+    }
     size_t allocatedPages = 0;
+    // Pages from any other pool, the unowned one included, count as remote.
+    const NUMAPool* targetPool = targetDomain.value < numDomains ? numaPools[targetDomain.value] : nullptr;
+    PageColoring* coloring = flags.has(AllocBehavior::COLORED) && pageColors > 1
+        ? &localPools[arch::getCurrentProcessorID()]->pageColoring()
+        : nullptr;
 
     const auto allocFromPool = [&](NUMAPool& pool) {
         if (smallPageCount == 0) return;
         BigPageMetadata* extras = nullptr;
-        const auto allocCount = pool.allocatePages(smallPageCount, cb, extras, flags);
+        const auto allocCount = pool.allocatePages(smallPageCount, cb, extras, flags, coloring);
         smallPageCount -= min(allocCount, smallPageCount);
         allocatedPages += allocCount;
+        if (&pool != targetPool) {
+            localPools[arch::getCurrentProcessorID()]->countEvent(AllocEvent::RemoteDomainPages, allocCount);
+        }
         // extras has its allocHolder already released by NUMAPool; returnPage flushes
         // allocBitmap → freeBitmap and routes it back to paPages or freeBigPages.
         if (extras != nullptr) {
@@ -754,6 +1447,18 @@ size_t PageAllocatorImpl::allocatePages(size_t smallPageCount, PageAllocationCal
         allocFromPool(*unownedPool);
     }
 
+    // Early in boot most memory may not have its metadata built yet. Build it one chunk at a
+    // time, target pool first, rather than failing.
+    const bool localOnly = flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY) && numaPolicy != nullptr;
+    if (!localOnly || targetPool != nullptr) {
+        NUMAPool& preferred = targetPool != nullptr ? *numaPools[targetDomain.value] : nearestPool(arch::getCurrentProcessorID());
+        while (smallPageCount != 0) {
+            NUMAPool* grown = initializeDeferredChunk(preferred, localOnly);
+            if (grown == nullptr) break;
+            allocFromPool(*grown);
+        }
+    }
+
     if (!flags.has(AllocBehavior::GRACEFUL_OOM) && smallPageCount != 0) {
         assertNotReached("Panic!!! Page allocator is out of memory");
     }
@@ -768,41 +1473,435 @@ size_t PageAllocatorImpl::allocatePages(size_t smallPageCount, PageAllocationCal
     return allocatePages(smallPageCount, cb, targetDomain, flags);
 }
 
-size_t PageAllocatorImpl::allocateFast(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags) {
+size_t PageAllocatorImpl::allocateFast(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags, PageColoring* coloring) {
     if (!flags.has(AllocBehavior::BIG_PAGE_ONLY) && smallPageCount < mm::PageAllocator::smallPagesPerBigPage) {
         const auto pid = arch::getCurrentProcessorID();
         auto& localPool = *localPools[pid];
-        return localPool.allocatePages(smallPageCount, cb, flags | AllocBehavior::LOCAL_DOMAIN_ONLY);
+        return localPool.allocatePages(smallPageCount, cb, flags | AllocBehavior::LOCAL_DOMAIN_ONLY, coloring);
     }
     return 0;
 }
 
 size_t PageAllocatorImpl::allocatePages(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags) {
+    // Checked before anything else touches per-CPU state, since this may run in an interrupt.
+    if (flags.has(AllocBehavior::ATOMIC_RESERVE)) {
+        return allocateFromReserve(smallPageCount, cb, flags);
+    }
+    AllocationScope scope(*this);
+    if (flags.has(AllocBehavior::GIGANTIC_PAGE_ONLY)) {
+        return allocateGigantic(smallPageCount, cb, nearestPool(arch::getCurrentProcessorID()).domain(), flags);
+    }
+    if (flags.has(AllocBehavior::ZEROED)) {
+        auto allocDirty = [&](size_t count, PageAllocationCallback dirtyCb, AllocFlags dirtyFlags) {
+            return allocatePages(count, dirtyCb, dirtyFlags);
+        };
+        return allocateZeroed(smallPageCount, cb, nearestPool(arch::getCurrentProcessorID()), allocDirty, flags);
+    }
+    if (flags.has(AllocBehavior::INTERLEAVE) && numaPolicy != nullptr && !flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY)) {
+        return allocateInterleaved(smallPageCount, cb, numaPolicy->homeDomain(arch::getCurrentProcessorID()), flags);
+    }
+    // Ahead of the magazine and big-page cache, whose pages are of whatever color they happen to be.
+    if (flags.has(AllocBehavior::COLORED) && pageColors > 1 && !flags.has(AllocBehavior::BIG_PAGE_ONLY)) {
+        return allocateColored(smallPageCount, cb, localPools[arch::getCurrentProcessorID()]->pageColoring(), flags);
+    }
+    // Magazine pages come from short-lived partial pages, so LONG_LIVED requests skip it, and
+    // requests that pin a domain go to the pools that enforce it.
+    if (magazinesEnabled && smallPageCount == 1 && !flags.has(AllocBehavior::BIG_PAGE_ONLY)
+        && !flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY) && lifetimeFor(flags) == PageLifetime::Short) {
+        return allocateFromMagazine(cb, flags);
+    }
+    if (bigPageCachesEnabled && flags.has(AllocBehavior::BIG_PAGE_ONLY)
+        && smallPageCount <= LocalPool::bigPageCacheBatch * mm::PageAllocator::smallPagesPerBigPage) {
+        return allocateFromBigPageCache(smallPageCount, cb, flags);
+    }
     const auto fastAllocs = allocateFast(smallPageCount, cb, flags);
     if (fastAllocs != smallPageCount) {
         return fastAllocs + allocateFallback(smallPageCount - fastAllocs, cb, flags);
     }
+    localPools[arch::getCurrentProcessorID()]->countEvent(AllocEvent::FastPathHit);
+    return fastAllocs;
+}
+
+size_t PageAllocatorImpl::allocateColored(size_t smallPageCount, PageAllocationCallback cb, PageColoring& coloring, AllocFlags flags) {
+    const auto fastAllocs = allocateFast(smallPageCount, cb, flags, &coloring);
+    if (fastAllocs != smallPageCount) {
+        return fastAllocs + allocateFallback(smallPageCount - fastAllocs, cb, flags, &coloring);
+    }
+    localPools[arch::getCurrentProcessorID()]->countEvent(AllocEvent::FastPathHit);
     return fastAllocs;
 }
 
-size_t PageAllocatorImpl::allocateFallback(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags) {
+size_t PageAllocatorImpl::allocateColoredPages(size_t smallPageCount, PageAllocationCallback cb,
+                                               mm::PageAllocator::PageColorCursor& cursor, AllocFlags flags) {
+    constexpr AllocFlags uncolored = AllocFlags(AllocBehavior::BIG_PAGE_ONLY) | AllocBehavior::GIGANTIC_PAGE_ONLY
+        | AllocBehavior::ZEROED | AllocBehavior::INTERLEAVE | AllocBehavior::ATOMIC_RESERVE;
+    if (pageColors <= 1 || (flags & uncolored)) {
+        return allocatePages(smallPageCount, cb, flags);
+    }
+    AllocationScope scope(*this);
+    PageColoring coloring{pageColors, cursor.next.load(RELAXED) & (pageColors - 1)};
+    const size_t allocated = allocateColored(smallPageCount, cb, coloring, flags | AllocBehavior::COLORED);
+    cursor.next.store(coloring.next, RELAXED);
+    return allocated;
+}
+
+void PageAllocatorImpl::setPageColors(const size_t colors) {
+    assert(colors > 0 && colors <= mm::PageAllocator::smallPagesPerBigPage && (colors & (colors - 1)) == 0,
+           "Page color count must be a power of two no larger than a big page");
+    pageColors = colors;
+    for (size_t cpu = 0; cpu < processorCount; cpu++) {
+        localPools[cpu]->pageColoring() = {colors, cpu * colors / processorCount};
+    }
+}
+
+size_t PageAllocatorImpl::allocateFromReserve(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags) {
+    assert(!flags.has(AllocBehavior::BIG_PAGE_ONLY) && !flags.has(AllocBehavior::GIGANTIC_PAGE_ONLY)
+           && !flags.has(AllocBehavior::ZEROED), "ATOMIC_RESERVE only serves plain small pages");
+    auto& localPool = *localPools[arch::getCurrentProcessorID()];
+    size_t allocatedPages = 0;
+    PageRef page;
+    while (allocatedPages < smallPageCount && localPool.popReserve(page)) {
+        cb(page);
+        allocatedPages++;
+    }
+    localPool.countEvent(AllocEvent::ReservePages, allocatedPages);
+    if (allocatedPages < smallPageCount) {
+        localPool.countEvent(AllocEvent::ReserveShortfall);
+    }
+    return allocatedPages;
+}
+
+void PageAllocatorImpl::serviceReserveAndWatermarks() {
+    const auto pid = arch::getCurrentProcessorID();
+    if (reservesEnabled && localPools[pid]->reserveLow()) {
+        (void)refillReserve(pid);
+    }
+    runLowWatermarkCallbacks();
+}
+
+size_t PageAllocatorImpl::refillReserve(const arch::ProcessorID cpu) {
+    assert(cpu == arch::getCurrentProcessorID(), "Reserve refilled from another CPU");
+    auto& localPool = *localPools[cpu];
+    if (!localPool.reserveLow() || !localPool.beginReserveRefill()) {
+        return 0;
+    }
+    // Reserve pages may sit unused for a long time, so they come from long-lived big pages
+    // instead of pinning pages that short-lived churn would otherwise empty out.
+    const size_t wanted = LocalPool::reserveCapacity - localPool.reserveSize();
+    const size_t added = allocatePages(wanted, [&](PageRef page) { localPool.pushReserve(page); },
+                                       AllocBehavior::LONG_LIVED | AllocBehavior::GRACEFUL_OOM);
+    localPool.endReserveRefill();
+    return added;
+}
+
+void PageAllocatorImpl::flushReserve(const arch::ProcessorID cpu) {
+    auto& localPool = *localPools[cpu];
+    PageRef spill[LocalPool::reserveCapacity];
+    size_t spilled = 0;
+    while (localPool.popReserve(spill[spilled])) {
+        spilled++;
+    }
+    if (spilled > 0) {
+        freePages(spill, spilled);
+    }
+}
+
+bool PageAllocatorImpl::addLowWatermarkCallback(const mm::PageAllocator::LowWatermarkCallback callback) {
+    bool added = true;
+    for (size_t i = 0; i < numDomains; i++) {
+        if (numaPools[i] != nullptr) added &= numaPools[i]->addLowWatermarkCallback(callback);
+    }
+    if (unownedPool != nullptr) added &= unownedPool->addLowWatermarkCallback(callback);
+    return added;
+}
+
+void PageAllocatorImpl::runLowWatermarkCallbacks() {
+    for (size_t i = 0; i < numDomains; i++) {
+        if (numaPools[i] != nullptr) (void)numaPools[i]->runLowWatermarkCallbacks();
+    }
+    if (unownedPool != nullptr) (void)unownedPool->runLowWatermarkCallbacks();
+}
+
+size_t PageAllocatorImpl::allocateFromMagazine(PageAllocationCallback cb, AllocFlags flags) {
+    const auto pid = arch::getCurrentProcessorID();
+    auto& localPool = *localPools[pid];
+    if (!localPool.magazineEmpty()) {
+        localPool.countEvent(AllocEvent::FastPathHit);
+    } else {
+        localPool.countEvent(AllocEvent::MagazineRefill);
+        // The magazine holds single pages, so the refill never asks for runs. It only draws on
+        // this CPU's partial pages and the nearest pool, so the magazine never caches remote
+        // memory; anything further away is left to the regular path below.
+        const AllocFlags refillFlags = (flags & ~AllocFlags(AllocBehavior::PAGE_RUNS)) | AllocBehavior::LOCAL_DOMAIN_ONLY;
+        auto refill = [&](PageRef page) { localPool.pushMagazine(page); };
+        const auto fastAllocs = allocateFast(LocalPool::magazineBatch, refill, refillFlags);
+        if (fastAllocs < LocalPool::magazineBatch) {
+            BigPageMetadata* extras = nullptr;
+            (void)nearestPool(pid).allocatePages(LocalPool::magazineBatch - fastAllocs, refill, extras, refillFlags);
+            if (extras != nullptr) {
+                localPool.tryGivePAPage(*extras);
+            }
+        }
+        // Nothing left anywhere: let the regular path decide whether this is a panic.
+        if (localPool.magazineEmpty()) {
+            return allocateFallback(1, cb, flags);
+        }
+    }
+    cb(localPool.popMagazine());
+    return 1;
+}
+
+size_t PageAllocatorImpl::allocateInterleaved(size_t smallPageCount, PageAllocationCallback cb,
+                                              kernel::numa::DomainID initiator, AllocFlags flags) {
+    constexpr auto smallPagesPerBigPage = mm::PageAllocator::smallPagesPerBigPage;
+    const auto weights = numaPolicy->interleaveWeights(initiator);
+    const size_t domains = min(numDomains, weights.size());
+    uint64_t totalWeight = 0;
+    for (size_t d = 0; d < domains; d++) {
+        if (numaPools[d] != nullptr) totalWeight += weights[d];
+    }
+
+    auto& localPool = *localPools[arch::getCurrentProcessorID()];
+    const NUMAPool* homePool = initiator.value < numDomains ? numaPools[initiator.value] : nullptr;
+    const AllocFlags stripeFlags = (flags & ~AllocFlags(AllocBehavior::INTERLEAVE)) | AllocBehavior::GRACEFUL_OOM;
+    size_t allocatedPages = 0;
+    if (totalWeight > 0) {
+        // Stripe boundaries fall on cumulative weight, rounded down to whole big pages so every
+        // stripe but the last can be served as big pages. Starting at a rotating domain keeps
+        // requests too small to span every domain from always landing on the same one.
+        const size_t start = localPool.nextInterleaveStart(domains);
+        uint64_t cumulativeWeight = 0;
+        size_t stripeStart = 0;
+        for (size_t k = 0; k < domains; k++) {
+            const size_t d = (start + k) % domains;
+            NUMAPool* pool = numaPools[d];
+            if (pool == nullptr || weights[d] == 0) continue;
+            cumulativeWeight += weights[d];
+            const size_t stripeEnd = cumulativeWeight == totalWeight
+                ? smallPageCount
+                : roundDownToNearestMultiple(smallPageCount * cumulativeWeight / totalWeight, smallPagesPerBigPage);
+            if (stripeEnd <= stripeStart) continue;
+            BigPageMetadata* extras = nullptr;
+            const size_t allocCount = pool->allocatePages(stripeEnd - stripeStart, cb, extras, stripeFlags);
+            allocatedPages += allocCount;
+            if (pool != homePool) {
+                localPool.countEvent(AllocEvent::RemoteDomainPages, allocCount);
+            }
+            if (extras != nullptr) {
+                extras->returnPage();
+            }
+            stripeStart = stripeEnd;
+        }
+    }
+
+    // Whatever a full domain could not take comes from the usual order, which also panics on OOM.
+    if (allocatedPages < smallPageCount) {
+        allocatedPages += allocatePages(smallPageCount - allocatedPages, cb, initiator,
+                                        flags & ~AllocFlags(AllocBehavior::INTERLEAVE));
+    }
+    return allocatedPages;
+}
+
+size_t PageAllocatorImpl::allocateGigantic(size_t smallPageCount, PageAllocationCallback cb,
+                                           kernel::numa::DomainID targetDomain, AllocFlags flags) {
+    const size_t wanted = divideAndRoundUp(smallPageCount, mm::PageAllocator::smallPagesPerGiganticPage);
+    const bool zeroed = flags.has(AllocBehavior::ZEROED);
+    assert(!zeroed || pageZeroer != nullptr, "ZEROED allocation requires a registered page zeroer");
+    // No list keeps gigantic pages pre-zeroed; clear each one as it is handed out.
+    auto deliver = [&](PageRef page) {
+        if (zeroed) {
+            pageZeroer(page.addr(), arch::giganticPageSize);
+        }
+        cb(page);
+    };
+
+    size_t delivered = 0;
+    const NUMAPool* targetPool = targetDomain.value < numDomains ? numaPools[targetDomain.value] : nullptr;
+    const auto allocFromPool = [&](NUMAPool* pool) {
+        if (pool != nullptr && delivered < wanted) {
+            const size_t got = pool->allocateGiganticPages(wanted - delivered, deliver);
+            delivered += got;
+            if (pool != targetPool) {
+                localPools[arch::getCurrentProcessorID()]->countEvent(AllocEvent::RemoteDomainPages,
+                                                                      got * mm::PageAllocator::smallPagesPerGiganticPage);
+            }
+        }
+    };
+    if (numaPolicy != nullptr) {
+        if (flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY)) {
+            if (targetDomain.value < numDomains) {
+                allocFromPool(numaPools[targetDomain.value]);
+            }
+        } else {
+            for (const auto domain : numaPolicy->domainOrder(targetDomain)) {
+                if (domain.value < numDomains) {
+                    allocFromPool(numaPools[domain.value]);
+                }
+            }
+        }
+    } else {
+        allocFromPool(&nearestPool(arch::getCurrentProcessorID()));
+    }
+    allocFromPool(unownedPool);
+
+    // Memory whose metadata has not been built yet may still hold whole groups.
+    NUMAPool& preferred = targetPool != nullptr ? *numaPools[targetDomain.value] : nearestPool(arch::getCurrentProcessorID());
+    while (delivered < wanted) {
+        NUMAPool* grown = initializeDeferredChunk(preferred, flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY));
+        if (grown == nullptr) break;
+        allocFromPool(grown);
+    }
+
+    if (!flags.has(AllocBehavior::GRACEFUL_OOM) && delivered < wanted) {
+        assertNotReached("Panic!!! Page allocator is out of gigantic pages");
+    }
+    return delivered * mm::PageAllocator::smallPagesPerGiganticPage;
+}
+
+size_t PageAllocatorImpl::allocateFromBigPageCache(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags) {
+    const auto pid = arch::getCurrentProcessorID();
+    auto& localPool = *localPools[pid];
+    const size_t bigPages = divideAndRoundUp(smallPageCount, mm::PageAllocator::smallPagesPerBigPage);
+    const bool refilled = localPool.bigPageCacheSize() < bigPages;
+    if (refilled) {
+        localPool.countEvent(AllocEvent::BigPageCacheRefill);
+        BigPageMetadata* refill[LocalPool::bigPageCacheBatch];
+        const size_t taken = nearestPool(pid).takeBigPagesForCache(refill, LocalPool::bigPageCacheBatch, pid);
+        for (size_t i = 0; i < taken; i++) {
+            localPool.pushBigPageCache(*refill[i]);
+        }
+    }
+
+    size_t allocatedPages = 0;
+    while (allocatedPages < smallPageCount && !localPool.bigPageCacheEmpty()) {
+        BigPageMetadata* page = localPool.popBigPageCache();
+        // Fill the page before dropping our hold so it never looks free and unclaimed.
+        page->allocAll();
+        page->releaseAllocHolder();
+        cb(PageRef::big(page->baseAddr()));
+        allocatedPages += mm::PageAllocator::smallPagesPerBigPage;
+    }
+    // The home pool ran dry: let the regular path search further and decide on OOM.
+    if (allocatedPages < smallPageCount) {
+        allocatedPages += allocateFallback(smallPageCount - allocatedPages, cb, flags);
+    } else if (!refilled) {
+        localPool.countEvent(AllocEvent::FastPathHit);
+    }
+    return allocatedPages;
+}
+
+size_t PageAllocatorImpl::allocateZeroed(size_t smallPageCount, PageAllocationCallback cb, NUMAPool& preferred,
+                                         FunctionRef<size_t(size_t, PageAllocationCallback, AllocFlags)> allocDirty,
+                                         AllocFlags flags) {
+    constexpr auto smallPagesPerBigPage = mm::PageAllocator::smallPagesPerBigPage;
+    const bool bigOnly = flags.has(AllocBehavior::BIG_PAGE_ONLY);
+    size_t allocatedPages = preferred.allocateZeroedPages(smallPageCount, cb, bigOnly);
+
+    // Cover the rest from the regular paths in batches. Pages are zeroed only once the
+    // allocator has returned, so the zeroer is free to allocate memory of its own.
+    const AllocFlags dirtyFlags = (flags & ~AllocFlags(AllocBehavior::ZEROED)) | AllocBehavior::GRACEFUL_OOM;
+    PageRef batch[PA_ZEROED_BATCH];
+    size_t batchSize = 0;
+    auto collect = [&](PageRef page) { batch[batchSize++] = page; };
+    while (allocatedPages < smallPageCount) {
+        assert(pageZeroer != nullptr, "ZEROED allocation requires a registered page zeroer");
+        const size_t remaining = smallPageCount - allocatedPages;
+        batchSize = 0;
+        size_t got = 0;
+        // Whole big pages are preferred as usual; each batch holds at most PA_ZEROED_BATCH refs.
+        if (bigOnly || remaining >= smallPagesPerBigPage) {
+            const size_t bigRequest = bigOnly ? remaining : roundDownToNearestMultiple(remaining, smallPagesPerBigPage);
+            got = allocDirty(min(bigRequest, PA_ZEROED_BATCH * smallPagesPerBigPage), collect,
+                             dirtyFlags | AllocBehavior::BIG_PAGE_ONLY);
+        }
+        if (got == 0 && !bigOnly) {
+            got = allocDirty(min(remaining, PA_ZEROED_BATCH), collect, dirtyFlags);
+        }
+        if (got == 0) {
+            break;
+        }
+        for (size_t i = 0; i < batchSize; i++) {
+            const size_t bytes = (batch[i].size() == mm::PageSize::BIG ? arch::bigPageSize : arch::smallPageSize)
+                * batch[i].runLength();
+            pageZeroer(batch[i].addr(), bytes);
+            cb(batch[i]);
+        }
+        allocatedPages += got;
+    }
+
+    if (!flags.has(AllocBehavior::GRACEFUL_OOM) && allocatedPages < smallPageCount) {
+        assertNotReached("Panic!!! Page allocator is out of memory");
+    }
+    return allocatedPages;
+}
+
+NUMAPool* PageAllocatorImpl::initializeDeferredChunk(NUMAPool& preferred, const bool preferredOnly) {
+    if (preferred.initializeDeferredChunk()) {
+        return &preferred;
+    }
+    if (preferredOnly) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < numDomains; i++) {
+        if (numaPools[i] != nullptr && numaPools[i]->initializeDeferredChunk()) {
+            return numaPools[i];
+        }
+    }
+    if (unownedPool != nullptr && unownedPool->initializeDeferredChunk()) {
+        return unownedPool;
+    }
+    return nullptr;
+}
+
+void PageAllocatorImpl::initializeDeferredPages(const arch::ProcessorID cpu) {
+    // Once its own domain is done, a CPU moves on to help with the others, so domains
+    // without CPUs of their own get built too.
+    while (initializeDeferredChunk(nearestPool(cpu)) != nullptr) {}
+}
+
+size_t PageAllocatorImpl::zeroFreePages(const size_t maxBigPages) {
+    if (pageZeroer == nullptr) {
+        return 0;
+    }
+    size_t zeroed = 0;
+    const auto refill = [&](NUMAPool* pool) {
+        if (pool != nullptr && zeroed < maxBigPages) {
+            zeroed += pool->refillZeroedPages(pageZeroer, maxBigPages - zeroed);
+        }
+    };
+    // Stock the pool this CPU allocates from first; the others are visited so that
+    // domains without CPUs of their own still get pre-zeroed pages.
+    refill(&nearestPool(arch::getCurrentProcessorID()));
+    for (size_t i = 0; i < numDomains; i++) {
+        refill(numaPools[i]);
+    }
+    refill(unownedPool);
+    return zeroed;
+}
+
+size_t PageAllocatorImpl::allocateFallback(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags, PageColoring* coloring) {
     size_t allocatedPages = 0;
     const auto pid = arch::getCurrentProcessorID();
     auto& localPool = *localPools[pid];
+    localPool.countEvent(AllocEvent::Fallback);
+    serviceReserveAndWatermarks();
 
     const auto allocFromLocalPool = [&](const size_t count, const AllocFlags f) {
-        const auto allocCount = localPool.allocatePages(count, cb, f);
+        const auto allocCount = localPool.allocatePages(count, cb, f, coloring);
         smallPageCount -= allocCount;
         allocatedPages += allocCount;
     };
 
     const auto allocFromNumaPool = [&](const size_t count, NUMAPool& pool, const AllocFlags f) {
         BigPageMetadata* extras = nullptr;
-        const auto allocCount = pool.allocatePages(count, cb, extras, f);
+        const auto allocCount = pool.allocatePages(count, cb, extras, f, coloring);
         //Make sure we don't underflow if we're allocating big pages only and the requested page count is not divisible
         //by smallPagesPerBigPage
         smallPageCount -= min(allocCount, smallPageCount);
         allocatedPages += allocCount;
+        if (&pool != &nearestPool(pid)) {
+            localPool.countEvent(AllocEvent::RemoteDomainPages, allocCount);
+        }
         if (extras != nullptr) {
             localPool.tryGivePAPage(*extras);
         }
@@ -852,6 +1951,14 @@ size_t PageAllocatorImpl::allocateFallback(size_t smallPageCount, PageAllocation
         allocFromNumaPool(smallPageCount, *unownedPool, flags);
     }
 
+    //Early in boot, most memory may not have its metadata built yet. Build it one chunk at a time
+    //rather than failing, nearest pool first
+    while (smallPageCount != 0) {
+        NUMAPool* grown = initializeDeferredChunk(nearestPool(pid), flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY));
+        if (grown == nullptr) break;
+        allocFromNumaPool(smallPageCount, *grown, flags);
+    }
+
     if (!flags.has(AllocBehavior::GRACEFUL_OOM)) {
         if (smallPageCount != 0) {
             assertNotReached("Panic!!! Page allocator is out of memory");
@@ -861,10 +1968,13 @@ size_t PageAllocatorImpl::allocateFallback(size_t smallPageCount, PageAllocation
     return allocatedPages;
 }
 
-size_t LocalPool::allocatePages(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags) {
+size_t LocalPool::allocatePages(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags, PageColoring* pageColoring) {
     if (flags.has(AllocBehavior::BIG_PAGE_ONLY)) {
         return 0;
     }
+    if (lifetimeFor(flags) == PageLifetime::Long) {
+        return allocateLongLived(smallPageCount, cb, flags, pageColoring);
+    }
     size_t allocatedPages = 0;
     const auto allocFromPAPage = [&](BigPageMetadata& metadata) {
         if (metadata.isEmpty()) {
@@ -879,7 +1989,7 @@ size_t LocalPool::allocatePages(size_t smallPageCount, PageAllocationCallback cb
             }
         }
         OccupancyTransition transition{};
-        const auto allocd = metadata.allocatePages(smallPageCount, cb, transition);
+        const auto allocd = metadata.allocatePages(smallPageCount, cb, transition, flags.has(AllocBehavior::PAGE_RUNS), pageColoring);
         smallPageCount -= allocd;
         allocatedPages += allocd;
         if (transition.becameFull()) {
@@ -903,6 +2013,118 @@ size_t LocalPool::allocatePages(size_t smallPageCount, PageAllocationCallback cb
     return allocatedPages;
 }
 
+size_t LocalPool::allocateLongLived(size_t smallPageCount, PageAllocationCallback cb, AllocFlags flags, PageColoring* pageColoring) {
+    if (longLivedPage == nullptr) {
+        return 0;
+    }
+    // No hysteresis here: an empty long-lived page goes straight back so it can be reused whole.
+    if (longLivedPage->isEmpty()) {
+        longLivedPage->returnPage();
+        longLivedPage = nullptr;
+        return 0;
+    }
+    OccupancyTransition transition{};
+    const auto allocd = longLivedPage->allocatePages(smallPageCount, cb, transition, flags.has(AllocBehavior::PAGE_RUNS), pageColoring);
+    if (transition.becameFull()) {
+        longLivedPage->returnPage(true);
+        longLivedPage = nullptr;
+    }
+    return allocd;
+}
+
+Optional<mm::phys_addr> LocalPool::allocateContiguous(size_t smallPageCount, size_t alignPages, kernel::numa::DomainID domain) {
+    const auto allocFromPAPage = [&](BigPageMetadata& metadata, bool& exhausted) -> Optional<mm::phys_addr> {
+        if (metadata.getOwnerPool().domain() != domain) return {};
+        OccupancyTransition transition{};
+        auto result = metadata.allocateRun(smallPageCount, alignPages, transition);
+        if (transition.becameFull()) {
+            metadata.returnPage(true);
+            exhausted = true;
+        }
+        return result;
+    };
+
+    // Offer the run to both pages before dropping whichever one it filled.
+    bool exhausted1 = false;
+    bool exhausted2 = false;
+    Optional<mm::phys_addr> result;
+    if (paPage1) {
+        result = allocFromPAPage(*paPage1, exhausted1);
+    }
+    if (!result.occupied() && paPage2) {
+        result = allocFromPAPage(*paPage2, exhausted2);
+    }
+    if (exhausted2) {
+        paPage2 = nullptr;
+    }
+    if (exhausted1) {
+        paPage1 = paPage2;
+        paPage2 = nullptr;
+    }
+    return result;
+}
+
+size_t LocalPool::drainBigPageCache(BigPageMetadata** out, size_t count) {
+    const size_t drained = min(count, bigPageCacheCount);
+    for (size_t i = 0; i < drained; i++) out[i] = bigPageCache[i];
+    for (size_t i = drained; i < bigPageCacheCount; i++) bigPageCache[i - drained] = bigPageCache[i];
+    bigPageCacheCount -= drained;
+    return drained;
+}
+
+mm::AllocationCounters LocalPool::readCounters() const {
+    return {
+        getEventCount(AllocEvent::FastPathHit),
+        getEventCount(AllocEvent::Fallback),
+        getEventCount(AllocEvent::MagazineRefill),
+        getEventCount(AllocEvent::BigPageCacheRefill),
+        getEventCount(AllocEvent::RemoteDomainPages),
+        getEventCount(AllocEvent::RemoteFreesPosted),
+        getEventCount(AllocEvent::ReservePages),
+        getEventCount(AllocEvent::ReserveShortfall),
+    };
+}
+
+bool LocalPool::popReserve(PageRef& out) {
+    size_t count = reserveCount.load(ACQUIRE);
+    do {
+        if (count == 0) {
+            return false;
+        }
+        out = reserve[count - 1];
+    } while (!reserveCount.compare_exchange(count, count - 1, ACQ_REL, ACQUIRE));
+    return true;
+}
+
+void LocalPool::pushReserve(PageRef page) {
+    assert(page.size() == kernel::mm::PageSize::SMALL && page.runLength() == 1, "Only single small pages belong in the reserve");
+    size_t count = reserveCount.load(ACQUIRE);
+    do {
+        assert(count < reserveCapacity, "Pushed to full page reserve");
+        reserve[count] = page;
+    } while (!reserveCount.compare_exchange(count, count + 1, ACQ_REL, ACQUIRE));
+}
+
+size_t LocalPool::drainMagazine(PageRef* out, size_t count) {
+    // The bottom of the stack holds the pages pushed longest ago (the coldest in cache),
+    // so those are the ones that leave.
+    const size_t drained = min(count, magazineCount);
+    for (size_t i = 0; i < drained; i++) out[i] = magazine[i];
+    for (size_t i = drained; i < magazineCount; i++) magazine[i - drained] = magazine[i];
+    magazineCount -= drained;
+    return drained;
+}
+
+size_t LocalPool::takeDeferredFrees(PageRef* out, size_t count, uint64_t generation) {
+    size_t taken = 0;
+    while (taken < count && deferredFreeCount > 0 && deferredFrees[deferredFreeHead].generation <= generation) {
+        out[taken++] = deferredFrees[deferredFreeHead].page;
+        deferredFreeHead = (deferredFreeHead + 1) % deferredFreeCapacity;
+        deferredFreeCount--;
+    }
+    return taken;
+}
+
 void LocalPool::tryGivePAPage(BigPageMetadata& page) {
     // Never hold new empty pages — they have nothing to give and would only occupy a slot.
     if (page.isEmpty()) {
@@ -910,6 +2132,17 @@ void LocalPool::tryGivePAPage(BigPageMetadata& page) {
         return;
     }
 
+    // Long-lived pages have a single slot of their own; the first one offered keeps it.
+    if (page.lifetime() == PageLifetime::Long) {
+        if (longLivedPage == nullptr) {
+            page.markAllocHolder(pid);
+            longLivedPage = &page;
+        } else {
+            page.returnPage();
+        }
+        return;
+    }
+
     // Hysteresis release: if paPage1 is an empty home-pool page being held as a reservation,
     // release it now that a fresh home-pool page has arrived to replace it.
     if (paPage1 != nullptr && paPage1->isEmpty() && paPage2 == nullptr &&
@@ -987,7 +2220,7 @@ void NUMAPool::returnPage(BigPageMetadata &metadata, const bool evictedAsFull) {
         return;
     }
     if (metadata.isEmpty()) {
-        freeBigPages.write(&metadata);
+        pushFreeBigPage(metadata);
         return;
     }
     // NOTE: there is a benign TOCTOU window between the isEmpty() check above and
@@ -998,15 +2231,59 @@ void NUMAPool::returnPage(BigPageMetadata &metadata, const bool evictedAsFull) {
     // self-correct through normal allocation activity; the only consequence is that
     // BIG_PAGE_ONLY allocations cannot claim it until it is reclaimed.
     const auto index = metadataIndex(&metadata);
-    paPages.add(index);
+    partialPages(metadata.lifetime()).add(index);
+}
+
+size_t NUMAPool::takeBigPagesForCache(BigPageMetadata** out, size_t count, arch::ProcessorID pid) {
+    // Zeroed pages are left for ZEROED requests; the cache cannot tell them apart.
+    size_t taken = takeHotBigPages(out, count);
+    do {
+        const size_t before = taken;
+        taken += freeBigPages.bulkReadBestEffort(count - taken, [&](size_t index, BigPageMetadata* const& metadata) {
+            out[before + index] = metadata;
+        });
+    } while (taken < count && splitGiganticPage());
+    for (size_t i = 0; i < taken; i++) {
+        out[i]->markAllocHolder(pid);
+    }
+    checkWatermarks();
+    return taken;
+}
+
+void NUMAPool::returnCachedBigPages(BigPageMetadata* const* pages, size_t count) {
+    freeBigPages.bulkWrite(count, [&](size_t index, BigPageMetadata*& slot) {
+        assert(pages[index]->isEmpty(), "Cached big page was not empty");
+        pages[index]->releaseAllocHolder();
+        slot = pages[index];
+    });
+}
+
+size_t NUMAPool::allocateGiganticPages(size_t count, PageAllocationCallback cb) {
+    size_t allocated = freeGiganticPages.bulkReadBestEffort(count, [&](size_t, BigPageMetadata* const& first) {
+        for (size_t i = 0; i < mm::PageAllocator::bigPagesPerGiganticPage; i++) {
+            first[i].allocAll();
+        }
+        cb(PageRef::gigantic(first->baseAddr()));
+    });
+    while (allocated < count) {
+        const auto base = allocateContiguousBigPages(mm::PageAllocator::smallPagesPerGiganticPage, arch::giganticPageSize);
+        if (!base.occupied()) {
+            break;
+        }
+        cb(PageRef::gigantic(*base));
+        allocated++;
+    }
+    checkWatermarks();
+    return allocated;
 }
 
-size_t NUMAPool::allocatePages(size_t smallPageCount, const PageAllocationCallback cb, BigPageMetadata *&paPageRemaining, const AllocFlags flags) {
+size_t NUMAPool::allocatePages(size_t smallPageCount, const PageAllocationCallback cb, BigPageMetadata *&paPageRemaining, const AllocFlags flags,
+                               PageColoring* coloring) {
     //If we can only allocate from big pages, we're forced to only allocate from the freeBigPages buffer
     if (flags.has(AllocBehavior::BIG_PAGE_ONLY)) {
         //Overallocate in case smallPageCount is not divisible by smallPagesPerBigPage
         const auto numBigPages = divideAndRoundUp(smallPageCount, mm::PageAllocator::smallPagesPerBigPage);
-        const auto allocatedPages = freeBigPages.bulkReadBestEffort(numBigPages, [&](size_t, const auto& metadata) {
+        const auto allocatedPages = takeFreeBigPages(numBigPages, [&](size_t, const auto& metadata) {
             const auto pageAddr = metadata -> baseAddr();
             metadata -> allocAll();
             cb(PageRef::big(pageAddr));
@@ -1015,7 +2292,7 @@ size_t NUMAPool::allocatePages(size_t smallPageCount, const PageAllocationCallba
     }
     //First try allocating as much as we can from big pages
     const auto numBigPages = divideAndRoundDown(smallPageCount, mm::PageAllocator::smallPagesPerBigPage);
-    size_t allocatedPages = freeBigPages.bulkReadBestEffort(numBigPages, [&](size_t, const auto& metadata) {
+    size_t allocatedPages = takeFreeBigPages(numBigPages, [&](size_t, const auto& metadata) {
         const auto pageAddr = metadata -> baseAddr();
         metadata -> allocAll();
         cb(PageRef::big(pageAddr));
@@ -1024,15 +2301,17 @@ size_t NUMAPool::allocatePages(size_t smallPageCount, const PageAllocationCallba
     smallPageCount -= allocatedPages;
 
     const auto pid = arch::getCurrentProcessorID();
+    const PageLifetime lifetime = lifetimeFor(flags);
+    const bool runs = flags.has(AllocBehavior::PAGE_RUNS);
 
-    const auto allocateFromPAPages = [&](const size_t maxRetries) {
+    const auto allocateFromPAPages = [&](const PageLifetime cls, const size_t maxRetries) {
         while (smallPageCount > 0) {
-            if (size_t paIndex; paPages.getAny(pid, paIndex, maxRetries) == AtomicBitPool::GetResult::Success) {
+            if (size_t paIndex; getPAPage(cls, pid, paIndex, maxRetries) == AtomicBitPool::GetResult::Success) {
                 auto& bigPage = bigPageMetadataBuffer[paIndex];
                 bigPage.markAllocHolder(pid);
                 OccupancyTransition stateChange {};
                 while (true) {
-                    const auto allocated = bigPage.allocatePages(smallPageCount, cb, stateChange);
+                    const auto allocated = bigPage.allocatePages(smallPageCount, cb, stateChange, runs, coloring);
                     assert(allocated > 0, "A page in the PAPage bitmap should never be full");
                     smallPageCount -= allocated;
                     allocatedPages += allocated;
@@ -1053,13 +2332,15 @@ size_t NUMAPool::allocatePages(size_t smallPageCount, const PageAllocationCallba
         }
     };
 
-    allocateFromPAPages(PA_BITPOOL_RELAXED_RETRIES);
+    allocateFromPAPages(lifetime, PA_BITPOOL_RELAXED_RETRIES);
     while (smallPageCount > 0) {
         const auto requiredPages = divideAndRoundUp(smallPageCount, mm::PageAllocator::smallPagesPerBigPage);
-        const auto grabbedPages = freeBigPages.bulkReadBestEffort(requiredPages, [&](size_t index, auto& metadata) {
+        const auto grabbedPages = takeFreeBigPages(requiredPages, [&](size_t index, auto& metadata) {
             assert(metadata -> isEmpty(), "Big pages in the free pool should be FREE");
             if (index == 0) {
                 paPageRemaining = metadata;
+                paPageRemaining->setLifetime(lifetime);
+                localityHints[pid] = metadataIndex(metadata);
             }
             else {
                 const auto pageAddr = metadata -> baseAddr();
@@ -1082,7 +2363,8 @@ size_t NUMAPool::allocatePages(size_t smallPageCount, const PageAllocationCallba
             allocatedPages += (grabbedPages - 1) * mm::PageAllocator::smallPagesPerBigPage;
             smallPageCount -= (grabbedPages - 1) * mm::PageAllocator::smallPagesPerBigPage;
             paPageRemaining->markAllocHolder(pid);
-            const auto smallAllocd = paPageRemaining -> allocatePages(smallPageCount, cb);
+            OccupancyTransition stateChange {};
+            const auto smallAllocd = paPageRemaining -> allocatePages(smallPageCount, cb, stateChange, runs, coloring);
             paPageRemaining->releaseAllocHolder();
             smallPageCount -= smallAllocd;
             allocatedPages += smallAllocd;
@@ -1090,72 +2372,380 @@ size_t NUMAPool::allocatePages(size_t smallPageCount, const PageAllocationCallba
             return allocatedPages;
         }
     }
-    allocateFromPAPages(PA_BITPOOL_DETERMINED_RETRIES);
+    allocateFromPAPages(lifetime, PA_BITPOOL_DETERMINED_RETRIES);
+    // Out of whole big pages: mixing lifetimes in a big page beats failing the request.
+    const PageLifetime otherLifetime = lifetime == PageLifetime::Long ? PageLifetime::Short : PageLifetime::Long;
+    allocateFromPAPages(otherLifetime, PA_BITPOOL_DETERMINED_RETRIES);
 
     return allocatedPages;
 }
 
-void NUMAPool::freePages(PageRef *pages, size_t count) {
-    const auto freeBigPageRun = [&](BigPageMetadata* firstMetadata, PageRef *runStart, size_t runSize) {
-        freeBigPages.bulkWrite(runSize, [&](size_t index, BigPageMetadata*& entry) {
-            const auto metadataIndex = divideAndRoundDown(runStart[index].value - runStart[0].value, static_cast<uint64_t>(arch::bigPageSize));
-            assert(firstMetadata[metadataIndex].isFull(), "We should only take this path when freeing totally occupied big pages");
-            firstMetadata[metadataIndex].freeAll();
-            entry = &(firstMetadata[metadataIndex]);
-        });
-    };
-    const auto freeSmallPageRun = [&](BigPageMetadata* superpage, PageRef *runStart, size_t runSize) {
-        OccupancyTransition transition {};
-        superpage->freePages(runStart, runSize, transition);
+size_t NUMAPool::allocateZeroedPages(size_t smallPageCount, const PageAllocationCallback cb, const bool bigOnly) {
+    constexpr auto smallPagesPerBigPage = mm::PageAllocator::smallPagesPerBigPage;
+    const auto numBigPages = bigOnly ? divideAndRoundUp(smallPageCount, smallPagesPerBigPage)
+                                     : divideAndRoundDown(smallPageCount, smallPagesPerBigPage);
+    size_t allocatedPages = zeroedBigPages.bulkReadBestEffort(numBigPages, [&](size_t, BigPageMetadata* const& metadata) {
+        metadata->allocAll();
+        cb(PageRef::big(metadata->baseAddr()));
+    }) * smallPagesPerBigPage;
+    if (bigOnly || allocatedPages >= smallPageCount) {
+        return allocatedPages;
+    }
+    // Zeroed small pages are already marked allocated, so handing one out is just a read.
+    allocatedPages += zeroedSmallPages.bulkReadBestEffort(smallPageCount - allocatedPages, [&](size_t, const PageRef& page) {
+        cb(page);
+    });
+    return allocatedPages;
+}
 
-        if (transition.becameEmpty()) {
-            // If the page is cached in a LocalPool it is not in paPages, so skip the
-            // remove. The LocalPool will call returnPage() when it evicts or uses it up,
-            // which routes it correctly at that point.
-            if (superpage->hasAllocHolder()) {
-                // nothing to do
-            } else if (transition.before == OccupancyState::Partial) {
-                // The page was partial, so it may be in paPages. Attempt to remove it and
-                // move it to freeBigPages. If remove returns NotPresent, a concurrent free
-                // of the same page beat us here: that thread will have already added it to
-                // paPages (Full→Partial) but our Partial→Empty remove will see NotPresent,
-                // leaving an empty page stranded in paPages. This is a known benign race:
-                // the page remains fully allocatable for small-page requests and will find
-                // its way back to freeBigPages through normal allocation activity. The only
-                // practical consequence is that BIG_PAGE_ONLY allocations cannot see it
-                // until it is reclaimed.
-                if (paPages.remove(metadataIndex(superpage)) != AtomicBitPool::RemoveResult::NotPresent) {
-                    freeBigPages.write(superpage);
-                }
-            } else {
-                // Full→Empty: page was never in paPages, return it directly.
-                freeBigPages.write(superpage);
-            }
-        }
-        else if (transition.becameAvailable()) {
-            // Full→Partial: page newly has free subpages; publish it for small-page allocation.
-            size_t spinCount = 0;
-            while (superpage->hasAllocHolder()) {
-                tight_spin();
-                spinCount++;
-                assert(spinCount < 100000, "stuck waiting for alloc holder to release hold");
-            }
-            paPages.add(metadataIndex(superpage));
+size_t NUMAPool::refillZeroedPages(const mm::PageAllocator::PageZeroer zeroFn, const size_t maxBigPages) {
+    if (!zeroingLock.try_acquire()) {
+        return 0;
+    }
+    size_t zeroed = 0;
+    // freeBigPages is FIFO, so tryRead hands back the page that has sat unused the longest.
+    const auto zeroOldestFreePage = [&](BigPageMetadata*& page) {
+        if (zeroed == maxBigPages || !freeBigPages.tryRead(page)) {
+            return false;
         }
+        assert(page->isEmpty(), "Big pages in the free pool should be FREE");
+        zeroFn(page->baseAddr(), arch::bigPageSize);
+        zeroed++;
+        return true;
     };
 
-    // Subrange cursor: only advances forward since pages are sorted by address.
-    size_t subrangeIdx = 0;
-    size_t i = 0;
+    // Keep at least one big page's worth of small pages ready by splitting a zeroed big page.
+    // We are the only writer while holding zeroingLock, so the write below always fits.
+    if (zeroedSmallPages.availableToRead() < mm::PageAllocator::smallPagesPerBigPage) {
+        BigPageMetadata* page = nullptr;
+        if (zeroedBigPages.tryRead(page) || zeroOldestFreePage(page)) {
+            page->allocAll();
+            const auto base = page->baseAddr();
+            const bool written = zeroedSmallPages.bulkWrite(mm::PageAllocator::smallPagesPerBigPage, [&](size_t index, PageRef& slot) {
+                slot = PageRef::small(base + index * arch::smallPageSize);
+            });
+            assert(written, "Zeroed small page list overflowed");
+        }
+    }
 
-    while (i < count) {
-        if (pages[i].size() == mm::PageSize::BIG) {
-            const uint64_t addr = pages[i].addr().value;
+    while (zeroedBigPages.availableToRead() < zeroedBigPageTarget()) {
+        BigPageMetadata* page = nullptr;
+        if (!zeroOldestFreePage(page)) {
+            break;
+        }
+        zeroedBigPages.write(page);
+    }
+    zeroingLock.release();
+    return zeroed;
+}
 
-            // Advance the subrange cursor past entries that end before this big page.
-            while (subrangeIdx < subrangeCount && addr >= subrangeInfo[subrangeIdx].rangeEnd.value) {
-                subrangeIdx++;
-            }
+Optional<mm::phys_addr> NUMAPool::allocateContiguous(size_t smallPageCount, size_t alignment, BigPageMetadata*& paPageRemaining) {
+    if (smallPageCount > mm::PageAllocator::smallPagesPerBigPage || alignment > arch::bigPageSize) {
+        return allocateContiguousBigPages(smallPageCount, alignment);
+    }
+
+    const auto pid = arch::getCurrentProcessorID();
+    const size_t alignPages = alignment / arch::smallPageSize;
+    Optional<mm::phys_addr> result;
+
+    // Probe a handful of partially allocated pages first. Probed pages are held until the
+    // search is over so getAny does not keep handing back the same unsuitable page.
+    BigPageMetadata* probed[PA_CONTIGUOUS_PROBES];
+    size_t probedCount = 0;
+    while (probedCount < PA_CONTIGUOUS_PROBES) {
+        size_t paIndex;
+        if (getPAPage(PageLifetime::Short, pid, paIndex, PA_BITPOOL_RELAXED_RETRIES) != AtomicBitPool::GetResult::Success) {
+            break;
+        }
+        auto& bigPage = bigPageMetadataBuffer[paIndex];
+        bigPage.markAllocHolder(pid);
+        probed[probedCount++] = &bigPage;
+        result = bigPage.allocateRun(smallPageCount, alignPages);
+        if (result.occupied()) {
+            break;
+        }
+    }
+    // returnPage routes each probed page by its current occupancy (full pages are dropped).
+    for (size_t i = 0; i < probedCount; i++) {
+        probed[i]->returnPage();
+    }
+    if (result.occupied()) {
+        return result;
+    }
+
+    // Carve the run from the bottom of a fresh big page and hand back the rest.
+    BigPageMetadata* fresh = nullptr;
+    if (!takeFreeBigPage(fresh)) {
+        return {};
+    }
+    assert(fresh->isEmpty(), "Big pages in the free pool should be FREE");
+    fresh->markAllocHolder(pid);
+    fresh->setLifetime(PageLifetime::Short);
+    result = fresh->allocateRun(smallPageCount, alignPages);
+    assert(result.occupied(), "An empty big page must be able to satisfy any single-page run");
+    fresh->releaseAllocHolder();
+    if (!fresh->isFull()) {
+        paPageRemaining = fresh;
+    }
+    return result;
+}
+
+Optional<mm::phys_addr> NUMAPool::allocateContiguousBigPages(size_t smallPageCount, size_t alignment) {
+    const size_t runLength = divideAndRoundUp(smallPageCount, mm::PageAllocator::smallPagesPerBigPage);
+    const size_t tailPages = smallPageCount % mm::PageAllocator::smallPagesPerBigPage;
+    const uint64_t baseAlignment = max(static_cast<uint64_t>(alignment), static_cast<uint64_t>(arch::bigPageSize));
+
+    const auto isCandidate = [](const BigPageMetadata& meta) {
+        return meta.isEmpty() && !meta.hasAllocHolder() && !meta.hasReservedSubpages();
+    };
+    // Every page of a claimed run is held by us and absent from the free lists.
+    const auto finishRun = [&](BigPageMetadata* first) {
+        for (size_t k = 0; k < runLength; k++) {
+            if (k == runLength - 1 && tailPages != 0) {
+                first[k].setLifetime(PageLifetime::Short);
+                const auto tail = first[k].allocateRun(tailPages, 1);
+                assert(tail.occupied() && (*tail).value == first[k].baseAddr().value,
+                       "Tail of contiguous run must start at the bottom of its big page");
+                first[k].returnPage();
+            } else {
+                first[k].allocAll();
+                first[k].releaseAllocHolder();
+            }
+        }
+        return first->baseAddr();
+    };
+
+    LockGuard guard(contiguousLock);
+    size_t attempts = 0;
+    // Runs may only use big pages whose metadata has been built.
+    const size_t initialized = initializedBigPages.load(ACQUIRE);
+    for (size_t si = 0; si < subrangeCount; si++) {
+        const SubrangeInfo& sr = subrangeInfo[si];
+        const size_t srFirst = metadataIndex(sr.metadataBase);
+        if (srFirst >= initialized) break;
+        const size_t pagesInRange = min(static_cast<size_t>((sr.rangeEnd.value - sr.rangeStart.value) / arch::bigPageSize),
+                                        initialized - srFirst);
+
+        size_t runStart = 0;
+        size_t runSoFar = 0;
+        for (size_t i = 0; i < pagesInRange; i++) {
+            BigPageMetadata& meta = sr.metadataBase[i];
+            if (runSoFar == 0 && meta.baseAddr().value % baseAlignment != 0) continue;
+            if (!isCandidate(meta)) {
+                runSoFar = 0;
+                continue;
+            }
+            if (runSoFar++ == 0) runStart = i;
+            if (runSoFar < runLength) continue;
+
+            BigPageMetadata* first = &sr.metadataBase[runStart];
+            runSoFar = 0;
+            if (claimFreeBigPageRun(first, runLength)) {
+                return finishRun(first);
+            }
+            if (++attempts == PA_CONTIGUOUS_CLAIM_ATTEMPTS) {
+                break;
+            }
+        }
+        if (attempts == PA_CONTIGUOUS_CLAIM_ATTEMPTS) {
+            break;
+        }
+    }
+
+    // A listed gigantic group is a free run that needs no searching. Take one whole and
+    // give back the pages past the run.
+    BigPageMetadata* group = nullptr;
+    if (runLength > mm::PageAllocator::bigPagesPerGiganticPage || baseAlignment > arch::giganticPageSize
+        || !freeGiganticPages.tryRead(group)) {
+        return {};
+    }
+    const auto pid = arch::getCurrentProcessorID();
+    for (size_t k = 0; k < runLength; k++) {
+        group[k].markAllocHolder(pid);
+    }
+    if (runLength < mm::PageAllocator::bigPagesPerGiganticPage) {
+        freeBigPages.bulkWrite(mm::PageAllocator::bigPagesPerGiganticPage - runLength, [&](size_t index, BigPageMetadata*& slot) {
+            slot = &group[runLength + index];
+        });
+    }
+    checkWatermarks();
+    return finishRun(group);
+}
+
+bool NUMAPool::claimFreeBigPageRun(BigPageMetadata* first, size_t runLength) {
+    const auto pid = arch::getCurrentProcessorID();
+    BigPageMetadata* const last = first + runLength;
+
+    // Both free rings are FIFO, so pull pages off the front of each, keeping the ones
+    // inside the run and writing everything else straight back where it came from. Only
+    // runLength + PA_CONTIGUOUS_RING_SCAN entries are looked at; a run lying deeper fails to claim.
+    const size_t scanLimit = runLength + PA_CONTIGUOUS_RING_SCAN;
+    size_t claimed = 0;
+    const auto claimFrom = [&](HighReliabilityRingBuffer<BigPageMetadata*, false, true>& ring) {
+        const size_t lap = min(ring.availableToRead(), scanLimit);
+        for (size_t n = 0; n < lap && claimed < runLength; n++) {
+            BigPageMetadata* page = nullptr;
+            if (!ring.tryRead(page)) break;
+            if (page >= first && page < last) {
+                page->markAllocHolder(pid);
+                claimed++;
+            } else {
+                ring.write(page);
+            }
+        }
+    };
+    {
+        // The hot stack is small; compact it around the pages we take.
+        LockGuard guard(hotLock);
+        size_t kept = 0;
+        for (size_t n = 0; n < hotBigPageCount; n++) {
+            BigPageMetadata* page = hotBigPages[(hotBigPageStart + n) % hotBigPageCapacity];
+            if (page >= first && page < last) {
+                page->markAllocHolder(pid);
+                claimed++;
+            } else {
+                hotBigPages[(hotBigPageStart + kept++) % hotBigPageCapacity] = page;
+            }
+        }
+        hotBigPageCount = kept;
+    }
+    claimFrom(freeBigPages);
+    claimFrom(zeroedBigPages);
+    // A listed gigantic group overlapping the run is split: its pages inside the run are
+    // ours, the rest go to freeBigPages.
+    const size_t groupLap = min(freeGiganticPages.availableToRead(), scanLimit);
+    for (size_t n = 0; n < groupLap && claimed < runLength; n++) {
+        BigPageMetadata* group = nullptr;
+        if (!freeGiganticPages.tryRead(group)) break;
+        if (group + mm::PageAllocator::bigPagesPerGiganticPage <= first || group >= last) {
+            freeGiganticPages.write(group);
+            continue;
+        }
+        for (size_t k = 0; k < mm::PageAllocator::bigPagesPerGiganticPage; k++) {
+            BigPageMetadata* page = &group[k];
+            if (page >= first && page < last) {
+                page->markAllocHolder(pid);
+                claimed++;
+            } else {
+                freeBigPages.write(page);
+            }
+        }
+    }
+    if (claimed == runLength) {
+        return true;
+    }
+
+    // Some page in the run was taken in the meantime; give back what we claimed. Pages
+    // taken from zeroedBigPages go back to freeBigPages and just lose their known-zero status.
+    for (BigPageMetadata* page = first; page < last; page++) {
+        if (page->isAllocHolder(pid)) {
+            page->releaseAllocHolder();
+            freeBigPages.write(page);
+        }
+    }
+    return false;
+}
+
+void NUMAPool::freePages(PageRef *pages, size_t count) {
+    // Full→Partial pages are published in batches at the end of the call. Until then they are
+    // merely invisible to small-page allocation, which is the same state the alloc-holder wait
+    // below already puts them in. A concurrent free may empty such a page before it is
+    // published, find it absent from partialPages and leave it there, so once published each
+    // page is checked again and moved to the free big pages if it has emptied meanwhile.
+    //
+    // An empty page found in partialPages is only ours once remove succeeds, and by then an
+    // allocator may have taken it, used it and published it again. So emptiness is checked
+    // again after the remove, and a page that is in use once more goes back where it was.
+    const auto retireEmptyPartialPage = [&](BigPageMetadata& page) {
+        const size_t index = metadataIndex(&page);
+        if (partialPages(page.lifetime()).remove(index) == AtomicBitPool::RemoveResult::NotPresent) {
+            return;
+        }
+        if (page.isEmpty()) {
+            pushFreeBigPage(page);
+        } else {
+            partialPages(page.lifetime()).add(index);
+        }
+    };
+    auto recheckPublished = [&](size_t index) {
+        BigPageMetadata& page = bigPageMetadataBuffer[index];
+        if (page.isEmpty() && !page.hasAllocHolder()) {
+            retireEmptyPartialPage(page);
+        }
+    };
+    BitPoolBatch becameAvailable[] = {{partialPages(PageLifetime::Short), false, recheckPublished},
+                                      {partialPages(PageLifetime::Long), false, recheckPublished}};
+    const auto freeBigPageRun = [&](BigPageMetadata* firstMetadata, PageRef *runStart, size_t runSize) {
+        // A lone big page is likely still warm; longer runs go straight to the ring in one write.
+        if (runSize == 1) {
+            assert(firstMetadata->isFull(), "We should only take this path when freeing totally occupied big pages");
+            firstMetadata->freeAll();
+            pushFreeBigPage(*firstMetadata);
+            return;
+        }
+        freeBigPages.bulkWrite(runSize, [&](size_t index, BigPageMetadata*& entry) {
+            const auto metadataIndex = divideAndRoundDown(runStart[index].value - runStart[0].value, static_cast<uint64_t>(arch::bigPageSize));
+            assert(firstMetadata[metadataIndex].isFull(), "We should only take this path when freeing totally occupied big pages");
+            firstMetadata[metadataIndex].freeAll();
+            entry = &(firstMetadata[metadataIndex]);
+        });
+    };
+    const auto freeSmallPageRun = [&](BigPageMetadata* superpage, PageRef *runStart, size_t runSize) {
+        OccupancyTransition transition {};
+        superpage->freePages(runStart, runSize, transition);
+
+        if (transition.becameEmpty()) {
+            // If the page is cached in a LocalPool it is not in paPages, so skip the
+            // remove. The LocalPool will call returnPage() when it evicts or uses it up,
+            // which routes it correctly at that point.
+            if (superpage->hasAllocHolder()) {
+                // nothing to do
+            } else if (transition.before == OccupancyState::Partial) {
+                // Publish any pending Full→Partial adds first, in case this page is among them.
+                becameAvailable[static_cast<size_t>(superpage->lifetime())].flush();
+                // The page was partial, so it may be in paPages. Attempt to remove it and
+                // move it to freeBigPages. If remove returns NotPresent, either an allocator
+                // just took it, or the concurrent free that made it partial has not published
+                // it yet; that thread checks it again once published.
+                retireEmptyPartialPage(*superpage);
+            } else {
+                // Full→Empty: page was never in paPages, return it directly.
+                pushFreeBigPage(*superpage);
+            }
+        }
+        else if (transition.becameAvailable()) {
+            // Full→Partial: page newly has free subpages; publish it for small-page allocation.
+            size_t spinCount = 0;
+            while (superpage->hasAllocHolder()) {
+                tight_spin();
+                spinCount++;
+                assert(spinCount < 100000, "stuck waiting for alloc holder to release hold");
+            }
+            becameAvailable[static_cast<size_t>(superpage->lifetime())].push(metadataIndex(superpage));
+        }
+    };
+
+    // Subrange cursor: only advances forward since big pages ascend through the array.
+    size_t subrangeIdx = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        if (pages[i].size() == mm::PageSize::GIGANTIC) {
+            BigPageMetadata* first = findMetadata(pages[i].addr());
+            assert(first != nullptr, "NUMAPool::freePages: gigantic page address outside all subranges");
+            for (size_t k = 0; k < mm::PageAllocator::bigPagesPerGiganticPage; k++) {
+                assert(first[k].isFull(), "Freed gigantic page was not fully allocated");
+                first[k].freeAll();
+            }
+            freeGiganticPages.write(first);
+            i++;
+        } else if (pages[i].size() == mm::PageSize::BIG) {
+            const uint64_t addr = pages[i].addr().value;
+
+            // Advance the subrange cursor past entries that end before this big page.
+            while (subrangeIdx < subrangeCount && addr >= subrangeInfo[subrangeIdx].rangeEnd.value) {
+                subrangeIdx++;
+            }
 
             // Collect consecutive big pages within the same subrange.
             assert(subrangeIdx < subrangeCount, "NUMAPool::freePages: big page address outside all subranges");
@@ -1181,13 +2771,402 @@ void NUMAPool::freePages(PageRef *pages, size_t count) {
     }
 }
 
+bool PageAllocatorImpl::freeToMagazine(PageRef page) {
+    if (page.size() != mm::PageSize::SMALL || page.runLength() != 1) return false;
+    const auto pid = arch::getCurrentProcessorID();
+    BigPageMetadata* meta = findMetadata(page.addr());
+    if (meta == nullptr) return false;
+    // Only cache pages from the nearest pool, so the magazine never serves remote memory.
+    if (&meta->getOwnerPool() != &nearestPool(pid)) return false;
+    // A freed long-lived page goes straight home; recycling it as a short-lived page would
+    // keep its big page pinned after the long-lived data is gone.
+    if (meta->lifetime() == PageLifetime::Long) return false;
+    auto& localPool = *localPools[pid];
+    // The same double-free checks the bitmap free path makes. Magazine pages stay allocated in
+    // their big page, so a page freed twice into the magazine would otherwise go unnoticed.
+    assert(meta->isSubpageAllocated(page), "Double free: page is already free in its big page");
+    assert(!localPool.magazineContains(page), "Double free: page is already in the magazine");
+    if (localPool.magazineFull()) {
+        PageRef spill[LocalPool::magazineBatch];
+        const size_t spilled = localPool.drainMagazine(spill, LocalPool::magazineBatch);
+        freePages(spill, spilled);
+    }
+    localPool.pushMagazine(page);
+    return true;
+}
+
+bool PageAllocatorImpl::freeToBigPageCache(PageRef page) {
+    if (page.size() != mm::PageSize::BIG || page.runLength() != 1) return false;
+    const auto pid = arch::getCurrentProcessorID();
+    // As with the magazine, only pages from the nearest pool are kept.
+    BigPageMetadata* meta = findMetadata(page.addr());
+    if (meta == nullptr || &meta->getOwnerPool() != &nearestPool(pid)) return false;
+    auto& localPool = *localPools[pid];
+    if (localPool.bigPageCacheFull()) {
+        BigPageMetadata* spill[LocalPool::bigPageCacheBatch];
+        const size_t spilled = localPool.drainBigPageCache(spill, LocalPool::bigPageCacheBatch);
+        nearestPool(pid).returnCachedBigPages(spill, spilled);
+    }
+    assert(meta->isFull(), "Freed big page was not fully allocated");
+    meta->freeAll();
+    meta->markAllocHolder(pid);
+    localPool.pushBigPageCache(*meta);
+    return true;
+}
+
+void PageAllocatorImpl::flushBigPageCache(arch::ProcessorID cpu) {
+    auto& localPool = *localPools[cpu];
+    BigPageMetadata* spill[LocalPool::bigPageCacheCapacity];
+    const size_t spilled = localPool.drainBigPageCache(spill, LocalPool::bigPageCacheCapacity);
+    if (spilled > 0) {
+        nearestPool(cpu).returnCachedBigPages(spill, spilled);
+    }
+}
+
+void PageAllocatorImpl::flushMagazine(arch::ProcessorID cpu) {
+    auto& localPool = *localPools[cpu];
+    PageRef spill[LocalPool::magazineCapacity];
+    const size_t spilled = localPool.drainMagazine(spill, LocalPool::magazineCapacity);
+    if (spilled > 0) {
+        freePages(spill, spilled);
+    }
+}
+
+void PageAllocatorImpl::drainRemoteFrees(arch::ProcessorID cpu) {
+    auto& localPool = *localPools[cpu];
+    PageRef batch[PA_REMOTE_FREE_BATCH];
+    // Bounded to one inbox's worth so a steady stream of posts cannot keep us here.
+    for (size_t drained = 0; drained < LocalPool::remoteFreeCapacity; ) {
+        const size_t taken = localPool.takeRemoteFrees(batch, PA_REMOTE_FREE_BATCH);
+        if (taken == 0) {
+            break;
+        }
+        orderPagesForFree(batch, taken);
+        freeSortedPages(batch, taken);
+        drained += taken;
+    }
+}
+
+void PageAllocatorImpl::drainOwnRemoteFrees() {
+    if (!remoteFreesEnabled) {
+        return;
+    }
+    const auto pid = arch::getCurrentProcessorID();
+    if (localPools[pid]->hasRemoteFrees()) {
+        drainRemoteFrees(pid);
+    }
+}
+
+PageAllocatorImpl::AllocationScope::AllocationScope(PageAllocatorImpl& impl)
+    : impl(impl), cpu(arch::getCurrentProcessorID()) {
+    if (!impl.remoteFreesEnabled) {
+        return;
+    }
+    localPool = impl.localPools[cpu];
+    localPool->enterAllocation();
+    impl.drainOwnRemoteFrees();
+}
+
+PageAllocatorImpl::AllocationScope::~AllocationScope() {
+    if (localPool == nullptr || !localPool->leaveAllocation()) {
+        return;
+    }
+    // Pairs with the fence in postRemoteFrees: either the poster sees we have left and frees
+    // its pages itself, or we see them here.
+    thread_fence();
+    if (localPool->hasRemoteFrees()) {
+        impl.drainRemoteFrees(cpu);
+    }
+}
+
+// TLB flush generations are system-wide. gTlbGeneration is bumped once per deferred free;
+// gTlbFlushedEverywhere caches the lowest generation every CPU has reported, and only grows.
+static Atomic<uint64_t> gTlbGeneration{0};
+static Atomic<uint64_t> gTlbFlushedEverywhere{0};
+
+uint64_t PageAllocatorImpl::tlbFlushGeneration() {
+    return gTlbGeneration.load(ACQUIRE);
+}
+
+void PageAllocatorImpl::noteTlbFlush(arch::ProcessorID cpu, uint64_t generation) {
+    localPools[cpu]->noteTlbFlush(generation);
+}
+
+uint64_t PageAllocatorImpl::generationFlushedEverywhere(const uint64_t needed) const {
+    uint64_t known = gTlbFlushedEverywhere.load(ACQUIRE);
+    if (known >= needed) {
+        return known;
+    }
+    uint64_t lowest = UINT64_MAX;
+    for (size_t cpu = 0; cpu < processorCount; cpu++) {
+        lowest = min(lowest, localPools[cpu]->getFlushedGeneration());
+    }
+    // CPUs rescanning at the same time may finish out of order; keep the largest result.
+    while (lowest > known && !gTlbFlushedEverywhere.compare_exchange(known, lowest, RELEASE, ACQUIRE)) {}
+    return max(known, lowest);
+}
+
+void PageAllocatorImpl::flushOwnTlb(arch::ProcessorID cpu) {
+    const uint64_t generation = tlbFlushGeneration();
+#ifndef CROCOS_TESTING
+    arch::flushGlobalTLB();
+#endif
+    noteTlbFlush(cpu, generation);
+}
+
+void PageAllocatorImpl::catchUpTlbFlush(arch::ProcessorID cpu) {
+    if (localPools[cpu]->getFlushedGeneration() < tlbFlushGeneration()) {
+        flushOwnTlb(cpu);
+    }
+}
+
+size_t PageAllocatorImpl::freePagesAfterTlbFlush(const PageRef* pages, size_t count) {
+    const auto pid = arch::getCurrentProcessorID();
+    auto& localPool = *localPools[pid];
+    // The mappings are already gone, so any CPU that reads this generation or a later one
+    // before flushing cannot hold them afterwards.
+    const uint64_t generation = gTlbGeneration.add_fetch(1, ACQ_REL);
+    for (size_t i = 0; i < count; i++) {
+        if (localPool.deferredFreesFull() && releaseDeferredFrees(pid) == 0) {
+            // Our own flush is free to do, and may be all that is missing.
+            flushOwnTlb(pid);
+            size_t released = 0;
+            for (size_t spin = 0; spin < PA_DEFERRED_FREE_WAIT_SPINS && (released = releaseDeferredFrees(pid)) == 0; spin++) {
+                tight_spin();
+            }
+            if (released == 0) {
+                // Some CPU is not flushing on its own. Without a shootdown to make it, the
+                // remaining pages stay with the caller.
+                if (tlbShootdown == nullptr) {
+                    return i;
+                }
+                tlbShootdown();
+                released = releaseDeferredFrees(pid);
+                assert(released != 0, "TLB shootdown did not release any deferred frees");
+            }
+        }
+        localPool.pushDeferredFree(pages[i], generation);
+    }
+    return count;
+}
+
+size_t PageAllocatorImpl::releaseDeferredFrees(arch::ProcessorID cpu) {
+    auto& localPool = *localPools[cpu];
+    if (!localPool.hasDeferredFrees()) {
+        return 0;
+    }
+    const uint64_t flushed = generationFlushedEverywhere(localPool.oldestDeferredGeneration());
+    PageRef batch[PA_DEFERRED_FREE_BATCH];
+    size_t released = 0;
+    while (const size_t taken = localPool.takeDeferredFrees(batch, PA_DEFERRED_FREE_BATCH, flushed)) {
+        freePageRuns(batch, taken);
+        released += taken;
+    }
+    return released;
+}
+
+size_t PageAllocatorImpl::postRemoteFrees(PageRef* pages, size_t count) {
+    const auto pid = arch::getCurrentProcessorID();
+    size_t kept = 0;
+    size_t i = 0;
+    while (i < count) {
+        size_t runEnd = i + 1;
+        if (pages[i].size() == mm::PageSize::SMALL) {
+            // Pages are ordered, so the small pages of one big page sit next to each other.
+            const uint64_t bigPageBase = roundDownToNearestMultiple(pages[i].addr().value, static_cast<uint64_t>(arch::bigPageSize));
+            while (runEnd < count && pages[runEnd].size() == mm::PageSize::SMALL
+                   && roundDownToNearestMultiple(pages[runEnd].addr().value, static_cast<uint64_t>(arch::bigPageSize)) == bigPageBase) {
+                runEnd++;
+            }
+            const BigPageMetadata* meta = findMetadata(pages[i].addr());
+            arch::ProcessorID holder;
+            // A holder outside any allocation may not drain for a long time, and a full inbox
+            // has no room; either way we free the run ourselves.
+            if (meta != nullptr && meta->getAllocHolder(holder) && holder != pid
+                && localPools[holder]->isAllocating()
+                && localPools[holder]->postRemoteFrees(&pages[i], runEnd - i)) {
+                size_t posted = 0;
+                for (size_t j = i; j < runEnd; j++) posted += pages[j].runLength();
+                localPools[pid]->countEvent(AllocEvent::RemoteFreesPosted, posted);
+                // The holder may have left its allocation before seeing the post. Then nobody
+                // else is draining its inbox, so we do it ourselves.
+                thread_fence();
+                if (!localPools[holder]->isAllocating()) {
+                    drainRemoteFrees(holder);
+                }
+                i = runEnd;
+                continue;
+            }
+        }
+        for (; i < runEnd; i++) {
+            pages[kept++] = pages[i];
+        }
+    }
+    return kept;
+}
+
+void PageAllocatorImpl::assertFramesCleared(const PageRef* pages, const size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        mm::PageFrame* frame = frameFor(pages[i].addr());
+        if (frame == nullptr) {
+            continue;
+        }
+        // A big or gigantic page is described by its first frame alone; a small run by one
+        // frame per page, which all sit in the same big page.
+        const size_t frames = pages[i].size() == mm::PageSize::SMALL ? pages[i].runLength() : 1;
+        for (size_t j = 0; j < frames; j++) {
+            assert(frame[j].isClear(), "Freed page's PageFrame was not cleared");
+        }
+    }
+}
+
 void PageAllocatorImpl::freePages(PageRef *pages, size_t count) {
-    algorithm::sort(pages, count, [](const PageRef& p1, const PageRef& p2) {
-        return p1.addr().value < p2.addr().value;
-    });
+    // Everything below takes big pages one ref each, so big runs are expanded first.
+    for (size_t i = 0; i < count; i++) {
+        if (pages[i].size() == mm::PageSize::BIG && pages[i].runLength() > 1) {
+            freePageRuns(pages, count);
+            return;
+        }
+    }
+    assertFramesCleared(pages, count);
+    if (deferredFreesEnabled) {
+        const auto pid = arch::getCurrentProcessorID();
+        if (localPools[pid]->hasDeferredFrees()) {
+            (void)releaseDeferredFrees(pid);
+        }
+    }
+    if (magazinesEnabled && count == 1 && freeToMagazine(pages[0])) {
+        return;
+    }
+    if (bigPageCachesEnabled && count == 1 && freeToBigPageCache(pages[0])) {
+        return;
+    }
+    orderPagesForFree(pages, count);
+    if (remoteFreesEnabled) {
+        count = postRemoteFrees(pages, count);
+    }
+    freeSortedPages(pages, count);
+}
 
-    // Walk the sorted page list alongside the sorted domain table.
-    // Both are ordered by address, so tableIdx only ever advances forward.
+// Appends pages to a caller's run array, folding each one into the previous run when it
+// directly follows it and the encoding has room.
+class PageRunWriter {
+    PageRef* runs;
+    size_t capacity;
+    size_t count = 0;
+
+    bool extendLast(const PageRef page) {
+        if (count == 0) return false;
+        PageRef& last = runs[count - 1];
+        const auto size = last.size();
+        if (size == mm::PageSize::GIGANTIC || page.size() != size) return false;
+        const size_t pageBytes = size == mm::PageSize::BIG ? arch::bigPageSize : arch::smallPageSize;
+        const size_t groupBytes = size == mm::PageSize::BIG ? arch::giganticPageSize : arch::bigPageSize;
+        const size_t length = last.runLength();
+        const auto base = last.addr();
+        if (page.addr() != base + length * pageBytes) return false;
+        // Runs never cross the next larger page size, which also keeps them within the encoding.
+        if (base.value / groupBytes != page.addr().value / groupBytes) return false;
+        const size_t merged = length + page.runLength();
+        last = size == mm::PageSize::BIG ? PageRef::bigRun(base, merged) : PageRef::smallRun(base, merged);
+        return true;
+    }
+public:
+    PageRunWriter(PageRef* r, const size_t cap) : runs(r), capacity(cap) {}
+
+    void append(const PageRef page) {
+        if (extendLast(page)) return;
+        assert(count < capacity, "Page run array overflow");
+        runs[count++] = page;
+    }
+
+    [[nodiscard]] size_t size() const { return count; }
+    [[nodiscard]] size_t spare() const { return capacity - count; }
+};
+
+size_t PageAllocatorImpl::collectPageRuns(size_t smallPageCount, PageRef* runs, size_t maxRuns, size_t& runCount,
+                                          FunctionRef<size_t(size_t, PageAllocationCallback, AllocFlags)> allocate,
+                                          AllocFlags flags) {
+    constexpr auto smallPagesPerBigPage = mm::PageAllocator::smallPagesPerBigPage;
+    const bool bigOnly = flags.has(AllocBehavior::BIG_PAGE_ONLY);
+    const AllocFlags roundFlags = flags | AllocBehavior::PAGE_RUNS | AllocBehavior::GRACEFUL_OOM;
+    PageRunWriter writer(runs, maxRuns);
+    auto append = [&](PageRef page) { writer.append(page); };
+    size_t allocatedPages = 0;
+    // Each round asks for no more pages than the spare slots could hold if nothing merged:
+    // one slot per big page for big-page rounds, one per small page otherwise.
+    while (allocatedPages < smallPageCount && writer.spare() > 0) {
+        const size_t remaining = smallPageCount - allocatedPages;
+        size_t got = 0;
+        if (bigOnly || remaining >= smallPagesPerBigPage) {
+            const size_t bigRequest = bigOnly ? remaining : roundDownToNearestMultiple(remaining, smallPagesPerBigPage);
+            got = allocate(min(bigRequest, writer.spare() * smallPagesPerBigPage), append,
+                           roundFlags | AllocBehavior::BIG_PAGE_ONLY);
+        }
+        if (got == 0 && !bigOnly) {
+            got = allocate(min(remaining, writer.spare()), append, roundFlags);
+        }
+        if (got == 0) {
+            break;
+        }
+        allocatedPages += got;
+    }
+    runCount = writer.size();
+
+    if (!flags.has(AllocBehavior::GRACEFUL_OOM) && allocatedPages < smallPageCount && writer.spare() > 0) {
+        assertNotReached("Panic!!! Page allocator is out of memory");
+    }
+    return allocatedPages;
+}
+
+size_t PageAllocatorImpl::allocatePageRuns(size_t smallPageCount, PageRef* runs, size_t maxRuns, size_t& runCount,
+                                           AllocFlags flags) {
+    auto allocate = [&](size_t count, PageAllocationCallback cb, AllocFlags roundFlags) {
+        return allocatePages(count, cb, roundFlags);
+    };
+    return collectPageRuns(smallPageCount, runs, maxRuns, runCount, allocate, flags);
+}
+
+size_t PageAllocatorImpl::allocatePageRuns(size_t smallPageCount, PageRef* runs, size_t maxRuns, size_t& runCount,
+                                           kernel::numa::DomainID targetDomain, AllocFlags flags) {
+    auto allocate = [&](size_t count, PageAllocationCallback cb, AllocFlags roundFlags) {
+        return allocatePages(count, cb, targetDomain, roundFlags);
+    };
+    return collectPageRuns(smallPageCount, runs, maxRuns, runCount, allocate, flags);
+}
+
+void PageAllocatorImpl::freePageRuns(const PageRef* runs, size_t count) {
+    assertFramesCleared(runs, count);
+    // Big runs go back as single big pages, which is what the pool free paths take; small
+    // runs stay whole since SmallPageAllocator::free handles them directly.
+    PageRef batch[PA_RUN_FREE_BATCH];
+    size_t batched = 0;
+    const auto flush = [&] {
+        orderPagesForFree(batch, batched);
+        if (remoteFreesEnabled) {
+            batched = postRemoteFrees(batch, batched);
+        }
+        freeSortedPages(batch, batched);
+        batched = 0;
+    };
+    for (size_t i = 0; i < count; i++) {
+        const bool bigRun = runs[i].size() == mm::PageSize::BIG;
+        const size_t length = bigRun ? runs[i].runLength() : 1;
+        for (size_t j = 0; j < length; j++) {
+            if (batched == PA_RUN_FREE_BATCH) {
+                flush();
+            }
+            batch[batched++] = bigRun ? PageRef::big(runs[i].addr() + j * arch::bigPageSize) : runs[i];
+        }
+    }
+    if (batched > 0) {
+        flush();
+    }
+}
+
+void PageAllocatorImpl::freeSortedPages(PageRef *pages, size_t count) {
+    // Without a radix, walk the page list alongside the sorted domain table.
+    // Both ascend by address, so tableIdx only ever advances forward.
     size_t tableIdx = 0;
     size_t runStart = 0;
     NUMAPool* runPool = nullptr;
@@ -1195,15 +3174,20 @@ void PageAllocatorImpl::freePages(PageRef *pages, size_t count) {
     for (size_t i = 0; i < count; i++) {
         const uint64_t addr = pages[i].addr().value;
 
-        // Advance the table cursor past entries whose range ends before this address.
-        while (tableIdx < domainTableSize && addr >= domainTable[tableIdx].rangeEnd.value) {
-            tableIdx++;
-        }
-
         // Determine the pool that owns this page (nullptr if outside all known ranges).
         NUMAPool* pagePool = nullptr;
-        if (tableIdx < domainTableSize && addr >= domainTable[tableIdx].rangeStart.value) {
-            pagePool = domainTable[tableIdx].pool;
+        if (metadataRadix.valid()) {
+            if (const BigPageMetadata* meta = metadataRadix.lookup(pages[i].addr())) {
+                pagePool = &meta->getOwnerPool();
+            }
+        } else {
+            // Advance the table cursor past entries whose range ends before this address.
+            while (tableIdx < domainTableSize && addr >= domainTable[tableIdx].rangeEnd.value) {
+                tableIdx++;
+            }
+            if (tableIdx < domainTableSize && addr >= domainTable[tableIdx].rangeStart.value) {
+                pagePool = domainTable[tableIdx].pool;
+            }
         }
 
         // Pool changed — flush the accumulated run to the previous pool.
@@ -1222,6 +3206,117 @@ void PageAllocatorImpl::freePages(PageRef *pages, size_t count) {
     }
 }
 
+Optional<mm::phys_addr> PageAllocatorImpl::allocateContiguous(size_t smallPageCount, size_t alignment,
+                                                              kernel::numa::DomainID targetDomain, AllocFlags flags) {
+    assert(smallPageCount > 0, "Contiguous allocation of zero pages");
+    assert((alignment & (alignment - 1)) == 0 && alignment >= arch::smallPageSize,
+           "Contiguous allocation alignment must be a power of two no smaller than a small page");
+    AllocationScope scope(*this);
+    const auto pid = arch::getCurrentProcessorID();
+    auto& localPool = *localPools[pid];
+
+    if (smallPageCount <= mm::PageAllocator::smallPagesPerBigPage && alignment <= arch::bigPageSize) {
+        if (auto result = localPool.allocateContiguous(smallPageCount, alignment / arch::smallPageSize, targetDomain)) {
+            return result;
+        }
+    }
+
+    Optional<mm::phys_addr> result;
+    const auto allocFromPool = [&](NUMAPool& pool) {
+        if (result.occupied()) return;
+        BigPageMetadata* extras = nullptr;
+        result = pool.allocateContiguous(smallPageCount, alignment, extras);
+        if (extras != nullptr) {
+            localPool.tryGivePAPage(*extras);
+        }
+    };
+
+    if (numaPolicy != nullptr) {
+        if (flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY)) {
+            if (targetDomain.value < numDomains && numaPools[targetDomain.value] != nullptr) {
+                allocFromPool(*numaPools[targetDomain.value]);
+            }
+        } else {
+            for (const auto domain : numaPolicy->domainOrder(targetDomain)) {
+                if (domain.value < numDomains && numaPools[domain.value] != nullptr) {
+                    allocFromPool(*numaPools[domain.value]);
+                }
+            }
+        }
+    } else {
+        allocFromPool(nearestPool(pid));
+    }
+
+    if (unownedPool != nullptr) {
+        allocFromPool(*unownedPool);
+    }
+
+    NUMAPool& preferred = (targetDomain.value < numDomains && numaPools[targetDomain.value] != nullptr)
+        ? *numaPools[targetDomain.value] : nearestPool(pid);
+    while (!result.occupied()) {
+        NUMAPool* grown = initializeDeferredChunk(preferred, flags.has(AllocBehavior::LOCAL_DOMAIN_ONLY));
+        if (grown == nullptr) break;
+        allocFromPool(*grown);
+    }
+
+    if (!flags.has(AllocBehavior::GRACEFUL_OOM) && !result.occupied()) {
+        assertNotReached("Panic!!! Page allocator could not satisfy contiguous allocation");
+    }
+    return result;
+}
+
+void PageAllocatorImpl::freeContiguous(mm::phys_addr base, size_t smallPageCount) {
+    assert(base.value % arch::smallPageSize == 0, "Contiguous run base is not small page aligned");
+    // A big page is either fully inside the run (and therefore full) or only partially
+    // covered, in which case its pages must go back one by one.
+    constexpr size_t batchSize = 64;
+    PageRef batch[batchSize];
+    size_t batched = 0;
+
+    const uint64_t end = base.value + smallPageCount * arch::smallPageSize;
+    for (uint64_t addr = base.value; addr < end;) {
+        if (addr % arch::bigPageSize == 0 && end - addr >= arch::bigPageSize) {
+            batch[batched++] = PageRef::big(mm::phys_addr{addr});
+            addr += arch::bigPageSize;
+        } else {
+            batch[batched++] = PageRef::small(mm::phys_addr{addr});
+            addr += arch::smallPageSize;
+        }
+        if (batched == batchSize) {
+            freePages(batch, batched);
+            batched = 0;
+        }
+    }
+    if (batched > 0) {
+        freePages(batch, batched);
+    }
+}
+
+mm::MemoryStatistics PageAllocatorImpl::getStatistics() {
+    mm::MemoryStatistics stats{};
+    for (size_t i = 0; i < numDomains; i++) {
+        NUMAPool* pool = numaPools[i];
+        stats.freeBigPageCount.push(pool ? pool->countFreeBigPages() : 0);
+        stats.freeSmallPageCount.push(pool ? pool->countTotalFreePages() : 0);
+        stats.paPagesContention.push(pool ? pool->getPAPagesContention() : 0);
+        stats.ringStalls.push(pool ? pool->getRingStallCount() : 0);
+    }
+    stats.globalPoolSize = unownedPool ? unownedPool->countTotalFreePages() : 0;
+    for (size_t p = 0; p < processorCount; p++) {
+        const mm::AllocationCounters counters = localPools[p] ? localPools[p]->readCounters() : mm::AllocationCounters{};
+        stats.perCpu.push(counters);
+        stats.total.fastPathHits        += counters.fastPathHits;
+        stats.total.fallbacks           += counters.fallbacks;
+        stats.total.magazineRefills     += counters.magazineRefills;
+        stats.total.bigPageCacheRefills += counters.bigPageCacheRefills;
+        stats.total.remoteDomainPages   += counters.remoteDomainPages;
+        stats.total.remoteFreesPosted   += counters.remoteFreesPosted;
+        stats.total.reservePages        += counters.reservePages;
+        stats.total.reserveShortfalls   += counters.reserveShortfalls;
+    }
+    return stats;
+}
+
 #ifdef CROCOS_TESTING
 size_t PageAllocatorImpl::countFreePages() const {
     size_t total = 0;
@@ -1235,7 +3330,7 @@ size_t PageAllocatorImpl::countFreePages() const {
 bool PageAllocatorImpl::isPageAllocated(PageRef page) {
     BigPageMetadata* meta = findMetadata(page.addr());
     if (meta == nullptr) return false;
-    if (page.size() == kernel::mm::PageSize::BIG) {
+    if (page.size() != kernel::mm::PageSize::SMALL) {
         return meta->isFull();
     }
     return meta->isSubpageAllocated(page);
@@ -1286,9 +3381,23 @@ namespace kernel::mm::PageAllocator {
         return result;
     }
 
+    phys_addr allocateGiganticPage() {
+        phys_addr result{};
+        (void)gPageAllocator->allocatePages(smallPagesPerGiganticPage, [&](PageRef ref) { result = ref.addr(); }, AllocBehavior::GIGANTIC_PAGE_ONLY);
+        return result;
+    }
+
+    phys_addr allocateGiganticPage(numa::DomainID targetDomain) {
+        phys_addr result{};
+        (void)gPageAllocator->allocatePages(smallPagesPerGiganticPage, [&](PageRef ref) { result = ref.addr(); }, targetDomain, AllocBehavior::GIGANTIC_PAGE_ONLY);
+        return result;
+    }
+
     // ---- Bulk allocation ----
 
     static size_t allocatePagesImpl(size_t count, FunctionRef<void(PageRef)> cb, AllocFlags flags) {
+        if (flags.has(AllocBehavior::GIGANTIC_PAGE_ONLY))
+            return gPageAllocator->allocatePages(count * smallPagesPerGiganticPage, cb, flags) / smallPagesPerGiganticPage;
         if (flags.has(AllocBehavior::BIG_PAGE_ONLY))
             return gPageAllocator->allocatePages(count * smallPagesPerBigPage, cb, flags) / smallPagesPerBigPage;
         return gPageAllocator->allocatePages(count, cb, flags);
@@ -1299,12 +3408,16 @@ namespace kernel::mm::PageAllocator {
     }
 
     size_t allocatePages(size_t count, FunctionRef<void(PageRef)> cb, numa::DomainID targetDomain, AllocFlags flags) {
+        if (flags.has(AllocBehavior::GIGANTIC_PAGE_ONLY))
+            return gPageAllocator->allocatePages(count * smallPagesPerGiganticPage, cb, targetDomain, flags) / smallPagesPerGiganticPage;
         if (flags.has(AllocBehavior::BIG_PAGE_ONLY))
             return gPageAllocator->allocatePages(count * smallPagesPerBigPage, cb, targetDomain, flags) / smallPagesPerBigPage;
         return gPageAllocator->allocatePages(count, cb, targetDomain, flags);
     }
 
     size_t allocatePages(size_t count, FunctionRef<void(PageRef)> cb, arch::ProcessorID targetProc, AllocFlags flags) {
+        if (flags.has(AllocBehavior::GIGANTIC_PAGE_ONLY))
+            return gPageAllocator->allocatePages(count * smallPagesPerGiganticPage, cb, targetProc, flags) / smallPagesPerGiganticPage;
         if (flags.has(AllocBehavior::BIG_PAGE_ONLY))
             return gPageAllocator->allocatePages(count * smallPagesPerBigPage, cb, targetProc, flags) / smallPagesPerBigPage;
         return gPageAllocator->allocatePages(count, cb, targetProc, flags);
@@ -1322,9 +3435,126 @@ namespace kernel::mm::PageAllocator {
         gPageAllocator->freePages(&ref, 1);
     }
 
+    void freeGiganticPage(phys_addr addr) {
+        PageRef ref = PageRef::gigantic(addr);
+        gPageAllocator->freePages(&ref, 1);
+    }
+
     // ---- Bulk free ----
 
     void freePages(PageRef* pages, size_t count) {
         gPageAllocator->freePages(pages, count);
     }
+
+    void drainRemoteFrees() {
+        gPageAllocator->drainRemoteFrees(arch::getCurrentProcessorID());
+    }
+
+    // ---- Deferred freeing across TLB flushes ----
+
+    uint64_t tlbFlushGeneration() {
+        return PageAllocatorImpl::tlbFlushGeneration();
+    }
+
+    void noteTlbFlush(uint64_t generation) {
+        gPageAllocator->noteTlbFlush(arch::getCurrentProcessorID(), generation);
+    }
+
+    size_t freePagesAfterTlbFlush(const PageRef* pages, size_t count) {
+        return gPageAllocator->freePagesAfterTlbFlush(pages, count);
+    }
+
+    void catchUpTlbFlush() {
+        gPageAllocator->catchUpTlbFlush(arch::getCurrentProcessorID());
+    }
+
+    size_t releaseDeferredFrees() {
+        return gPageAllocator->releaseDeferredFrees(arch::getCurrentProcessorID());
+    }
+
+    void setTlbShootdown(TlbShootdown shootdown) {
+        gPageAllocator->tlbShootdown = shootdown;
+    }
+
+    // ---- Run-length allocation ----
+
+    size_t allocatePageRuns(size_t count, PageRef* runs, size_t maxRuns, size_t& runCount, AllocFlags flags) {
+        return gPageAllocator->allocatePageRuns(count, runs, maxRuns, runCount, flags);
+    }
+
+    size_t allocatePageRuns(size_t count, PageRef* runs, size_t maxRuns, size_t& runCount, numa::DomainID targetDomain, AllocFlags flags) {
+        return gPageAllocator->allocatePageRuns(count, runs, maxRuns, runCount, targetDomain, flags);
+    }
+
+    void freePageRuns(const PageRef* runs, size_t count) {
+        gPageAllocator->freePageRuns(runs, count);
+    }
+
+    // ---- Cache coloring ----
+
+    size_t colorsForCache(const arch::CacheGeometry& cache) {
+        const size_t waySpan = cache.waySizeBytes() / arch::smallPageSize;
+        if (waySpan <= 1) return 1;
+        return min(1ul << log2floor(static_cast<uint64_t>(waySpan)), smallPagesPerBigPage);
+    }
+
+    size_t pageColorCount() {
+        return gPageAllocator->pageColors;
+    }
+
+    size_t allocateColoredPages(size_t count, FunctionRef<void(PageRef)> cb, PageColorCursor& cursor, AllocFlags flags) {
+        if (flags.has(AllocBehavior::GIGANTIC_PAGE_ONLY) || flags.has(AllocBehavior::BIG_PAGE_ONLY))
+            return allocatePages(count, cb, flags);
+        return gPageAllocator->allocateColoredPages(count, cb, cursor, flags);
+    }
+
+    // ---- Per-frame descriptors ----
+
+    PageFrame* frameFor(phys_addr addr) {
+        return gPageAllocator->frameFor(addr);
+    }
+
+    // ---- Physically contiguous allocation ----
+
+    Optional<phys_addr> allocateContiguous(size_t count, size_t alignment, numa::DomainID targetDomain, AllocFlags flags) {
+        return gPageAllocator->allocateContiguous(count, alignment, targetDomain, flags);
+    }
+
+    void freeContiguous(phys_addr base, size_t count) {
+        gPageAllocator->freeContiguous(base, count);
+    }
+
+    // ---- Page zeroing ----
+
+    void setPageZeroer(PageZeroer zeroer) {
+        gPageAllocator->pageZeroer = zeroer;
+    }
+
+    size_t zeroIdlePages(size_t maxBigPages) {
+        return gPageAllocator->zeroFreePages(maxBigPages);
+    }
+
+    // ---- Emergency reserve and watermarks ----
+
+    size_t refillReserve() {
+        const size_t added = gPageAllocator->refillReserve(arch::getCurrentProcessorID());
+        gPageAllocator->runLowWatermarkCallbacks();
+        return added;
+    }
+
+    bool addLowWatermarkCallback(LowWatermarkCallback callback) {
+        return gPageAllocator->addLowWatermarkCallback(callback);
+    }
+
+    // ---- Deferred initialization ----
+
+    void initializeDeferredPages() {
+        gPageAllocator->initializeDeferredPages(arch::getCurrentProcessorID());
+    }
+
+    // ---- Statistics ----
+
+    MemoryStatistics getStatistics() {
+        return gPageAllocator->getStatistics();
+    }
 }
@@ -4,6 +4,7 @@
 
 #include <mem/VMSubstrate.h>
 #include <mem/mm.h>
+#include <mem/FlushPlanner.h>
 #include <arch.h>
 
 #include <kmemlayout.h>
@@ -18,20 +19,17 @@ namespace VMSubstrateHelper{
     // Wraps the bottom-level page table (arch::PageTable<leafLevel>) with two
     // 512-bit occupancy bitmaps embedded in the topmost 32 reserved entries:
     //
-    //   PTEs 0–(N-1)  leaf entries mapping per-CPU dirty-bitmap pages  (N = dirtyWordCount())
     //   PTEs 480–495  allocBitmap words 0–15  (plain uint32_t, allocator-only)
     //   PTEs 496–511  freeBitmap words 0–15   (Atomic<uint32_t>, any freeing CPU)
     //   PTE  511      also holds freeWordCount in its uint16_t field
+    //   PTE  510      also holds liveCount in its uint16_t field
     //
-    // Each dirty-bitmap page (4 KiB) holds one Atomic<uint64_t> per leaf-PT entry (8 bytes × 512).
-    // The dirty word for entry k and CPU word dw is at virtual address:
-    //     tableBase + dw * smallPageSize + k * sizeof(uint64_t)
-    // where tableBase is the 2 MiB-aligned virtual base of the range this leaf PT covers.
-    // Dirty pages are installed by the caller immediately after construction.
+    // Word i covers PTE indices [i*32, i*32+32).  Words 0–14 (covering PTEs 0–479)
+    // start fully set; word 15 (covering the 32 reserved PTEs) is permanently 0.
     //
-    // Word i covers PTE indices [i*32, i*32+32).  Words 1–14 (covering PTEs 32–479)
-    // start fully set; word 0 starts with bits [N, 32) set (bits 0..N-1 cleared by the
-    // dirty-bitmap reservation); word 15 (covering the 32 reserved PTEs) is permanently 0.
+    // liveCount is the number of mapped entries.  The allocator raises it when it claims
+    // entries; a freeing CPU lowers it as its very last access to the table, so a table whose
+    // liveCount reads 0 is untouched by anyone and its owner may reclaim it.
     //
     // freeWordCount ∈ [0, 32]: counts words with ≥1 free bit across both bitmaps.
     // It changes only at two sites:
@@ -42,16 +40,23 @@ namespace VMSubstrateHelper{
     // from the counter's perspective.
 
     constexpr size_t leafLevel      = arch::pageTableDescriptor.LEVEL_COUNT - 1;
+    constexpr size_t bigLevel       = leafLevel - 1;                  // level whose leaf entries map big pages
     constexpr size_t wordWidth      = 32;
     constexpr size_t kEntryCount    = arch::pageTableDescriptor.entryCount[leafLevel]; // 512
     constexpr size_t kBitmapWords   = kEntryCount / wordWidth;               // 512 bits / 32 per word
     constexpr size_t kUsableEntries = kEntryCount - 2 * kBitmapWords; // 480
     constexpr size_t kAllocStart    = kUsableEntries;                 // first allocBitmap PTE (480)
     constexpr size_t kFreeStart     = kUsableEntries + kBitmapWords;  // first freeBitmap PTE (496)
+    static_assert(kUsableEntries == kernel::mm::VMSubstrate::maxPagesPerRun);
+    static_assert(kEntryCount * arch::smallPageSize == arch::bigPageSize);
 
     using LeafPTE  = arch::PTE<leafLevel>;
     using LeafMeta = arch::PTEMetadataEntry<arch::pageTableDescriptor.levels[leafLevel]>;
 
+    // Constructor tag for a table built on a page that already reads as zero (a ZEROED
+    // allocation), which lets the constructor skip clearing it again.
+    struct ZeroedPage {};
+
     struct LeafPageTableWrapper {
         arch::PageTable<leafLevel> table;
 
@@ -71,12 +76,9 @@ namespace VMSubstrateHelper{
         Atomic<uint16_t>& freeWordCount() {
             return metaAt(kEntryCount - 1).atomicU16();
         }
-
-        static size_t dirtyWordCount() {
-            return divideAndRoundUp(arch::processorCount(), static_cast<size_t>(64));
+        Atomic<uint16_t>& liveCount() {
+            return metaAt(kEntryCount - 2).atomicU16();
         }
-        static size_t dirtyCPUWord(size_t cpu) { return cpu / 64; }
-        static uint64_t dirtyCPUBit(size_t cpu) { return uint64_t{1} << (cpu % 64); }
 
         void reserveEntry(size_t index) {
             const auto wordIndex = divideAndRoundDown(index, static_cast<size_t>(wordWidth));
@@ -97,14 +99,19 @@ namespace VMSubstrateHelper{
         // and every reserved (bitmap) slot permanently unavailable.
         LeafPageTableWrapper() {
             memset(&table, 0, sizeof(table));
+            initBitmaps();
+        }
+
+        explicit LeafPageTableWrapper(ZeroedPage) {
+            initBitmaps();
+        }
+
+        void initBitmaps() {
             freeWordCount().store(kBitmapWords, RELAXED);
             for (size_t i = 0; i < kBitmapWords; i++)
                 allocWord(i) = UINT32_MAX;
             for (size_t i = kUsableEntries; i < kEntryCount; i++)
                 reserveEntry(i);
-            const size_t dirtyWords = dirtyWordCount();
-            for (size_t i = 0; i < dirtyWords; i++)
-                reserveEntry(i);
         }
 
         // ── Alloc / free ─────────────────────────────────────────────────────
@@ -143,6 +150,52 @@ namespace VMSubstrateHelper{
             return {nullptr, false};
         }
 
+        // Claim count adjacent free entries, lowest run first.  Allocator-CPU only.
+        // Every freed entry is drained into allocBitmap before the search so a run can span
+        // entries freed by other CPUs.  A word with free bits in both bitmaps holds two credits
+        // in freeWordCount, so merging it gives one back.
+        ClaimResult claimFreeRun(size_t count) {
+            for (size_t w = 0; w < kBitmapWords; w++) {
+                const uint32_t freed = freeWord(w).exchange(0, ACQ_REL);
+                if (!freed) continue;
+                if (allocWord(w)) freeWordCount().sub_fetch(1, RELAXED);
+                allocWord(w) |= freed;
+            }
+
+            size_t runStart = 0;
+            size_t runLength = 0;
+            for (size_t index = 0; index < kUsableEntries && runLength < count; index++) {
+                const uint32_t word = allocWord(index / wordWidth);
+                if (word == UINT32_MAX && index % wordWidth == 0 && runLength + wordWidth <= count) {
+                    if (runLength == 0) runStart = index;
+                    runLength += wordWidth;
+                    index += wordWidth - 1;
+                } else if (word & (1u << (index % wordWidth))) {
+                    if (runLength++ == 0) runStart = index;
+                } else {
+                    runLength = 0;
+                }
+            }
+            if (runLength < count) return {nullptr, false};
+
+            const size_t runEnd = runStart + count;
+            size_t emptiedWords = 0;
+            for (size_t w = runStart / wordWidth; w * wordWidth < runEnd; w++) {
+                const size_t lo = max(runStart, w * wordWidth) - w * wordWidth;
+                const size_t hi = min(runEnd, (w + 1) * wordWidth) - w * wordWidth;
+                const uint32_t mask = (hi - lo == wordWidth) ? UINT32_MAX : ((1u << (hi - lo)) - 1) << lo;
+                const uint32_t prev = allocWord(w);
+                allocWord(w) = prev & ~mask;
+                if (prev && !allocWord(w)) emptiedWords++;
+            }
+            bool becameFull = false;
+            if (emptiedWords) {
+                const uint16_t prev = freeWordCount().fetch_sub(static_cast<uint16_t>(emptiedWords), ACQ_REL);
+                becameFull = (prev == emptiedWords);
+            }
+            return {&table[runStart], becameFull};
+        }
+
         // Free a previously claimed entry.  May be called from any CPU.
         // Returns true if the table transitioned from full to available.
         bool freeEntry(LeafPTE* entry) {
@@ -165,12 +218,16 @@ namespace VMSubstrateHelper{
     //
     //   PTEs 496–511  bitmap words 0–15  (Atomic<uint32_t>, all mutators)
     //   PTE  511      also holds freeWordCount in its uint16_t field
+    //   PTE  510      also holds liveCount in its uint16_t field
     //
     // 496 usable entries (0–495).  Word 15 is partial: bits 0–15 cover usable
     // entries 480–495; bits 16–31 are permanently 0 (reserved entries 496–511).
     //
     // freeWordCount ∈ [0, 16]: counts words with ≥1 free bit.
     //
+    // liveCount is the number of present entries (subtables and big pages), kept as for the
+    // leaf wrapper.  The root's self-reference is not counted.
+    //
     // Three-operation API (intentionally separated so the caller can write a
     // subtable pointer into the entry between find and mark):
     //   findFreeEntry   — read-only scan, no bitmap mutation
@@ -200,6 +257,9 @@ namespace VMSubstrateHelper{
         Atomic<uint16_t>& freeWordCount() {
             return metaAt(kEntryCount - 1).atomicU16();
         }
+        Atomic<uint16_t>& liveCount() {
+            return metaAt(kEntryCount - 2).atomicU16();
+        }
 
         void reserveEntry(size_t index) {
             const size_t w = index / wordWidth;
@@ -211,6 +271,14 @@ namespace VMSubstrateHelper{
 
         UpperPageTableWrapper() {
             memset(&table, 0, sizeof(table));
+            initBitmaps();
+        }
+
+        explicit UpperPageTableWrapper(ZeroedPage) {
+            initBitmaps();
+        }
+
+        void initBitmaps() {
             for (size_t i = 0; i < kBitmapWords; i++)
                 bitmapWord(i).store(UINT32_MAX, RELAXED);
             for (size_t i = kUpperUsable; i < kEntryCount; i++)
@@ -226,14 +294,34 @@ namespace VMSubstrateHelper{
         // Scan for any free entry.  Allocator-CPU only; does not mutate the bitmap.
         // Returns nullptr when the table is full.
         UpperPTE* findFreeEntry() {
-            for (size_t w = 0; w < kBitmapWords; w++) {
-                const uint32_t val = bitmapWord(w).load(ACQUIRE);
+            return findFreeEntryFrom(0);
+        }
+
+        // As findFreeEntry, but only considers entries at or above startIndex.
+        UpperPTE* findFreeEntryFrom(size_t startIndex) {
+            for (size_t w = startIndex / wordWidth; w < kBitmapWords; w++) {
+                uint32_t val = bitmapWord(w).load(ACQUIRE);
+                if (w == startIndex / wordWidth)
+                    val &= UINT32_MAX << (startIndex % wordWidth);
                 if (!val) continue;
                 return &table[w * wordWidth + static_cast<size_t>(__builtin_ctz(val))];
             }
             return nullptr;
         }
 
+        // Scan for a free entry with nothing installed under it, which can take a leaf mapping
+        // of this level's page size.  Allocator-CPU only; does not mutate the bitmap.
+        UpperPTE* findUnusedEntry() {
+            for (UpperPTE* entry = findFreeEntry(); entry; entry = findFreeEntryFrom(indexOf(entry) + 1)) {
+                if (!entry->isPresent()) return entry;
+            }
+            return nullptr;
+        }
+
+        size_t indexOf(const UpperPTE* entry) const {
+            return static_cast<size_t>(entry - table.data);
+        }
+
         // Mark a free entry as used (XOR 1→0).  Allocator-CPU only.
         // Returns true if the table transitioned to full.
         bool markEntryUsed(UpperPTE* entry) {
@@ -266,10 +354,14 @@ namespace VMSubstrateHelper{
     };
 
     template <size_t level>
-    struct PageTableWrapper : UpperPageTableWrapper<level> {};
+    struct PageTableWrapper : UpperPageTableWrapper<level> {
+        using UpperPageTableWrapper<level>::UpperPageTableWrapper;
+    };
 
     template <>
-    struct PageTableWrapper<leafLevel> : LeafPageTableWrapper {};
+    struct PageTableWrapper<leafLevel> : LeafPageTableWrapper {
+        using LeafPageTableWrapper::LeafPageTableWrapper;
+    };
 
     static_assert([]() {
         for (size_t i = 1; i < arch::pageTableDescriptor.LEVEL_COUNT; i++)
@@ -287,11 +379,67 @@ namespace kernel::mm::VMSubstrate {
     Atomic<size_t> freeArenaIndex = 0;
     WITH_GLOBAL_CONSTRUCTOR(Spinlock, arenaCreationLock);
 
+    // ── TLB freshness ───────────────────────────────────────────────────────
+    //
+    // Arena i belongs to CPU i. Only that CPU maps pages into it, and it invalidates each new
+    // mapping locally.
+    // Other CPUs can still hold a stale translation for a slot that was unmapped and then
+    // mapped again. Each arena therefore has a mapping generation that its owner bumps with a
+    // plain store per mapping. Each CPU keeps, for every arena, the generation its TLB was last
+    // flushed through. A dereference on a CPU whose recorded generation for the arena is
+    // behind flushes that CPU's TLB once and catches it up on every arena.
+
+    struct alignas(arch::CACHE_LINE_SIZE) ArenaGeneration {
+        Atomic<uint64_t> value;
+    };
+    ArenaGeneration arenaGenerations[arch::MAX_PROCESSOR_COUNT];
+
+    // One page per CPU, indexed by arena and written only by that CPU. Allocated in init().
+    uint64_t* flushedGenerations[arch::MAX_PROCESSOR_COUNT];
+    static_assert(arch::MAX_PROCESSOR_COUNT * sizeof(uint64_t) <= arch::smallPageSize);
+
+    // ── Page table reclamation ──────────────────────────────────────────────
+    //
+    // Any CPU may empty a page table by unmapping its last entry, but only the arena's owner
+    // edits the tree's shape, so the emptying CPU just raises the arena's hint. The owner
+    // then sweeps the tree on its next allocation (or from reclaimPageTables), unhooks every
+    // table whose liveCount has dropped to 0 and hands the pages to the page allocator to free
+    // once every CPU has flushed its TLB past the unhooking. The first table present under each parent
+    // is always kept, since allocation fills lowest entries first and it is the one a burst
+    // would otherwise rebuild straight away.
+
+    struct alignas(arch::CACHE_LINE_SIZE) ArenaReclaimHint {
+        Atomic<bool> pending;
+    };
+    ArenaReclaimHint reclaimHints[arch::MAX_PROCESSOR_COUNT];
+
+    // Table pages handed to the page allocator per deferred free during a sweep.
+    constexpr size_t kReclaimBatch = 32;
+
+    // Hands pages whose mappings are gone to the page allocator, which frees them once every
+    // CPU has flushed its TLB past the unmapping. Until a TLB shootdown is registered it may
+    // not take them all; the rest go back after a flush round of our own.
+    void freeAfterTlbFlush(const PageRef* pages, size_t count) {
+        const size_t queued = PageAllocator::freePagesAfterTlbFlush(pages, count);
+        if (queued == count) return;
+        FlushPlanner planner;
+        planner.invalidateAll();
+        planner.targetAllProcessors();
+        planner.flush();
+        PageRef rest[kReclaimBatch];
+        for (size_t start = queued; start < count; start += kReclaimBatch) {
+            const size_t batch = min(kReclaimBatch, count - start);
+            for (size_t i = 0; i < batch; i++) rest[i] = pages[start + i];
+            PageAllocator::freePages(rest, batch);
+        }
+    }
+
     template <size_t level>
     phys_addr initializePageTable(arch::ProcessorID cpu, phys_addr subtable = phys_addr(nullptr)) requires (level >= pageTableLevelForKMemRegion()) && (level < arch::pageTableDescriptor.LEVEL_COUNT){
-        const auto ptaddr = PageAllocator::allocateSmallPage(cpu);
+        phys_addr ptaddr{};
+        PageAllocator::allocatePages(1, [&](PageRef page) { ptaddr = page.addr(); }, cpu, AllocBehavior::ZEROED);
         TempWindow<VMSubstrateHelper::PageTableWrapper<level>> window(ptaddr);
-        auto* pageTablePtr = new (&*window)VMSubstrateHelper::PageTableWrapper<level>();
+        auto* pageTablePtr = new (&*window)VMSubstrateHelper::PageTableWrapper<level>(VMSubstrateHelper::ZeroedPage{});
         using Flag = arch::PageEntryFlag;
         constexpr auto kSubtableFlags = Flag::Write | Flag::Global | Flag::NoExecute;
         if constexpr (level == pageTableLevelForKMemRegion()) {
@@ -300,20 +448,15 @@ namespace kernel::mm::VMSubstrate {
             pageTablePtr->reserveEntry(0);  // self-ref: permanently off-limits for allocation
             auto& first = pageTablePtr->table[1];
             first = arch::PTE<level>::subtableEntry(subtable, kSubtableFlags);
+            pageTablePtr->liveCount().store(1, RELAXED);
 
             assert(selfRef.isPresent(), "AAAA");
             assert(first.isPresent(), "AAAA");
             // PD[1] keeps its bitmap bit = 1: the newly installed PT has free entries
-        } else if constexpr (level == arch::pageTableDescriptor.LEVEL_COUNT - 1) {
-            // Install per-CPU dirty-bitmap pages at entries 0..dirtyWordCount()-1.
-            const size_t dirtyWords = VMSubstrateHelper::LeafPageTableWrapper::dirtyWordCount();
-            for (size_t dw = 0; dw < dirtyWords; dw++) {
-                const phys_addr dirtyPhys = PageAllocator::allocateSmallPage(cpu);
-                pageTablePtr->table[dw] = arch::PTE<level>::leafEntry(dirtyPhys, kSubtableFlags);
-            }
-        } else {
+        } else if constexpr (level < arch::pageTableDescriptor.LEVEL_COUNT - 1) {
             auto& entry = pageTablePtr->table[0];
             entry = arch::PTE<level>::subtableEntry(subtable, kSubtableFlags);
+            pageTablePtr->liveCount().store(1, RELAXED);
         }
         return ptaddr;
     }
@@ -352,6 +495,11 @@ namespace kernel::mm::VMSubstrate {
             return VMSubstrateArena{virt_addr{roundDownToNearestMultiple(ptrAddr, getKernelMemRegionSize())}};
         }
 
+        // Arena i belongs to CPU i.
+        [[nodiscard]] size_t index() const {
+            return (baseAddr_ - arenaVirtualBase(0).value) / getKernelMemRegionSize();
+        }
+
     private:
         uint64_t baseAddr_;
 
@@ -369,82 +517,131 @@ namespace kernel::mm::VMSubstrate {
             return reinterpret_cast<void*>(outAddr);
         }
 
+        // Inverse of getChildAddr: the address of the entry one level up that maps addr.
+        [[nodiscard]] uint64_t getParentEntryAddr(uint64_t addr) const {
+            return (addr - base().value) / arch::pageTableDescriptor.entryCount[0] + base().value;
+        }
+
+        // Every other CPU's TLB is now behind on this arena. We are the only writer, so a
+        // plain store suffices; the caller invalidates the new mapping in our own TLB. Only
+        // mappings other CPUs can reach are published. A private window needs none: no other
+        // CPU touches it, and the next shared mapping of its slot is published anyway.
+        void publishMapping() {
+            auto& generation = arenaGenerations[index()].value;
+            generation.store(generation.load(RELAXED) + 1, RELEASE);
+        }
+
+        // Returns the table under entry, installing an empty one first if there is none.
+        template <size_t n>
+        PT<n + 1>* ensureSubtable(PT<n>& table, PTE<n>* entry) {
+            using Flag = arch::PageEntryFlag;
+            constexpr auto kFlags = Flag::Write | Flag::Global | Flag::NoExecute;
+            auto* child = reinterpret_cast<PT<n + 1>*>(getChildAddr(entry));
+            if (!entry->isPresent()) {
+                // Not a ZEROED allocation: the zeroer maps its windows through this very arena.
+                const phys_addr physAddr = PageAllocator::allocateSmallPage(arch::getCurrentProcessorID());
+                *entry = PTE<n>::subtableEntry(physAddr, kFlags);
+                // The slot may have held a reclaimed table, whose translation we could still cache.
+                arch::invlpg(virt_addr{reinterpret_cast<uint64_t>(child)});
+                new (child) PT<n + 1>();
+                table.liveCount().add_fetch(1, RELAXED);
+            }
+            return child;
+        }
+
+        // Offers a request to each child of table that has free entries, in index order, until
+        // allocInChild(child, childBecameFull) succeeds.  Any such child can take a single page,
+        // so only runs and big pages ever look past the first.  outBecameFull is set as for
+        // allocFromLevel.
+        template <size_t n, typename AllocInChild>
+        void* allocFromChildren(PT<n>& table, bool& outBecameFull, AllocInChild&& allocInChild) {
+            outBecameFull = false;
+            for (PTE<n>* entry = table.findFreeEntry(); entry; entry = table.findFreeEntryFrom(table.indexOf(entry) + 1)) {
+                bool childBecameFull = false;
+                void* result = allocInChild(*ensureSubtable<n>(table, entry), childBecameFull);
+                if (!result) continue;
+                if (childBecameFull)
+                    outBecameFull = table.markEntryUsed(entry);
+                return result;
+            }
+            return nullptr;
+        }
+
         // Recursive allocator: walks the arena page table tree from level n down to the leaf,
-        // installing new sub-tables as needed.  Returns the mapped virtual address on success
-        // or nullptr if the arena is full.  outBecameFull is set to true if this call caused
-        // the table at level n to transition from available → full.
-        // mmioAddr: non-zero → map that physical address with CacheDisable (for MMIO);
-        //           zero    → allocate a new physical page normally.
+        // installing new sub-tables as needed, and maps count virtually adjacent pages within
+        // one leaf table.  Returns the first mapped virtual address on success or nullptr if no
+        // leaf table has a long enough free run.  outBecameFull is set to true if this call
+        // caused the table at level n to transition from available → full.
+        // fixedAddr: set        → map the physical pages from there on (CacheDisable if cacheDisable, for MMIO);
+        //            UINT64_MAX → allocate new physical pages normally.
         template <size_t n>
-        void* allocFromLevel(PT<n>& table, bool& outBecameFull, phys_addr mmioAddr = phys_addr(UINT64_MAX)) {
+        void* allocFromLevel(PT<n>& table, bool& outBecameFull, size_t count = 1,
+                             phys_addr fixedAddr = phys_addr(UINT64_MAX), bool cacheDisable = false) {
             using Flag = arch::PageEntryFlag;
             constexpr auto kFlags = Flag::Write | Flag::Global | Flag::NoExecute;
 
             if constexpr (n == VMSubstrateHelper::leafLevel) {
-                auto [entry, becameFull] = table.claimFreeEntry();
-                if (!entry) { outBecameFull = false; return nullptr; }
-                const bool isMMIO = mmioAddr.value != UINT64_MAX;
-                const phys_addr paddr = isMMIO ? mmioAddr
-                    : PageAllocator::allocateSmallPage(arch::getCurrentProcessorID());
-                *entry = PTE<n>::leafEntry(paddr, isMMIO ? kFlags | Flag::CacheDisable : kFlags);
-                // Notify all other CPUs that this mapping is new and their TLBs are stale.
-                using LPT = VMSubstrateHelper::LeafPageTableWrapper;
-                void* result = getChildAddr(entry);
-                const auto resultAddr = reinterpret_cast<uint64_t>(result);
-                const auto tableBase = roundDownToNearestMultiple(resultAddr, arch::bigPageSize);
-                const size_t k_abs = (resultAddr - tableBase) / arch::smallPageSize;
-                const size_t myCPU = arch::getCurrentProcessorID();
-                for (size_t dw = 0; dw < LPT::dirtyWordCount(); dw++) {
-                    const uint64_t mask = (LPT::dirtyCPUWord(myCPU) == dw)
-                        ? UINT64_MAX & ~LPT::dirtyCPUBit(myCPU)
-                        : UINT64_MAX;
-                    if (mask) {
-                        auto& dirtyEntry = *reinterpret_cast<Atomic<uint64_t>*>(
-                            tableBase + dw * arch::smallPageSize + k_abs * sizeof(uint64_t));
-                        dirtyEntry.fetch_or(mask, RELEASE);
-                    }
+                auto [first, becameFull] = count == 1 ? table.claimFreeEntry() : table.claimFreeRun(count);
+                if (!first) { outBecameFull = false; return nullptr; }
+                table.liveCount().add_fetch(static_cast<uint16_t>(count), RELAXED);
+                const auto flags = cacheDisable ? kFlags | Flag::CacheDisable : kFlags;
+                if (fixedAddr.value != UINT64_MAX) {
+                    for (size_t i = 0; i < count; i++)
+                        first[i] = PTE<n>::leafEntry(fixedAddr + i * arch::smallPageSize, flags);
+                } else if (count == 1) {
+                    *first = PTE<n>::leafEntry(PageAllocator::allocateSmallPage(arch::getCurrentProcessorID()), flags);
+                } else {
+                    size_t mapped = 0;
+                    PageAllocator::allocatePages(count, [&](PageRef page) {
+                        assert(page.size() == PageSize::SMALL, "Run shorter than a big page got a big page");
+                        first[mapped++] = PTE<n>::leafEntry(page.addr(), flags);
+                    }, arch::getCurrentProcessorID());
                 }
                 outBecameFull = becameFull;
-                return result;
+                return getChildAddr(first);
             } else {
-                PTE<n>* entry = table.findFreeEntry();
-                if (!entry) { outBecameFull = false; return nullptr; }
+                return allocFromChildren<n>(table, outBecameFull, [&](PT<n + 1>& child, bool& childBecameFull) {
+                    return allocFromLevel<n + 1>(child, childBecameFull, count, fixedAddr, cacheDisable);
+                });
+            }
+        }
 
-                auto* child = reinterpret_cast<PT<n + 1>*>(getChildAddr(entry));
-                if (!entry->isPresent()) {
-                    const phys_addr physAddr = PageAllocator::allocateSmallPage(arch::getCurrentProcessorID());
-                    *entry = PTE<n>::subtableEntry(physAddr, kFlags);
-                    arch::invlpg(virt_addr{reinterpret_cast<uint64_t>(child)});
-                    new (child) PT<n + 1>();
-                    if constexpr (n + 1 == VMSubstrateHelper::leafLevel) {
-                        using LPT = VMSubstrateHelper::LeafPageTableWrapper;
-                        const auto tableBase = reinterpret_cast<uint64_t>(getChildAddr(child));
-                        for (size_t dw = 0; dw < LPT::dirtyWordCount(); dw++) {
-                            const phys_addr dirtyPhys = PageAllocator::allocateSmallPage(
-                                arch::getCurrentProcessorID());
-                            child->table[dw] = PTE<n + 1>::leafEntry(dirtyPhys, kFlags);
-                            arch::invlpg(virt_addr{tableBase + dw * arch::smallPageSize});
-                        }
-                    }
-                }
+        // Big-page counterpart of allocFromLevel: maps one big page with a leaf entry at
+        // bigLevel, which must be free with no subtable under it.
+        template <size_t n>
+        void* allocBigFromLevel(PT<n>& table, bool& outBecameFull, phys_addr fixedAddr = phys_addr(UINT64_MAX),
+                                bool cacheDisable = false) {
+            using Flag = arch::PageEntryFlag;
+            constexpr auto kFlags = Flag::Write | Flag::Global | Flag::NoExecute;
 
-                bool childBecameFull = false;
-                void* result = allocFromLevel<n + 1>(*child, childBecameFull, mmioAddr);
-                if (childBecameFull)
-                    outBecameFull = table.markEntryUsed(entry);
-                else
-                    outBecameFull = false;
-                return result;
+            if constexpr (n == VMSubstrateHelper::bigLevel) {
+                PTE<n>* entry = table.findUnusedEntry();
+                if (!entry) { outBecameFull = false; return nullptr; }
+                const phys_addr paddr = fixedAddr.value != UINT64_MAX ? fixedAddr
+                    : PageAllocator::allocateBigPage(arch::getCurrentProcessorID());
+                *entry = PTE<n>::leafEntry(paddr, cacheDisable ? kFlags | Flag::CacheDisable : kFlags);
+                table.liveCount().add_fetch(1, RELAXED);
+                outBecameFull = table.markEntryUsed(entry);
+                return getChildAddr(getChildAddr(entry));
+            } else {
+                return allocFromChildren<n>(table, outBecameFull, [&](PT<n + 1>& child, bool& childBecameFull) {
+                    return allocBigFromLevel<n + 1>(child, childBecameFull, fixedAddr, cacheDisable);
+                });
             }
         }
 
+        // Invalidates a freshly mapped run in our own TLB.
+        static void invalidateLocally(void* first, size_t count) {
+            FlushPlanner planner;
+            planner.invalidate(virt_addr(first), count);
+            planner.flush();
+        }
+
         // Propagates a "became available" signal up the tree after a child table transitions
-        // from full to having free entries.  Intermediate tables are never freed.
+        // from full to having free entries.
         template <size_t n>
         void propagateAvailability(PT<n + 1>& childTable) {
-            constexpr size_t entryCount = arch::pageTableDescriptor.entryCount[0];
-            const auto childAddr = reinterpret_cast<uint64_t>(&childTable);
-            const auto parentEntryAddr = (childAddr - base().value) / entryCount + base().value;
+            const auto parentEntryAddr = getParentEntryAddr(reinterpret_cast<uint64_t>(&childTable));
             auto& parentEntry = *reinterpret_cast<PTE<n>*>(parentEntryAddr);
             const auto parentTableAddr = roundDownToNearestMultiple(parentEntryAddr, sizeof(PT<n>));
             PT<n>& parentTable = *reinterpret_cast<PT<n>*>(parentTableAddr);
@@ -455,52 +652,433 @@ namespace kernel::mm::VMSubstrate {
             }
         }
 
+        // Drops one entry from table's liveCount.  This must be the caller's last access to the
+        // table or any above it, since once the count reaches 0 the owner may reclaim them.
+        template <size_t n>
+        void releaseEntry(PT<n>& table) {
+            if (table.liveCount().sub_fetch(1, ACQ_REL) == 0)
+                reclaimHints[index()].pending.store(true, RELEASE);
+        }
+
+        // Table pages unhooked by a sweep, passed on to the page allocator in batches.
+        struct ReclaimedTables {
+            PageRef pages[kReclaimBatch];
+            size_t count = 0;
+            size_t total = 0;
+
+            void add(phys_addr page) {
+                pages[count++] = PageRef::small(page);
+                total++;
+                if (count == kReclaimBatch) release();
+            }
+            // Any CPU may still cache translations through the unhooked tables. Only full
+            // flushes are reported to the page allocator, and those also drop the
+            // paging-structure caches, so the pages wait for one on every CPU.
+            void release() {
+                if (count == 0) return;
+                freeAfterTlbFlush(pages, count);
+                count = 0;
+            }
+        };
+
+        // Unhooks every empty table below table, deepest first, so a parent emptied by losing
+        // its children goes in the same sweep.  Owner only.
+        template <size_t n>
+        void reclaimEmptyChildren(PT<n>& table, ReclaimedTables& reclaimed) {
+            bool keptFirst = false;
+            for (size_t i = 0; i < VMSubstrateHelper::kUpperUsable; i++) {
+                PTE<n>* entry = &table.table[i];
+                if (!entry->isPresent() || entry->isLeafEntry())
+                    continue;
+                if (n == pageTableLevelForKMemRegion() && i == 0)
+                    continue;  // self-reference
+                auto& child = *reinterpret_cast<PT<n + 1>*>(getChildAddr(entry));
+                if constexpr (n + 1 < VMSubstrateHelper::leafLevel)
+                    reclaimEmptyChildren<n + 1>(child, reclaimed);
+                if (!keptFirst) {
+                    keptFirst = true;
+                    continue;
+                }
+                if (child.liveCount().load(ACQUIRE) != 0)
+                    continue;
+                // Nothing is mapped under child, so its bit in our bitmap is already free and
+                // the slot simply reads as absent from now on.
+                const phys_addr physAddr = entry->getPhysicalAddress();
+                *entry = PTE<n>{};
+                table.liveCount().sub_fetch(1, RELAXED);
+                reclaimed.add(physAddr);
+            }
+        }
+
     public:
         void* allocPage() {
             bool ignored = false;
             const auto out = allocFromLevel<pageTableLevelForKMemRegion()>(root(), ignored);
             arch::invlpg(virt_addr(out));
+            if (out) publishMapping();
+            return out;
+        }
+
+        void* allocPages(size_t count) {
+            bool ignored = false;
+            const auto out = allocFromLevel<pageTableLevelForKMemRegion()>(root(), ignored, count);
+            if (out) {
+                invalidateLocally(out, count);
+                publishMapping();
+            }
+            return out;
+        }
+
+        void* allocBigPage() {
+            bool ignored = false;
+            const auto out = allocBigFromLevel<pageTableLevelForKMemRegion()>(root(), ignored);
+            if (out) {
+                arch::invlpg(virt_addr(out));
+                publishMapping();
+            }
             return out;
         }
 
         void* mapMMIOPage(phys_addr paddr) {
             assert(paddr.value % arch::smallPageSize == 0, "Misaligned MMIO physical address");
             bool ignored = false;
-            const auto out = allocFromLevel<pageTableLevelForKMemRegion()>(root(), ignored, paddr);
+            const auto out = allocFromLevel<pageTableLevelForKMemRegion()>(root(), ignored, 1, paddr, true);
             arch::invlpg(virt_addr(out));
+            if (out) publishMapping();
             return out;
         }
 
-        void freePage(void* ptr) {
-            constexpr size_t entryCount = arch::pageTableDescriptor.entryCount[0];
+        void* mapMMIOPages(phys_addr paddr, size_t count) {
+            assert(paddr.value % arch::smallPageSize == 0, "Misaligned MMIO physical address");
+            bool ignored = false;
+            const auto out = allocFromLevel<pageTableLevelForKMemRegion()>(root(), ignored, count, paddr, true);
+            if (out) {
+                invalidateLocally(out, count);
+                publishMapping();
+            }
+            return out;
+        }
+
+        void* mapMMIOBigPage(phys_addr paddr) {
+            assert(paddr.value % arch::bigPageSize == 0, "Misaligned MMIO physical address");
+            bool ignored = false;
+            const auto out = allocBigFromLevel<pageTableLevelForKMemRegion()>(root(), ignored, paddr, true);
+            if (out) {
+                arch::invlpg(virt_addr(out));
+                publishMapping();
+            }
+            return out;
+        }
+
+        // Temporarily maps an existing (cacheable) physical page; release it with unmapPage.
+        void* mapPhysicalPage(phys_addr paddr) {
+            assert(paddr.value % arch::smallPageSize == 0, "Misaligned physical address");
+            bool ignored = false;
+            const auto out = allocFromLevel<pageTableLevelForKMemRegion()>(root(), ignored, 1, paddr);
+            arch::invlpg(virt_addr(out));
+            return out;
+        }
+
+        // Run and big-page counterparts of mapPhysicalPage; release with unmapPage or
+        // unmapBigPage. Both return nullptr when the arena has no room for the window.
+        void* mapPhysicalPages(phys_addr paddr, size_t count) {
+            assert(paddr.value % arch::smallPageSize == 0, "Misaligned physical address");
+            bool ignored = false;
+            const auto out = allocFromLevel<pageTableLevelForKMemRegion()>(root(), ignored, count, paddr);
+            if (out) invalidateLocally(out, count);
+            return out;
+        }
+
+        void* mapPhysicalBigPage(phys_addr paddr) {
+            assert(paddr.value % arch::bigPageSize == 0, "Misaligned physical address");
+            bool ignored = false;
+            const auto out = allocBigFromLevel<pageTableLevelForKMemRegion()>(root(), ignored, paddr);
+            if (out) arch::invlpg(virt_addr(out));
+            return out;
+        }
+
+        // Removes the mapping at ptr and returns the physical page it pointed to, leaving
+        // that page allocated. The stale translation is queued on planner, and the page must
+        // not be reused before the planner has flushed.
+        phys_addr unmapPage(void* ptr, FlushPlanner& planner) {
             const auto ptrAddr = reinterpret_cast<uint64_t>(ptr);
-            const auto leafPTEAddr = (ptrAddr - base().value) / entryCount + base().value;
+            const auto leafPTEAddr = getParentEntryAddr(ptrAddr);
             auto& leafEntry = *reinterpret_cast<PTE<VMSubstrateHelper::leafLevel>*>(leafPTEAddr);
 
             const phys_addr physAddr = leafEntry.getPhysicalAddress();
             leafEntry = PTE<VMSubstrateHelper::leafLevel>{};
-            arch::invlpg(virt_addr{ptrAddr});
-            PageAllocator::freeSmallPage(physAddr);
+            planner.invalidate(virt_addr{ptrAddr});
 
             const auto leafTableAddr = roundDownToNearestMultiple(leafPTEAddr, sizeof(PT<VMSubstrateHelper::leafLevel>));
             auto& leafTable = *reinterpret_cast<PT<VMSubstrateHelper::leafLevel>*>(leafTableAddr);
             if (leafTable.freeEntry(&leafEntry))
                 propagateAvailability<VMSubstrateHelper::leafLevel - 1>(leafTable);
+            releaseEntry(leafTable);
+            return physAddr;
+        }
+
+        phys_addr unmapPage(void* ptr) {
+            FlushPlanner planner;
+            const phys_addr physAddr = unmapPage(ptr, planner);
+            planner.flush();
+            return physAddr;
+        }
+
+        // Big-page counterpart of unmapPage; ptr must be the start of a page from allocBigPage.
+        phys_addr unmapBigPage(void* ptr, FlushPlanner& planner) {
+            constexpr size_t bigLevel = VMSubstrateHelper::bigLevel;
+            const auto ptrAddr = reinterpret_cast<uint64_t>(ptr);
+            assert(ptrAddr % arch::bigPageSize == 0, "Misaligned big page pointer");
+            const auto entryAddr = getParentEntryAddr(getParentEntryAddr(ptrAddr));
+            auto& entry = *reinterpret_cast<PTE<bigLevel>*>(entryAddr);
+            assert(entry.isPresent() && entry.isLeafEntry(), "Not a big page mapping");
+
+            const phys_addr physAddr = entry.getPhysicalAddress();
+            entry = PTE<bigLevel>{};
+            // One invlpg anywhere in a big page drops its whole translation.
+            planner.invalidate(virt_addr{ptrAddr});
+
+            auto& table = *reinterpret_cast<PT<bigLevel>*>(roundDownToNearestMultiple(entryAddr, sizeof(PT<bigLevel>)));
+            const bool becameAvailable = table.markEntryFree(&entry);
+            if constexpr (bigLevel > pageTableLevelForKMemRegion()) {
+                if (becameAvailable)
+                    propagateAvailability<bigLevel - 1>(table);
+            }
+            releaseEntry(table);
+            return physAddr;
+        }
+
+        void freePage(void* ptr) {
+            const PageRef page = PageRef::small(unmapPage(ptr));
+            freeAfterTlbFlush(&page, 1);
+        }
+
+        // Owner only.  Returns the number of table pages released.
+        size_t reclaimPageTables() {
+            auto& pending = reclaimHints[index()].pending;
+            // Checked on every allocation, so stay off the line unless a table emptied.
+            if (!pending.load(RELAXED) || !pending.exchange(false, ACQUIRE))
+                return 0;
+            ReclaimedTables reclaimed;
+            reclaimEmptyChildren<pageTableLevelForKMemRegion()>(root(), reclaimed);
+            reclaimed.release();
+            return reclaimed.total;
         }
     };
 
+    // Pages unmapped per local flush and deferred free by freePages.
+    constexpr size_t kFreeBatch = 64;
+
+    size_t reclaimPageTables() {
+        return VMSubstrateArena::forCurrentCPU().reclaimPageTables();
+    }
+
     void* allocPage() {
-        return VMSubstrateArena::forCurrentCPU().allocPage();
+        auto arena = VMSubstrateArena::forCurrentCPU();
+        (void)arena.reclaimPageTables();
+        return arena.allocPage();
     }
 
     void freePage(void* ptr) {
         VMSubstrateArena::forPointer(ptr).freePage(ptr);
     }
 
+    // Unmaps and frees the count pages pageAt(0..count-1).  Any CPU may still cache the old
+    // translations, so the physical pages only go back once every CPU has flushed past the
+    // unmapping; a reuse of the virtual slots is covered by the arena generation as usual.
+    template <typename PageAt>
+    void freeInBatches(size_t count, PageAt&& pageAt) {
+        for (size_t start = 0; start < count; start += kFreeBatch) {
+            const size_t batch = min(kFreeBatch, count - start);
+            PageRef physical[kFreeBatch];
+            FlushPlanner planner;
+            for (size_t i = 0; i < batch; i++) {
+                void* ptr = pageAt(start + i);
+                physical[i] = PageRef::small(VMSubstrateArena::forPointer(ptr).unmapPage(ptr, planner));
+            }
+            planner.flush();
+            freeAfterTlbFlush(physical, batch);
+        }
+    }
+
+    void freePages(void* const* pages, size_t count) {
+        freeInBatches(count, [&](size_t i) { return pages[i]; });
+    }
+
+    void* allocPages(size_t count) {
+        assert(count > 0 && count <= maxPagesPerRun, "Page run does not fit in one leaf table");
+        auto arena = VMSubstrateArena::forCurrentCPU();
+        (void)arena.reclaimPageTables();
+        return arena.allocPages(count);
+    }
+
+    void freePageRun(void* first, size_t count) {
+        const auto firstAddr = reinterpret_cast<uint64_t>(first);
+        freeInBatches(count, [&](size_t i) { return reinterpret_cast<void*>(firstAddr + i * arch::smallPageSize); });
+    }
+
+    void* allocBigPage() {
+        auto arena = VMSubstrateArena::forCurrentCPU();
+        (void)arena.reclaimPageTables();
+        return arena.allocBigPage();
+    }
+
+    void freeBigPage(void* ptr) {
+        FlushPlanner planner;
+        const PageRef page = PageRef::big(VMSubstrateArena::forPointer(ptr).unmapBigPage(ptr, planner));
+        planner.flush();
+        freeAfterTlbFlush(&page, 1);
+    }
+
     void* mapMMIOPage(phys_addr paddr) {
         return VMSubstrateArena::forCurrentCPU().mapMMIOPage(paddr);
     }
 
+    void* mapMMIOPages(phys_addr paddr, size_t count) {
+        assert(count > 0 && count <= maxPagesPerRun, "Page run does not fit in one leaf table");
+        return VMSubstrateArena::forCurrentCPU().mapMMIOPages(paddr, count);
+    }
+
+    void* mapMMIOBigPage(phys_addr paddr) {
+        return VMSubstrateArena::forCurrentCPU().mapMMIOBigPage(paddr);
+    }
+
+    // Exercises the mapping paths on the calling CPU.  The table wrappers are driven directly
+    // on scratch pages, where every claim lands at a known index; the arena is then checked
+    // end to end through runs, big pages and MMIO windows onto a page we own.
+    bool mappingSelfCheck() {
+        using namespace VMSubstrateHelper;
+        using Flag = arch::PageEntryFlag;
+
+        // Runs claimed from partial words and across word boundaries.
+        auto* leaf = new (allocPage()) PageTableWrapper<leafLevel>();
+        auto leafIndex = [&](const LeafPTE* entry) { return static_cast<size_t>(entry - leaf->table.data); };
+        assert(leafIndex(leaf->claimFreeEntry().entry) == 0, "claimFreeEntry: not the lowest entry");
+        assert(leafIndex(leaf->claimFreeRun(40).entry) == 1, "claimFreeRun: run from a partial word");
+        assert(leafIndex(leaf->claimFreeRun(30).entry) == 41, "claimFreeRun: run across a word boundary");
+        for (size_t i = 10; i < 15; i++) (void)leaf->freeEntry(&leaf->table[i]);
+        assert(leafIndex(leaf->claimFreeRun(6).entry) == 71, "claimFreeRun: run placed in a short hole");
+        // Word 2 now has free bits in both bitmaps.
+        (void)leaf->freeEntry(&leaf->table[65]);
+        assert(leafIndex(leaf->claimFreeRun(5).entry) == 10, "claimFreeRun: freed entries not drained");
+        assert(leafIndex(leaf->claimFreeEntry().entry) == 65, "claimFreeEntry: freed entry not reused");
+        const auto last = leaf->claimFreeRun(kUsableEntries - 77);
+        assert(last.entry && leafIndex(last.entry) == 77 && last.becameFull, "claimFreeRun: table not full");
+        assert(leaf->freeWordCount().load(RELAXED) == 0, "claimFreeRun: free word count drifted");
+        assert(leaf->claimFreeEntry().entry == nullptr, "claimFreeEntry: claimed from a full table");
+        assert(leaf->freeEntry(&leaf->table[200]), "freeEntry: full table did not become available");
+        assert(leaf->claimFreeRun(2).entry == nullptr, "claimFreeRun: run longer than the free space");
+        freePage(leaf);
+
+        // Big-page slots skip entries holding a subtable, whose bits stay free while it has room.
+        auto* upper = new (allocPage()) PageTableWrapper<bigLevel>();
+        using UpperPTE = arch::PTE<bigLevel>;
+        const phys_addr somewhere{arch::bigPageSize};
+        upper->table[0] = UpperPTE::subtableEntry(somewhere, Flag::Write);
+        UpperPTE* slot = upper->findUnusedEntry();
+        assert(slot == &upper->table[1], "findUnusedEntry: took a slot holding a subtable");
+        *slot = UpperPTE::leafEntry(somewhere, Flag::Write);
+        (void)upper->markEntryUsed(slot);
+        assert(upper->findUnusedEntry() == &upper->table[2], "findUnusedEntry: took a used slot");
+        *slot = UpperPTE{};
+        (void)upper->markEntryFree(slot);
+        assert(upper->findUnusedEntry() == slot, "findUnusedEntry: freed slot not reused");
+        for (size_t i = 0; i < kUpperUsable; i++)
+            upper->table[i] = UpperPTE::subtableEntry(somewhere, Flag::Write);
+        assert(upper->findFreeEntry() != nullptr && upper->findUnusedEntry() == nullptr,
+               "findUnusedEntry: found a slot with every entry holding a subtable");
+        freePage(upper);
+
+        // Runs in the arena: each page distinct and writable, and a full run takes a whole leaf table.
+        constexpr size_t runLengths[] = {1, 31, 40, maxPagesPerRun};
+        for (const size_t count : runLengths) {
+            auto* run = static_cast<uint64_t*>(allocPages(count));
+            assert(run != nullptr, "allocPages: no run");
+            constexpr size_t wordsPerPage = arch::smallPageSize / sizeof(uint64_t);
+            for (size_t i = 0; i < count; i++) run[i * wordsPerPage] = i;
+            for (size_t i = 0; i < count; i++)
+                assert(run[i * wordsPerPage] == i, "allocPages: run pages alias");
+            if (count == maxPagesPerRun)
+                assert(reinterpret_cast<uint64_t>(run) % arch::bigPageSize == 0, "allocPages: full run not table-aligned");
+            freePageRun(run, count);
+        }
+
+        // Big pages: the slot comes back once unmapped.  No allocation happens in between, so
+        // nothing else can take it.
+        auto arena = VMSubstrateArena::forCurrentCPU();
+        auto* big = static_cast<uint64_t*>(allocBigPage());
+        assert(big != nullptr && reinterpret_cast<uint64_t>(big) % arch::bigPageSize == 0, "allocBigPage: misaligned");
+        constexpr size_t lastWord = arch::bigPageSize / sizeof(uint64_t) - 1;
+        big[0] = 1;
+        big[lastWord] = 2;
+        assert(big[0] == 1 && big[lastWord] == 2, "allocBigPage: page not writable");
+        FlushPlanner planner;
+        PageRef bigPages[2];
+        bigPages[0] = PageRef::big(arena.unmapBigPage(big, planner));
+        planner.flush();
+        void* again = arena.allocBigPage();
+        assert(again == big, "allocBigPage: freed slot not reused");
+        bigPages[1] = PageRef::big(arena.unmapBigPage(again, planner));
+        planner.flush();
+        freeAfterTlbFlush(bigPages, 2);
+
+        // MMIO windows translate to exactly the requested physical pages.
+        const phys_addr device = PageAllocator::allocateBigPage(arch::getCurrentProcessorID());
+        void* window = mapMMIOBigPage(device);
+        assert(window != nullptr && reinterpret_cast<uint64_t>(window) % arch::bigPageSize == 0,
+               "mapMMIOBigPage: misaligned");
+        assert(arena.unmapBigPage(window, planner) == device, "mapMMIOBigPage: wrong physical page");
+        constexpr size_t mmioOffset = 5;
+        constexpr size_t mmioCount = 40;
+        auto* pages = static_cast<uint8_t*>(mapMMIOPages(device + mmioOffset * arch::smallPageSize, mmioCount));
+        assert(pages != nullptr, "mapMMIOPages: no run");
+        for (size_t i = 0; i < mmioCount; i++) {
+            assert(arena.unmapPage(pages + i * arch::smallPageSize, planner) == device + (mmioOffset + i) * arch::smallPageSize,
+                   "mapMMIOPages: wrong physical page");
+        }
+        planner.flush();
+        const PageRef devicePage = PageRef::big(device);
+        freeAfterTlbFlush(&devicePage, 1);
+        return true;
+    }
+
+    // Page zeroer for the page allocator: clears the range through short-lived windows in the
+    // current CPU's arena, one big-page mapping per aligned big page and one run per leftover
+    // stretch, so the whole range costs a handful of mappings and a single local flush.
+    void zeroPhysicalRange(phys_addr base, size_t bytes) {
+        if (static_cast<size_t>(arch::getCurrentProcessorID()) >= freeArenaIndex.load(ACQUIRE)) {
+            // Our own arena's first tables are being allocated; there is no arena to map through yet.
+            TempWindow<arch::PageTable<VMSubstrateHelper::leafLevel>> window(base);
+            for (size_t offset = 0; offset < bytes; offset += arch::smallPageSize) {
+                memset(&window[offset / arch::smallPageSize], 0, arch::smallPageSize);
+            }
+            return;
+        }
+        auto arena = VMSubstrateArena::forCurrentCPU();
+        FlushPlanner planner;
+        for (size_t offset = 0; offset < bytes;) {
+            const phys_addr chunk = base + offset;
+            if (chunk.value % arch::bigPageSize == 0 && bytes - offset >= arch::bigPageSize) {
+                if (void* window = arena.mapPhysicalBigPage(chunk)) {
+                    memset(window, 0, arch::bigPageSize);
+                    (void)arena.unmapBigPage(window, planner);
+                    offset += arch::bigPageSize;
+                    continue;
+                }
+            }
+            const size_t toBigBoundary = (arch::bigPageSize - chunk.value % arch::bigPageSize) / arch::smallPageSize;
+            const size_t count = min(min((bytes - offset) / arch::smallPageSize, toBigBoundary), maxPagesPerRun);
+            auto* window = static_cast<uint8_t*>(arena.mapPhysicalPages(chunk, count));
+            assert(window != nullptr, "Out of arena space for a zeroing window");
+            memset(window, 0, count * arch::smallPageSize);
+            for (size_t i = 0; i < count; i++) {
+                (void)arena.unmapPage(window + i * arch::smallPageSize, planner);
+            }
+            offset += count * arch::smallPageSize;
+        }
+        planner.flush();
+    }
+
     void* createArena(arch::ProcessorID cpu) {
         LockGuard arenaGuard(arenaCreationLock);
         const phys_addr topAddr = initializeArenaChain<pageTableLevelForKMemRegion()>(cpu);
@@ -511,20 +1089,269 @@ namespace kernel::mm::VMSubstrate {
         return reinterpret_cast<void*>(arenaVirtualBase(index).value);
     }
 
+    // Slow path of ensureTLBEntryFresh: the generations are read before the flush, so any
+    // mapping made after a read is simply seen as newer next time.
+    [[gnu::noinline]] void catchUpTLB(uint64_t* flushed) {
+        const size_t arenaCount = freeArenaIndex.load(ACQUIRE);
+        for (size_t arena = 0; arena < arenaCount; arena++)
+            flushed[arena] = arenaGenerations[arena].value.load(ACQUIRE);
+        const uint64_t tlbGeneration = PageAllocator::tlbFlushGeneration();
+        arch::flushGlobalTLB();
+        PageAllocator::noteTlbFlush(tlbGeneration);
+    }
+
     void ensureTLBEntryFresh(void* ptr) {
         const auto ptrAddr = reinterpret_cast<uint64_t>(ptr);
-        const auto tableBase = roundDownToNearestMultiple(ptrAddr, arch::bigPageSize);
-        const size_t k_abs = (ptrAddr - tableBase) / arch::smallPageSize;
-        const size_t myCPU = arch::getCurrentProcessorID();
-        using LPT = VMSubstrateHelper::LeafPageTableWrapper;
-        const size_t dw = LPT::dirtyCPUWord(myCPU);
-        const uint64_t bit = LPT::dirtyCPUBit(myCPU);
-        auto& dirtyEntry = *reinterpret_cast<Atomic<uint64_t>*>(
-            tableBase + dw * arch::smallPageSize + k_abs * sizeof(uint64_t));
-        if (dirtyEntry.load(ACQUIRE) & bit) {
-            arch::invlpg(virt_addr{ptrAddr});
-            dirtyEntry.fetch_and(~bit, RELAXED);
+        const size_t arena = (ptrAddr - arenaVirtualBase(0).value) / getKernelMemRegionSize();
+        const arch::ProcessorID cpu = arch::getCurrentProcessorID();
+        // Our own arena's mappings were invalidated here as they were made.
+        if (arena == cpu)
+            return;
+        uint64_t* flushed = flushedGenerations[cpu];
+        if (flushed[arena] < arenaGenerations[arena].value.load(ACQUIRE))
+            catchUpTLB(flushed);
+    }
+
+    // ── Small-object heap ───────────────────────────────────────────────────
+    //
+    // vmsmalloc serves objects of up to kMaxSlabObject bytes from slabs: single arena pages
+    // headed by a SlabHeader and carved into equal slots of one size class.  A CPU only
+    // allocates from slabs in its own arena and keeps them in per-class lists that nobody else
+    // touches, so allocation takes no lock and shares nothing beyond the page allocator.  A
+    // CPU freeing an object from another arena pushes it onto that arena's remote-free stack;
+    // the owner puts such objects back into their slabs the next time an allocation misses, or
+    // every kRemoteDrainInterval allocations, so a CPU that always hits does not leave them
+    // stranded.
+    // Larger objects get a run of whole pages, with a SlabHeader in front recording its length.
+    // Like the page allocator's per-CPU state, none of this may be used from an interrupt
+    // handler that can preempt the same CPU's allocator.
+
+    struct FreeObject {
+        FreeObject* next;
+    };
+
+    struct alignas(64) SlabHeader {
+        uint16_t sizeClass;     // index into kSizeClasses, or kLargeClass for a page run
+        uint16_t inUse;         // owner only
+        uint32_t pageCount;     // page runs only
+        FreeObject* freeList;   // owner only
+        SlabHeader* next;       // owner's partial list for sizeClass
+        SlabHeader* prev;
+    };
+
+    // Up to 256 bytes, every multiple of 16. Past that, the largest multiple of 16 that still
+    // fits k slots in a slab for k = 12, 10, 8, 6, 5, 4, 3, 2, so no slab wastes more than a
+    // few dozen bytes.
+    constexpr uint16_t kSizeClasses[] = {16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240,
+                                         256, 336, 400, 496, 672, 800, 1008, 1344, 2016};
+    constexpr size_t kClassCount = sizeof(kSizeClasses) / sizeof(kSizeClasses[0]);
+    constexpr size_t kMaxSlabObject = kSizeClasses[kClassCount - 1];
+    constexpr uint16_t kLargeClass = UINT16_MAX;
+    constexpr size_t kSlabPayload = arch::smallPageSize - sizeof(SlabHeader);
+    constexpr size_t kMaxLargeObject = maxPagesPerRun * arch::smallPageSize - sizeof(SlabHeader);
+    // Allocations between checks of the remote-free stack on the hit path.
+    constexpr uint32_t kRemoteDrainInterval = 64;
+    static_assert(kSlabPayload / kMaxSlabObject == 2);
+    static_assert([] {
+        for (const auto size : kSizeClasses)
+            if (size % 16 != 0) return false;
+        return true;
+    }(), "Size classes must keep slots 16-byte aligned");
+
+    // Size class for each 16-byte granule of request size.
+    constexpr auto kClassForGranule = [] {
+        struct { uint8_t entries[kMaxSlabObject / 16 + 1]; } table{};
+        size_t cls = 0;
+        for (size_t granule = 0; granule <= kMaxSlabObject / 16; granule++) {
+            while (kSizeClasses[cls] < granule * 16) cls++;
+            table.entries[granule] = static_cast<uint8_t>(cls);
+        }
+        return table;
+    }();
+
+    struct alignas(arch::CACHE_LINE_SIZE) HeapCPU {
+        // Slabs with at least one free slot; allocation takes from the head.
+        SlabHeader* partial[kClassCount];
+        // Allocations since remoteFrees was last drained.
+        uint32_t allocationsSinceDrain;
+        alignas(arch::CACHE_LINE_SIZE) Atomic<FreeObject*> remoteFrees;
+    };
+    HeapCPU heapCPUs[arch::MAX_PROCESSOR_COUNT];
+
+    SlabHeader* slabFor(const void* ptr) {
+        return reinterpret_cast<SlabHeader*>(roundDownToNearestMultiple(reinterpret_cast<uint64_t>(ptr),
+                                                                        static_cast<uint64_t>(arch::smallPageSize)));
+    }
+
+    void linkPartial(HeapCPU& heap, SlabHeader* slab) {
+        SlabHeader*& head = heap.partial[slab->sizeClass];
+        slab->prev = nullptr;
+        slab->next = head;
+        if (head) head->prev = slab;
+        head = slab;
+    }
+
+    void unlinkPartial(HeapCPU& heap, SlabHeader* slab) {
+        if (slab->prev) slab->prev->next = slab->next;
+        else heap.partial[slab->sizeClass] = slab->next;
+        if (slab->next) slab->next->prev = slab->prev;
+        slab->next = slab->prev = nullptr;
+    }
+
+    SlabHeader* newSlab(HeapCPU& heap, size_t cls) {
+        auto* slab = static_cast<SlabHeader*>(allocPage());
+        if (!slab) return nullptr;
+        slab->sizeClass = static_cast<uint16_t>(cls);
+        slab->inUse = 0;
+        slab->pageCount = 1;
+        const size_t objectSize = kSizeClasses[cls];
+        const size_t capacity = kSlabPayload / objectSize;
+        auto* objects = reinterpret_cast<uint8_t*>(slab + 1);
+        for (size_t i = 0; i < capacity; i++)
+            reinterpret_cast<FreeObject*>(objects + i * objectSize)->next =
+                i + 1 < capacity ? reinterpret_cast<FreeObject*>(objects + (i + 1) * objectSize) : nullptr;
+        slab->freeList = reinterpret_cast<FreeObject*>(objects);
+        linkPartial(heap, slab);
+        return slab;
+    }
+
+    // Return an object to its slab on the owning CPU.  A slab that empties is released unless
+    // it is the only one left with free slots in its class, so a CPU cycling one object does
+    // not map and unmap a page each time.
+    void freeLocal(HeapCPU& heap, void* ptr) {
+        SlabHeader* slab = slabFor(ptr);
+        auto* object = static_cast<FreeObject*>(ptr);
+        const bool wasFull = slab->freeList == nullptr;
+        object->next = slab->freeList;
+        slab->freeList = object;
+        if (wasFull) linkPartial(heap, slab);
+        if (--slab->inUse == 0 && (heap.partial[slab->sizeClass] != slab || slab->next != nullptr)) {
+            unlinkPartial(heap, slab);
+            freePage(slab);
+        }
+    }
+
+    // What vmsfree does for an object of another CPU's arena.
+    void pushRemoteFree(HeapCPU& heap, void* ptr) {
+        auto* object = static_cast<FreeObject*>(ptr);
+        FreeObject* head = heap.remoteFrees.load(RELAXED);
+        do {
+            object->next = head;
+        } while (!heap.remoteFrees.compare_exchange(head, object, RELEASE, RELAXED));
+    }
+
+    void drainRemoteFrees(HeapCPU& heap) {
+        heap.allocationsSinceDrain = 0;
+        FreeObject* object = heap.remoteFrees.exchange(nullptr, ACQUIRE);
+        while (object) {
+            FreeObject* next = object->next;
+            freeLocal(heap, object);
+            object = next;
+        }
+    }
+
+    void* vmsmalloc(size_t size) {
+        if (size > kMaxSlabObject) {
+            if (size > kMaxLargeObject) return nullptr;
+            const size_t pages = divideAndRoundUp(size + sizeof(SlabHeader), arch::smallPageSize);
+            auto* header = static_cast<SlabHeader*>(allocPages(pages));
+            if (!header) return nullptr;
+            header->sizeClass = kLargeClass;
+            header->pageCount = static_cast<uint32_t>(pages);
+            return header + 1;
+        }
+
+        const size_t cls = kClassForGranule.entries[divideAndRoundUp(size, static_cast<size_t>(16))];
+        HeapCPU& heap = heapCPUs[arch::getCurrentProcessorID()];
+        // Only a non-empty stack is worth the exchange, and its line is the one remote freers
+        // write, so it is not read on every allocation either.
+        if (++heap.allocationsSinceDrain == kRemoteDrainInterval) {
+            if (heap.remoteFrees.load(RELAXED)) drainRemoteFrees(heap);
+            else heap.allocationsSinceDrain = 0;
         }
+        SlabHeader* slab = heap.partial[cls];
+        if (!slab) {
+            drainRemoteFrees(heap);
+            slab = heap.partial[cls];
+            if (!slab && !(slab = newSlab(heap, cls))) return nullptr;
+        }
+        FreeObject* object = slab->freeList;
+        slab->freeList = object->next;
+        slab->inUse++;
+        if (!slab->freeList) unlinkPartial(heap, slab);
+        return object;
+    }
+
+    void vmsfree(void* ptr) {
+        if (!ptr) return;
+        // The slab may have been mapped since this CPU last caught up on its arena.
+        ensureTLBEntryFresh(ptr);
+        SlabHeader* slab = slabFor(ptr);
+        if (slab->sizeClass == kLargeClass) {
+            freePageRun(slab, slab->pageCount);
+            return;
+        }
+        const size_t owner = VMSubstrateArena::forPointer(ptr).index();
+        if (owner == arch::getCurrentProcessorID()) {
+            freeLocal(heapCPUs[owner], ptr);
+            return;
+        }
+        pushRemoteFree(heapCPUs[owner], ptr);
+    }
+
+    // Exercises the heap on the calling CPU: size-class selection, alignment, slab retirement,
+    // the periodic remote-free drain and page-run objects. Other CPUs' frees are stood in for
+    // by pushing onto our own remote-free stack, which is all vmsfree does for them.
+    bool heapSelfCheck() {
+        HeapCPU& heap = heapCPUs[arch::getCurrentProcessorID()];
+
+        constexpr size_t sizes[] = {1, 16, 17, 100, 256, 257, 1000, kMaxSlabObject};
+        for (const size_t size : sizes) {
+            void* object = vmsmalloc(size);
+            assert(object != nullptr && reinterpret_cast<uint64_t>(object) % 16 == 0, "vmsmalloc: misaligned object");
+            const size_t cls = slabFor(object)->sizeClass;
+            assert(kSizeClasses[cls] >= size && (cls == 0 || kSizeClasses[cls - 1] < size),
+                   "vmsmalloc: object not in the smallest class that fits");
+            memset(object, 0xa5, size);
+            vmsfree(object);
+        }
+
+        // Enough objects of the largest class to span several slabs; once they are freed,
+        // at most one empty slab of the class may stay behind.
+        constexpr size_t slabSpan = 4 * (kSlabPayload / kMaxSlabObject);
+        void* objects[kRemoteDrainInterval];
+        static_assert(slabSpan <= kRemoteDrainInterval);
+        for (size_t i = 0; i < slabSpan; i++) objects[i] = vmsmalloc(kMaxSlabObject);
+        for (size_t i = 0; i < slabSpan; i++) vmsfree(objects[i]);
+        size_t emptySlabs = 0;
+        for (SlabHeader* slab = heap.partial[kClassCount - 1]; slab; slab = slab->next) {
+            if (slab->inUse == 0) emptySlabs++;
+        }
+        assert(emptySlabs <= 1, "vmsmalloc: emptied slabs were not released");
+
+        // A remote free is put back within kRemoteDrainInterval allocations even though every
+        // one of them hits.
+        pushRemoteFree(heap, vmsmalloc(16));
+        for (size_t i = 0; i < kRemoteDrainInterval; i++) objects[i] = vmsmalloc(16);
+        assert(heap.remoteFrees.load(ACQUIRE) == nullptr, "vmsmalloc: remote frees were not drained");
+        for (size_t i = 0; i < kRemoteDrainInterval; i++) vmsfree(objects[i]);
+
+        // Objects past the largest class get a page run with the header in front.
+        auto* large = static_cast<uint8_t*>(vmsmalloc(3 * arch::smallPageSize));
+        assert(large != nullptr && slabFor(large)->sizeClass == kLargeClass, "vmsmalloc: large object not a page run");
+        assert(slabFor(large)->pageCount == 4, "vmsmalloc: large object has the wrong page count");
+        memset(large, 0x5a, 3 * arch::smallPageSize);
+        vmsfree(large);
+        assert(vmsmalloc(kMaxLargeObject + 1) == nullptr, "vmsmalloc: oversized request did not fail");
+
+        struct Probe {
+            uint64_t value;
+            explicit Probe(uint64_t v) : value(v) {}
+        };
+        SafePtr<Probe> probe = make<Probe>(42);
+        assert(probe && probe->value == 42, "make: object not constructed");
+        destroy(probe);
+        return true;
     }
 
     bool init() {
@@ -534,10 +1361,18 @@ namespace kernel::mm::VMSubstrate {
             early_boot_virt_to_phys(virt_addr(&vmmArenaTable)),
             kSubtableFlags);
         assert(bootPageTable[VMM_SUBSTRATE_ROOT_INDEX].isPresent(), "AAAA");
+        // Registered first: arena page tables are ZEROED allocations.
+        PageAllocator::setPageZeroer(zeroPhysicalRange);
         for (size_t i = 0; i < arch::processorCount(); i++) {
             createArena(static_cast<arch::ProcessorID>(i));
         }
         arch::flushTLB();
+        // A zeroed page is behind on every arena that has mapped anything, so each CPU's
+        // first dereference into another arena flushes once.
+        for (size_t i = 0; i < arch::processorCount(); i++) {
+            flushedGenerations[i] = static_cast<uint64_t*>(allocPage());
+            memset(flushedGenerations[i], 0, arch::smallPageSize);
+        }
         return true;
     }
 }
@@ -115,10 +115,12 @@ size_t AtomicBitPool::bitIndexInParent(size_t entryIndex, size_t level) const {
     return entryIndex & ((1ull << parentShift) - 1);
 }
 
-AtomicBitPool::CountResult AtomicBitPool::incrementCount(size_t entryIndex, size_t level) {
-    int64_t oldCount = entryAt(entryIndex, level).count.fetch_add(1, bpAcqRel);
-    CountResult result{oldCount + 1, false, false};
-    if (oldCount == 0 && level < levelCount - 1) {
+AtomicBitPool::CountResult AtomicBitPool::incrementCount(size_t entryIndex, size_t level, int64_t delta) {
+    int64_t oldCount = entryAt(entryIndex, level).count.fetch_add(delta, bpAcqRel);
+    CountResult result{oldCount + delta, false, false};
+    // The parent bit flips each time the count crosses from <= 0 to > 0 and back, so a batched
+    // delta toggles it exactly when a run of single increments would have.
+    if (oldCount <= 0 && oldCount + delta > 0 && level < levelCount - 1) {
         size_t parentIdx = parentEntryIndex(entryIndex, level);
         uint64_t bit = 1ull << bitIndexInParent(entryIndex, level);
         uint64_t oldBitmap = entryAt(parentIdx, level + 1).bitmap.fetch_xor(bit, bpRelease);
@@ -145,6 +147,27 @@ AtomicBitPool::CountResult AtomicBitPool::decrementCount(size_t entryIndex, size
     return result;
 }
 
+int64_t AtomicBitPool::takeCount(size_t entryIndex, size_t level, int64_t amount, bool exact, CountResult& result) {
+    auto& count = entryAt(entryIndex, level).count;
+    int64_t oldCount = count.load(bpAcquire);
+    int64_t taken;
+    do {
+        if (oldCount <= 0 || (exact && oldCount < amount)) return 0;
+        taken = min(oldCount, amount);
+    } while (!count.compare_exchange(oldCount, oldCount - taken, bpAcqRel, bpAcquire));
+    result = {oldCount - taken, false, false};
+    if (oldCount == taken && level < levelCount - 1) {
+        size_t parentIdx = parentEntryIndex(entryIndex, level);
+        uint64_t bit = 1ull << bitIndexInParent(entryIndex, level);
+        uint64_t oldBitmap = entryAt(parentIdx, level + 1).bitmap.fetch_xor(bit, bpRelease);
+        if (level == levelCount - 2) {
+            result.toggledTopLevel = true;
+            result.poolTransitioned = ((oldBitmap ^ bit) == 0);
+        }
+    }
+    return taken;
+}
+
 AtomicBitPool::AddResult AtomicBitPool::add(size_t absoluteIndex) {
     size_t l0Entry = entryIndexForLevel(absoluteIndex, 0);
     size_t l0Bit = bitIndexForLevel(absoluteIndex, 0);
@@ -221,7 +244,127 @@ AtomicBitPool::RemoveResult AtomicBitPool::remove(size_t absoluteIndex) {
     return madeEmpty ? RemoveResult::RemovedAndMadeEmpty : RemoveResult::RemovedAndStayedNonempty;
 }
 
-AtomicBitPool::GetResult AtomicBitPool::getAny(size_t threadId, size_t& outIndex, size_t maxRetries) {
+// ==================== Batched add / remove ====================
+
+size_t AtomicBitPool::sameEntryRun(const size_t* indices, size_t count, size_t level) const {
+    const size_t entry = entryIndexForLevel(indices[0], level);
+    size_t n = 1;
+    while (n < count && entryIndexForLevel(indices[n], level) == entry) n++;
+    return n;
+}
+
+static uint64_t leafMask(const size_t* indices, size_t count) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < count; i++) mask |= uint64_t(1) << (indices[i] & 63);
+    return mask;
+}
+
+// Sets the indices, which all lie under one entry at level, and returns how many were newly set.
+// Counts are raised bottom-up once each child run is done, as add does for a single index.
+size_t AtomicBitPool::addRun(const size_t* indices, size_t count, size_t level, bool& madeNonempty) {
+    if (level == 0) {
+        const uint64_t mask = leafMask(indices, count);
+        const uint64_t old = entryAt(entryIndexForLevel(indices[0], 0), 0).bitmap.fetch_or(mask, bpAcqRel);
+        if (levelCount == 1 && old == 0) madeNonempty = true;
+        return static_cast<size_t>(__builtin_popcountll(mask & ~old));
+    }
+    size_t added = 0;
+    for (size_t pos = 0; pos < count;) {
+        const size_t n = sameEntryRun(indices + pos, count - pos, level - 1);
+        const size_t childAdded = addRun(indices + pos, n, level - 1, madeNonempty);
+        if (childAdded > 0) {
+            CountResult cr = incrementCount(entryIndexForLevel(indices[pos], level - 1), level - 1,
+                                            static_cast<int64_t>(childAdded));
+            if (cr.toggledTopLevel && cr.poolTransitioned) madeNonempty = true;
+        }
+        added += childAdded;
+        pos += n;
+    }
+    return added;
+}
+
+// Clears the indices, which all lie under one entry at level, and returns how many were cleared.
+// As in remove, each child's count is taken before anything below it is touched. The caller has
+// already taken this entry's share and gives back whatever was not cleared.
+size_t AtomicBitPool::removeRun(const size_t* indices, size_t count, size_t level, bool& madeEmpty) {
+    if (level == 0) {
+        // Only reached when the root is the leaf (levelCount == 1), which keeps no counts.
+        const uint64_t mask = leafMask(indices, count);
+        const uint64_t old = entryAt(0, 0).bitmap.fetch_and(~mask, bpAcqRel);
+        if ((old & mask) != 0) madeEmpty = (old & ~mask) == 0;
+        return static_cast<size_t>(__builtin_popcountll(old & mask));
+    }
+
+    // Returns SIZE_MAX if the child's count could not cover the run.
+    const auto removeChild = [&](const size_t* run, size_t n) -> size_t {
+        const size_t child = entryIndexForLevel(run[0], level - 1);
+        CountResult cr{};
+        int64_t wanted = 0;
+        size_t removed;
+        if (level == 1) {
+            // The child is a leaf: take counts only for the indices a snapshot shows present, and
+            // clear only those, so an index set after the snapshot is never cleared unaccounted.
+            auto& bitmap = entryAt(child, 0).bitmap;
+            const uint64_t present = leafMask(run, n) & bitmap.load(bpAcquire);
+            if (present == 0) return 0;
+            wanted = __builtin_popcountll(present);
+            if (takeCount(child, 0, wanted, true, cr) == 0) return SIZE_MAX;
+            if (cr.toggledTopLevel) madeEmpty = cr.poolTransitioned;
+            removed = static_cast<size_t>(__builtin_popcountll(bitmap.fetch_and(~present, bpAcqRel) & present));
+        } else {
+            // Higher up we cannot tell which indices are present without walking down, so take
+            // one per distinct index; the leaves give back what they do not clear.
+            for (size_t pos = 0; pos < n;) {
+                const size_t leafRun = sameEntryRun(run + pos, n - pos, 0);
+                wanted += __builtin_popcountll(leafMask(run + pos, leafRun));
+                pos += leafRun;
+            }
+            if (takeCount(child, level - 1, wanted, true, cr) == 0) return SIZE_MAX;
+            if (cr.toggledTopLevel) madeEmpty = cr.poolTransitioned;
+            removed = removeRun(run, n, level - 1, madeEmpty);
+        }
+        if (static_cast<int64_t>(removed) < wanted) {
+            cr = incrementCount(child, level - 1, wanted - static_cast<int64_t>(removed));
+            if (cr.toggledTopLevel) madeEmpty = false;
+        }
+        return removed;
+    };
+
+    size_t removed = 0;
+    for (size_t pos = 0; pos < count;) {
+        const size_t n = sameEntryRun(indices + pos, count - pos, level - 1);
+        const size_t childRemoved = removeChild(indices + pos, n);
+        if (childRemoved != SIZE_MAX) {
+            removed += childRemoved;
+        } else if (n > 1) {
+            // The child could not cover the whole run, so some of it is absent or being claimed.
+            // Retry one index at a time, which fails only for the indices remove would reject.
+            for (size_t i = 0; i < n; i++) {
+                const size_t single = removeChild(indices + pos + i, 1);
+                if (single != SIZE_MAX) removed += single;
+            }
+        }
+        pos += n;
+    }
+    return removed;
+}
+
+AtomicBitPool::BatchResult AtomicBitPool::addMany(const size_t* indices, size_t count) {
+    if (count == 0) return {0, false};
+    bool madeNonempty = false;
+    const size_t added = addRun(indices, count, levelCount - 1, madeNonempty);
+    return {added, added > 0 && madeNonempty};
+}
+
+AtomicBitPool::BatchResult AtomicBitPool::removeMany(const size_t* indices, size_t count) {
+    if (count == 0) return {0, false};
+    bool madeEmpty = false;
+    const size_t removed = removeRun(indices, count, levelCount - 1, madeEmpty);
+    return {removed, removed > 0 && madeEmpty};
+}
+
+template <typename Chooser>
+AtomicBitPool::GetResult AtomicBitPool::claim(Chooser&& choose, size_t& outIndex, size_t maxRetries) {
     size_t retryCount = 0;
     size_t level = levelCount - 1;
     size_t entryIndex = 0;
@@ -229,16 +372,6 @@ AtomicBitPool::GetResult AtomicBitPool::getAny(size_t threadId, size_t& outIndex
     size_t decrementedAt[maxLevelCount];
     for (size_t i = 0; i < levelCount; i++) decrementedAt[i] = SIZE_MAX;
 
-    auto doRotation = [&](uint64_t bitmap) -> size_t {
-        size_t hash = threadId ^ (retryCount * 2654435761ULL);
-        size_t r = hash & 63;
-        bool useLzcnt = hash & 64;
-        uint64_t rotated = (bitmap << r) | (bitmap >> (64 - r));
-        size_t b = useLzcnt ? (63 - countLeadingZeros(rotated))
-                            : countTrailingZeros(rotated);
-        return (b + 64 - r) & 63;
-    };
-
     auto backout = [&]() {
         for (size_t k = 0; k < levelCount; k++) {
             if (decrementedAt[k] != SIZE_MAX) {
@@ -257,7 +390,7 @@ AtomicBitPool::GetResult AtomicBitPool::getAny(size_t threadId, size_t& outIndex
                 backout();
                 return GetResult::Empty;
             }
-            size_t actualBit = doRotation(bitmap);
+            size_t actualBit = choose(bitmap, size_t(0), entryIndex, retryCount);
             uint64_t mask = uint64_t(1) << actualBit;
             uint64_t old = entryAt(entryIndex, 0).bitmap.fetch_and(~mask, bpAcqRel);
             if (old & mask) {
@@ -291,7 +424,7 @@ AtomicBitPool::GetResult AtomicBitPool::getAny(size_t threadId, size_t& outIndex
             retryCount++;
             continue;
         }
-        size_t actualBit = doRotation(bitmap);
+        size_t actualBit = choose(bitmap, level, entryIndex, retryCount);
         size_t childEntry = childEntryIndex(entryIndex, actualBit, level);
 
         CountResult cr = decrementCount(childEntry, level - 1);
@@ -309,6 +442,105 @@ AtomicBitPool::GetResult AtomicBitPool::getAny(size_t threadId, size_t& outIndex
     return GetResult::Contended;
 }
 
+AtomicBitPool::GetResult AtomicBitPool::getAny(size_t threadId, size_t& outIndex, size_t maxRetries) {
+    auto doRotation = [&](uint64_t bitmap, size_t, size_t, size_t retryCount) -> size_t {
+        size_t hash = threadId ^ (retryCount * 2654435761ULL);
+        size_t r = hash & 63;
+        bool useLzcnt = hash & 64;
+        uint64_t rotated = (bitmap << r) | (bitmap >> (64 - r));
+        size_t b = useLzcnt ? (63 - countLeadingZeros(rotated))
+                            : countTrailingZeros(rotated);
+        return (b + 64 - r) & 63;
+    };
+    return claim(doRotation, outIndex, maxRetries);
+}
+
+// Takes up to count more indices from one L0 entry. The leaf gives what it can, each ancestor's
+// count is then taken once for the lot, and the bits are cleared together.
+size_t AtomicBitPool::claimFromWord(size_t entryIndex, size_t* outIndices, size_t count, size_t maxRetries) {
+    if (count == 0) return 0;
+    const size_t leafIndex = entryIndex << 6;
+    int64_t reserved = static_cast<int64_t>(count);
+    if (levelCount > 1) {
+        CountResult cr{};
+        reserved = takeCount(entryIndex, 0, reserved, false, cr);
+        if (reserved == 0) return 0;
+        for (size_t k = 1; k < levelCount - 1; k++) {
+            if (takeCount(entryIndexForLevel(leafIndex, k), k, reserved, true, cr) == 0) {
+                for (size_t j = 0; j < k; j++)
+                    incrementCount(entryIndexForLevel(leafIndex, j), j, reserved);
+                return 0;
+            }
+        }
+    }
+
+    auto& bitmap = entryAt(entryIndex, 0).bitmap;
+    size_t claimed = 0;
+    for (size_t attempt = 0; static_cast<int64_t>(claimed) < reserved && attempt <= maxRetries; attempt++) {
+        uint64_t available = bitmap.load(bpAcquire);
+        uint64_t mask = 0;
+        for (int64_t n = static_cast<int64_t>(claimed); n < reserved && available != 0; n++) {
+            mask |= available & -available;
+            available &= available - 1;
+        }
+        if (mask == 0) {
+            // Without counts (levelCount == 1) an empty word just means there is nothing left.
+            if (levelCount == 1) break;
+            continue;
+        }
+        for (uint64_t got = bitmap.fetch_and(~mask, bpAcqRel) & mask; got != 0; got &= got - 1)
+            outIndices[claimed++] = leafIndex | countTrailingZeros(got);
+    }
+
+    if (levelCount > 1 && static_cast<int64_t>(claimed) < reserved) {
+        for (size_t k = 0; k < levelCount - 1; k++)
+            incrementCount(entryIndexForLevel(leafIndex, k), k, reserved - static_cast<int64_t>(claimed));
+    }
+    return claimed;
+}
+
+AtomicBitPool::GetResult AtomicBitPool::getMany(size_t threadId, size_t* outIndices, size_t count, size_t& outCount, size_t maxRetries) {
+    outCount = 0;
+    GetResult result = GetResult::Empty;
+    while (outCount < count) {
+        size_t first;
+        result = getAny(threadId, first, maxRetries);
+        if (result != GetResult::Success) break;
+        outIndices[outCount++] = first;
+        outCount += claimFromWord(entryIndexForLevel(first, 0), outIndices + outCount, count - outCount, maxRetries);
+    }
+    return outCount > 0 ? GetResult::Success : result;
+}
+
+// The set bit of bitmap closest to bit, taking the higher one on a tie. bitmap must be nonzero.
+static size_t nearestSetBit(uint64_t bitmap, size_t bit) {
+    const uint64_t atOrAbove = bitmap & (~uint64_t(0) << bit);
+    const uint64_t below = bitmap & ~(~uint64_t(0) << bit);
+    if (below == 0) return countTrailingZeros(atOrAbove);
+    const size_t down = 63 - countLeadingZeros(below);
+    if (atOrAbove == 0) return down;
+    const size_t up = countTrailingZeros(atOrAbove);
+    return (up - bit <= bit - down) ? up : down;
+}
+
+AtomicBitPool::GetResult AtomicBitPool::getNear(size_t hintIndex, size_t& outIndex, size_t maxRetries) {
+    // target always lies inside the subtree being searched. Whenever the search turns away from
+    // it, target moves to the edge of the chosen subtree that faces the hint, so the rest of the
+    // descent keeps closing in on the hint from that side.
+    size_t target = min(hintIndex, capacity - 1);
+    auto nearest = [&](uint64_t bitmap, size_t level, size_t entryIndex, size_t) -> size_t {
+        const size_t targetBit = bitIndexForLevel(target, level);
+        const size_t bit = nearestSetBit(bitmap, targetBit);
+        if (bit != targetBit && level > 0) {
+            const size_t span = cumulativeShift(level);
+            const size_t child = childEntryIndex(entryIndex, bit, level);
+            target = bit > targetBit ? child << span : ((child + 1) << span) - 1;
+        }
+        return bit;
+    };
+    return claim(nearest, outIndex, maxRetries);
+}
+
 #ifdef CROCOS_TESTING
 size_t AtomicBitPool::countSet() const {
     const size_t leafEntryCount = (capacity + 63) / 64;
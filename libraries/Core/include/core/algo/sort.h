@@ -145,6 +145,74 @@ namespace algorithm {
         auto depth_limit = log2floor(N) * 2;
         algorithm::introsort(&arr[0], 0, N - 1, depth_limit, comp);
     }
+
+#define RADIX_SORT_DIGIT_BITS 8
+#define RADIX_SORT_THRESHOLD 64
+
+    //Sorts data[0, size) on bits [0, shift + RADIX_SORT_DIGIT_BITS) of key, most significant digit first.
+    //Each pass permutes elements into their buckets in place (American flag sort), then recurses into
+    //every bucket on the next digit down. Buckets below RADIX_SORT_THRESHOLD go to introsort instead.
+    template <typename T, typename KeyFn>
+    void radixSortDigit(T* data, size_t size, size_t shift, KeyFn& key) {
+        constexpr size_t radix = 1ul << RADIX_SORT_DIGIT_BITS;
+        const auto digit = [&](const T& value) {
+            return static_cast<size_t>((key(value) >> shift) & (radix - 1));
+        };
+
+        size_t bucketStart[radix + 1] = {};
+        for (size_t i = 0; i < size; i++) {
+            bucketStart[digit(data[i]) + 1]++;
+        }
+        for (size_t b = 0; b < radix; b++) {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+
+        //Cycle each misplaced element into the next open slot of its bucket. nextFree[b] only moves
+        //forward, so every element is moved at most once.
+        size_t nextFree[radix];
+        for (size_t b = 0; b < radix; b++) nextFree[b] = bucketStart[b];
+        for (size_t b = 0; b < radix; b++) {
+            while (nextFree[b] < bucketStart[b + 1]) {
+                T value = move(data[nextFree[b]]);
+                size_t d = digit(value);
+                while (d != b) {
+                    swap(value, data[nextFree[d]++]);
+                    d = digit(value);
+                }
+                data[nextFree[b]++] = move(value);
+            }
+        }
+
+        if (shift == 0) return;
+        for (size_t b = 0; b < radix; b++) {
+            const size_t count = bucketStart[b + 1] - bucketStart[b];
+            if (count < 2) continue;
+            if (count < RADIX_SORT_THRESHOLD) {
+                auto comp = [&](const T& lhs, const T& rhs) { return key(lhs) < key(rhs); };
+                algorithm::sort(data + bucketStart[b], count, comp);
+            } else {
+                radixSortDigit(data + bucketStart[b], count, shift - RADIX_SORT_DIGIT_BITS, key);
+            }
+        }
+    }
+
+    //Sorts data by an unsigned integer key in time linear in size for a fixed key width, without
+    //scratch memory. Passes start at the highest digit any key uses, so narrow keys cost fewer
+    //passes. Not stable. Each level of recursion keeps two radix-sized tables on the stack.
+    template <typename T, typename KeyFn>
+    void radixSort(T* data, const size_t size, KeyFn key) {
+        if (size < RADIX_SORT_THRESHOLD) {
+            if (size < 2) return;
+            auto comp = [&](const T& lhs, const T& rhs) { return key(lhs) < key(rhs); };
+            algorithm::sort(data, size, comp);
+            return;
+        }
+        uint64_t keyBits = 0;
+        for (size_t i = 0; i < size; i++) keyBits |= static_cast<uint64_t>(key(data[i]));
+        if (keyBits == 0) return;
+        const size_t topShift = (log2floor(keyBits) / RADIX_SORT_DIGIT_BITS) * RADIX_SORT_DIGIT_BITS;
+        radixSortDigit(data, size, topShift, key);
+    }
 }
 
 #endif //SORT_H
@@ -46,8 +46,16 @@ class AtomicBitPool {
     [[nodiscard]] size_t parentEntryIndex(size_t entryIndex, size_t level) const;
     [[nodiscard]] size_t bitIndexInParent(size_t entryIndex, size_t level) const;
 
-    CountResult incrementCount(size_t entryIndex, size_t level);
+    CountResult incrementCount(size_t entryIndex, size_t level, int64_t delta = 1);
     CountResult decrementCount(size_t entryIndex, size_t level);
+    // Takes up to amount from the entry's count without letting it go negative (all of amount
+    // or nothing if exact). Returns how much was taken.
+    int64_t takeCount(size_t entryIndex, size_t level, int64_t amount, bool exact, CountResult& result);
+
+    [[nodiscard]] size_t sameEntryRun(const size_t* indices, size_t count, size_t level) const;
+    size_t addRun(const size_t* indices, size_t count, size_t level, bool& madeNonempty);
+    size_t removeRun(const size_t* indices, size_t count, size_t level, bool& madeEmpty);
+    size_t claimFromWord(size_t entryIndex, size_t* outIndices, size_t count, size_t maxRetries);
 
 public:
     enum class AddResult {
@@ -68,6 +76,11 @@ public:
         Contended,
     };
 
+    struct BatchResult {
+        size_t changed;         // indices actually added or removed
+        bool poolTransitioned;  // addMany: the pool was empty before; removeMany: it is empty now
+    };
+
     static constexpr size_t maxLevelCount = 10;
     static size_t requiredBufferSize(size_t capacity, size_t entryStride = 64);
 
@@ -77,7 +90,21 @@ public:
     AddResult add(size_t absoluteIndex);
     RemoveResult remove(size_t absoluteIndex);
 
+    // Batched add and remove. Indices sharing an L0 word are set or cleared with one atomic op,
+    // and each count above them is updated once per batch rather than once per index. Any order
+    // is accepted, but ascending order groups best. Duplicates and indices already in the
+    // requested state are not counted in changed.
+    BatchResult addMany(const size_t* indices, size_t count);
+    BatchResult removeMany(const size_t* indices, size_t count);
+
     GetResult getAny(size_t threadId, size_t &outIndex, size_t maxRetries = 16);
+    // Claims up to count indices. Each getAny descent is followed by taking whatever else the
+    // same L0 word can give in one fetch_and. Success if at least one index was claimed.
+    GetResult getMany(size_t threadId, size_t* outIndices, size_t count, size_t& outCount, size_t maxRetries = 16);
+    // Like getAny, but claims an index close to hintIndex: the hint itself if it is set,
+    // otherwise the nearest set index in the smallest subtree around the hint that has one.
+    // A hint past the end counts as the last index.
+    GetResult getNear(size_t hintIndex, size_t &outIndex, size_t maxRetries = 16);
 #ifdef CROCOS_TESTING
     [[nodiscard]] bool checkInvariants() const;
 
@@ -92,6 +119,12 @@ public:
     // Count of all currently set indices.  Only safe in quiescent state.
     [[nodiscard]] size_t countSet() const;
 #endif
+
+private:
+    // Descend from the root and claim one set index. choose(bitmap, level, entryIndex, retryCount)
+    // picks which set bit of the entry at level to follow; bitmap is never zero.
+    template <typename Chooser>
+    GetResult claim(Chooser&& choose, size_t& outIndex, size_t maxRetries);
 };
 
 #endif //CROCOS_ATOMICBITPOOL_H
\ No newline at end of file
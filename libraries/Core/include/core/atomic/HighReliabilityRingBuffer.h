@@ -22,6 +22,8 @@ template<typename T, bool Owning = true, bool ScanOnComplete = false>
 class HighReliabilityRingBuffer {
     MPMCRingBuffer<T, Owning, ScanOnComplete> buffer;
     Atomic<size_t> logicalCount{size_t(0)};
+    // Number of times a reader found a claimed item not yet visible and had to spin for it.
+    Atomic<size_t> stalls{size_t(0)};
 
     // Drain `toClaim` already-claimed items from the underlying buffer, invoking
     // callback(callbackOffset + i, slot) for each. Spins if writtenHead has not
@@ -41,6 +43,9 @@ class HighReliabilityRingBuffer {
                 drained += got;
                 spinsWithoutProgress = 0;
             } else {
+                if (spinsWithoutProgress == 0) {
+                    stalls.add_fetch(1, RELAXED);
+                }
                 if (++spinsWithoutProgress > maxSpins) {
                     logicalCount.fetch_add(toClaim - drained, RELEASE);
                     return drained;
@@ -141,6 +146,8 @@ public:
     size_t availableToWrite() const { return buffer.availableToWrite(); }
     bool empty() const { return logicalCount.load(ACQUIRE) == 0; }
     bool full() const { return buffer.full(); }
+    // Reads that had to wait on an in-flight write since construction. Monotonic, relaxed.
+    size_t stallCount() const { return stalls.load(RELAXED); }
     void clear() { buffer.clear(); logicalCount.store(0, RELEASE); }
 };
 
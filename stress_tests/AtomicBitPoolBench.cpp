@@ -0,0 +1,221 @@
+// AtomicBitPoolBench.cpp
+// Throughput comparison of single-index and batched AtomicBitPool operations.
+//
+// Each benchmark does the same work both ways and prints operations per second, along with
+// the speedup of the batched form. Correctness is checked after every run, so a benchmark
+// that reports numbers also left its pool in a consistent state.
+//
+// Usage:
+//   ./AtomicBitPoolBench [options]
+//
+//   --capacity  N      Indices in each pool (default 65536)
+//   --rounds    N      Fill/empty or drain rounds per benchmark (default 16)
+//   --threads   N      Threads for the concurrent benchmark (default 8)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include <core/atomic/AtomicBitPool.h>
+
+using GR = AtomicBitPool::GetResult;
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+struct Config {
+    size_t capacity = 1 << 16;
+    size_t rounds   = 16;
+    size_t threads  = 8;
+};
+
+static Config parseArgs(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--capacity") == 0) cfg.capacity = atoi(argv[++i]);
+        if (strcmp(argv[i], "--rounds")   == 0) cfg.rounds   = atoi(argv[++i]);
+        if (strcmp(argv[i], "--threads")  == 0) cfg.threads  = atoi(argv[++i]);
+    }
+    return cfg;
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+struct BenchPool {
+    std::vector<uint8_t> buffer;
+    AtomicBitPool*       pool = nullptr;
+
+    explicit BenchPool(size_t capacity) {
+        buffer.resize(AtomicBitPool::requiredBufferSize(capacity));
+        pool = new AtomicBitPool(capacity, buffer.data());
+    }
+
+    ~BenchPool() { delete pool; }
+};
+
+template <typename Fn>
+static double timeSeconds(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        fprintf(stderr, "\n[BENCH] CHECK FAILED: %s\n", what);
+        exit(1);
+    }
+}
+
+static void report(const char* name, size_t ops, double singleSeconds, double batchedSeconds) {
+    printf("  %-32s single %12.0f ops/s   batched %12.0f ops/s   (%.2fx)\n", name,
+           static_cast<double>(ops) / singleSeconds, static_cast<double>(ops) / batchedSeconds,
+           singleSeconds / batchedSeconds);
+    fflush(stdout);
+}
+
+// ============================================================================
+// Single-threaded: fill and empty a pool in sorted batches, the pattern
+// NUMAPool sees when it republishes a range of big pages.
+// ============================================================================
+
+static void benchFillAndEmpty(size_t capacity, size_t batchSize, size_t rounds) {
+    BenchPool single(capacity);
+    BenchPool batched(capacity);
+    std::vector<size_t> indices(capacity);
+    for (size_t i = 0; i < capacity; i++) indices[i] = i;
+
+    const double singleSeconds = timeSeconds([&] {
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < capacity; i++) (void)single.pool->add(i);
+            for (size_t i = 0; i < capacity; i++) (void)single.pool->remove(i);
+        }
+    });
+    const double batchedSeconds = timeSeconds([&] {
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < capacity; i += batchSize)
+                (void)batched.pool->addMany(&indices[i], std::min(batchSize, capacity - i));
+            for (size_t i = 0; i < capacity; i += batchSize)
+                (void)batched.pool->removeMany(&indices[i], std::min(batchSize, capacity - i));
+        }
+    });
+
+    check(single.pool->checkInvariants(), "single-index pool invariants after fill/empty");
+    check(batched.pool->checkInvariants(), "batched pool invariants after fill/empty");
+    check(batched.pool->countSet() == 0, "batched pool is empty after fill/empty");
+    char name[64];
+    snprintf(name, sizeof(name), "fill/empty batch %zu", batchSize);
+    report(name, 2 * capacity * rounds, singleSeconds, batchedSeconds);
+}
+
+// ============================================================================
+// Single-threaded: drain a full pool with getAny versus getMany.
+// ============================================================================
+
+static void benchDrain(size_t capacity, size_t batchSize, size_t rounds) {
+    BenchPool single(capacity);
+    BenchPool batched(capacity);
+    std::vector<size_t> indices(capacity);
+    for (size_t i = 0; i < capacity; i++) indices[i] = i;
+    std::vector<size_t> out(batchSize);
+
+    size_t singleTotal = 0;
+    size_t batchedTotal = 0;
+    double singleSeconds = 0;
+    double batchedSeconds = 0;
+    for (size_t r = 0; r < rounds; r++) {
+        (void)single.pool->addMany(indices.data(), capacity);
+        (void)batched.pool->addMany(indices.data(), capacity);
+        singleSeconds += timeSeconds([&] {
+            size_t idx;
+            while (single.pool->getAny(0, idx) == GR::Success) singleTotal++;
+        });
+        batchedSeconds += timeSeconds([&] {
+            size_t got;
+            while (batched.pool->getMany(0, out.data(), batchSize, got) == GR::Success) batchedTotal += got;
+        });
+    }
+
+    check(singleTotal == capacity * rounds, "getAny drained every index");
+    check(batchedTotal == capacity * rounds, "getMany drained every index");
+    check(batched.pool->checkInvariants(), "batched pool invariants after drain");
+    char name[64];
+    snprintf(name, sizeof(name), "drain batch %zu", batchSize);
+    report(name, capacity * rounds, singleSeconds, batchedSeconds);
+}
+
+// ============================================================================
+// Concurrent: each thread repeatedly adds and removes its own stripe of the
+// pool, so the shared upper levels take the traffic.
+// ============================================================================
+
+static void benchConcurrentStripes(size_t capacity, size_t numThreads, size_t batchSize, size_t rounds) {
+    const size_t stripe = capacity / numThreads;
+
+    const auto run = [&](AtomicBitPool& pool, bool useBatches) {
+        std::vector<std::thread> threads;
+        return timeSeconds([&] {
+            for (size_t t = 0; t < numThreads; t++) {
+                threads.emplace_back([&, t] {
+                    std::vector<size_t> indices(stripe);
+                    for (size_t i = 0; i < stripe; i++) indices[i] = t * stripe + i;
+                    for (size_t r = 0; r < rounds; r++) {
+                        if (useBatches) {
+                            for (size_t i = 0; i < stripe; i += batchSize)
+                                (void)pool.addMany(&indices[i], std::min(batchSize, stripe - i));
+                            for (size_t i = 0; i < stripe; i += batchSize)
+                                (void)pool.removeMany(&indices[i], std::min(batchSize, stripe - i));
+                        } else {
+                            for (size_t idx : indices) (void)pool.add(idx);
+                            for (size_t idx : indices) (void)pool.remove(idx);
+                        }
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+        });
+    };
+
+    BenchPool single(capacity);
+    BenchPool batched(capacity);
+    const double singleSeconds = run(*single.pool, false);
+    const double batchedSeconds = run(*batched.pool, true);
+
+    check(single.pool->checkInvariants(), "single-index pool invariants after concurrent stripes");
+    check(batched.pool->checkInvariants(), "batched pool invariants after concurrent stripes");
+    check(batched.pool->countSet() == 0, "batched pool is empty after concurrent stripes");
+    char name[64];
+    snprintf(name, sizeof(name), "%zu threads batch %zu", numThreads, batchSize);
+    report(name, 2 * stripe * numThreads * rounds, singleSeconds, batchedSeconds);
+}
+
+// ============================================================================
+// Entry point
+// ============================================================================
+
+int main(int argc, char** argv) {
+    Config cfg = parseArgs(argc, argv);
+    if (cfg.capacity == 0) cfg.capacity = 1;
+    if (cfg.rounds == 0) cfg.rounds = 1;
+    if (cfg.threads == 0) cfg.threads = 1;
+    if (cfg.threads > cfg.capacity) cfg.threads = cfg.capacity;
+
+    printf("=== CroCOS AtomicBitPool Batch Benchmark ===\n");
+    printf("  Capacity:  %zu\n", cfg.capacity);
+    printf("  Rounds:    %zu\n", cfg.rounds);
+    printf("  Threads:   %zu\n\n", cfg.threads);
+
+    benchFillAndEmpty(cfg.capacity, 64, cfg.rounds);
+    benchFillAndEmpty(cfg.capacity, 512, cfg.rounds);
+    benchDrain(cfg.capacity, 64, cfg.rounds);
+    benchConcurrentStripes(cfg.capacity, cfg.threads, 64, cfg.rounds);
+    return 0;
+}
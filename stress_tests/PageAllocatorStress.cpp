@@ -11,6 +11,18 @@
 //   --batch     N      Max pages per alloc call (default 64)
 //   --interval  N      Report interval in milliseconds (default 5000)
 //   --intervals N      Stop after N report intervals (default 0 = run forever)
+//   --mode      M      mixed:  random-sized bulk alloc/free (default)
+//                      single: one page per call, reporting per-call latency
+//                      xcpu:   threads run in producer/consumer pairs; pages allocated
+//                              on one CPU are freed on another
+//                      bulk:   allocate --bulk pages, then hand them all to one freePages call
+//                      lifetime: mixed churn plus small long-lived batches held across many
+//                              calls, to watch how many big pages stay whole over time
+//   --bulk      N      Pages per bulk free in bulk mode (default 16384)
+//   --bulk-order sorted|shuffled  Address order of the bulk free array (default shuffled)
+//   --magazine  on|off Per-CPU single-page magazines (default off)
+//   --remote-free on|off  Queue cross-CPU frees on the holder's inbox (default off)
+//   --hints     on|off Pass LONG_LIVED on long-lived batches in lifetime mode (default on)
 //
 // Ctrl+C to stop gracefully.
 
@@ -27,11 +39,14 @@
 #include <vector>
 #include <optional>
 #include <string>
+#include <mutex>
+#include <algorithm>
 
 #include <mem/PageAllocator.h>
 #include <mem/mm.h>
 #include <mem/NUMA.h>
 #include <arch.h>
+#include <core/algo/sort.h>
 
 using namespace kernel::mm;
 namespace PA = kernel::mm::PageAllocator;
@@ -52,8 +67,33 @@ struct Config {
     size_t maxBatch          = 2048;
     size_t reportIntervalMs  = 5000;
     size_t maxIntervals      = 0;   // 0 = run until SIGINT/SIGTERM
+    enum class Mode { Mixed, Single, CrossCPU, BulkFree, Lifetime };
+    Mode   mode              = Mode::Mixed;
+    bool   magazines         = false;
+    bool   remoteFrees       = false;
+    size_t bulkPages         = 16384;
+    bool   bulkSorted        = false;
+    bool   lifetimeHints     = true;
 };
 
+static Config::Mode parseMode(const char* name) {
+    if (strcmp(name, "single") == 0) return Config::Mode::Single;
+    if (strcmp(name, "xcpu")   == 0) return Config::Mode::CrossCPU;
+    if (strcmp(name, "bulk")   == 0) return Config::Mode::BulkFree;
+    if (strcmp(name, "lifetime") == 0) return Config::Mode::Lifetime;
+    return Config::Mode::Mixed;
+}
+
+static const char* modeName(Config::Mode mode) {
+    switch (mode) {
+        case Config::Mode::Single:   return "single-page";
+        case Config::Mode::CrossCPU: return "cross-CPU producer/consumer";
+        case Config::Mode::BulkFree: return "bulk free";
+        case Config::Mode::Lifetime: return "lifetime-segregated churn";
+        default:                     return "mixed";
+    }
+}
+
 static Config parseArgs(int argc, char** argv) {
     Config cfg;
     for (int i = 1; i < argc - 1; i++) {
@@ -63,6 +103,12 @@ static Config parseArgs(int argc, char** argv) {
         if (strcmp(argv[i], "--batch")     == 0) cfg.maxBatch          = atoi(argv[++i]);
         if (strcmp(argv[i], "--interval")  == 0) cfg.reportIntervalMs  = atoi(argv[++i]);
         if (strcmp(argv[i], "--intervals") == 0) cfg.maxIntervals      = atoi(argv[++i]);
+        if (strcmp(argv[i], "--mode")      == 0) cfg.mode              = parseMode(argv[++i]);
+        if (strcmp(argv[i], "--magazine")  == 0) cfg.magazines         = strcmp(argv[++i], "on") == 0;
+        if (strcmp(argv[i], "--remote-free") == 0) cfg.remoteFrees     = strcmp(argv[++i], "on") == 0;
+        if (strcmp(argv[i], "--bulk")      == 0) cfg.bulkPages         = atoi(argv[++i]);
+        if (strcmp(argv[i], "--bulk-order") == 0) cfg.bulkSorted      = strcmp(argv[++i], "sorted") == 0;
+        if (strcmp(argv[i], "--hints")     == 0) cfg.lifetimeHints     = strcmp(argv[++i], "on") == 0;
     }
     return cfg;
 }
@@ -76,7 +122,11 @@ struct alignas(64) ThreadStats {
     std::atomic<uint64_t> freeCalls     {0};
     std::atomic<uint64_t> pagesAllocated{0};
     std::atomic<uint64_t> oomEvents     {0};
-    char _pad[64 - 4 * sizeof(std::atomic<uint64_t>)];
+    std::atomic<uint64_t> pagesFreed    {0};
+    // Wall time spent inside allocatePages / freePages (single-page, cross-CPU and bulk modes).
+    std::atomic<uint64_t> allocNanos    {0};
+    std::atomic<uint64_t> freeNanos     {0};
+    char _pad[64 - 7 * sizeof(std::atomic<uint64_t>)];
 };
 static_assert(sizeof(ThreadStats) == 64, "ThreadStats must be exactly one cache line");
 
@@ -90,14 +140,19 @@ static constexpr uint64_t domainBase(size_t d) {
 
 struct BootstrapBuffer {
     std::vector<uint8_t> storage;
-    explicit BootstrapBuffer(size_t bytes) : storage(bytes, 0) {}
+    // The measuring pass starts at address 0, so the real buffer must start on a
+    // cache line too or cache-line-aligned structures would pad differently.
+    explicit BootstrapBuffer(size_t bytes) : storage(bytes + arch::CACHE_LINE_SIZE, 0) {}
     BootstrapAllocator makeAllocator() {
-        return BootstrapAllocator(storage.data(), storage.size());
+        const auto base = reinterpret_cast<uintptr_t>(storage.data());
+        const size_t slack = (arch::CACHE_LINE_SIZE - base % arch::CACHE_LINE_SIZE) % arch::CACHE_LINE_SIZE;
+        return BootstrapAllocator(storage.data() + slack, storage.size() - slack);
     }
 };
 
 struct StressAllocatorImpl {
     std::vector<BootstrapBuffer>           domainBuffers;
+    std::optional<BootstrapBuffer>         radixBuffer;
     LocalPool*                             localPools[arch::MAX_PROCESSOR_COUNT] = {};
     kernel::numa::NUMATopology             topology = kernel::numa::NUMATopology::build(
         kernel::numa::EmptyIterable<kernel::numa::ProcessorAffinityEntry>{},
@@ -138,6 +193,16 @@ struct StressAllocatorImpl {
             policyPtr = &policy.value();
         }
 
+        // Metadata radix over every domain's range
+        Vector<phys_memory_range> allRanges;
+        for (size_t d = 0; d < numDomains; d++)
+            allRanges.push({ phys_addr(domainBase(d)), phys_addr(domainBase(d) + bigPages * arch::bigPageSize) });
+        BootstrapAllocator radixMeasuring;
+        createMetadataRadix(radixMeasuring, allRanges);
+        radixBuffer.emplace(radixMeasuring.bytesNeeded());
+        BootstrapAllocator radixReal = radixBuffer->makeAllocator();
+        const MetadataRadix metadataRadix = createMetadataRadix(radixReal, allRanges);
+
         domainBuffers.reserve(numDomains);
         Vector<NUMAPool*> numaPools;
 
@@ -166,7 +231,7 @@ struct StressAllocatorImpl {
         }
 
         impl = createPageAllocator(move(numaPools), localPools,
-                                   totalThreads, nullptr, policyPtr);
+                                   totalThreads, nullptr, policyPtr, metadataRadix);
     }
 };
 
@@ -223,7 +288,274 @@ static void workerThread(PageAllocatorImpl& impl,
             stats.pagesAllocated.fetch_add(count, std::memory_order_relaxed);
             impl.freePages(pages, count);
             stats.freeCalls.fetch_add(1, std::memory_order_relaxed);
+            stats.pagesFreed.fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Single-page mode: allocate up to maxBatch pages one call at a time, then free them
+// one call at a time, timing each phase as a whole so clock reads stay off the per-call path.
+static void singlePageWorkerThread(PageAllocatorImpl& impl,
+                                   ThreadStats& stats,
+                                   size_t maxBatch) {
+    using Clock = std::chrono::steady_clock;
+    std::mt19937_64 rng(std::random_device{}());
+    std::uniform_int_distribution<size_t> pick(1, maxBatch);
+
+    PageRef pages[HARD_MAX_BATCH];
+
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        const size_t target = pick(rng);
+        size_t count = 0;
+
+        const auto allocStart = Clock::now();
+        for (size_t i = 0; i < target; i++) {
+            if (impl.allocatePages(1, [&](PageRef r) { pages[count++] = r; },
+                                   AllocBehavior::GRACEFUL_OOM) == 0) {
+                break;
+            }
+        }
+        const auto allocEnd = Clock::now();
+        for (size_t i = 0; i < count; i++) {
+            impl.freePages(&pages[i], 1);
+        }
+        const auto freeEnd = Clock::now();
+
+        stats.allocCalls.fetch_add(count, std::memory_order_relaxed);
+        stats.freeCalls.fetch_add(count, std::memory_order_relaxed);
+        stats.pagesAllocated.fetch_add(count, std::memory_order_relaxed);
+        stats.pagesFreed.fetch_add(count, std::memory_order_relaxed);
+        if (count < target) stats.oomEvents.fetch_add(1, std::memory_order_relaxed);
+        stats.allocNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(allocEnd - allocStart).count(),
+                                   std::memory_order_relaxed);
+        stats.freeNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(freeEnd - allocEnd).count(),
+                                  std::memory_order_relaxed);
+    }
+}
+
+// Bulk-free mode: accumulate bulkPages pages over many allocation calls, arrange them in
+// the requested address order, and return them all with a single freePages call. The
+// free phase is what this mode measures; a shuffled array exercises the free path's sort.
+static void bulkFreeWorkerThread(PageAllocatorImpl& impl,
+                                 ThreadStats& stats,
+                                 size_t maxBatch,
+                                 size_t bulkPages,
+                                 bool sorted) {
+    using Clock = std::chrono::steady_clock;
+    std::mt19937_64 rng(std::random_device{}());
+
+    std::vector<PageRef> pages(bulkPages);
+    // Requests of a big page or more come back as big PageRefs; keep every chunk below that
+    // so the bulk free is made entirely of small pages.
+    const size_t chunk = std::min(maxBatch, PA::smallPagesPerBigPage - 1);
+
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        size_t count = 0;
+        const auto allocStart = Clock::now();
+        while (count < bulkPages) {
+            const size_t got = impl.allocatePages(std::min(chunk, bulkPages - count),
+                [&](PageRef r) { pages[count++] = r; },
+                AllocBehavior::GRACEFUL_OOM);
+            stats.allocCalls.fetch_add(1, std::memory_order_relaxed);
+            if (got == 0) {
+                stats.oomEvents.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
         }
+        const auto allocEnd = Clock::now();
+        if (count == 0) continue;
+
+        // Core's swap and std::swap are ambiguous for PageRef, so order by hand rather than
+        // through <algorithm>.
+        if (sorted) {
+            algorithm::sort(pages.data(), count,
+                            [](const PageRef& a, const PageRef& b) { return a.addr().value < b.addr().value; });
+        } else {
+            for (size_t i = count - 1; i > 0; i--) {
+                const size_t j = std::uniform_int_distribution<size_t>(0, i)(rng);
+                const PageRef tmp = pages[i];
+                pages[i] = pages[j];
+                pages[j] = tmp;
+            }
+        }
+
+        const auto freeStart = Clock::now();
+        impl.freePages(pages.data(), count);
+        const auto freeEnd = Clock::now();
+
+        stats.pagesAllocated.fetch_add(count, std::memory_order_relaxed);
+        stats.freeCalls.fetch_add(1, std::memory_order_relaxed);
+        stats.pagesFreed.fetch_add(count, std::memory_order_relaxed);
+        stats.allocNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(allocEnd - allocStart).count(),
+                                   std::memory_order_relaxed);
+        stats.freeNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(freeEnd - freeStart).count(),
+                                  std::memory_order_relaxed);
+    }
+}
+
+// Lifetime mode: short-lived batches are freed straight away as in mixed mode, while every
+// eighth call also allocates a small long-lived batch that is parked in a per-thread ring and
+// freed only when the ring wraps around to it. With hints off the long-lived batches carry no
+// LONG_LIVED flag and share big pages with the churn; compare the whole-big-page column.
+static void lifetimeWorkerThread(PageAllocatorImpl& impl,
+                                 ThreadStats& stats,
+                                 size_t maxBatch,
+                                 bool hints) {
+    static constexpr size_t LONG_LIVED_SLOTS = 256;
+    static constexpr size_t LONG_LIVED_MAX   = 16;
+    struct Held {
+        size_t  count = 0;
+        PageRef pages[LONG_LIVED_MAX];
+    };
+
+    std::mt19937_64 rng(std::random_device{}());
+    std::uniform_int_distribution<size_t> pick(1, maxBatch);
+    std::uniform_int_distribution<size_t> pickLong(1, LONG_LIVED_MAX);
+    const AllocFlags longFlags = hints ? AllocBehavior::GRACEFUL_OOM | AllocBehavior::LONG_LIVED
+                                       : AllocFlags(AllocBehavior::GRACEFUL_OOM);
+
+    PageRef pages[HARD_MAX_BATCH];
+    std::vector<Held> held(LONG_LIVED_SLOTS);
+    size_t nextSlot = 0;
+    uint64_t calls = 0;
+
+    const auto release = [&](Held& slot) {
+        if (slot.count == 0) return;
+        impl.freePages(slot.pages, slot.count);
+        stats.freeCalls.fetch_add(1, std::memory_order_relaxed);
+        stats.pagesFreed.fetch_add(slot.count, std::memory_order_relaxed);
+        slot.count = 0;
+    };
+
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        if (++calls % 8 == 0) {
+            Held& slot = held[nextSlot];
+            nextSlot = (nextSlot + 1) % LONG_LIVED_SLOTS;
+            release(slot);
+            impl.allocatePages(pickLong(rng), [&](PageRef r) { slot.pages[slot.count++] = r; }, longFlags);
+            stats.allocCalls.fetch_add(1, std::memory_order_relaxed);
+            if (slot.count == 0) stats.oomEvents.fetch_add(1, std::memory_order_relaxed);
+            stats.pagesAllocated.fetch_add(slot.count, std::memory_order_relaxed);
+        }
+
+        size_t count = 0;
+        impl.allocatePages(pick(rng),
+            [&](PageRef r) { pages[count++] = r; },
+            AllocBehavior::GRACEFUL_OOM | AllocBehavior::SHORT_LIVED);
+
+        stats.allocCalls.fetch_add(1, std::memory_order_relaxed);
+        if (count == 0) {
+            stats.oomEvents.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            stats.pagesAllocated.fetch_add(count, std::memory_order_relaxed);
+            impl.freePages(pages, count);
+            stats.freeCalls.fetch_add(1, std::memory_order_relaxed);
+            stats.pagesFreed.fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+    for (auto& slot : held) release(slot);
+}
+
+// Cross-CPU mode: a bounded hand-off queue of page batches between one producer
+// thread and one consumer thread (and therefore between two different CPUs).
+struct CrossCPUChannel {
+    static constexpr size_t DEPTH = 8;
+    struct Batch {
+        size_t  count = 0;
+        PageRef pages[HARD_MAX_BATCH];
+    };
+
+    std::mutex            lock;
+    Batch                 slots[DEPTH];
+    size_t                head = 0;   // next slot to pop
+    size_t                size = 0;
+    std::atomic<bool>     producerDone{false};
+
+    bool push(const PageRef* pages, size_t count) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (size == DEPTH) return false;
+        Batch& slot = slots[(head + size) % DEPTH];
+        memcpy(slot.pages, pages, count * sizeof(PageRef));
+        slot.count = count;
+        size++;
+        return true;
+    }
+
+    size_t pop(PageRef* out) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (size == 0) return 0;
+        Batch& slot = slots[head];
+        memcpy(out, slot.pages, slot.count * sizeof(PageRef));
+        head = (head + 1) % DEPTH;
+        size--;
+        return slot.count;
+    }
+};
+
+static void crossCPUProducerThread(PageAllocatorImpl& impl,
+                                   ThreadStats& stats,
+                                   CrossCPUChannel& channel,
+                                   size_t maxBatch) {
+    using Clock = std::chrono::steady_clock;
+    std::mt19937_64 rng(std::random_device{}());
+    std::uniform_int_distribution<size_t> pick(1, maxBatch);
+
+    PageRef pages[HARD_MAX_BATCH];
+
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        size_t count = 0;
+        const auto allocStart = Clock::now();
+        impl.allocatePages(pick(rng),
+            [&](PageRef r) { pages[count++] = r; },
+            AllocBehavior::GRACEFUL_OOM);
+        const auto allocEnd = Clock::now();
+
+        stats.allocCalls.fetch_add(1, std::memory_order_relaxed);
+        stats.allocNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(allocEnd - allocStart).count(),
+                                   std::memory_order_relaxed);
+        if (count == 0) {
+            stats.oomEvents.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+            continue;
+        }
+        stats.pagesAllocated.fetch_add(count, std::memory_order_relaxed);
+
+        while (!channel.push(pages, count)) {
+            if (g_stop.load(std::memory_order_relaxed)) {
+                // The consumer may already be gone; keep the accounting whole.
+                impl.freePages(pages, count);
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    channel.producerDone.store(true, std::memory_order_release);
+}
+
+static void crossCPUConsumerThread(PageAllocatorImpl& impl,
+                                   ThreadStats& stats,
+                                   CrossCPUChannel& channel) {
+    using Clock = std::chrono::steady_clock;
+    PageRef pages[HARD_MAX_BATCH];
+
+    while (true) {
+        // Check producerDone before popping so a final batch pushed just before it is set
+        // is still seen.
+        const bool producerDone = channel.producerDone.load(std::memory_order_acquire);
+        const size_t count = channel.pop(pages);
+        if (count == 0) {
+            if (producerDone) break;
+            std::this_thread::yield();
+            continue;
+        }
+        const auto freeStart = Clock::now();
+        impl.freePages(pages, count);
+        const auto freeEnd = Clock::now();
+
+        stats.freeCalls.fetch_add(1, std::memory_order_relaxed);
+        stats.pagesFreed.fetch_add(count, std::memory_order_relaxed);
+        stats.freeNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(freeEnd - freeStart).count(),
+                                  std::memory_order_relaxed);
     }
 }
 
@@ -231,6 +563,14 @@ static void workerThread(PageAllocatorImpl& impl,
 // Reporter thread — wakes every reportIntervalMs and prints a stats line
 // ============================================================================
 
+// Free big pages summed over every domain: whole 2 MiB pages, not counting partial ones.
+static size_t countFreeBigPages(PageAllocatorImpl& impl) {
+    const auto pa = impl.getStatistics();
+    size_t total = 0;
+    for (size_t d = 0; d < pa.freeBigPageCount.size(); d++) total += pa.freeBigPageCount[d];
+    return total;
+}
+
 static void reporterThread(PageAllocatorImpl& impl,
                             std::vector<ThreadStats>& stats,
                             size_t totalPages,
@@ -244,7 +584,8 @@ static void reporterThread(PageAllocatorImpl& impl,
     // Previous-snapshot accumulators for delta computation
     const size_t n = stats.size();
     std::vector<uint64_t> prevAlloc(n, 0), prevFree(n, 0),
-                          prevPages(n, 0), prevOom(n, 0);
+                          prevPages(n, 0), prevOom(n, 0), prevFreed(n, 0),
+                          prevAllocNs(n, 0), prevFreeNs(n, 0);
 
     size_t intervalsDone = 0;
 
@@ -254,7 +595,7 @@ static void reporterThread(PageAllocatorImpl& impl,
 
         double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
 
-        uint64_t dAlloc = 0, dFree = 0, dPages = 0, dOom = 0;
+        uint64_t dAlloc = 0, dFree = 0, dPages = 0, dOom = 0, dFreed = 0, dAllocNs = 0, dFreeNs = 0;
         for (size_t i = 0; i < n; i++) {
             uint64_t a = stats[i].allocCalls    .load(std::memory_order_relaxed);
             uint64_t f = stats[i].freeCalls     .load(std::memory_order_relaxed);
@@ -264,20 +605,34 @@ static void reporterThread(PageAllocatorImpl& impl,
             dFree  += f - prevFree[i];   prevFree[i]  = f;
             dPages += p - prevPages[i];  prevPages[i] = p;
             dOom   += o - prevOom[i];    prevOom[i]   = o;
+            uint64_t pf = stats[i].pagesFreed.load(std::memory_order_relaxed);
+            dFreed += pf - prevFreed[i]; prevFreed[i] = pf;
+            uint64_t an = stats[i].allocNanos.load(std::memory_order_relaxed);
+            uint64_t fn = stats[i].freeNanos .load(std::memory_order_relaxed);
+            dAllocNs += an - prevAllocNs[i];  prevAllocNs[i] = an;
+            dFreeNs  += fn - prevFreeNs[i];   prevFreeNs[i]  = fn;
         }
 
         uint64_t freeCount = impl.countFreePages();
+        uint64_t freeBig   = countFreeBigPages(impl);
         double   oomPct    = (dAlloc > 0) ? 100.0 * dOom / dAlloc : 0.0;
 
         printf("[%8.3fs]  alloc: %s/s  free: %s/s  pages: %s/s  OOM: %5.2f%%  "
-               "free pages: %s / %s\n",
+               "free pages: %s / %s  whole big pages: %s / %s\n",
                elapsed,
                fmtRate(dAlloc / intervalSec).c_str(),
                fmtRate(dFree  / intervalSec).c_str(),
                fmtRate(dPages / intervalSec).c_str(),
                oomPct,
                fmtNum(freeCount).c_str(),
-               fmtNum(totalPages).c_str());
+               fmtNum(totalPages).c_str(),
+               fmtNum(freeBig).c_str(),
+               fmtNum(totalPages / PA::smallPagesPerBigPage).c_str());
+        if (dAllocNs > 0 && dPages > 0 && dFreed > 0) {
+            printf("             per-page latency: alloc %.1f ns  free %.1f ns\n",
+                   static_cast<double>(dAllocNs) / dPages,
+                   static_cast<double>(dFreeNs)  / dFreed);
+        }
         fflush(stdout);
 
         ++intervalsDone;
@@ -317,6 +672,13 @@ int main(int argc, char** argv) {
     printf("  Worker threads:   %zu  (%zu per domain)\n",
            totalThreads, cfg.threadsPerDomain);
     printf("  Max alloc batch:  %zu pages\n", cfg.maxBatch);
+    printf("  Mode:             %s\n", modeName(cfg.mode));
+    printf("  Magazines:        %s\n", cfg.magazines ? "on" : "off");
+    printf("  Remote frees:     %s\n", cfg.remoteFrees ? "on" : "off");
+    if (cfg.mode == Config::Mode::BulkFree)
+        printf("  Bulk free:        %zu pages, %s\n", cfg.bulkPages, cfg.bulkSorted ? "sorted" : "shuffled");
+    if (cfg.mode == Config::Mode::Lifetime)
+        printf("  Lifetime hints:   %s\n", cfg.lifetimeHints ? "on" : "off");
     printf("  Report interval:  %zu ms\n", cfg.reportIntervalMs);
     if (cfg.maxIntervals > 0)
         printf("  Max intervals:    %zu  (%.1f s total)\n",
@@ -325,12 +687,14 @@ int main(int argc, char** argv) {
 
     printf("Building allocator...\n");
     StressAllocatorImpl allocator(cfg);
+    allocator.impl.magazinesEnabled = cfg.magazines;
+    allocator.impl.remoteFreesEnabled = cfg.remoteFrees;
     printf("Allocator ready. Starting workers.\n\n");
 
-    printf("%-10s  %-15s  %-15s  %-17s  %-8s  %s\n",
+    printf("%-10s  %-15s  %-15s  %-17s  %-8s  %-20s  %s\n",
            "[elapsed]", "alloc ops/s", "free ops/s", "pages alloc'd/s",
-           "OOM %", "free pages");
-    printf("%s\n", std::string(85, '-').c_str());
+           "OOM %", "free pages", "whole big pages");
+    printf("%s\n", std::string(107, '-').c_str());
     fflush(stdout);
 
     // Allocate stats array (one entry per worker thread)
@@ -342,12 +706,26 @@ int main(int argc, char** argv) {
                        cfg.reportIntervalMs, cfg.maxIntervals);
     });
 
+    // Cross-CPU mode pairs thread 2k (producer) with thread 2k+1 (consumer); an odd
+    // thread out runs the mixed workload.
+    std::vector<CrossCPUChannel> channels(cfg.mode == Config::Mode::CrossCPU ? totalThreads / 2 : 0);
+
     // Launch worker threads
     std::vector<std::thread> workers;
     workers.reserve(totalThreads);
     for (size_t i = 0; i < totalThreads; i++) {
         workers.emplace_back([&, i]() {
-            workerThread(allocator.impl, stats[i], cfg.maxBatch);
+            if (cfg.mode == Config::Mode::Single)
+                singlePageWorkerThread(allocator.impl, stats[i], cfg.maxBatch);
+            else if (cfg.mode == Config::Mode::BulkFree)
+                bulkFreeWorkerThread(allocator.impl, stats[i], cfg.maxBatch, cfg.bulkPages, cfg.bulkSorted);
+            else if (cfg.mode == Config::Mode::Lifetime)
+                lifetimeWorkerThread(allocator.impl, stats[i], cfg.maxBatch, cfg.lifetimeHints);
+            else if (cfg.mode == Config::Mode::CrossCPU && i / 2 < channels.size())
+                (i % 2 == 0) ? crossCPUProducerThread(allocator.impl, stats[i], channels[i / 2], cfg.maxBatch)
+                             : crossCPUConsumerThread(allocator.impl, stats[i], channels[i / 2]);
+            else
+                workerThread(allocator.impl, stats[i], cfg.maxBatch);
         });
     }
 
@@ -355,12 +733,24 @@ int main(int argc, char** argv) {
     for (auto& w : workers) w.join();
     reporter.join();
 
+    // Pages parked in magazines or remote-free inboxes still count as allocated; hand them
+    // back before the final tally. Disable both first so the flush cannot refill either.
+    allocator.impl.magazinesEnabled = false;
+    allocator.impl.remoteFreesEnabled = false;
+    for (size_t cpu = 0; cpu < totalThreads; cpu++) {
+        allocator.impl.flushMagazine(static_cast<arch::ProcessorID>(cpu));
+        allocator.impl.drainRemoteFrees(static_cast<arch::ProcessorID>(cpu));
+    }
+
     // Final summary
-    uint64_t totalAlloc = 0, totalFree = 0, totalPg = 0, totalOom = 0;
+    uint64_t totalAlloc = 0, totalFree = 0, totalPg = 0, totalFreed = 0, totalOom = 0, totalAllocNs = 0, totalFreeNs = 0;
     for (auto& s : stats) {
+        totalAllocNs += s.allocNanos.load(std::memory_order_relaxed);
+        totalFreeNs  += s.freeNanos .load(std::memory_order_relaxed);
         totalAlloc += s.allocCalls    .load(std::memory_order_relaxed);
         totalFree  += s.freeCalls     .load(std::memory_order_relaxed);
         totalPg    += s.pagesAllocated.load(std::memory_order_relaxed);
+        totalFreed += s.pagesFreed    .load(std::memory_order_relaxed);
         totalOom   += s.oomEvents     .load(std::memory_order_relaxed);
     }
 
@@ -371,9 +761,33 @@ int main(int argc, char** argv) {
     printf("  OOM events:      %s  (%.2f%%)\n",
            fmtNum(totalOom).c_str(),
            totalAlloc > 0 ? 100.0 * totalOom / totalAlloc : 0.0);
+    if (cfg.mode != Config::Mode::Mixed && totalPg > 0 && totalFreed > 0) {
+        printf("  Alloc latency:   %.1f ns/page\n", static_cast<double>(totalAllocNs) / totalPg);
+        printf("  Free latency:    %.1f ns/page\n", static_cast<double>(totalFreeNs)  / totalFreed);
+    }
     printf("  Free pages now:  %s / %s\n",
            fmtNum(allocator.impl.countFreePages()).c_str(),
            fmtNum(totalPages).c_str());
+    printf("  Whole big pages: %s / %s\n",
+           fmtNum(countFreeBigPages(allocator.impl)).c_str(),
+           fmtNum(totalPages / PA::smallPagesPerBigPage).c_str());
+
+    const auto pa = allocator.impl.getStatistics();
+    uint64_t contention = 0, stalls = 0;
+    for (size_t d = 0; d < pa.paPagesContention.size(); d++) {
+        contention += pa.paPagesContention[d];
+        stalls     += pa.ringStalls[d];
+    }
+    const uint64_t requests = pa.total.fastPathHits + pa.total.fallbacks;
+    printf("\n=== Allocator Counters ===\n");
+    printf("  Fast-path hits:  %s  (%.2f%%)\n", fmtNum(pa.total.fastPathHits).c_str(),
+           requests > 0 ? 100.0 * pa.total.fastPathHits / requests : 0.0);
+    printf("  Fallbacks:       %s\n", fmtNum(pa.total.fallbacks).c_str());
+    printf("  Refills:         magazine %s  big-page cache %s\n",
+           fmtNum(pa.total.magazineRefills).c_str(), fmtNum(pa.total.bigPageCacheRefills).c_str());
+    printf("  Remote-domain:   %s pages\n", fmtNum(pa.total.remoteDomainPages).c_str());
+    printf("  Remote frees:    %s pages posted\n", fmtNum(pa.total.remoteFreesPosted).c_str());
+    printf("  paPages contention: %s   ring stalls: %s\n", fmtNum(contention).c_str(), fmtNum(stalls).c_str());
 
     return 0;
 }
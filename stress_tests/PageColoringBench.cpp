@@ -0,0 +1,272 @@
+// PageColoringBench.cpp
+// Compares cache conflict misses on per-CPU data allocated with and without COLORED.
+//
+// Each simulated CPU builds a hot set of small pages one page at a time, with other
+// allocations and frees churning its partial big pages in between, the way per-CPU buffers
+// and page tables accumulate over a kernel's lifetime. It then makes random accesses to
+// the hot set through a model of its L2 (geometry from arch::getCacheGeometry, LRU within
+// each set). The hot set fits in the cache, so once every line has been touched once any
+// further miss is a conflict miss: some set was asked to hold more lines than it has ways.
+// The host's own caches are not involved, since the physical addresses are simulated.
+//
+// Usage:
+//   ./PageColoringBench [options]
+//
+//   --cpus      N      Simulated CPUs, one thread each (default 4)
+//   --pages     N      Big pages in the pool (default 256)
+//   --hot       N      Hot pages per CPU (default 3/4 of the L2)
+//   --churn     N      Background alloc/free operations between hot pages (default 8)
+//   --accesses  N      Simulated accesses per CPU after warmup (default 2,000,000)
+//   --seed      N      Random seed (default 1)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <thread>
+#include <random>
+#include <vector>
+#include <optional>
+#include <string>
+#include <algorithm>
+
+#include <mem/PageAllocator.h>
+#include <mem/mm.h>
+#include <mem/NUMA.h>
+#include <arch.h>
+
+using namespace kernel::mm;
+namespace PA = kernel::mm::PageAllocator;
+
+namespace arch { void stressSetProcessorCount(size_t n); }
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+struct Config {
+    size_t cpus     = 4;
+    size_t bigPages = 256;
+    size_t hotPages = 0;    // 0 = three quarters of the L2
+    size_t churnOps = 8;
+    size_t accesses = 2000000;
+    uint64_t seed   = 1;
+};
+
+static Config parseArgs(int argc, char** argv) {
+    Config cfg;
+    for (int i = 1; i < argc - 1; i++) {
+        if (strcmp(argv[i], "--cpus")     == 0) cfg.cpus     = atoi(argv[++i]);
+        if (strcmp(argv[i], "--pages")    == 0) cfg.bigPages = atoi(argv[++i]);
+        if (strcmp(argv[i], "--hot")      == 0) cfg.hotPages = atoi(argv[++i]);
+        if (strcmp(argv[i], "--churn")    == 0) cfg.churnOps = atoi(argv[++i]);
+        if (strcmp(argv[i], "--accesses") == 0) cfg.accesses = atoi(argv[++i]);
+        if (strcmp(argv[i], "--seed")     == 0) cfg.seed     = strtoull(argv[++i], nullptr, 10);
+    }
+    return cfg;
+}
+
+static std::string fmtNum(uint64_t n) {
+    std::string s = std::to_string(n);
+    for (int i = static_cast<int>(s.size()) - 3; i > 0; i -= 3)
+        s.insert(static_cast<size_t>(i), ",");
+    return s;
+}
+
+// ============================================================================
+// Allocator setup (single domain, one LocalPool per simulated CPU)
+// ============================================================================
+
+static constexpr uint64_t poolBase = 1ull << 30;
+
+struct BootstrapBuffer {
+    std::vector<uint8_t> storage;
+    explicit BootstrapBuffer(size_t bytes) : storage(bytes + arch::CACHE_LINE_SIZE, 0) {}
+    BootstrapAllocator makeAllocator() {
+        const auto base = reinterpret_cast<uintptr_t>(storage.data());
+        const size_t slack = (arch::CACHE_LINE_SIZE - base % arch::CACHE_LINE_SIZE) % arch::CACHE_LINE_SIZE;
+        return BootstrapAllocator(storage.data() + slack, storage.size() - slack);
+    }
+};
+
+struct BenchAllocatorImpl {
+    std::optional<BootstrapBuffer> buffer;
+    LocalPool*                     localPools[arch::MAX_PROCESSOR_COUNT] = {};
+    PageAllocatorImpl              impl;
+
+    BenchAllocatorImpl(const Config& cfg, size_t colors) {
+        Vector<phys_memory_range> ranges;
+        ranges.push({ phys_addr(poolBase), phys_addr(poolBase + cfg.bigPages * arch::bigPageSize) });
+
+        BootstrapAllocator measuring;
+        createNumaPool(measuring, ranges);
+        for (size_t cpu = 0; cpu < cfg.cpus; cpu++)
+            createLocalPool(measuring);
+        buffer.emplace(measuring.bytesNeeded());
+
+        BootstrapAllocator real = buffer->makeAllocator();
+        NUMAPool* pool = createNumaPool(real, ranges);
+        for (size_t cpu = 0; cpu < cfg.cpus; cpu++)
+            localPools[cpu] = createLocalPool(real, nullptr, pool, static_cast<arch::ProcessorID>(cpu));
+        Vector<NUMAPool*> pools;
+        pools.push(pool);
+        impl = createPageAllocator(move(pools), localPools, cfg.cpus);
+
+        // Same fast-path configuration as initPageAllocator.
+        impl.magazinesEnabled = true;
+        impl.remoteFreesEnabled = true;
+        impl.bigPageCachesEnabled = true;
+        impl.setPageColors(colors);
+    }
+};
+
+// ============================================================================
+// Cache model
+// ============================================================================
+
+class SetAssociativeCache {
+    arch::CacheGeometry geometry;
+    std::vector<uint64_t> tags;      // setCount * associativity, ~0 when the way is empty
+    std::vector<uint64_t> lastUse;
+    uint64_t clock = 0;
+public:
+    explicit SetAssociativeCache(const arch::CacheGeometry& g)
+        : geometry(g), tags(g.setCount * g.associativity, ~0ull), lastUse(g.setCount * g.associativity, 0) {}
+
+    // Returns true on a hit; on a miss the least recently used way of the set is replaced.
+    bool access(uint64_t physAddr) {
+        const uint64_t line = physAddr / geometry.lineSize;
+        const size_t set = line % geometry.setCount;
+        uint64_t* setTags = &tags[set * geometry.associativity];
+        uint64_t* setUse = &lastUse[set * geometry.associativity];
+        clock++;
+        size_t victim = 0;
+        for (size_t way = 0; way < geometry.associativity; way++) {
+            if (setTags[way] == line) {
+                setUse[way] = clock;
+                return true;
+            }
+            if (setUse[way] < setUse[victim]) victim = way;
+        }
+        setTags[victim] = line;
+        setUse[victim] = clock;
+        return false;
+    }
+};
+
+// ============================================================================
+// Per-CPU run
+// ============================================================================
+
+struct CpuResult {
+    uint64_t conflictMisses = 0;
+    size_t worstColorLoad = 0;  // most hot pages sharing one color
+};
+
+static CpuResult runCpu(PageAllocatorImpl& impl, const Config& cfg, const arch::CacheGeometry& cache,
+                        size_t colors, size_t hotPages, AllocFlags hotFlags, size_t cpu) {
+    std::mt19937_64 rng(cfg.seed * 1000003 + cpu);
+    std::vector<PageRef> hot;
+    std::vector<PageRef> background;
+
+    for (size_t h = 0; h < hotPages; h++) {
+        for (size_t op = 0; op < cfg.churnOps; op++) {
+            if (!background.empty() && rng() % 2) {
+                const size_t victim = rng() % background.size();
+                std::swap(background[victim], background.back());
+                impl.freePages(&background.back(), 1);
+                background.pop_back();
+            } else {
+                (void)impl.allocatePages(1 + rng() % 4, [&](PageRef r){ background.push_back(r); },
+                                         AllocBehavior::GRACEFUL_OOM);
+            }
+        }
+        (void)impl.allocatePages(1, [&](PageRef r){ hot.push_back(r); }, hotFlags);
+    }
+
+    CpuResult result;
+    std::vector<size_t> colorLoad(colors, 0);
+    for (const auto& page : hot)
+        result.worstColorLoad = std::max(result.worstColorLoad, ++colorLoad[(page.addr().value / arch::smallPageSize) % colors]);
+
+    // Warm up by touching every line once, then count what still misses.
+    SetAssociativeCache model(cache);
+    const size_t linesPerPage = arch::smallPageSize / cache.lineSize;
+    for (const auto& page : hot)
+        for (size_t line = 0; line < linesPerPage; line++)
+            (void)model.access(page.addr().value + line * cache.lineSize);
+    for (size_t i = 0; i < cfg.accesses; i++) {
+        const auto& page = hot[rng() % hot.size()];
+        if (!model.access(page.addr().value + (rng() % linesPerPage) * cache.lineSize))
+            result.conflictMisses++;
+    }
+
+    impl.freePages(hot.data(), hot.size());
+    impl.freePages(background.data(), background.size());
+    return result;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    Config cfg = parseArgs(argc, argv);
+    if (cfg.cpus == 0) cfg.cpus = 1;
+    if (cfg.cpus > arch::MAX_PROCESSOR_COUNT) cfg.cpus = arch::MAX_PROCESSOR_COUNT;
+    if (cfg.bigPages == 0) cfg.bigPages = 1;
+
+    const auto l2 = arch::getCacheGeometry(2);
+    if (!l2.occupied()) {
+        fprintf(stderr, "No L2 geometry reported; nothing to color against.\n");
+        return 1;
+    }
+    const arch::CacheGeometry cache = *l2;
+    const size_t colors = PA::colorsForCache(cache);
+    const size_t hotPages = cfg.hotPages != 0 ? cfg.hotPages : cache.sizeBytes() / arch::smallPageSize * 3 / 4;
+
+    arch::stressSetProcessorCount(cfg.cpus);
+
+    printf("=== CroCOS Page Coloring Benchmark ===\n");
+    printf("  L2 model:         %zu KiB, %zu-way, %zu B lines, %zu sets\n",
+           cache.sizeBytes() / 1024, cache.associativity, cache.lineSize, cache.setCount);
+    printf("  Page colors:      %zu\n", colors);
+    printf("  CPUs:             %zu\n", cfg.cpus);
+    printf("  Hot pages/CPU:    %zu  (%zu per color when evenly spread)\n", hotPages, hotPages / colors);
+    printf("  Churn ops/page:   %zu\n", cfg.churnOps);
+    printf("  Accesses/CPU:     %s\n\n", fmtNum(cfg.accesses).c_str());
+
+    // Both allocators are driven from the same threads, so each simulated CPU keeps one
+    // ProcessorID and replays the same churn against each of them.
+    BenchAllocatorImpl uncolored(cfg, 1);
+    BenchAllocatorImpl colored(cfg, colors);
+    std::vector<CpuResult> uncoloredResults(cfg.cpus);
+    std::vector<CpuResult> coloredResults(cfg.cpus);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < cfg.cpus; t++) {
+        threads.emplace_back([&, t] {
+            const size_t cpu = arch::getCurrentProcessorID();
+            uncoloredResults[t] = runCpu(uncolored.impl, cfg, cache, colors, hotPages, {}, cpu);
+            coloredResults[t] = runCpu(colored.impl, cfg, cache, colors, hotPages, AllocBehavior::COLORED, cpu);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    printf("%-12s  %-18s  %-12s  %s\n", "mode", "conflict misses", "miss rate", "worst color load");
+    printf("%s\n", std::string(64, '-').c_str());
+    const auto report = [&](const char* name, const std::vector<CpuResult>& results) {
+        uint64_t misses = 0;
+        size_t worst = 0;
+        for (const auto& r : results) {
+            misses += r.conflictMisses;
+            worst = std::max(worst, r.worstColorLoad);
+        }
+        printf("%-12s  %-18s  %10.3f%%  %zu pages (%zu ways)\n", name, fmtNum(misses).c_str(),
+               100.0 * static_cast<double>(misses) / static_cast<double>(cfg.accesses * cfg.cpus),
+               worst, cache.associativity);
+    };
+    report("uncolored", uncoloredResults);
+    report("colored", coloredResults);
+    return 0;
+}
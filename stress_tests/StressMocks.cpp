@@ -90,4 +90,9 @@ namespace arch {
 
     size_t processorCount()   { return gProcessorCount; }
     size_t getCacheLineSize() { return 64; }
+    Optional<CacheGeometry> getCacheGeometry(size_t level) {
+        if (level == 1) return CacheGeometry{64, 12, 64};
+        if (level == 2) return CacheGeometry{64, 16, 1024};
+        return {};
+    }
 }
@@ -13,6 +13,8 @@
 //   - After every operation: checkInvariants() passes (counts == L0 popcount,
 //     hint bitmaps match nonzero counts)
 //   - Edge cases: capacity 1, 64, 65
+//   - getNear: prefers the hint, then the closest set index, across levels
+//   - addMany / removeMany / getMany: counts, transitions, unsorted and duplicate input
 //
 
 #include "../test.h"
@@ -25,6 +27,7 @@
 #include <atomic>
 #include <random>
 #include <chrono>
+#include <algorithm>
 
 // ============================================================
 // Convenience type aliases
@@ -510,7 +513,7 @@ TEST(AtomicBitPool_GetAny_EdgeCase_Capacity65) { testGetAnyDrainAll(65); }
 // The hard correctness check is checkInvariants() after each epoch.
 // ============================================================
 
-static void runGetAnyConcurrentStress(size_t capacity) {
+static void runGetAnyConcurrentStress(size_t capacity, bool useNear = false) {
     constexpr int numThreads = 8;
     constexpr int numEpochs  = 50;
     constexpr int epochMs    = 10;
@@ -556,7 +559,8 @@ static void runGetAnyConcurrentStress(size_t capacity) {
                                                        std::memory_order_relaxed);
                     } else {
                         size_t outIdx = SIZE_MAX;
-                        GR result = f.pool->getAny(size_t(t), outIdx);
+                        GR result = useNear ? f.pool->getNear(idx, outIdx)
+                                            : f.pool->getAny(size_t(t), outIdx);
                         if (result == GR::Success) {
                             successCount.fetch_add(1, std::memory_order_relaxed);
                             bitset[outIdx / 64].fetch_and(
@@ -620,4 +624,261 @@ static void testEmptinessTransitions(size_t capacity) {
 
 TEST(AtomicBitPool_EmptinessTransitions_LevelCount1) { testEmptinessTransitions(64); }
 TEST(AtomicBitPool_EmptinessTransitions_LevelCount2) { testEmptinessTransitions(128); }
-TEST(AtomicBitPool_EmptinessTransitions_LevelCount3) { testEmptinessTransitions(8192); }
\ No newline at end of file
+TEST(AtomicBitPool_EmptinessTransitions_LevelCount3) { testEmptinessTransitions(8192); }
+// ============================================================
+// getNear: claims the set index closest to the hint
+// ============================================================
+
+static size_t checkedGetNearSuccess(PoolFixture& f, size_t hint) {
+    size_t idx = SIZE_MAX;
+    ASSERT_EQ(f.pool->getNear(hint, idx), GR::Success);
+    ASSERT_TRUE(f.pool->checkInvariants());
+    return idx;
+}
+
+static void testGetNearBasics(size_t capacity) {
+    PoolFixture f(capacity);
+    const size_t mid = capacity / 128 * 64 + 32;   // middle of a word
+
+    size_t idx = SIZE_MAX;
+    ASSERT_EQ(f.pool->getNear(mid, idx), GR::Empty);
+
+    // The hint itself wins when it is set.
+    f.pool->add(0);
+    f.pool->add(mid);
+    f.pool->add(capacity - 1);
+    ASSERT_EQ(checkedGetNearSuccess(f, mid), mid);
+
+    // Otherwise the closest set index in the hint's word.
+    f.pool->add(mid - 3);
+    f.pool->add(mid + 5);
+    ASSERT_EQ(checkedGetNearSuccess(f, mid), mid - 3);
+    ASSERT_EQ(checkedGetNearSuccess(f, mid), mid + 5);
+
+    // Hints past the end behave like the last index.
+    ASSERT_EQ(checkedGetNearSuccess(f, capacity * 4), capacity - 1);
+    ASSERT_EQ(checkedGetNearSuccess(f, capacity - 1), 0u);
+    ASSERT_EQ(f.pool->getNear(0, idx), GR::Empty);
+}
+
+TEST(AtomicBitPool_GetNearBasics_Small)  { testGetNearBasics(64); }
+TEST(AtomicBitPool_GetNearBasics_Medium) { testGetNearBasics(4096); }
+TEST(AtomicBitPool_GetNearBasics_Large)  { testGetNearBasics(8192); }
+
+// When the hint's word is empty the search must step to the neighbouring
+// word on whichever side holds the closer index, not just the first one set.
+TEST(AtomicBitPool_GetNear_CrossesToNearestWord) {
+    PoolFixture f(4096);
+    f.pool->add(64 * 4 + 60);
+    f.pool->add(64 * 9);
+    ASSERT_EQ(checkedGetNearSuccess(f, 64 * 5 + 3), 64u * 4 + 60);
+    ASSERT_EQ(checkedGetNearSuccess(f, 64 * 5 + 3), 64u * 9);
+
+    f.pool->add(64 * 2 + 63);
+    f.pool->add(64 * 7 + 1);
+    ASSERT_EQ(checkedGetNearSuccess(f, 64 * 5), 64u * 7 + 1);
+}
+
+// With three levels the search stays inside the hint's subtree while it has
+// anything set, even when another subtree holds a lower index.
+TEST(AtomicBitPool_GetNear_StaysInHintSubtree) {
+    PoolFixture f(8192);
+    f.pool->add(130);
+    f.pool->add(4000);
+    f.pool->add(8000);
+    ASSERT_EQ(checkedGetNearSuccess(f, 200), 130u);
+    ASSERT_EQ(checkedGetNearSuccess(f, 7000), 8000u);
+    ASSERT_EQ(checkedGetNearSuccess(f, 7000), 4000u);
+}
+
+// Draining from a fixed hint yields every index once; within a single word
+// the distance from the hint never decreases.
+static void testGetNearDrainAll(size_t capacity) {
+    PoolFixture f(capacity);
+    for (size_t i = 0; i < capacity; i++) f.pool->add(i);
+
+    const size_t hint = capacity / 3;
+    std::vector<bool> seen(capacity, false);
+    size_t lastDistance = 0;
+    for (size_t n = 0; n < capacity; n++) {
+        size_t idx = checkedGetNearSuccess(f, hint);
+        ASSERT_TRUE(idx < capacity);
+        ASSERT_FALSE(seen[idx]);
+        seen[idx] = true;
+        if (capacity <= 64) {
+            size_t distance = idx > hint ? idx - hint : hint - idx;
+            ASSERT_TRUE(distance >= lastDistance);
+            lastDistance = distance;
+        }
+    }
+    size_t idx = SIZE_MAX;
+    ASSERT_EQ(f.pool->getNear(hint, idx), GR::Empty);
+}
+
+TEST(AtomicBitPool_GetNearDrainAll_Small)  { testGetNearDrainAll(64); }
+TEST(AtomicBitPool_GetNearDrainAll_Medium) { testGetNearDrainAll(4096); }
+TEST(AtomicBitPool_GetNearDrainAll_Large)  { testGetNearDrainAll(8192); }
+
+TEST_WITH_TIMEOUT(AtomicBitPool_GetNearConcurrentStress_Capacity256,  5000) { runGetAnyConcurrentStress(256, true); }
+TEST_WITH_TIMEOUT(AtomicBitPool_GetNearConcurrentStress_Capacity8192, 5000) { runGetAnyConcurrentStress(8192, true); }
+
+// ============================================================
+// Batched operations: addMany / removeMany / getMany
+// ============================================================
+
+using BR = AtomicBitPool::BatchResult;
+
+static void testBatchedAddRemove(size_t capacity) {
+    PoolFixture f(capacity);
+
+    // Every third index, ascending, spanning every word.
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < capacity; i += 3) indices.push_back(i);
+
+    BR added = f.pool->addMany(indices.data(), indices.size());
+    ASSERT_EQ(added.changed, indices.size());
+    ASSERT_TRUE(added.poolTransitioned);
+    ASSERT_TRUE(f.pool->checkInvariants());
+    ASSERT_EQ(f.pool->countSet(), indices.size());
+
+    // Re-adding changes nothing and the pool was not empty.
+    added = f.pool->addMany(indices.data(), indices.size());
+    ASSERT_EQ(added.changed, 0u);
+    ASSERT_FALSE(added.poolTransitioned);
+
+    // Removing a mix of present and absent indices only counts the present ones.
+    std::vector<size_t> mixed;
+    for (size_t i = 0; i < capacity / 2; i++) mixed.push_back(i);
+    const size_t presentInMixed = (capacity / 2 + 2) / 3;
+    BR removed = f.pool->removeMany(mixed.data(), mixed.size());
+    ASSERT_EQ(removed.changed, presentInMixed);
+    ASSERT_FALSE(removed.poolTransitioned);
+    ASSERT_TRUE(f.pool->checkInvariants());
+    for (size_t i = 0; i < capacity; i++)
+        ASSERT_EQ(f.pool->isSet(i), i >= capacity / 2 && i % 3 == 0);
+
+    // Removing the rest empties the pool.
+    removed = f.pool->removeMany(indices.data(), indices.size());
+    ASSERT_EQ(removed.changed, indices.size() - presentInMixed);
+    ASSERT_TRUE(removed.poolTransitioned);
+    ASSERT_TRUE(f.pool->checkInvariants());
+    ASSERT_EQ(f.pool->add(0), AR::AddedToEmpty);
+}
+
+TEST(AtomicBitPool_BatchedAddRemove_Small)  { testBatchedAddRemove(64); }
+TEST(AtomicBitPool_BatchedAddRemove_Medium) { testBatchedAddRemove(4096); }
+TEST(AtomicBitPool_BatchedAddRemove_Large)  { testBatchedAddRemove(8192); }
+
+// Unsorted input with duplicates gives the same result as adding one at a time.
+static void testBatchedUnsortedWithDuplicates(size_t capacity) {
+    PoolFixture batched(capacity);
+    PoolFixture single(capacity);
+    std::mt19937_64 rng(capacity);
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < capacity; i++) indices.push_back(rng() % capacity);
+
+    size_t expectedAdded = 0;
+    for (size_t idx : indices)
+        if (single.pool->add(idx) != AR::AlreadyPresent) expectedAdded++;
+    ASSERT_EQ(batched.pool->addMany(indices.data(), indices.size()).changed, expectedAdded);
+    ASSERT_TRUE(batched.pool->checkInvariants());
+    for (size_t i = 0; i < capacity; i++)
+        ASSERT_EQ(batched.pool->isSet(i), single.pool->isSet(i));
+
+    std::shuffle(indices.begin(), indices.end(), rng);
+    BR removed = batched.pool->removeMany(indices.data(), indices.size());
+    ASSERT_EQ(removed.changed, expectedAdded);
+    ASSERT_TRUE(removed.poolTransitioned);
+    ASSERT_TRUE(batched.pool->checkInvariants());
+    ASSERT_EQ(batched.pool->countSet(), 0u);
+}
+
+TEST(AtomicBitPool_BatchedUnsortedWithDuplicates_Small)  { testBatchedUnsortedWithDuplicates(64); }
+TEST(AtomicBitPool_BatchedUnsortedWithDuplicates_Medium) { testBatchedUnsortedWithDuplicates(4096); }
+TEST(AtomicBitPool_BatchedUnsortedWithDuplicates_Large)  { testBatchedUnsortedWithDuplicates(8192); }
+
+static void testGetManyDrainAll(size_t capacity) {
+    PoolFixture f(capacity);
+    size_t outCount = SIZE_MAX;
+    std::vector<size_t> out(100);
+    ASSERT_EQ(f.pool->getMany(0, out.data(), out.size(), outCount), GR::Empty);
+    ASSERT_EQ(outCount, 0u);
+
+    for (size_t i = 0; i < capacity; i++) f.pool->add(i);
+    std::vector<bool> seen(capacity, false);
+    size_t total = 0;
+    while (f.pool->getMany(7, out.data(), out.size(), outCount) == GR::Success) {
+        ASSERT_TRUE(outCount > 0 && outCount <= out.size());
+        ASSERT_TRUE(f.pool->checkInvariants());
+        for (size_t n = 0; n < outCount; n++) {
+            ASSERT_TRUE(out[n] < capacity);
+            ASSERT_FALSE(seen[out[n]]);
+            seen[out[n]] = true;
+        }
+        total += outCount;
+    }
+    ASSERT_EQ(total, capacity);
+    ASSERT_EQ(f.pool->add(0), AR::AddedToEmpty);
+}
+
+TEST(AtomicBitPool_GetManyDrainAll_Small)  { testGetManyDrainAll(64); }
+TEST(AtomicBitPool_GetManyDrainAll_Medium) { testGetManyDrainAll(4096); }
+TEST(AtomicBitPool_GetManyDrainAll_Large)  { testGetManyDrainAll(8192); }
+
+// ============================================================
+// Batched concurrent stress: each thread adds, removes, and claims
+// sorted random batches. checkInvariants() after each epoch is the
+// correctness check, and the pool is drained at the end to make sure
+// every set index can still be claimed exactly once.
+// ============================================================
+
+static void runBatchedConcurrentStress(size_t capacity) {
+    constexpr int numThreads = 8;
+    constexpr int numEpochs  = 5;
+    constexpr int epochMs    = 40;
+
+    PoolFixture f(capacity);
+    for (int epoch = 0; epoch < numEpochs; epoch++) {
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> threads;
+        pauseTracking();
+        for (int t = 0; t < numThreads; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937_64 rng(std::random_device{}() ^ (uint64_t(t) << 32));
+                size_t batch[32];
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const size_t n = 1 + rng() % 32;
+                    const size_t base = rng() % capacity;
+                    for (size_t i = 0; i < n; i++) batch[i] = (base + i * (1 + rng() % 4)) % capacity;
+                    std::sort(batch, batch + n);
+                    switch (rng() % 3) {
+                        case 0: (void)f.pool->addMany(batch, n); break;
+                        case 1: (void)f.pool->removeMany(batch, n); break;
+                        default: {
+                            size_t got;
+                            (void)f.pool->getMany(size_t(t), batch, n, got);
+                        }
+                    }
+                }
+            });
+        }
+        resumeTracking();
+        std::this_thread::sleep_for(std::chrono::milliseconds(epochMs));
+        stop.store(true, std::memory_order_relaxed);
+        pauseTracking();
+        for (auto& th : threads) th.join();
+        resumeTracking();
+        ASSERT_TRUE(f.pool->checkInvariants());
+    }
+
+    const size_t remaining = f.pool->countSet();
+    size_t drained = 0;
+    size_t idx;
+    while (f.pool->getAny(0, idx) == GR::Success) drained++;
+    ASSERT_EQ(drained, remaining);
+    ASSERT_TRUE(f.pool->checkInvariants());
+}
+
+TEST_WITH_TIMEOUT(AtomicBitPool_BatchedConcurrentStress_Capacity64,   5000) { runBatchedConcurrentStress(64); }
+TEST_WITH_TIMEOUT(AtomicBitPool_BatchedConcurrentStress_Capacity256,  5000) { runBatchedConcurrentStress(256); }
+TEST_WITH_TIMEOUT(AtomicBitPool_BatchedConcurrentStress_Capacity8192, 5000) { runBatchedConcurrentStress(8192); }
@@ -0,0 +1,109 @@
+//
+// Unit tests for Core radix sort
+//
+
+#include "../test.h"
+#include <harness/TestHarness.h>
+#include <core/algo/sort.h>
+
+using namespace CroCOSTest;
+
+namespace {
+    // Small deterministic xorshift generator so the tests need no host headers.
+    uint64_t nextRandom(uint64_t& state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    struct KeyedValue {
+        uint64_t key;
+        uint64_t tag;
+    };
+
+    template <typename T, typename KeyFn>
+    bool isSortedBy(const T* data, size_t size, KeyFn key) {
+        for (size_t i = 1; i < size; i++) {
+            if (key(data[i]) < key(data[i - 1])) return false;
+        }
+        return true;
+    }
+}
+
+// -----------------------------------------------------------------------------------------
+// radixSort tests
+// -----------------------------------------------------------------------------------------
+
+TEST(RadixSortEmptyAndSingle) {
+    uint64_t one[1] = {42};
+    const auto identity = [](uint64_t v) { return v; };
+    algorithm::radixSort(one, 0, identity);
+    algorithm::radixSort(one, 1, identity);
+    ASSERT_EQ(42u, one[0]);
+}
+
+TEST(RadixSortSmallInputUsesComparisonPath) {
+    uint64_t data[10] = {9, 3, 7, 1, 8, 2, 6, 0, 5, 4};
+    algorithm::radixSort(data, 10, [](uint64_t v) { return v; });
+    for (uint64_t i = 0; i < 10; i++) {
+        ASSERT_EQ(i, data[i]);
+    }
+}
+
+TEST(RadixSortRandomWideKeys) {
+    constexpr size_t N = 5000;
+    static uint64_t data[N];
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < N; i++) {
+        data[i] = nextRandom(state);
+        sum += data[i];
+    }
+    algorithm::radixSort(data, N, [](uint64_t v) { return v; });
+    ASSERT_TRUE(isSortedBy(data, N, [](uint64_t v) { return v; }));
+    uint64_t sortedSum = 0;
+    for (size_t i = 0; i < N; i++) sortedSum += data[i];
+    ASSERT_EQ(sum, sortedSum);
+}
+
+TEST(RadixSortNarrowKeysWithDuplicates) {
+    // Keys fit in 12 bits, so there are many duplicates and only two digit passes.
+    constexpr size_t N = 4096;
+    static KeyedValue data[N];
+    uint64_t state = 12345;
+    size_t histogram[1 << 12] = {};
+    for (size_t i = 0; i < N; i++) {
+        data[i] = {nextRandom(state) & 0xfff, i};
+        histogram[data[i].key]++;
+    }
+    const auto key = [](const KeyedValue& v) { return v.key; };
+    algorithm::radixSort(data, N, key);
+    ASSERT_TRUE(isSortedBy(data, N, key));
+    for (size_t i = 0; i < N; i++) histogram[data[i].key]--;
+    for (size_t k = 0; k < (1 << 12); k++) {
+        ASSERT_EQ(0u, histogram[k]);
+    }
+}
+
+TEST(RadixSortDerivedKeyGroupsEqualKeys) {
+    // Sorting on a coarse key (value / 512) must leave equal-key elements adjacent.
+    constexpr size_t N = 2048;
+    static uint64_t data[N];
+    for (size_t i = 0; i < N; i++) data[i] = ((N - 1 - i) * 2654435761u) % (64 * 512);
+    const auto bucket = [](uint64_t v) { return v / 512; };
+    algorithm::radixSort(data, N, bucket);
+    ASSERT_TRUE(isSortedBy(data, N, bucket));
+}
+
+TEST(RadixSortAllEqualAndReversed) {
+    constexpr size_t N = 1000;
+    static uint64_t data[N];
+    for (size_t i = 0; i < N; i++) data[i] = 7;
+    algorithm::radixSort(data, N, [](uint64_t v) { return v; });
+    for (size_t i = 0; i < N; i++) ASSERT_EQ(7u, data[i]);
+
+    for (size_t i = 0; i < N; i++) data[i] = (N - i) << 20;
+    algorithm::radixSort(data, N, [](uint64_t v) { return v; });
+    for (size_t i = 0; i < N; i++) ASSERT_EQ((i + 1) << 20, data[i]);
+}
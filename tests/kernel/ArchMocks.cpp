@@ -100,6 +100,13 @@ namespace arch {
     size_t getCacheLineSize() {
         return 64;
     }
+
+    // A typical client core: 48 KiB 12-way L1D, 1 MiB 16-way L2, no L3 reported.
+    Optional<CacheGeometry> getCacheGeometry(size_t level) {
+        if (level == 1) return CacheGeometry{64, 12, 64};
+        if (level == 2) return CacheGeometry{64, 16, 1024};
+        return {};
+    }
 }
 
 // ============================================================================
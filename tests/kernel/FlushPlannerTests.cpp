@@ -0,0 +1,240 @@
+//
+// Unit tests for FlushPlanner
+// Local invalidation only counts in test builds, so these check what each CPU would have
+// flushed and how many shootdown rounds it took.
+//
+
+#include "../test.h"
+#include <TestHarness.h>
+
+#include <mem/FlushPlanner.h>
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <mutex>
+
+using namespace kernel::mm;
+using namespace CroCOSTest;
+
+// Forward-declare arch mock helpers defined in ArchMocks.cpp
+namespace arch { namespace testing {
+    void setProcessorCount(size_t count);
+    void resetProcessorState();
+}}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+namespace {
+    constexpr uint64_t testBase = 0xffff'c000'0000'0000;
+
+    virt_addr pageAt(size_t index) {
+        return virt_addr(testBase + index * arch::smallPageSize);
+    }
+
+    // Sender that delivers each shootdown synchronously, as if the target took the IPI at once.
+    std::mutex senderMutex;
+    ProcessorSet sentRounds[16];
+    size_t sentRoundCount = 0;
+
+    void deliverImmediately(const ProcessorSet& targets) {
+        {
+            std::lock_guard lock(senderMutex);
+            sentRounds[sentRoundCount++] = targets;
+        }
+        targets.forEach([](arch::ProcessorID cpu) { FlushPlanner::serviceShootdowns(cpu); });
+    }
+
+    // Sender that only records; the targets pick requests up from their own loops.
+    std::atomic<size_t> deferredSends{0};
+
+    void deliverLater(const ProcessorSet&) {
+        deferredSends.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // RAII: clear the flush counters and sender for a test, restore defaults afterwards.
+    class FlushPlannerTestSetup {
+    public:
+        explicit FlushPlannerTestSetup(FlushPlanner::ShootdownSender sender = nullptr, size_t cpuCount = 8) {
+            arch::testing::resetProcessorState();
+            arch::testing::setProcessorCount(cpuCount);
+            FlushPlanner::resetFlushStats();
+            FlushPlanner::setShootdownSender(sender);
+            sentRoundCount = 0;
+            deferredSends.store(0);
+        }
+        ~FlushPlannerTestSetup() {
+            FlushPlanner::setShootdownSender(nullptr);
+            FlushPlanner::resetFlushStats();
+            arch::testing::resetProcessorState();
+            arch::testing::setProcessorCount(8);
+        }
+    };
+}
+
+// ============================================================================
+// Range coalescing and full-flush switching
+// ============================================================================
+
+TEST(FlushPlanner_CoalescesAdjacentPages) {
+    FlushPlannerTestSetup setup;
+    FlushPlanner planner;
+    for (size_t i = 0; i < 5; i++) planner.invalidate(pageAt(i));
+    // Walking backwards onto the front of the range extends it too.
+    planner.invalidate(pageAt(10));
+    planner.invalidate(pageAt(9));
+
+    ASSERT_FALSE(planner.isFullFlush());
+    ASSERT_EQ(2u, planner.queuedRangeCount());
+    ASSERT_EQ(pageAt(0).value, planner.queuedRange(0).start.value);
+    ASSERT_EQ(5u, planner.queuedRange(0).pageCount);
+    ASSERT_EQ(pageAt(9).value, planner.queuedRange(1).start.value);
+    ASSERT_EQ(2u, planner.queuedRange(1).pageCount);
+
+    planner.flush();
+    ASSERT_FALSE(planner.hasPendingInvalidations());
+    const auto stats = FlushPlanner::localFlushStats(arch::getCurrentProcessorID());
+    ASSERT_EQ(7u, stats.pagesInvalidated);
+    ASSERT_EQ(0u, stats.fullFlushes);
+}
+
+TEST(FlushPlanner_SwitchesToFullFlushAboveThreshold) {
+    FlushPlannerTestSetup setup;
+    FlushPlanner planner;
+    for (size_t i = 0; i < FlushPlanner::fullFlushThreshold; i++) planner.invalidate(pageAt(i));
+    ASSERT_FALSE(planner.isFullFlush());
+    planner.invalidate(pageAt(FlushPlanner::fullFlushThreshold));
+    ASSERT_TRUE(planner.isFullFlush());
+    ASSERT_EQ(0u, planner.queuedRangeCount());
+
+    planner.flush();
+    const auto stats = FlushPlanner::localFlushStats(arch::getCurrentProcessorID());
+    ASSERT_EQ(0u, stats.pagesInvalidated);
+    ASSERT_EQ(1u, stats.fullFlushes);
+}
+
+TEST(FlushPlanner_SwitchesToFullFlushWhenRangesOverflow) {
+    FlushPlannerTestSetup setup;
+    FlushPlanner planner;
+    // Every other page, so nothing coalesces.
+    for (size_t i = 0; i < FlushPlanner::rangeCapacity; i++) planner.invalidate(pageAt(2 * i));
+    ASSERT_FALSE(planner.isFullFlush());
+    ASSERT_EQ(FlushPlanner::rangeCapacity, planner.queuedRangeCount());
+    planner.invalidate(pageAt(2 * FlushPlanner::rangeCapacity));
+    ASSERT_TRUE(planner.isFullFlush());
+}
+
+TEST(FlushPlanner_DestructorFlushesPendingWork) {
+    FlushPlannerTestSetup setup;
+    {
+        FlushPlanner planner;
+        planner.invalidate(pageAt(0), 3);
+    }
+    ASSERT_EQ(3u, FlushPlanner::localFlushStats(arch::getCurrentProcessorID()).pagesInvalidated);
+}
+
+// ============================================================================
+// Shootdown rounds
+// ============================================================================
+
+TEST(FlushPlanner_WithoutSenderFlushesLocallyOnly) {
+    FlushPlannerTestSetup setup;
+    const auto self = arch::getCurrentProcessorID();
+    FlushPlanner planner;
+    planner.targetAllProcessors();
+    planner.invalidate(pageAt(0), 4);
+    planner.flush();
+
+    ASSERT_EQ(0u, FlushPlanner::shootdownRoundCount());
+    for (arch::ProcessorID cpu = 0; cpu < 8; cpu++) {
+        ASSERT_EQ(cpu == self ? 4u : 0u, FlushPlanner::localFlushStats(cpu).pagesInvalidated);
+    }
+}
+
+TEST(FlushPlanner_SelfOnlyTargetsSkipShootdown) {
+    FlushPlannerTestSetup setup(deliverImmediately);
+    FlushPlanner planner;
+    planner.addTarget(arch::getCurrentProcessorID());
+    planner.invalidate(pageAt(0));
+    planner.flush();
+
+    ASSERT_EQ(0u, FlushPlanner::shootdownRoundCount());
+    ASSERT_EQ(0u, sentRoundCount);
+}
+
+TEST(FlushPlanner_ManyUnmapsCostOneRound) {
+    FlushPlannerTestSetup setup(deliverImmediately);
+    const auto self = arch::getCurrentProcessorID();
+    FlushPlanner planner;
+    planner.targetAllProcessors();
+    for (size_t i = 0; i < 16; i++) planner.invalidate(pageAt(i));
+    planner.flush();
+
+    ASSERT_EQ(1u, FlushPlanner::shootdownRoundCount());
+    ASSERT_EQ(1u, sentRoundCount);
+    ASSERT_EQ(7u, sentRounds[0].count());
+    ASSERT_FALSE(sentRounds[0].contains(self));
+    for (arch::ProcessorID cpu = 0; cpu < 8; cpu++) {
+        ASSERT_EQ(16u, FlushPlanner::localFlushStats(cpu).pagesInvalidated);
+    }
+}
+
+TEST(FlushPlanner_RoundReachesOnlyTargets) {
+    FlushPlannerTestSetup setup(deliverImmediately);
+    const auto self = arch::getCurrentProcessorID();
+    const arch::ProcessorID other = (self + 3) % 8;
+    FlushPlanner planner;
+    planner.addTarget(other);
+    planner.invalidateAll();
+    planner.flush();
+
+    ASSERT_EQ(1u, FlushPlanner::shootdownRoundCount());
+    for (arch::ProcessorID cpu = 0; cpu < 8; cpu++) {
+        const bool hit = cpu == self || cpu == other;
+        ASSERT_EQ(hit ? 1u : 0u, FlushPlanner::localFlushStats(cpu).fullFlushes);
+    }
+}
+
+// Every CPU shoots down every other one at once, with nobody taking interrupts: each can only
+// make progress by servicing the others' requests while it waits on its own round.
+TEST_WITH_TIMEOUT(FlushPlanner_ConcurrentMutualShootdowns, 10000) {
+    constexpr size_t numCpus = 4;
+    constexpr size_t roundsPerCpu = 200;
+    FlushPlannerTestSetup setup(deliverLater, numCpus);
+
+    std::atomic<bool> start{false};
+    std::atomic<size_t> finished{0};
+    const auto worker = [&] {
+        const auto self = arch::getCurrentProcessorID();
+        while (!start.load(std::memory_order_acquire)) {}
+        for (size_t round = 0; round < roundsPerCpu; round++) {
+            FlushPlanner planner;
+            planner.targetAllProcessors();
+            planner.invalidate(pageAt(round), 2);
+            planner.flush();
+        }
+        finished.fetch_add(1, std::memory_order_acq_rel);
+        // Keep answering until everyone else is done, as the IPI handler would.
+        while (finished.load(std::memory_order_acquire) < numCpus) {
+            FlushPlanner::serviceShootdowns(self);
+        }
+    };
+
+    pauseTracking();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numCpus; i++) threads.emplace_back(worker);
+    resumeTracking();
+    start.store(true, std::memory_order_release);
+    pauseTracking();
+    for (auto& t : threads) t.join();
+    resumeTracking();
+
+    ASSERT_EQ(numCpus * roundsPerCpu, FlushPlanner::shootdownRoundCount());
+    ASSERT_EQ(numCpus * roundsPerCpu, deferredSends.load());
+    // Each CPU flushes two pages for its own rounds and for every other CPU's.
+    for (arch::ProcessorID cpu = 0; cpu < numCpus; cpu++) {
+        ASSERT_EQ(2 * numCpus * roundsPerCpu, FlushPlanner::localFlushStats(cpu).pagesInvalidated);
+    }
+}
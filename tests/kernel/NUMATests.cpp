@@ -720,6 +720,86 @@ TEST(NUMAPolicy_DomainOrder_ByLatency) {
     ASSERT_EQ(DomainID(2), order1[2]);
 }
 
+// ============================================================================
+// NUMAPolicy — interleave weights
+// ============================================================================
+
+TEST(NUMAPolicy_InterleaveWeights_FromBandwidth) {
+    // The run_numa_hmat layout: two CPU domains and a memory-only (CXL-style) domain 2.
+    NUMATestSetup setup(2);
+    Vector<ProcessorAffinityEntry>   procs;
+    Vector<MemoryRangeAffinityEntry> mems;
+    procs.push({0, 0, 0});
+    procs.push({1, 1, 0});
+    mems.push({makeRange(0x0000, 0x1000), 0, MemoryType::Volatile});
+    mems.push({makeRange(0x1000, 0x2000), 1, MemoryType::Volatile});
+    mems.push({makeRange(0x2000, 0x3000), 2, MemoryType::Volatile});
+
+    Vector<BandwidthEntry> bws;
+    bws.push({0, 0, 40000, DISTANCE_NO_DATA});
+    bws.push({0, 1, 10000, DISTANCE_NO_DATA});
+    bws.push({0, 2,  8000, DISTANCE_NO_DATA});
+    bws.push({1, 0, 10000, DISTANCE_NO_DATA});
+    bws.push({1, 1, 40000, DISTANCE_NO_DATA});
+    bws.push({1, 2, 12000, DISTANCE_NO_DATA});
+
+    auto topo = NUMATopology::build(procs, mems, emptyGen, emptyLat, bws);
+    NUMAPolicy policy(topo);
+
+    auto w0 = policy.interleaveWeights(DomainID(0));
+    ASSERT_EQ(3u, w0.size());
+    ASSERT_EQ(INTERLEAVE_WEIGHT_MAX, w0[0]);
+    ASSERT_EQ(8u, w0[1]);
+    ASSERT_EQ(6u, w0[2]);   // 8000 / 40000 * 32 = 6.4
+
+    auto w1 = policy.interleaveWeights(DomainID(1));
+    ASSERT_EQ(8u, w1[0]);
+    ASSERT_EQ(INTERLEAVE_WEIGHT_MAX, w1[1]);
+    ASSERT_EQ(10u, w1[2]);  // 12000 / 40000 * 32 = 9.6
+
+    // Domain 2 initiates nothing, so its row has no data and falls back to uniform.
+    auto w2 = policy.interleaveWeights(DomainID(2));
+    ASSERT_EQ(1u, w2[0]);
+    ASSERT_EQ(1u, w2[1]);
+    ASSERT_EQ(1u, w2[2]);
+}
+
+TEST(NUMAPolicy_InterleaveWeights_MissingAndUnreachable) {
+    NUMATestSetup setup(3);
+    Vector<ProcessorAffinityEntry> procs;
+    procs.push({0, 0, 0});
+    procs.push({1, 1, 0});
+    procs.push({2, 2, 0});
+
+    Vector<BandwidthEntry> bws;
+    bws.push({0, 0, 30000, DISTANCE_NO_DATA});
+    bws.push({0, 2, DISTANCE_UNREACHABLE, DISTANCE_NO_DATA});
+    // 0 -> 1 not reported.
+
+    auto topo = NUMATopology::build(procs, emptyMem, emptyGen, emptyLat, bws);
+    NUMAPolicy policy(topo);
+
+    auto w0 = policy.interleaveWeights(DomainID(0));
+    ASSERT_EQ(INTERLEAVE_WEIGHT_MAX, w0[0]);
+    ASSERT_EQ(1u, w0[1]);
+    ASSERT_EQ(0u, w0[2]);
+}
+
+TEST(NUMAPolicy_InterleaveWeights_NoBandwidthIsUniform) {
+    NUMATestSetup setup(2);
+    Vector<ProcessorAffinityEntry> procs;
+    procs.push({0, 0, 0});
+    procs.push({1, 1, 0});
+
+    auto topo = NUMATopology::build(procs, emptyMem, emptyGen);
+    NUMAPolicy policy(topo);
+
+    auto w0 = policy.interleaveWeights(DomainID(0));
+    ASSERT_EQ(2u, w0.size());
+    ASSERT_EQ(1u, w0[0]);
+    ASSERT_EQ(1u, w0[1]);
+}
+
 // ============================================================================
 // partitionMemoryByDomain
 // ============================================================================
@@ -61,6 +61,26 @@ TEST(PageRef_Equality) {
     ASSERT_NE(a, c);
 }
 
+TEST(PageRef_RunEncodingRoundTrips) {
+    ASSERT_EQ(1u, PageRef::small(phys_addr(0x1000)).runLength());
+    ASSERT_EQ(1u, PageRef::big(phys_addr(0x200000)).runLength());
+    ASSERT_EQ(1u, PageRef::gigantic(phys_addr(0x40000000)).runLength());
+
+    // A small run may end exactly at the end of its big page.
+    auto small = PageRef::smallRun(phys_addr(0x201000), PageAllocator::smallPagesPerBigPage - 1);
+    ASSERT_EQ(PageSize::SMALL, small.size());
+    ASSERT_EQ(0x201000ul, small.addr().value);
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage - 1, small.runLength());
+
+    auto big = PageRef::bigRun(phys_addr(0x40000000), PageAllocator::bigPagesPerGiganticPage);
+    ASSERT_EQ(PageSize::BIG, big.size());
+    ASSERT_EQ(0x40000000ul, big.addr().value);
+    ASSERT_EQ(PageAllocator::bigPagesPerGiganticPage, big.runLength());
+
+    ASSERT_EQ(PageRef::small(phys_addr(0x3000)), PageRef::smallRun(phys_addr(0x3000), 1));
+    ASSERT_EQ(PageRef::big(phys_addr(0x600000)), PageRef::bigRun(phys_addr(0x600000), 1));
+}
+
 // ============================================================================
 // Construction and Initial State
 // ============================================================================
@@ -102,6 +122,20 @@ TEST(SmallPageAllocator_AllocAllThenFreeAllRoundtrip) {
     }
 }
 
+TEST(SmallPageAllocator_FreeAllAfterSmallExhaustionIsAllocatable) {
+    // Exhausting the page through alloc() leaves the scan hint at the end of the bitmap;
+    // freeAll must rewind it or the freshly freed pages are never found.
+    SmallPageAllocator spa(testBaseAddr);
+    size_t count = spa.alloc([](PageRef) {}, PageAllocator::smallPagesPerBigPage);
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, count);
+    spa.allocAll();
+    spa.freeAll();
+
+    count = spa.alloc([](PageRef) {}, PageAllocator::smallPagesPerBigPage);
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, count);
+    ASSERT_TRUE(spa.isFull());
+}
+
 // ============================================================================
 // Allocation via Lazy Init Path
 // ============================================================================
@@ -627,10 +661,14 @@ static phys_memory_range makeBigPageRange(uint64_t base, size_t bigPageCount) {
 struct BootstrapBuffer {
     std::vector<uint8_t> storage;
 
-    explicit BootstrapBuffer(size_t bytes) : storage(bytes, 0) {}
+    // The measuring pass starts at address 0, so the real buffer must start on a
+    // cache line too or cache-line-aligned structures would pad differently.
+    explicit BootstrapBuffer(size_t bytes) : storage(bytes + arch::CACHE_LINE_SIZE, 0) {}
 
     BootstrapAllocator makeAllocator() {
-        return BootstrapAllocator(storage.data(), storage.size());
+        const auto base = reinterpret_cast<uintptr_t>(storage.data());
+        const size_t slack = (arch::CACHE_LINE_SIZE - base % arch::CACHE_LINE_SIZE) % arch::CACHE_LINE_SIZE;
+        return BootstrapAllocator(storage.data() + slack, storage.size() - slack);
     }
 };
 
@@ -648,12 +686,13 @@ struct TestNUMAPool {
     BootstrapBuffer           buffer;
     NUMAPool*                 pool = nullptr;
 
-    explicit TestNUMAPool(Vector<phys_memory_range> r)
+    // eagerBigPages is forwarded to createNumaPool; by default every big page is built up front.
+    explicit TestNUMAPool(Vector<phys_memory_range> r, size_t eagerBigPages = static_cast<size_t>(-1))
         : ranges(move(r))
         , buffer(measure(ranges))
     {
         BootstrapAllocator real = buffer.makeAllocator();
-        pool = createNumaPool(real, ranges);
+        pool = createNumaPool(real, ranges, kernel::numa::DomainID{0}, eagerBigPages);
     }
 
     // Single contiguous range of bigPageCount big pages.
@@ -688,6 +727,7 @@ private:
 struct DomainSpec {
     Vector<phys_memory_range> ranges;
     std::vector<size_t>       cpuIds; // logical CPU IDs owned by this domain
+    size_t                    eagerBigPages = static_cast<size_t>(-1); // see createNumaPool
 
     // Convenience: a single range at testDomainBase(domainSlot) covering
     // bigPageCount big pages, assigned to cpuIds.
@@ -715,6 +755,7 @@ struct DomainSpec {
 // The test helpers below always use contiguous IDs starting at 0.
 struct TestPageAllocatorImpl {
     std::vector<BootstrapBuffer>              domainBuffers;
+    std::optional<BootstrapBuffer>            radixBuffer;
     LocalPool*                                localPools[arch::MAX_PROCESSOR_COUNT] = {};
     kernel::numa::NUMATopology                topology = kernel::numa::NUMATopology::build(
         kernel::numa::EmptyIterable<kernel::numa::ProcessorAffinityEntry>{},
@@ -724,7 +765,9 @@ struct TestPageAllocatorImpl {
     std::optional<kernel::numa::NUMAPolicy>   policy;
     PageAllocatorImpl                         impl;
 
-    explicit TestPageAllocatorImpl(std::vector<DomainSpec> domains) {
+    // bandwidth, if given, becomes the topology's HMAT bandwidth table (raw IDs = domain slots).
+    explicit TestPageAllocatorImpl(std::vector<DomainSpec> domains,
+                                   std::vector<kernel::numa::BandwidthEntry> bandwidth = {}) {
         domainBuffers.reserve(domains.size()); // prevent reallocation; see note above
         Vector<NUMAPool*> numaPools;
 
@@ -747,11 +790,21 @@ struct TestPageAllocatorImpl {
                 });
             }
         }
+        // Domains without CPUs are memory-only; list their ranges so the topology knows them.
+        std::vector<kernel::numa::MemoryRangeAffinityEntry> memEntries;
+        for (size_t di = 0; di < domains.size(); di++) {
+            if (!domains[di].cpuIds.empty()) continue;
+            for (const auto& range : domains[di].ranges) {
+                memEntries.push_back({range, static_cast<uint32_t>(di), kernel::numa::MemoryType::Volatile});
+            }
+        }
         if (!procEntries.empty()) {
             topology = kernel::numa::NUMATopology::build(
                 procEntries,
-                kernel::numa::EmptyIterable<kernel::numa::MemoryRangeAffinityEntry>{},
-                kernel::numa::EmptyIterable<kernel::numa::GenericInitiatorEntry>{}
+                memEntries,
+                kernel::numa::EmptyIterable<kernel::numa::GenericInitiatorEntry>{},
+                kernel::numa::EmptyIterable<kernel::numa::LatencyEntry>{},
+                bandwidth
             );
         }
 
@@ -763,6 +816,17 @@ struct TestPageAllocatorImpl {
             policyPtr = &policy.value();
         }
 
+        // ---- Metadata radix over every domain's ranges ----
+        Vector<phys_memory_range> allRanges;
+        for (auto& spec : domains) {
+            for (const auto& range : spec.ranges) allRanges.push(range);
+        }
+        BootstrapAllocator radixMeasuring;
+        createMetadataRadix(radixMeasuring, allRanges);
+        radixBuffer.emplace(radixMeasuring.bytesNeeded());
+        BootstrapAllocator radixReal = radixBuffer->makeAllocator();
+        const MetadataRadix metadataRadix = createMetadataRadix(radixReal, allRanges);
+
         for (size_t di = 0; di < domains.size(); di++) {
             auto& spec = domains[di];
             kernel::numa::DomainID domainId{static_cast<uint16_t>(di)};
@@ -779,7 +843,7 @@ struct TestPageAllocatorImpl {
 
             // ---- Real pass: construct NUMAPool and LocalPools in the buffer ----
             BootstrapAllocator real = domainBuffers.back().makeAllocator();
-            NUMAPool* domainPool = createNumaPool(real, spec.ranges, domainId);
+            NUMAPool* domainPool = createNumaPool(real, spec.ranges, domainId, spec.eagerBigPages);
             numaPools.push(domainPool);
             for (size_t cpu : spec.cpuIds) {
                 localPools[cpu] = createLocalPool(real, &topology, domainPool, static_cast<arch::ProcessorID>(cpu));
@@ -787,7 +851,7 @@ struct TestPageAllocatorImpl {
         }
 
         impl = createPageAllocator(move(numaPools), localPools, processorCount,
-                                   nullptr, policyPtr);
+                                   nullptr, policyPtr, metadataRadix);
     }
 };
 
@@ -1190,6 +1254,180 @@ TEST(NUMAPool_BigPageOnly_ExhaustPool) {
     ASSERT_EQ(0u, extra);
 }
 
+// ============================================================================
+// NUMAPool — Hot big-page stack
+// ============================================================================
+
+static void takeOneBigPage(TestNUMAPool& p, PageRef& out) {
+    BigPageMetadata* rem = nullptr;
+    (void)p.pool->allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ out = r; }, rem,
+                                AllocBehavior::BIG_PAGE_ONLY);
+}
+
+TEST(NUMAPool_HotStack_FreedBigPageIsReusedFirst) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), 4);
+    PageRef first{}, second{}, again{};
+    takeOneBigPage(p, first);
+    takeOneBigPage(p, second);
+
+    // FIFO order alone would hand out the third page next.
+    p.pool->freePages(&first, 1);
+    ASSERT_EQ(1u, p.pool->getHotBigPageCount());
+    takeOneBigPage(p, again);
+    ASSERT_EQ(first.value, again.value);
+    ASSERT_EQ(0u, p.pool->getHotBigPageCount());
+}
+
+TEST(NUMAPool_HotStack_OverflowPushesOldestToRing) {
+    constexpr size_t pageCount = 18;
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), pageCount);
+    PageRef pages[pageCount];
+    for (auto& page : pages) takeOneBigPage(p, page);
+    ASSERT_EQ(0u, p.pool->getFreeBigPageCount());
+
+    for (auto& page : pages) p.pool->freePages(&page, 1);
+    ASSERT_EQ(pageCount, p.pool->getFreeBigPageCount());
+    ASSERT_TRUE(p.pool->getHotBigPageCount() < pageCount);
+
+    // The most recently freed page comes back first...
+    PageRef hot{};
+    takeOneBigPage(p, hot);
+    ASSERT_EQ(pages[pageCount - 1].value, hot.value);
+
+    // ...while the zeroing worker gets the coldest one.
+    static uint64_t zeroedBase;
+    zeroedBase = 0;
+    ASSERT_EQ(1u, p.pool->refillZeroedPages([](phys_addr base, size_t) {
+        if (zeroedBase == 0) zeroedBase = base.value;
+    }, 1));
+    ASSERT_EQ(pages[0].addr().value, zeroedBase);
+}
+
+TEST(NUMAPool_HotStack_ContiguousClaimsHotPages) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), 4);
+    PageRef pages[4];
+    for (auto& page : pages) takeOneBigPage(p, page);
+    for (auto& page : pages) p.pool->freePages(&page, 1);
+    ASSERT_EQ(4u, p.pool->getHotBigPageCount());
+
+    BigPageMetadata* rem = nullptr;
+    auto base = p.pool->allocateContiguous(4 * PageAllocator::smallPagesPerBigPage, arch::bigPageSize, rem);
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ(0u, p.pool->getFreeBigPageCount());
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
+TEST(NUMAPool_Contiguous_ClaimScansOnlyTheRingFront) {
+    // More free pages than a claim looks at (PA_CONTIGUOUS_RING_SCAN), but no gigantic group.
+    constexpr size_t pageCount = 300;
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), pageCount);
+    std::vector<uint64_t> addrs;
+    BigPageMetadata* rem = nullptr;
+    p.pool->allocatePages(pageCount * PageAllocator::smallPagesPerBigPage, [&](PageRef r){ addrs.push_back(r.addr().value); },
+                          rem, AllocBehavior::BIG_PAGE_ONLY);
+    ASSERT_EQ(pageCount, addrs.size());
+    std::sort(addrs.begin(), addrs.end());
+    std::vector<PageRef> pages;
+    for (const uint64_t addr : addrs) pages.push_back(PageRef::big(phys_addr(addr)));
+
+    // The lowest free run goes back last, so it sits past the part of the ring a claim scans
+    // and the next run up is taken instead.
+    p.pool->freePages(pages.data() + 2, pageCount - 2);
+    p.pool->freePages(pages.data(), 2);
+    auto base = p.pool->allocateContiguous(2 * PageAllocator::smallPagesPerBigPage, arch::bigPageSize, rem);
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ(pages[2].addr().value, (*base).value);
+    ASSERT_EQ(pageCount - 2, p.pool->getFreeBigPageCount());
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
+// ============================================================================
+// NUMAPool — Gigantic tier
+// ============================================================================
+
+static constexpr size_t bigPagesPerGigantic = PageAllocator::bigPagesPerGiganticPage;
+
+TEST(NUMAPool_Gigantic_AlignedFreeGroupsListedAtInit) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), 2 * bigPagesPerGigantic + 16);
+    ASSERT_EQ(2u, p.pool->getFreeGiganticPageCount());
+    ASSERT_EQ(2 * bigPagesPerGigantic + 16, p.pool->getFreeBigPageCount());
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
+TEST(NUMAPool_Gigantic_UnalignedAndReservedGroupsAreNotListed) {
+    // Starting one big page past the boundary leaves room for only one aligned group.
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0) + arch::bigPageSize, 2 * bigPagesPerGigantic);
+    ASSERT_EQ(1u, p.pool->getFreeGiganticPageCount());
+
+    // A reserved small page breaks up the group that contains it.
+    const uint64_t inGroup = testDomainBase(0) + arch::giganticPageSize + 7 * arch::bigPageSize;
+    p.pool->reserveRange({ phys_addr(inGroup), phys_addr(inGroup + arch::smallPageSize) });
+    ASSERT_EQ(0u, p.pool->getFreeGiganticPageCount());
+    ASSERT_EQ(2 * bigPagesPerGigantic - 1, p.pool->getFreeBigPageCount());
+}
+
+TEST(NUMAPool_Gigantic_AllocAndFreeRoundtrip) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), bigPagesPerGigantic);
+    const size_t freeBefore = p.pool->countTotalFreePages();
+
+    std::vector<PageRef> pages;
+    ASSERT_EQ(1u, p.pool->allocateGiganticPages(2, [&](PageRef r){ pages.push_back(r); }));
+    ASSERT_EQ(1u, pages.size());
+    ASSERT_EQ(PageSize::GIGANTIC, pages[0].size());
+    ASSERT_EQ(testDomainBase(0), pages[0].addr().value);
+    ASSERT_EQ(0u, p.pool->countTotalFreePages());
+
+    p.pool->freePages(pages.data(), 1);
+    ASSERT_EQ(1u, p.pool->getFreeGiganticPageCount());
+    ASSERT_EQ(freeBefore, p.pool->countTotalFreePages());
+}
+
+TEST(NUMAPool_Gigantic_BigAllocSplitsGroupOnlyWhenNeeded) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), bigPagesPerGigantic + 4);
+    BigPageMetadata* rem = nullptr;
+    ASSERT_EQ(4 * PageAllocator::smallPagesPerBigPage,
+              p.pool->allocatePages(4 * PageAllocator::smallPagesPerBigPage, [](PageRef){}, rem,
+                                    AllocBehavior::BIG_PAGE_ONLY));
+    ASSERT_EQ(1u, p.pool->getFreeGiganticPageCount());
+
+    PageRef page{};
+    p.pool->allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ page = r; }, rem,
+                          AllocBehavior::BIG_PAGE_ONLY);
+    ASSERT_EQ(0u, p.pool->getFreeGiganticPageCount());
+    ASSERT_EQ(bigPagesPerGigantic - 1, p.pool->getFreeBigPageCount());
+    ASSERT_TRUE(page.addr().value >= testDomainBase(0) && page.addr().value < testDomainBase(1));
+}
+
+TEST(NUMAPool_Gigantic_ReformsOnceEveryBigPageIsFree) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), bigPagesPerGigantic);
+    std::vector<PageRef> pages;
+    BigPageMetadata* rem = nullptr;
+    p.pool->allocatePages(bigPagesPerGigantic * PageAllocator::smallPagesPerBigPage,
+                          [&](PageRef r){ pages.push_back(r); }, rem, AllocBehavior::BIG_PAGE_ONLY);
+    ASSERT_EQ(bigPagesPerGigantic, pages.size());
+
+    // One page still out: no gigantic page can be formed.
+    p.pool->freePages(pages.data(), pages.size() - 1);
+    ASSERT_EQ(0u, p.pool->allocateGiganticPages(1, [](PageRef){}));
+
+    p.pool->freePages(&pages.back(), 1);
+    PageRef gigantic{};
+    ASSERT_EQ(1u, p.pool->allocateGiganticPages(1, [&](PageRef r){ gigantic = r; }));
+    ASSERT_EQ(testDomainBase(0), gigantic.addr().value);
+    ASSERT_EQ(0u, p.pool->getFreeBigPageCount());
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
+TEST(NUMAPool_Gigantic_ContiguousRunSplitsListedGroup) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), bigPagesPerGigantic);
+    BigPageMetadata* rem = nullptr;
+    auto base = p.pool->allocateContiguous(4 * PageAllocator::smallPagesPerBigPage, arch::bigPageSize, rem);
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ(0u, p.pool->getFreeGiganticPageCount());
+    ASSERT_EQ(bigPagesPerGigantic - 4, p.pool->getFreeBigPageCount());
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
 // ============================================================================
 // NUMAPool — Small-page allocation
 // ============================================================================
@@ -2301,6 +2539,85 @@ TEST(PAI_MultiDomain_FreeRoutesToCorrectPool) {
     ASSERT_TRUE(impl.impl.numaPools[1]->checkInvariants());
 }
 
+// ============================================================================
+// PageAllocatorImpl — Metadata radix
+// ============================================================================
+
+TEST(PAI_MetadataRadix_ResolvesEveryBigPageAcrossRanges) {
+    // Domain 0 owns two ranges several leaf spans apart; every big page in either must
+    // resolve to its own metadata, and the hole between them to nothing.
+    constexpr size_t N = 4;
+    const uint64_t farBase = testDomainBase(0) + 3 * MetadataRadix::leafSpan;
+    DomainSpec split;
+    split.ranges.push(makeBigPageRange(testDomainBase(0), N));
+    split.ranges.push(makeBigPageRange(farBase, N));
+    split.cpuIds = {0};
+    TestPageAllocatorImpl impl({ move(split), DomainSpec::simple(5, N, {1}) });
+
+    ASSERT_TRUE(impl.impl.metadataRadix.valid());
+    for (const uint64_t base : {testDomainBase(0), farBase, testDomainBase(5)}) {
+        for (size_t i = 0; i < N; i++) {
+            const uint64_t addr = base + i * arch::bigPageSize;
+            BigPageMetadata* meta = impl.impl.findMetadata(phys_addr(addr + arch::smallPageSize));
+            ASSERT_NE(nullptr, meta);
+            ASSERT_EQ(addr, meta->baseAddr().value);
+            ASSERT_EQ(meta, meta->getOwnerPool().findMetadata(phys_addr(addr)));
+        }
+    }
+    ASSERT_EQ(nullptr, impl.impl.findMetadata(phys_addr(testDomainBase(0) + N * arch::bigPageSize)));
+    ASSERT_EQ(nullptr, impl.impl.findMetadata(phys_addr(testDomainBase(0) + MetadataRadix::leafSpan)));
+    ASSERT_EQ(nullptr, impl.impl.findMetadata(phys_addr(testDomainBase(5) + MetadataRadix::leafSpan)));
+}
+
+TEST(PAI_MetadataRadix_DomainsSharingALeaf) {
+    // Two domains split one leaf span. Each pool must only claim its own pages, and frees
+    // must still route to the owning pool.
+    constexpr size_t N = 2;
+    const uint64_t secondBase = testDomainBase(0) + N * arch::bigPageSize;
+    DomainSpec first, second;
+    first.ranges.push(makeBigPageRange(testDomainBase(0), N));
+    first.cpuIds = {0};
+    second.ranges.push(makeBigPageRange(secondBase, N));
+    second.cpuIds = {1};
+    TestPageAllocatorImpl impl({ move(first), move(second) });
+
+    NUMAPool* pool0 = impl.impl.numaPools[0];
+    NUMAPool* pool1 = impl.impl.numaPools[1];
+    ASSERT_EQ(pool0, &impl.impl.findMetadata(phys_addr(testDomainBase(0)))->getOwnerPool());
+    ASSERT_EQ(pool1, &impl.impl.findMetadata(phys_addr(secondBase))->getOwnerPool());
+    ASSERT_EQ(nullptr, pool0->findMetadata(phys_addr(secondBase)));
+    ASSERT_EQ(nullptr, pool1->findMetadata(phys_addr(testDomainBase(0))));
+
+    std::vector<PageRef> pages;
+    impl.impl.allocatePages(2 * N * PageAllocator::smallPagesPerBigPage,
+                            [&](PageRef r){ pages.push_back(r); },
+                            AllocBehavior::BIG_PAGE_ONLY);
+    ASSERT_EQ(2 * N, pages.size());
+    ASSERT_EQ(0u, pool0->getFreeBigPageCount());
+    ASSERT_EQ(0u, pool1->getFreeBigPageCount());
+    impl.impl.freePages(pages.data(), pages.size());
+    ASSERT_EQ(N, pool0->getFreeBigPageCount());
+    ASSERT_EQ(N, pool1->getFreeBigPageCount());
+}
+
+TEST(MetadataRadix_MeasuringBoundsRealAllocation) {
+    // Ranges sharing a leaf span are charged twice while measuring but backed once.
+    Vector<phys_memory_range> ranges;
+    ranges.push(makeBigPageRange(testDomainBase(0), 2));
+    ranges.push(makeBigPageRange(testDomainBase(0) + 8 * arch::bigPageSize, 2));
+    BootstrapAllocator measuring;
+    ASSERT_FALSE(createMetadataRadix(measuring, ranges).valid());
+
+    BootstrapBuffer buffer(measuring.bytesNeeded());
+    BootstrapAllocator real = buffer.makeAllocator();
+    const MetadataRadix radix = createMetadataRadix(real, ranges);
+    ASSERT_TRUE(radix.valid());
+    ASSERT_EQ(divideAndRoundUp(testDomainBase(0) + 10 * arch::bigPageSize, static_cast<uint64_t>(MetadataRadix::leafSpan)),
+              radix.rootEntries);
+    ASSERT_GE(real.bytesRemaining(), MetadataRadix::leafEntries * sizeof(BigPageMetadata*));
+    ASSERT_EQ(nullptr, radix.lookup(phys_addr(testDomainBase(0))));
+}
+
 // ============================================================================
 // PageAllocatorImpl — Concurrent stress (single domain)
 // ============================================================================
@@ -2404,3 +2721,1934 @@ TEST_WITH_TIMEOUT_NO_TRACKING(PAI_ConcurrentStress_SingleDomain, 8000) {
         ASSERT_EQ(totalPages, impl.impl.countFreePages());
     }
 }
+
+// ============================================================================
+// Contiguous allocation
+// ============================================================================
+
+TEST(SPA_AllocRun_AlignedRunInEmptyPage) {
+    SmallPageAllocator spa(testBaseAddr);
+    OccupancyTransition t{};
+    auto base = spa.allocRun(16, 16, t);
+
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ(testBaseAddr.value, (*base).value);
+    ASSERT_TRUE(t.before == OccupancyState::Empty);
+    ASSERT_TRUE(t.after  == OccupancyState::Partial);
+    for (size_t i = 0; i < 16; i++) {
+        ASSERT_FALSE(spa.isPageFree(PageRef::small(testBaseAddr + i * arch::smallPageSize)));
+    }
+    ASSERT_TRUE(spa.isPageFree(PageRef::small(testBaseAddr + 16 * arch::smallPageSize)));
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(SPA_AllocRun_SkipsToNextAlignedSlot) {
+    // Pages 0..2 are taken, so an 8-page run aligned to 8 must start at page 8.
+    SmallPageAllocator spa(testBaseAddr);
+    (void)spa.alloc([](PageRef){}, 3);
+
+    OccupancyTransition t{};
+    auto base = spa.allocRun(8, 8, t);
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ((testBaseAddr + 8 * arch::smallPageSize).value, (*base).value);
+    ASSERT_EQ(11u, spa.getAllocatedCount());
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(SPA_Alloc_RunsReportWholeSpans) {
+    // Free pages 10..99 of an otherwise full page: one run covers them, across bitmap words.
+    SmallPageAllocator spa(testBaseAddr);
+    (void)spa.alloc([](PageRef){}, PageAllocator::smallPagesPerBigPage);
+    PageRef hole = PageRef::smallRun(testBaseAddr + 10 * arch::smallPageSize, 90);
+    spa.free(&hole, 1);
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage - 90, spa.getAllocatedCount());
+
+    std::vector<PageRef> runs;
+    OccupancyTransition t{};
+    ASSERT_EQ(90u, spa.alloc([&](PageRef r){ runs.push_back(r); }, 100, t, true));
+    ASSERT_EQ(1u, runs.size());
+    ASSERT_EQ(hole, runs[0]);
+    ASSERT_TRUE(t.after == OccupancyState::Full);
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(SPA_Alloc_RunsStopAtRequestedCount) {
+    SmallPageAllocator spa(testBaseAddr);
+    std::vector<PageRef> runs;
+    OccupancyTransition t{};
+    ASSERT_EQ(70u, spa.alloc([&](PageRef r){ runs.push_back(r); }, 70, t, true));
+    ASSERT_EQ(1u, runs.size());
+    ASSERT_EQ(testBaseAddr.value, runs[0].addr().value);
+    ASSERT_EQ(70u, runs[0].runLength());
+    ASSERT_TRUE(spa.isPageFree(PageRef::small(testBaseAddr + 70 * arch::smallPageSize)));
+
+    spa.free(runs.data(), runs.size());
+    ASSERT_TRUE(spa.isEmpty());
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(SPA_AllocColored_WalksColorsFromCursor) {
+    SmallPageAllocator spa(testBaseAddr);
+    PageColoring coloring{16, 5};
+    std::vector<PageRef> pages;
+    OccupancyTransition t{};
+    ASSERT_EQ(20u, spa.alloc([&](PageRef r){ pages.push_back(r); }, 20, t, true, &coloring));
+    for (size_t i = 0; i < pages.size(); i++) {
+        ASSERT_EQ(1u, pages[i].runLength());
+        ASSERT_EQ((5 + i) % 16, (pages[i].addr().value / arch::smallPageSize) % 16);
+    }
+    ASSERT_EQ(9u, coloring.next);
+
+    spa.free(pages.data(), pages.size());
+    ASSERT_TRUE(spa.isEmpty());
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(SPA_AllocColored_FallsForwardToNextFreeColor) {
+    // With 128 colors only pages 3, 7 and 131 (colors 3, 7, 3) are free. Starting at color 4,
+    // the cursor settles for 7, then wraps around to the two pages of color 3.
+    SmallPageAllocator spa(testBaseAddr);
+    (void)spa.alloc([](PageRef){}, PageAllocator::smallPagesPerBigPage);
+    PageRef holes[] = {
+        PageRef::small(testBaseAddr + 3 * arch::smallPageSize),
+        PageRef::small(testBaseAddr + 7 * arch::smallPageSize),
+        PageRef::small(testBaseAddr + 131 * arch::smallPageSize),
+    };
+    spa.free(holes, 3);
+
+    PageColoring coloring{128, 4};
+    std::vector<PageRef> pages;
+    OccupancyTransition t{};
+    ASSERT_EQ(3u, spa.alloc([&](PageRef r){ pages.push_back(r); }, 8, t, false, &coloring));
+    ASSERT_EQ(3u, pages.size());
+    ASSERT_EQ(holes[1], pages[0]);
+    ASSERT_EQ(holes[0], pages[1]);
+    ASSERT_EQ(holes[2], pages[2]);
+    ASSERT_EQ(4u, coloring.next);
+    ASSERT_TRUE(t.after == OccupancyState::Full);
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(PageColors_DerivedFromCacheGeometry) {
+    // One way of a 1 MiB 16-way cache spans 64 KiB, i.e. 16 small pages.
+    ASSERT_EQ(16u, PageAllocator::colorsForCache(*arch::getCacheGeometry(2)));
+    // An L1 whose way is a single page has nothing to color.
+    ASSERT_EQ(1u, PageAllocator::colorsForCache(*arch::getCacheGeometry(1)));
+    // 384 pages per way rounds down to 256; a 32 MiB 4-way way is capped at one big page.
+    ASSERT_EQ(256u, PageAllocator::colorsForCache({64, 12, 24576}));
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, PageAllocator::colorsForCache({64, 4, 131072}));
+    // Two lines per tag double what one way covers without changing the line size.
+    const arch::CacheGeometry partitioned{64, 16, 1024, 2};
+    ASSERT_EQ(64u, partitioned.lineSize);
+    ASSERT_EQ(2u * 1024 * 1024, partitioned.sizeBytes());
+    ASSERT_EQ(32u, PageAllocator::colorsForCache(partitioned));
+}
+
+TEST(SPA_AllocRun_SpansBitmapWords) {
+    // An unaligned run crossing a 64-bit word boundary.
+    SmallPageAllocator spa(testBaseAddr);
+    (void)spa.alloc([](PageRef){}, 60);
+
+    OccupancyTransition t{};
+    auto base = spa.allocRun(10, 1, t);
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ((testBaseAddr + 60 * arch::smallPageSize).value, (*base).value);
+    ASSERT_FALSE(spa.isPageFree(PageRef::small(testBaseAddr + 69 * arch::smallPageSize)));
+    ASSERT_TRUE(spa.isPageFree(PageRef::small(testBaseAddr + 70 * arch::smallPageSize)));
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(SPA_AllocRun_SeesPagesInFreeBitmap) {
+    // Pages freed by other CPUs sit in freeBitmap; allocRun must find runs there too.
+    SmallPageAllocator spa(testBaseAddr);
+    spa.allocAll();
+    std::vector<PageRef> toFree;
+    for (size_t i = 32; i < 64; i++) toFree.push_back(PageRef::small(testBaseAddr + i * arch::smallPageSize));
+    spa.free(toFree.data(), toFree.size());
+
+    OccupancyTransition t{};
+    auto base = spa.allocRun(32, 32, t);
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ((testBaseAddr + 32 * arch::smallPageSize).value, (*base).value);
+    ASSERT_TRUE(t.after == OccupancyState::Full);
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(SPA_AllocRun_NoFittingRun) {
+    // Every other page is free: no run of two exists.
+    SmallPageAllocator spa(testBaseAddr);
+    spa.allocAll();
+    std::vector<PageRef> toFree;
+    for (size_t i = 0; i < PageAllocator::smallPagesPerBigPage; i += 2) {
+        toFree.push_back(PageRef::small(testBaseAddr + i * arch::smallPageSize));
+    }
+    spa.free(toFree.data(), toFree.size());
+
+    OccupancyTransition t{};
+    auto base = spa.allocRun(2, 1, t);
+    ASSERT_FALSE(base.occupied());
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage / 2, spa.getAllocatedCount());
+    ASSERT_TRUE(spa.checkInvariants());
+}
+
+TEST(PAI_Contiguous_SmallRun_AlignedAndAllocated) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1, 2, 3}) });
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    // Misalign the cached page first so the run cannot trivially start at page 0.
+    std::vector<PageRef> scattered;
+    impl.impl.allocatePages(5, [&](PageRef r){ scattered.push_back(r); });
+
+    auto base = impl.impl.allocateContiguous(16, 64 * 1024, kernel::numa::DomainID{0});
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ(0u, (*base).value % (64 * 1024));
+    for (size_t i = 0; i < 16; i++) {
+        ASSERT_TRUE(impl.impl.isPageAllocated(PageRef::small(*base + i * arch::smallPageSize)));
+    }
+    ASSERT_EQ(freeBefore - 21, impl.impl.countFreePages());
+
+    impl.impl.freeContiguous(*base, 16);
+    impl.impl.freePages(scattered.data(), scattered.size());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_Contiguous_MultiBigPageRun) {
+    // Two whole big pages plus a 100-page tail, aligned to 4 MiB.
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 8, {0, 1, 2, 3}) });
+    const size_t count = 2 * PageAllocator::smallPagesPerBigPage + 100;
+    const size_t alignment = 2 * arch::bigPageSize;
+
+    auto base = impl.impl.allocateContiguous(count, alignment, kernel::numa::DomainID{0});
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ(0u, (*base).value % alignment);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_TRUE(impl.impl.isPageAllocated(PageRef::small(*base + i * arch::smallPageSize)));
+    }
+    ASSERT_FALSE(impl.impl.isPageAllocated(PageRef::small(*base + count * arch::smallPageSize)));
+    ASSERT_EQ(5u, impl.impl.numaPools[0]->getFreeBigPageCount());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+
+    impl.impl.freeContiguous(*base, count);
+    ASSERT_EQ(8 * PageAllocator::smallPagesPerBigPage, impl.impl.countFreePages());
+    ASSERT_EQ(8u, impl.impl.numaPools[0]->getFreeBigPageCount());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_Contiguous_SkipsOccupiedBigPages) {
+    // Occupy every other big page; a two-big-page run must land on the one adjacent free pair.
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 6, {0, 1, 2, 3}) });
+    const uint64_t base0 = testDomainBase(0);
+
+    impl.impl.allocatePages(6 * PageAllocator::smallPagesPerBigPage,
+                            [](PageRef){}, AllocBehavior::BIG_PAGE_ONLY);
+    // Free big pages 1, 3 and 4 — only 3..4 are adjacent.
+    PageRef toFree[] = { PageRef::big(phys_addr(base0 + 1 * arch::bigPageSize)),
+                         PageRef::big(phys_addr(base0 + 3 * arch::bigPageSize)),
+                         PageRef::big(phys_addr(base0 + 4 * arch::bigPageSize)) };
+    impl.impl.freePages(toFree, 3);
+
+    auto base = impl.impl.allocateContiguous(2 * PageAllocator::smallPagesPerBigPage, arch::bigPageSize,
+                                             kernel::numa::DomainID{0});
+    ASSERT_TRUE(base.occupied());
+    ASSERT_EQ(base0 + 3 * arch::bigPageSize, (*base).value);
+    ASSERT_EQ(1u, impl.impl.numaPools[0]->getFreeBigPageCount());
+}
+
+TEST(PAI_Contiguous_GracefulOOM_ReturnsEmpty) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    auto base = impl.impl.allocateContiguous(3 * PageAllocator::smallPagesPerBigPage, arch::bigPageSize,
+                                             kernel::numa::DomainID{0}, AllocBehavior::GRACEFUL_OOM);
+    ASSERT_FALSE(base.occupied());
+    ASSERT_EQ(2u, impl.impl.numaPools[0]->getFreeBigPageCount());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+// ============================================================================
+// PageAllocatorImpl — Single-page magazine
+// ============================================================================
+
+TEST(PAI_Magazine_DisabledByDefault) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    ASSERT_FALSE(impl.impl.magazinesEnabled);
+
+    impl.impl.allocatePages(1, [](PageRef){});
+    ASSERT_EQ(0u, impl.localPools[0]->magazineSize());
+}
+
+TEST(PAI_Magazine_SingleAllocRefillsOneBatch) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.magazinesEnabled = true;
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }));
+    ASSERT_EQ(PageSize::SMALL, page.size());
+    ASSERT_TRUE(impl.impl.isPageAllocated(page));
+    ASSERT_EQ(LocalPool::magazineBatch - 1, impl.localPools[0]->magazineSize());
+    // The whole batch left the pools, not just the page handed out.
+    ASSERT_EQ(freeBefore - LocalPool::magazineBatch, impl.impl.countFreePages());
+
+    // Subsequent single-page allocations come straight off the magazine.
+    impl.impl.allocatePages(1, [](PageRef){});
+    ASSERT_EQ(LocalPool::magazineBatch - 2, impl.localPools[0]->magazineSize());
+    ASSERT_EQ(freeBefore - LocalPool::magazineBatch, impl.impl.countFreePages());
+}
+
+TEST(PAI_Magazine_FreedPageIsReusedFirst) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.magazinesEnabled = true;
+
+    PageRef first{}, second{};
+    impl.impl.allocatePages(1, [&](PageRef r){ first = r; });
+    impl.impl.allocatePages(1, [](PageRef){});
+    impl.impl.freePages(&first, 1);
+    impl.impl.allocatePages(1, [&](PageRef r){ second = r; });
+
+    ASSERT_EQ(first.value, second.value);
+}
+
+TEST(PAI_Magazine_OverflowSpillsToPools) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.magazinesEnabled = true;
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    std::vector<PageRef> pages;
+    impl.impl.allocatePages(3 * LocalPool::magazineCapacity, [&](PageRef r){ pages.push_back(r); });
+    for (auto& page : pages) {
+        impl.impl.freePages(&page, 1);
+        ASSERT_TRUE(impl.localPools[0]->magazineSize() <= LocalPool::magazineCapacity);
+    }
+    ASSERT_TRUE(impl.localPools[0]->magazineFull() ||
+                impl.localPools[0]->magazineSize() > LocalPool::magazineBatch);
+
+    impl.impl.flushMagazine(0);
+    ASSERT_TRUE(impl.localPools[0]->magazineEmpty());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_Magazine_RemoteDomainPagesBypassMagazine) {
+    // Domain 0: CPU 0; domain 1: CPU 1. A domain-1 page freed on CPU 0 goes straight home.
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0}), DomainSpec::simple(1, 2, {1}) });
+    impl.impl.magazinesEnabled = true;
+
+    PageRef remote{};
+    impl.impl.allocatePages(1, [&](PageRef r){ remote = r; }, kernel::numa::DomainID{1});
+    ASSERT_TRUE(remote.addr().value >= testDomainBase(1));
+
+    impl.impl.freePages(&remote, 1);
+    ASSERT_EQ(0u, impl.localPools[0]->magazineSize());
+    ASSERT_FALSE(impl.impl.isPageAllocated(remote));
+}
+
+TEST(PAI_Magazine_LocalDomainOnlyBypassesMagazine) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0}), DomainSpec::simple(1, 2, {1}) });
+    impl.impl.magazinesEnabled = true;
+
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }, AllocBehavior::LOCAL_DOMAIN_ONLY));
+    ASSERT_EQ(0u, impl.localPools[0]->magazineSize());
+    ASSERT_TRUE(page.addr().value >= testDomainBase(0) && page.addr().value < testDomainBase(1));
+}
+
+TEST(PAI_Magazine_RefillStaysInNearestDomain) {
+    // The nearest pool has a single small page left; the refill must not top up from domain 1.
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 1, {0}), DomainSpec::simple(1, 2, {1}) });
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage - 1, [](PageRef){}, kernel::numa::DomainID{0});
+    impl.impl.magazinesEnabled = true;
+
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }));
+    ASSERT_TRUE(page.addr().value < testDomainBase(1));
+    ASSERT_EQ(0u, impl.localPools[0]->magazineSize());
+
+    // With domain 0 exhausted the regular path serves the next page from domain 1, uncached.
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }));
+    ASSERT_TRUE(page.addr().value >= testDomainBase(1));
+    ASSERT_EQ(0u, impl.localPools[0]->magazineSize());
+}
+
+TEST(PAI_Magazine_DoubleFreeAsserts) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.magazinesEnabled = true;
+
+    PageRef page{};
+    impl.impl.allocatePages(1, [&](PageRef r){ page = r; });
+    impl.impl.freePages(&page, 1);
+    bool caught = false;
+    try {
+        impl.impl.freePages(&page, 1);
+    } catch (const AssertionFailure& e) {
+        caught = true;
+        ASSERT_TRUE(std::string(e.what()).find("Double free") != std::string::npos);
+    }
+    ASSERT_TRUE(caught);
+}
+
+// ============================================================================
+// PageAllocatorImpl — Per-CPU big-page cache
+// ============================================================================
+
+TEST(PAI_BigPageCache_DisabledByDefault) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 16, {0, 1, 2, 3}) });
+    ASSERT_FALSE(impl.impl.bigPageCachesEnabled);
+
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [](PageRef){}, AllocBehavior::BIG_PAGE_ONLY);
+    ASSERT_EQ(0u, impl.localPools[0]->bigPageCacheSize());
+    ASSERT_EQ(15u, impl.impl.numaPools[0]->getFreeBigPageCount());
+}
+
+TEST(PAI_BigPageCache_AllocRefillsOneBatch) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 16, {0, 1, 2, 3}) });
+    impl.impl.bigPageCachesEnabled = true;
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    PageRef page{};
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage,
+              impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ page = r; },
+                                      AllocBehavior::BIG_PAGE_ONLY));
+    ASSERT_EQ(PageSize::BIG, page.size());
+    ASSERT_TRUE(impl.impl.isPageAllocated(page));
+    ASSERT_EQ(LocalPool::bigPageCacheBatch - 1, impl.localPools[0]->bigPageCacheSize());
+    ASSERT_EQ(16u - LocalPool::bigPageCacheBatch, impl.impl.numaPools[0]->getFreeBigPageCount());
+    // Cached pages leave the ring but stay free, so only the page handed out is counted.
+    ASSERT_EQ(freeBefore - PageAllocator::smallPagesPerBigPage, impl.impl.countFreePages());
+}
+
+TEST(PAI_BigPageCache_FreedBigPageIsReusedFirst) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 16, {0, 1, 2, 3}) });
+    impl.impl.bigPageCachesEnabled = true;
+
+    PageRef first{}, second{};
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ first = r; }, AllocBehavior::BIG_PAGE_ONLY);
+    impl.impl.freePages(&first, 1);
+    ASSERT_FALSE(impl.impl.isPageAllocated(first));
+    ASSERT_EQ(LocalPool::bigPageCacheBatch, impl.localPools[0]->bigPageCacheSize());
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ second = r; }, AllocBehavior::BIG_PAGE_ONLY);
+
+    ASSERT_EQ(first.value, second.value);
+}
+
+TEST(PAI_BigPageCache_OverflowSpillsToPool) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 32, {0, 1, 2, 3}) });
+    impl.impl.bigPageCachesEnabled = true;
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    // Larger requests bypass the cache entirely.
+    std::vector<PageRef> pages;
+    impl.impl.allocatePages(3 * LocalPool::bigPageCacheCapacity * PageAllocator::smallPagesPerBigPage / 2,
+                            [&](PageRef r){ pages.push_back(r); }, AllocBehavior::BIG_PAGE_ONLY);
+    ASSERT_EQ(0u, impl.localPools[0]->bigPageCacheSize());
+    for (auto& page : pages) {
+        impl.impl.freePages(&page, 1);
+        ASSERT_TRUE(impl.localPools[0]->bigPageCacheSize() <= LocalPool::bigPageCacheCapacity);
+    }
+    ASSERT_TRUE(impl.localPools[0]->bigPageCacheSize() > LocalPool::bigPageCacheBatch);
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+
+    impl.impl.flushBigPageCache(0);
+    ASSERT_EQ(0u, impl.localPools[0]->bigPageCacheSize());
+    ASSERT_EQ(32u, impl.impl.numaPools[0]->getFreeBigPageCount());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_BigPageCache_FallsBackWhenPoolRunsDry) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0}), DomainSpec::simple(1, 2, {1}) });
+    impl.impl.bigPageCachesEnabled = true;
+
+    // Only two home pages exist; the other two come from domain 1 via the regular path.
+    std::vector<PageRef> pages;
+    ASSERT_EQ(4 * PageAllocator::smallPagesPerBigPage,
+              impl.impl.allocatePages(4 * PageAllocator::smallPagesPerBigPage, [&](PageRef r){ pages.push_back(r); },
+                                      AllocBehavior::BIG_PAGE_ONLY));
+    ASSERT_EQ(4u, pages.size());
+    ASSERT_EQ(0u, impl.localPools[0]->bigPageCacheSize());
+
+    // Remote-domain pages are freed straight home rather than cached.
+    for (auto& page : pages) impl.impl.freePages(&page, 1);
+    ASSERT_EQ(2u, impl.localPools[0]->bigPageCacheSize());
+    ASSERT_EQ(2u, impl.impl.numaPools[1]->getFreeBigPageCount());
+}
+
+TEST(PAI_BigPageCache_ContiguousSkipsCachedPages) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 16, {0, 1, 2, 3}) });
+    impl.impl.bigPageCachesEnabled = true;
+
+    // Pull a batch into the cache, then ask for a run longer than what is left in the ring.
+    PageRef page{};
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ page = r; }, AllocBehavior::BIG_PAGE_ONLY);
+    const size_t ringPages = impl.impl.numaPools[0]->getFreeBigPageCount();
+    auto base = impl.impl.allocateContiguous((ringPages + 1) * PageAllocator::smallPagesPerBigPage, arch::bigPageSize,
+                                             kernel::numa::DomainID{0}, AllocBehavior::GRACEFUL_OOM);
+    ASSERT_FALSE(base.occupied());
+    ASSERT_EQ(LocalPool::bigPageCacheBatch - 1, impl.localPools[0]->bigPageCacheSize());
+
+    impl.impl.freePages(&page, 1);
+    impl.impl.flushBigPageCache(0);
+    base = impl.impl.allocateContiguous((ringPages + 1) * PageAllocator::smallPagesPerBigPage, arch::bigPageSize,
+                                        kernel::numa::DomainID{0}, AllocBehavior::GRACEFUL_OOM);
+    ASSERT_TRUE(base.occupied());
+}
+
+// ============================================================================
+// PageAllocatorImpl — Gigantic pages
+// ============================================================================
+
+TEST(PAI_Gigantic_AllocatesWholeAlignedGroups) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2 * bigPagesPerGigantic, {0, 1}) });
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    std::vector<PageRef> pages;
+    ASSERT_EQ(2 * PageAllocator::smallPagesPerGiganticPage,
+              impl.impl.allocatePages(2 * PageAllocator::smallPagesPerGiganticPage,
+                                      [&](PageRef r){ pages.push_back(r); }, AllocBehavior::GIGANTIC_PAGE_ONLY));
+    ASSERT_EQ(2u, pages.size());
+    for (const auto& page : pages) {
+        ASSERT_EQ(PageSize::GIGANTIC, page.size());
+        ASSERT_EQ(0u, page.addr().value % arch::giganticPageSize);
+        ASSERT_TRUE(impl.impl.isPageAllocated(page));
+    }
+    ASSERT_EQ(0u, impl.impl.countFreePages());
+
+    impl.impl.freePages(pages.data(), pages.size());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+    ASSERT_EQ(2u, impl.impl.numaPools[0]->getFreeGiganticPageCount());
+}
+
+TEST(PAI_Gigantic_GracefulOOMReturnsShortCount) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, bigPagesPerGigantic + 8, {0}) });
+    size_t count = 0;
+    ASSERT_EQ(PageAllocator::smallPagesPerGiganticPage,
+              impl.impl.allocatePages(2 * PageAllocator::smallPagesPerGiganticPage, [&](PageRef){ count++; },
+                                      AllocBehavior::GIGANTIC_PAGE_ONLY | AllocBehavior::GRACEFUL_OOM));
+    ASSERT_EQ(1u, count);
+    // The leftover big pages are untouched.
+    ASSERT_EQ(8u, impl.impl.numaPools[0]->getFreeBigPageCount());
+}
+
+TEST(PAI_Gigantic_FallsBackToRemoteDomain) {
+    // Domain 0 is too small for a gigantic page; domain 1 (placed in its own GiB slots) is not.
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 16, {0}), DomainSpec::simple(2, bigPagesPerGigantic, {1}) });
+    PageRef page{};
+    ASSERT_EQ(PageAllocator::smallPagesPerGiganticPage,
+              impl.impl.allocatePages(PageAllocator::smallPagesPerGiganticPage, [&](PageRef r){ page = r; },
+                                      AllocBehavior::GIGANTIC_PAGE_ONLY));
+    ASSERT_EQ(testDomainBase(2), page.addr().value);
+
+    ASSERT_EQ(0u, impl.impl.allocatePages(PageAllocator::smallPagesPerGiganticPage, [](PageRef){},
+                                          kernel::numa::DomainID{0},
+                                          AllocBehavior::GIGANTIC_PAGE_ONLY | AllocBehavior::LOCAL_DOMAIN_ONLY |
+                                          AllocBehavior::GRACEFUL_OOM));
+    impl.impl.freePages(&page, 1);
+    ASSERT_FALSE(impl.impl.isPageAllocated(page));
+}
+
+// ============================================================================
+// PageAllocatorImpl — Zeroed allocation
+// ============================================================================
+
+// Stands in for the kernel's mapping-based zeroer; records every range it is asked to clear.
+// Fixed storage so the recorded ranges do not show up as leaks of the test that filled them.
+struct ZeroedRange { uint64_t base; size_t bytes; };
+static ZeroedRange gZeroedRanges[4096];
+static size_t gZeroedRangeCount = 0;
+
+static void recordingZeroer(phys_addr base, size_t bytes) {
+    if (gZeroedRangeCount < sizeof(gZeroedRanges) / sizeof(gZeroedRanges[0])) {
+        gZeroedRanges[gZeroedRangeCount++] = { base.value, bytes };
+    }
+}
+
+static bool wasZeroed(PageRef page) {
+    const size_t bytes = page.size() == PageSize::BIG ? arch::bigPageSize : arch::smallPageSize;
+    for (size_t i = 0; i < gZeroedRangeCount; i++) {
+        if (gZeroedRanges[i].base == page.addr().value && gZeroedRanges[i].bytes == bytes) return true;
+    }
+    return false;
+}
+
+TEST(PAI_Zeroed_FreshPagesAreZeroedBeforeDelivery) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.pageZeroer = recordingZeroer;
+    gZeroedRangeCount = 0;
+
+    std::vector<PageRef> pages;
+    ASSERT_EQ(3u, impl.impl.allocatePages(3, [&](PageRef r){ pages.push_back(r); }, AllocBehavior::ZEROED));
+    ASSERT_EQ(3u, pages.size());
+    ASSERT_EQ(3u, gZeroedRangeCount);
+    for (auto& page : pages) {
+        ASSERT_EQ(PageSize::SMALL, page.size());
+        ASSERT_TRUE(wasZeroed(page));
+        ASSERT_TRUE(impl.impl.isPageAllocated(page));
+    }
+}
+
+TEST(PAI_Zeroed_WorkerStocksZeroedLists) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 16, {0, 1, 2, 3}) });
+    ASSERT_EQ(0u, impl.impl.zeroFreePages(8)); // No zeroer registered yet.
+
+    impl.impl.pageZeroer = recordingZeroer;
+    gZeroedRangeCount = 0;
+    NUMAPool& pool = *impl.impl.numaPools[0];
+
+    // One big page is split into the small list, one more fills the big list (16 / 16).
+    ASSERT_EQ(2u, impl.impl.zeroFreePages(8));
+    ASSERT_EQ(2u, gZeroedRangeCount);
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, pool.getZeroedSmallPageCount());
+    ASSERT_EQ(1u, pool.getZeroedBigPageCount());
+    ASSERT_EQ(15u, pool.getFreeBigPageCount());
+
+    // Already stocked: nothing more to do.
+    ASSERT_EQ(0u, impl.impl.zeroFreePages(8));
+    ASSERT_TRUE(pool.checkInvariants());
+}
+
+TEST(PAI_Zeroed_PrezeroedPagesSkipTheZeroer) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 16, {0, 1, 2, 3}) });
+    impl.impl.pageZeroer = recordingZeroer;
+    (void)impl.impl.zeroFreePages(8);
+    gZeroedRangeCount = 0;
+    NUMAPool& pool = *impl.impl.numaPools[0];
+
+    std::vector<PageRef> pages;
+    ASSERT_EQ(4u, impl.impl.allocatePages(4, [&](PageRef r){ pages.push_back(r); }, AllocBehavior::ZEROED));
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage - 4, pool.getZeroedSmallPageCount());
+
+    PageRef big{};
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ big = r; },
+                                                            AllocBehavior::BIG_PAGE_ONLY | AllocBehavior::ZEROED));
+    ASSERT_EQ(PageSize::BIG, big.size());
+    ASSERT_EQ(0u, pool.getZeroedBigPageCount());
+
+    ASSERT_EQ(0u, gZeroedRangeCount);
+    for (auto& page : pages) {
+        ASSERT_TRUE(impl.impl.isPageAllocated(page));
+    }
+    ASSERT_TRUE(impl.impl.isPageAllocated(big));
+}
+
+TEST(PAI_Zeroed_OrdinaryAllocationsPreferDirtyPages) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1, 2, 3}) });
+    impl.impl.pageZeroer = recordingZeroer;
+    (void)impl.impl.zeroFreePages(8);
+    NUMAPool& pool = *impl.impl.numaPools[0];
+    ASSERT_EQ(1u, pool.getZeroedBigPageCount());
+    ASSERT_EQ(3u, pool.getFreeBigPageCount());
+
+    // Both dirty big pages go before the zeroed one is touched.
+    ASSERT_EQ(2 * PageAllocator::smallPagesPerBigPage, impl.impl.allocatePages(2 * PageAllocator::smallPagesPerBigPage, [](PageRef){},
+                                                                AllocBehavior::BIG_PAGE_ONLY));
+    ASSERT_EQ(1u, pool.getZeroedBigPageCount());
+
+    // With no dirty pages left, ordinary allocations fall back to the zeroed page.
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [](PageRef){},
+                                                            AllocBehavior::BIG_PAGE_ONLY));
+    ASSERT_EQ(0u, pool.getFreeBigPageCount());
+}
+
+TEST(PAI_Zeroed_GracefulOOMReturnsShortCount) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 1, {0, 1, 2, 3}) });
+    impl.impl.pageZeroer = recordingZeroer;
+    gZeroedRangeCount = 0;
+
+    std::vector<PageRef> pages;
+    const auto allocated = impl.impl.allocatePages(2 * PageAllocator::smallPagesPerBigPage, [&](PageRef r){ pages.push_back(r); },
+                                                   AllocBehavior::BIG_PAGE_ONLY | AllocBehavior::ZEROED |
+                                                   AllocBehavior::GRACEFUL_OOM);
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, allocated);
+    ASSERT_EQ(1u, pages.size());
+    ASSERT_TRUE(wasZeroed(pages[0]));
+}
+
+TEST(PAI_Zeroed_MagazinePagesAreZeroedToo) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.magazinesEnabled = true;
+    impl.impl.pageZeroer = recordingZeroer;
+
+    // Leave a page that may hold stale data on top of the magazine.
+    PageRef stale{};
+    impl.impl.allocatePages(1, [&](PageRef r){ stale = r; });
+    impl.impl.freePages(&stale, 1);
+    gZeroedRangeCount = 0;
+
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }, AllocBehavior::ZEROED));
+    ASSERT_EQ(stale.value, page.value);
+    ASSERT_TRUE(wasZeroed(page));
+}
+
+// ============================================================================
+// PageAllocatorImpl — Remote-free inbox
+// ============================================================================
+
+// Runs fn on a fresh thread, which the arch mock maps to the next unused CPU ID.
+template <typename Fn>
+static void runOnAnotherCPU(Fn fn) {
+    arch::ProcessorID cpu = 0;
+    pauseTracking();
+    std::thread worker([&] {
+        cpu = arch::getCurrentProcessorID();
+        fn();
+    });
+    worker.join();
+    resumeTracking();
+    ASSERT_TRUE(cpu != 0);
+}
+
+TEST(PAI_RemoteFree_HeldPagesGoToHolderInbox) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.remoteFreesEnabled = true;
+    ASSERT_EQ(0u, arch::getCurrentProcessorID());
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    // A small request leaves the rest of its big page cached in CPU 0's LocalPool.
+    PageRef pages[8];
+    size_t count = 0;
+    impl.impl.allocatePages(8, [&](PageRef r){ pages[count++] = r; });
+    BigPageMetadata* meta = impl.impl.findMetadata(pages[0].addr());
+    ASSERT_TRUE(meta->isAllocHolder(0));
+
+    {
+        // The free lands while CPU 0 is in the middle of an allocation.
+        PageAllocatorImpl::AllocationScope scope(impl.impl);
+        runOnAnotherCPU([&] { impl.impl.freePages(pages, count); });
+
+        // Nothing has been freed yet; the pages wait for CPU 0.
+        ASSERT_TRUE(impl.localPools[0]->hasRemoteFrees());
+        ASSERT_EQ(freeBefore - 8, impl.impl.countFreePages());
+    }
+
+    // Leaving the allocation returns them.
+    ASSERT_FALSE(impl.localPools[0]->hasRemoteFrees());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_RemoteFree_IdleHolderIsFreedDirectly) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.remoteFreesEnabled = true;
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    // CPU 0 still holds the big page but is not allocating, so it may never drain an inbox.
+    PageRef pages[8];
+    size_t count = 0;
+    impl.impl.allocatePages(8, [&](PageRef r){ pages[count++] = r; });
+    ASSERT_TRUE(impl.impl.findMetadata(pages[0].addr())->isAllocHolder(0));
+
+    runOnAnotherCPU([&] { impl.impl.freePages(pages, count); });
+    ASSERT_FALSE(impl.localPools[0]->hasRemoteFrees());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+}
+
+TEST(PAI_RemoteFree_UnheldAndOwnPagesAreFreedDirectly) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.remoteFreesEnabled = true;
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    // The holder freeing its own pages never queues them.
+    PageRef own[4];
+    size_t ownCount = 0;
+    impl.impl.allocatePages(4, [&](PageRef r){ own[ownCount++] = r; });
+    impl.impl.freePages(own, ownCount);
+    ASSERT_FALSE(impl.localPools[0]->hasRemoteFrees());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+
+    // Whole big pages have no holder, so another CPU frees them directly.
+    PageRef big{};
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ big = r; }, AllocBehavior::BIG_PAGE_ONLY);
+    runOnAnotherCPU([&] { impl.impl.freePages(&big, 1); });
+    ASSERT_FALSE(impl.localPools[0]->hasRemoteFrees());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+}
+
+TEST(PAI_RemoteFree_FullInboxFallsBackToDirectFree) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.remoteFreesEnabled = true;
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    // One run larger than the whole inbox cannot be posted.
+    constexpr size_t count = LocalPool::remoteFreeCapacity + 8;
+    std::vector<PageRef> pages;
+    impl.impl.allocatePages(count, [&](PageRef r){ pages.push_back(r); });
+    ASSERT_TRUE(impl.impl.findMetadata(pages[0].addr())->isAllocHolder(0));
+
+    PageAllocatorImpl::AllocationScope scope(impl.impl);
+    runOnAnotherCPU([&] { impl.impl.freePages(pages.data(), pages.size()); });
+    ASSERT_FALSE(impl.localPools[0]->hasRemoteFrees());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+}
+
+TEST(PAI_RemoteFree_DrainFromQuiescentCPU) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.remoteFreesEnabled = true;
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    PageRef pages[16];
+    size_t count = 0;
+    impl.impl.allocatePages(16, [&](PageRef r){ pages[count++] = r; });
+    PageAllocatorImpl::AllocationScope scope(impl.impl);
+    runOnAnotherCPU([&] { impl.impl.freePages(pages, count); });
+    ASSERT_TRUE(impl.localPools[0]->hasRemoteFrees());
+
+    impl.impl.drainRemoteFrees(0);
+    ASSERT_FALSE(impl.localPools[0]->hasRemoteFrees());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+}
+
+// ============================================================================
+// PageAllocatorImpl — Statistics
+// ============================================================================
+
+TEST(PAI_Stats_FreeCountsPerDomain) {
+    TestPageAllocatorImpl impl({
+        DomainSpec::simple(0, 2, {0}),
+        DomainSpec::simple(1, 3, {1}),
+    });
+
+    auto stats = impl.impl.getStatistics();
+    ASSERT_EQ(2u, stats.freeBigPageCount.size());
+    ASSERT_EQ(2u, stats.freeBigPageCount[0]);
+    ASSERT_EQ(3u, stats.freeBigPageCount[1]);
+    ASSERT_EQ(2 * PageAllocator::smallPagesPerBigPage, stats.freeSmallPageCount[0]);
+    ASSERT_EQ(3 * PageAllocator::smallPagesPerBigPage, stats.freeSmallPageCount[1]);
+    ASSERT_EQ(0u, stats.globalPoolSize);
+    ASSERT_EQ(2u, stats.perCpu.size());
+
+    // A small allocation takes one big page out of the free lists but only one small page
+    // out of the free total.
+    impl.impl.allocatePages(1, [](PageRef){});
+    stats = impl.impl.getStatistics();
+    ASSERT_EQ(1u, stats.freeBigPageCount[0]);
+    ASSERT_EQ(2 * PageAllocator::smallPagesPerBigPage - 1, stats.freeSmallPageCount[0]);
+    ASSERT_EQ(3u, stats.freeBigPageCount[1]);
+}
+
+TEST(PAI_Stats_FastPathAndFallbackCounters) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+
+    // The first request finds the LocalPool empty; the second is served from the
+    // partial page the first one left behind.
+    impl.impl.allocatePages(8, [](PageRef){});
+    impl.impl.allocatePages(8, [](PageRef){});
+    auto stats = impl.impl.getStatistics();
+    ASSERT_EQ(1u, stats.perCpu[0].fallbacks);
+    ASSERT_EQ(1u, stats.perCpu[0].fastPathHits);
+    ASSERT_EQ(0u, stats.perCpu[1].fallbacks + stats.perCpu[1].fastPathHits);
+    ASSERT_EQ(stats.perCpu[0].fallbacks, stats.total.fallbacks);
+
+    // Magazine: a refill is not a hit, the pop that follows it is.
+    impl.impl.magazinesEnabled = true;
+    impl.impl.allocatePages(1, [](PageRef){});
+    impl.impl.allocatePages(1, [](PageRef){});
+    stats = impl.impl.getStatistics();
+    ASSERT_EQ(1u, stats.total.magazineRefills);
+    ASSERT_EQ(2u, stats.total.fastPathHits);
+}
+
+TEST(PAI_Stats_BigPageCacheCounters) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 32, {0, 1, 2, 3}) });
+    impl.impl.bigPageCachesEnabled = true;
+
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [](PageRef){}, AllocBehavior::BIG_PAGE_ONLY);
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [](PageRef){}, AllocBehavior::BIG_PAGE_ONLY);
+    const auto stats = impl.impl.getStatistics();
+    ASSERT_EQ(1u, stats.total.bigPageCacheRefills);
+    ASSERT_EQ(1u, stats.total.fastPathHits);
+    ASSERT_EQ(0u, stats.total.fallbacks);
+    // Cached pages have left the pool's free lists but are still free pages.
+    ASSERT_EQ(32 - LocalPool::bigPageCacheBatch, stats.freeBigPageCount[0]);
+    ASSERT_EQ(30 * PageAllocator::smallPagesPerBigPage, stats.freeSmallPageCount[0]);
+}
+
+TEST(PAI_Stats_RemoteDomainPages) {
+    TestPageAllocatorImpl impl({
+        DomainSpec::simple(0, 2, {0}),
+        DomainSpec::simple(1, 2, {1}),
+    });
+
+    impl.impl.allocatePages(3 * PageAllocator::smallPagesPerBigPage, [](PageRef){});
+    auto stats = impl.impl.getStatistics();
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, stats.perCpu[0].remoteDomainPages);
+
+    // An explicit target counts pages from any other domain as remote.
+    impl.impl.allocatePages(4, [](PageRef){}, kernel::numa::DomainID{1});
+    stats = impl.impl.getStatistics();
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage, stats.total.remoteDomainPages);
+}
+
+TEST(PAI_Stats_RemoteFreesPosted) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.remoteFreesEnabled = true;
+
+    PageRef pages[8];
+    size_t count = 0;
+    impl.impl.allocatePages(8, [&](PageRef r){ pages[count++] = r; });
+    arch::ProcessorID freer = 0;
+    PageAllocatorImpl::AllocationScope scope(impl.impl);
+    runOnAnotherCPU([&] {
+        freer = arch::getCurrentProcessorID();
+        impl.impl.freePages(pages, count);
+    });
+
+    const auto stats = impl.impl.getStatistics();
+    ASSERT_LT(static_cast<size_t>(freer), stats.perCpu.size());
+    ASSERT_EQ(8u, stats.perCpu[freer].remoteFreesPosted);
+    ASSERT_EQ(0u, stats.perCpu[0].remoteFreesPosted);
+    ASSERT_EQ(8u, stats.total.remoteFreesPosted);
+    // Nothing here ever contends or stalls on one CPU.
+    ASSERT_EQ(0u, stats.paPagesContention[0]);
+    ASSERT_EQ(0u, stats.ringStalls[0]);
+}
+
+// ============================================================================
+// PageAllocatorImpl — Bandwidth-weighted interleave
+// ============================================================================
+
+// Number of big pages taken out of each domain's free lists since construction.
+static std::vector<size_t> bigPagesTaken(TestPageAllocatorImpl& impl, size_t bigPagesPerDomain) {
+    std::vector<size_t> taken;
+    for (size_t d = 0; d < impl.impl.numDomains; d++) {
+        taken.push_back(bigPagesPerDomain - impl.impl.numaPools[d]->getFreeBigPageCount());
+    }
+    return taken;
+}
+
+TEST(PAI_Interleave_SplitsByBandwidth) {
+    // CPU domains 0 and 1 plus a memory-only domain 2. From domain 0 the bandwidths
+    // 40000 : 10000 : 10000 MB/s give weights 32 : 8 : 8.
+    TestPageAllocatorImpl impl({
+        DomainSpec::simple(0, 16, {0}),
+        DomainSpec::simple(1, 16, {1}),
+        DomainSpec::simple(2, 16, {}),
+    }, {
+        {0, 0, 40000, kernel::numa::DISTANCE_NO_DATA},
+        {0, 1, 10000, kernel::numa::DISTANCE_NO_DATA},
+        {0, 2, 10000, kernel::numa::DISTANCE_NO_DATA},
+    });
+
+    constexpr size_t request = 12 * PageAllocator::smallPagesPerBigPage;
+    std::vector<PageRef> pages;
+    ASSERT_EQ(request, impl.impl.allocatePages(request, [&](PageRef r){ pages.push_back(r); },
+                                               AllocBehavior::INTERLEAVE));
+    const auto taken = bigPagesTaken(impl, 16);
+    ASSERT_EQ(8u, taken[0]);
+    ASSERT_EQ(2u, taken[1]);
+    ASSERT_EQ(2u, taken[2]);
+    for (const auto& page : pages) ASSERT_EQ(PageSize::BIG, page.size());
+
+    impl.impl.freePages(pages.data(), pages.size());
+    ASSERT_EQ(48 * PageAllocator::smallPagesPerBigPage, impl.impl.countFreePages());
+}
+
+TEST(PAI_Interleave_ShortStripeFallsBackInDomainOrder) {
+    // Domain 2 can only hold one of the two big pages its weight asks for; the other
+    // comes from the nearest domain instead.
+    TestPageAllocatorImpl impl({
+        DomainSpec::simple(0, 16, {0}),
+        DomainSpec::simple(1, 16, {1}),
+        DomainSpec::simple(2, 1, {}),
+    }, {
+        {0, 0, 40000, kernel::numa::DISTANCE_NO_DATA},
+        {0, 1, 10000, kernel::numa::DISTANCE_NO_DATA},
+        {0, 2, 10000, kernel::numa::DISTANCE_NO_DATA},
+    });
+
+    constexpr size_t request = 12 * PageAllocator::smallPagesPerBigPage;
+    ASSERT_EQ(request, impl.impl.allocatePages(request, [](PageRef){}, AllocBehavior::INTERLEAVE));
+    ASSERT_EQ(0u, impl.impl.numaPools[2]->getFreeBigPageCount());
+    ASSERT_EQ(16u - 9u, impl.impl.numaPools[0]->getFreeBigPageCount());
+    ASSERT_EQ(16u - 2u, impl.impl.numaPools[1]->getFreeBigPageCount());
+}
+
+TEST(PAI_Interleave_SmallRequestsRotateAcrossDomains) {
+    // Without bandwidth data every domain weighs the same; single pages alternate.
+    TestPageAllocatorImpl impl({
+        DomainSpec::simple(0, 4, {0}),
+        DomainSpec::simple(1, 4, {1}),
+    });
+
+    size_t perDomain[2] = {};
+    for (size_t i = 0; i < 4; i++) {
+        PageRef page{};
+        impl.impl.allocatePages(1, [&](PageRef r){ page = r; }, AllocBehavior::INTERLEAVE);
+        perDomain[impl.impl.findMetadata(page.addr())->getOwnerPool().domain().value]++;
+    }
+    ASSERT_EQ(2u, perDomain[0]);
+    ASSERT_EQ(2u, perDomain[1]);
+}
+
+TEST(PAI_Interleave_LocalDomainOnlyWins) {
+    TestPageAllocatorImpl impl({
+        DomainSpec::simple(0, 4, {0}),
+        DomainSpec::simple(1, 4, {1}),
+    });
+
+    constexpr size_t request = 2 * PageAllocator::smallPagesPerBigPage;
+    ASSERT_EQ(request, impl.impl.allocatePages(request, [](PageRef){},
+                                               AllocBehavior::INTERLEAVE | AllocBehavior::LOCAL_DOMAIN_ONLY));
+    ASSERT_EQ(4u, impl.impl.numaPools[1]->getFreeBigPageCount());
+}
+
+// ============================================================================
+// Lifetime-segregated partial pages
+// ============================================================================
+
+static uint64_t bigPageBaseOf(PageRef page) {
+    return page.addr().value & ~static_cast<uint64_t>(arch::bigPageSize - 1);
+}
+
+TEST(NUMAPool_Lifetime_ClassesUseSeparatePartialSets) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), 4);
+    std::vector<PageRef> longPages, shortPages;
+    BigPageMetadata* rem = nullptr;
+
+    p.pool->allocatePages(10, [&](PageRef r){ longPages.push_back(r); }, rem, AllocBehavior::LONG_LIVED);
+    ASSERT_TRUE(rem != nullptr);
+    ASSERT_TRUE(rem->lifetime() == PageLifetime::Long);
+    rem->returnPage();
+    ASSERT_EQ(1u, p.pool->getPAPagesCount(PageLifetime::Long));
+    ASSERT_EQ(0u, p.pool->getPAPagesCount(PageLifetime::Short));
+
+    // A short-lived request must not be carved from the long-lived partial page.
+    rem = nullptr;
+    p.pool->allocatePages(10, [&](PageRef r){ shortPages.push_back(r); }, rem);
+    ASSERT_TRUE(rem != nullptr);
+    ASSERT_TRUE(rem->lifetime() == PageLifetime::Short);
+    rem->returnPage();
+    ASSERT_NE(bigPageBaseOf(longPages[0]), bigPageBaseOf(shortPages[0]));
+    ASSERT_EQ(1u, p.pool->getPAPagesCount(PageLifetime::Long));
+    ASSERT_EQ(1u, p.pool->getPAPagesCount(PageLifetime::Short));
+    ASSERT_TRUE(p.pool->checkInvariants());
+
+    // A second long-lived request reuses the long-lived partial page.
+    rem = nullptr;
+    std::vector<PageRef> moreLong;
+    p.pool->allocatePages(10, [&](PageRef r){ moreLong.push_back(r); }, rem, AllocBehavior::LONG_LIVED);
+    ASSERT_EQ(bigPageBaseOf(longPages[0]), bigPageBaseOf(moreLong[0]));
+    ASSERT_EQ(2u, p.pool->getFreeBigPageCount());
+}
+
+TEST(NUMAPool_Lifetime_ShortChurnReturnsWholeBigPages) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), 4);
+    std::vector<PageRef> longPages;
+    BigPageMetadata* rem = nullptr;
+    p.pool->allocatePages(3, [&](PageRef r){ longPages.push_back(r); }, rem, AllocBehavior::LONG_LIVED);
+    rem->returnPage();
+
+    // Interleave short-lived allocations with the long-lived survivor; once they are all
+    // freed their big page is whole again and only the long-lived page stays partial.
+    for (int round = 0; round < 4; round++) {
+        std::vector<PageRef> shortPages;
+        rem = nullptr;
+        p.pool->allocatePages(50, [&](PageRef r){ shortPages.push_back(r); }, rem);
+        if (rem != nullptr) rem->returnPage();
+        p.pool->freePages(shortPages.data(), shortPages.size());
+        ASSERT_EQ(3u, p.pool->getFreeBigPageCount());
+        ASSERT_EQ(0u, p.pool->getPAPagesCount(PageLifetime::Short));
+        ASSERT_EQ(1u, p.pool->getPAPagesCount(PageLifetime::Long));
+    }
+
+    p.pool->freePages(longPages.data(), longPages.size());
+    ASSERT_EQ(4u, p.pool->getFreeBigPageCount());
+    ASSERT_EQ(0u, p.pool->getPAPagesCount());
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
+TEST(NUMAPool_Lifetime_BorrowsOtherClassWhenOutOfBigPages) {
+    auto p = TestNUMAPool::withBigPages(testDomainBase(0), 1);
+    std::vector<PageRef> pages;
+    BigPageMetadata* rem = nullptr;
+    p.pool->allocatePages(10, [&](PageRef r){ pages.push_back(r); }, rem);
+    rem->returnPage();
+
+    // No free big page is left, so the long-lived request shares the short-lived one.
+    rem = nullptr;
+    const size_t got = p.pool->allocatePages(10, [&](PageRef r){ pages.push_back(r); }, rem, AllocBehavior::LONG_LIVED);
+    ASSERT_EQ(10u, got);
+    ASSERT_EQ(bigPageBaseOf(pages[0]), bigPageBaseOf(pages[10]));
+    ASSERT_TRUE(rem != nullptr);
+    ASSERT_TRUE(rem->lifetime() == PageLifetime::Short);
+    rem->returnPage();
+    ASSERT_EQ(1u, p.pool->getPAPagesCount(PageLifetime::Short));
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
+TEST(PAI_Lifetime_LocalPoolKeepsClassesApart) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1, 2, 3}) });
+    std::vector<PageRef> longPages, shortPages;
+    for (int i = 0; i < 8; i++) {
+        impl.impl.allocatePages(1, [&](PageRef r){ shortPages.push_back(r); });
+        impl.impl.allocatePages(1, [&](PageRef r){ longPages.push_back(r); }, AllocBehavior::LONG_LIVED);
+    }
+    for (const auto& page : shortPages) ASSERT_EQ(bigPageBaseOf(shortPages[0]), bigPageBaseOf(page));
+    for (const auto& page : longPages) ASSERT_EQ(bigPageBaseOf(longPages[0]), bigPageBaseOf(page));
+    ASSERT_NE(bigPageBaseOf(shortPages[0]), bigPageBaseOf(longPages[0]));
+    ASSERT_TRUE(impl.impl.findMetadata(longPages[0].addr())->lifetime() == PageLifetime::Long);
+
+    // Only the first request of each class needed the NUMAPool.
+    const auto stats = impl.impl.getStatistics();
+    ASSERT_EQ(2u, stats.perCpu[0].fallbacks);
+    ASSERT_EQ(2u, stats.freeBigPageCount[0]);
+}
+
+TEST(PAI_Lifetime_LongLivedBypassesMagazine) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1, 2, 3}) });
+    impl.impl.magazinesEnabled = true;
+
+    PageRef page{};
+    impl.impl.allocatePages(1, [&](PageRef r){ page = r; }, AllocBehavior::LONG_LIVED);
+    ASSERT_EQ(0u, impl.impl.localPools[0]->magazineSize());
+    impl.impl.freePages(&page, 1);
+    ASSERT_EQ(0u, impl.impl.localPools[0]->magazineSize());
+
+    // Short-lived single pages still go through the magazine.
+    impl.impl.allocatePages(1, [&](PageRef r){ page = r; });
+    ASSERT_EQ(LocalPool::magazineBatch - 1, impl.impl.localPools[0]->magazineSize());
+}
+
+// ============================================================================
+// Deferred metadata initialization
+// ============================================================================
+
+TEST(NUMAPool_Deferred_OnlyEagerChunksBuiltAtCreation) {
+    const size_t total = 2 * bigPagesPerGigantic + 16;
+    Vector<phys_memory_range> r;
+    r.push(makeBigPageRange(testDomainBase(0), total));
+    TestNUMAPool p(move(r), 1);
+
+    // The eager count is rounded up to a whole chunk, which ends at the next gigantic boundary.
+    ASSERT_EQ(bigPagesPerGigantic, p.pool->getInitializedBigPageCount());
+    ASSERT_TRUE(p.pool->hasDeferredBigPages());
+    ASSERT_EQ(1u, p.pool->getFreeGiganticPageCount());
+    ASSERT_EQ(bigPagesPerGigantic, p.pool->getFreeBigPageCount());
+    ASSERT_EQ(bigPagesPerGigantic * PageAllocator::smallPagesPerBigPage, p.pool->countTotalFreePages());
+
+    ASSERT_TRUE(p.pool->initializeDeferredChunk());
+    ASSERT_EQ(2 * bigPagesPerGigantic, p.pool->getInitializedBigPageCount());
+    ASSERT_EQ(2u, p.pool->getFreeGiganticPageCount());
+    ASSERT_TRUE(p.pool->initializeDeferredChunk());
+    ASSERT_EQ(total, p.pool->getInitializedBigPageCount());
+    ASSERT_EQ(total, p.pool->getFreeBigPageCount());
+    ASSERT_FALSE(p.pool->hasDeferredBigPages());
+    ASSERT_FALSE(p.pool->initializeDeferredChunk());
+    ASSERT_EQ(total * PageAllocator::smallPagesPerBigPage, p.pool->countTotalFreePages());
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
+TEST(NUMAPool_Deferred_ChunksReserveGapsLikeEagerInit) {
+    // Two ranges sharing a big page, with unaligned outer ends: the gaps must be reserved the
+    // same way whether the metadata is built up front or later.
+    const auto makeRanges = [] {
+        Vector<phys_memory_range> r;
+        const uint64_t base = testDomainBase(0);
+        r.push({ phys_addr(base + 16 * arch::smallPageSize), phys_addr(base + arch::bigPageSize + 64 * arch::smallPageSize) });
+        r.push({ phys_addr(base + arch::bigPageSize + 128 * arch::smallPageSize), phys_addr(base + 4 * arch::bigPageSize - 8 * arch::smallPageSize) });
+        return r;
+    };
+    TestNUMAPool eager(makeRanges());
+    TestNUMAPool deferred(makeRanges(), 0);
+
+    ASSERT_EQ(0u, deferred.pool->getInitializedBigPageCount());
+    ASSERT_EQ(0u, deferred.pool->getFreeBigPageCount());
+    while (deferred.pool->initializeDeferredChunk()) {}
+
+    ASSERT_EQ(eager.pool->getTotalBigPageCount(), deferred.pool->getInitializedBigPageCount());
+    ASSERT_EQ(eager.pool->countTotalFreePages(), deferred.pool->countTotalFreePages());
+    ASSERT_EQ(4 * PageAllocator::smallPagesPerBigPage - 16 - 64 - 8, deferred.pool->countTotalFreePages());
+    ASSERT_EQ(eager.pool->getFreeBigPageCount(), deferred.pool->getFreeBigPageCount());
+    ASSERT_EQ(3u, deferred.pool->getPAPagesCount());
+    ASSERT_TRUE(deferred.pool->checkInvariants());
+}
+
+TEST(NUMAPool_Deferred_ChunksStopAtSubrangeEnds) {
+    // Three 4-page ranges laid end to end stay separate subranges, one chunk each.
+    Vector<phys_memory_range> r;
+    for (size_t i = 0; i < 3; i++) {
+        r.push(makeBigPageRange(testDomainBase(0) + i * 4 * arch::bigPageSize, 4));
+    }
+    TestNUMAPool p(move(r), 0);
+    ASSERT_EQ(3u, p.pool->getSubrangeCount());
+    for (size_t chunk = 1; chunk <= 3; chunk++) {
+        ASSERT_TRUE(p.pool->initializeDeferredChunk());
+        ASSERT_EQ(4 * chunk, p.pool->getInitializedBigPageCount());
+        ASSERT_EQ(4 * chunk, p.pool->getFreeBigPageCount());
+    }
+    ASSERT_FALSE(p.pool->initializeDeferredChunk());
+}
+
+TEST(NUMAPool_Deferred_ReserveRangeBuildsTouchedChunks) {
+    Vector<phys_memory_range> r;
+    r.push(makeBigPageRange(testDomainBase(0), 2 * bigPagesPerGigantic));
+    TestNUMAPool p(move(r), 0);
+
+    // Reserving two small pages in the second gigantic group builds both chunks.
+    const uint64_t reserveBase = testDomainBase(0) + arch::giganticPageSize + arch::bigPageSize;
+    p.pool->reserveRange({ phys_addr(reserveBase), phys_addr(reserveBase + 2 * arch::smallPageSize) });
+    ASSERT_EQ(2 * bigPagesPerGigantic, p.pool->getInitializedBigPageCount());
+    ASSERT_EQ(1u, p.pool->getFreeGiganticPageCount());
+    ASSERT_EQ(2 * bigPagesPerGigantic - 1, p.pool->getFreeBigPageCount());
+    ASSERT_EQ(1u, p.pool->getPAPagesCount());
+    ASSERT_EQ(2 * bigPagesPerGigantic * PageAllocator::smallPagesPerBigPage - 2, p.pool->countTotalFreePages());
+    ASSERT_TRUE(p.pool->checkInvariants());
+}
+
+TEST(PAI_Deferred_AllocationBuildsChunksOnDemand) {
+    DomainSpec spec = DomainSpec::simple(0, 2 * bigPagesPerGigantic, {0, 1});
+    spec.eagerBigPages = 1;
+    TestPageAllocatorImpl impl({ move(spec) });
+    NUMAPool& pool = *impl.impl.numaPools[0];
+    ASSERT_EQ(bigPagesPerGigantic, pool.getInitializedBigPageCount());
+
+    // More big pages than the eager chunk holds: the rest is built on the allocating CPU.
+    std::vector<PageRef> pages;
+    const size_t wanted = (bigPagesPerGigantic + 4) * PageAllocator::smallPagesPerBigPage;
+    ASSERT_EQ(wanted, impl.impl.allocatePages(wanted, [&](PageRef r){ pages.push_back(r); },
+                                              AllocBehavior::BIG_PAGE_ONLY));
+    ASSERT_EQ(2 * bigPagesPerGigantic, pool.getInitializedBigPageCount());
+    impl.impl.freePages(pages.data(), pages.size());
+    ASSERT_EQ(2 * bigPagesPerGigantic * PageAllocator::smallPagesPerBigPage, impl.impl.countFreePages());
+    ASSERT_TRUE(pool.checkInvariants());
+}
+
+TEST(PAI_Deferred_GiganticAllocationBuildsChunksOnDemand) {
+    DomainSpec spec = DomainSpec::simple(0, 2 * bigPagesPerGigantic, {0});
+    spec.eagerBigPages = 0;
+    TestPageAllocatorImpl impl({ move(spec) });
+
+    std::vector<PageRef> pages;
+    ASSERT_EQ(2 * PageAllocator::smallPagesPerGiganticPage,
+              impl.impl.allocatePages(2 * PageAllocator::smallPagesPerGiganticPage,
+                                      [&](PageRef r){ pages.push_back(r); }, AllocBehavior::GIGANTIC_PAGE_ONLY));
+    ASSERT_EQ(2u, pages.size());
+    ASSERT_FALSE(impl.impl.numaPools[0]->hasDeferredBigPages());
+}
+
+TEST(PAI_Deferred_TargetedAllocationBuildsChunksOnDemand) {
+    DomainSpec spec = DomainSpec::simple(0, bigPagesPerGigantic, {0, 1});
+    spec.eagerBigPages = 0;
+    TestPageAllocatorImpl impl({ move(spec) });
+    ASSERT_EQ(0u, impl.impl.numaPools[0]->getInitializedBigPageCount());
+
+    // Neither the DomainID nor the ProcessorID overload may call an unbuilt pool out of memory.
+    ASSERT_EQ(4u, impl.impl.allocatePages(4, [](PageRef){}, kernel::numa::DomainID{0}));
+    ASSERT_EQ(bigPagesPerGigantic, impl.impl.numaPools[0]->getInitializedBigPageCount());
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [](PageRef){}, static_cast<arch::ProcessorID>(1)));
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_Deferred_InterleavedAllocationBuildsChunksOnDemand) {
+    DomainSpec first = DomainSpec::simple(0, 16, {0});
+    DomainSpec second = DomainSpec::simple(1, 16, {1});
+    first.eagerBigPages = 0;
+    second.eagerBigPages = 0;
+    TestPageAllocatorImpl impl({ move(first), move(second) }, {
+        {0, 0, 10000, kernel::numa::DISTANCE_NO_DATA},
+        {0, 1, 10000, kernel::numa::DISTANCE_NO_DATA},
+    });
+
+    constexpr size_t request = 4 * PageAllocator::smallPagesPerBigPage;
+    ASSERT_EQ(request, impl.impl.allocatePages(request, [](PageRef){}, AllocBehavior::INTERLEAVE));
+    ASSERT_EQ(16u, impl.impl.numaPools[0]->getInitializedBigPageCount());
+}
+
+TEST(PAI_Deferred_InitializeDeferredPagesBuildsEveryPool) {
+    DomainSpec near = DomainSpec::simple(0, bigPagesPerGigantic + 8, {0});
+    DomainSpec memoryOnly = DomainSpec::simple(2, 16, {});
+    near.eagerBigPages = 0;
+    memoryOnly.eagerBigPages = 0;
+    TestPageAllocatorImpl impl({ move(near), move(memoryOnly) });
+
+    impl.impl.initializeDeferredPages(0);
+    ASSERT_EQ(bigPagesPerGigantic + 8, impl.impl.numaPools[0]->getInitializedBigPageCount());
+    ASSERT_EQ(16u, impl.impl.numaPools[1]->getInitializedBigPageCount());
+    ASSERT_EQ((bigPagesPerGigantic + 24) * PageAllocator::smallPagesPerBigPage, impl.impl.countFreePages());
+    ASSERT_TRUE(impl.impl.initializeDeferredChunk(impl.impl.nearestPool(0)) == nullptr);
+}
+
+// ============================================================================
+// PageAllocatorImpl — Run-length allocation
+// ============================================================================
+
+static size_t pagesInRuns(const PageRef* runs, size_t count) {
+    size_t pages = 0;
+    for (size_t i = 0; i < count; i++) {
+        pages += runs[i].runLength() * (runs[i].size() == PageSize::BIG ? PageAllocator::smallPagesPerBigPage : 1);
+    }
+    return pages;
+}
+
+TEST(PAI_Runs_SmallRequestIsOneRun) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1, 2, 3}) });
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    PageRef runs[8];
+    size_t runCount = 0;
+    ASSERT_EQ(100u, impl.impl.allocatePageRuns(100, runs, 8, runCount));
+    ASSERT_EQ(1u, runCount);
+    ASSERT_EQ(PageSize::SMALL, runs[0].size());
+    ASSERT_EQ(100u, runs[0].runLength());
+    ASSERT_EQ(freeBefore - 100, impl.impl.countFreePages());
+
+    impl.impl.freePageRuns(runs, runCount);
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_Runs_GiganticRegionTakesFewRuns) {
+    // A whole 1GiB region: 512 big pages, merged into a handful of runs rather than 262144 refs.
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, bigPagesPerGigantic, {0}) });
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    PageRef runs[16];
+    size_t runCount = 0;
+    ASSERT_EQ(PageAllocator::smallPagesPerGiganticPage,
+              impl.impl.allocatePageRuns(PageAllocator::smallPagesPerGiganticPage, runs, 16, runCount));
+    ASSERT_TRUE(runCount <= 4);
+    ASSERT_EQ(PageAllocator::smallPagesPerGiganticPage, pagesInRuns(runs, runCount));
+    for (size_t i = 0; i < runCount; i++) {
+        ASSERT_EQ(PageSize::BIG, runs[i].size());
+    }
+    ASSERT_EQ(0u, impl.impl.countFreePages());
+
+    impl.impl.freePageRuns(runs, runCount);
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_Runs_MixedRequestEndsInSmallRun) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 8, {0, 1}) });
+    const size_t wanted = 3 * PageAllocator::smallPagesPerBigPage + 7;
+
+    PageRef runs[8];
+    size_t runCount = 0;
+    ASSERT_EQ(wanted, impl.impl.allocatePageRuns(wanted, runs, 8, runCount));
+    ASSERT_EQ(wanted, pagesInRuns(runs, runCount));
+    ASSERT_EQ(PageSize::SMALL, runs[runCount - 1].size());
+    ASSERT_EQ(7u, runs[runCount - 1].runLength());
+
+    impl.impl.freePageRuns(runs, runCount);
+    ASSERT_EQ(8 * PageAllocator::smallPagesPerBigPage, impl.impl.countFreePages());
+}
+
+TEST(PAI_Runs_FullRunArrayReturnsShortCount) {
+    // Every other page of the only big page is free, so each run holds a single page.
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 1, {0}) });
+    std::vector<PageRef> pages;
+    // Two half-page requests, since a whole big page's worth would come back as one big page.
+    for (int half = 0; half < 2; half++) {
+        impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage / 2, [&](PageRef r){ pages.push_back(r); });
+    }
+    std::vector<PageRef> evens;
+    for (const auto& page : pages) {
+        if ((page.addr().value / arch::smallPageSize) % 2 == 0) evens.push_back(page);
+    }
+    impl.impl.freePages(evens.data(), evens.size());
+
+    PageRef runs[10];
+    size_t runCount = 0;
+    // Not a panic even without GRACEFUL_OOM: memory is there, the caller just ran out of room.
+    ASSERT_EQ(10u, impl.impl.allocatePageRuns(100, runs, 10, runCount));
+    ASSERT_EQ(10u, runCount);
+    for (const auto& run : runs) {
+        ASSERT_EQ(1u, run.runLength());
+        ASSERT_TRUE(impl.impl.isPageAllocated(run));
+    }
+
+    impl.impl.freePageRuns(runs, runCount);
+    ASSERT_EQ(evens.size(), impl.impl.countFreePages());
+}
+
+TEST(PAI_Runs_GracefulOOMReturnsWhatFits) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0}) });
+    PageRef runs[8];
+    size_t runCount = 0;
+    ASSERT_EQ(2 * PageAllocator::smallPagesPerBigPage,
+              impl.impl.allocatePageRuns(5 * PageAllocator::smallPagesPerBigPage, runs, 8, runCount,
+                                         AllocBehavior::GRACEFUL_OOM));
+    ASSERT_EQ(0u, impl.impl.countFreePages());
+    impl.impl.freePageRuns(runs, runCount);
+    ASSERT_EQ(2 * PageAllocator::smallPagesPerBigPage, impl.impl.countFreePages());
+}
+
+TEST(PAI_Runs_FreePagesTakesWholeRuns) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 8, {0, 1}) });
+    const size_t freeBefore = impl.impl.countFreePages();
+    const size_t wanted = 3 * PageAllocator::smallPagesPerBigPage + 7;
+
+    PageRef runs[8];
+    size_t runCount = 0;
+    ASSERT_EQ(wanted, impl.impl.allocatePageRuns(wanted, runs, 8, runCount));
+    ASSERT_EQ(2u, runCount);
+    ASSERT_EQ(PageSize::BIG, runs[0].size());
+    ASSERT_EQ(3u, runs[0].runLength());
+
+    // A big run mixed with a small one: every big page of the run goes back, not just the first.
+    impl.impl.freePages(runs, runCount);
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+    ASSERT_TRUE(impl.impl.numaPools[0]->checkInvariants());
+}
+
+TEST(PAI_Runs_SingleBigRunBypassesBigPageCache) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 8, {0, 1}) });
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    PageRef runs[4];
+    size_t runCount = 0;
+    ASSERT_EQ(4 * PageAllocator::smallPagesPerBigPage,
+              impl.impl.allocatePageRuns(4 * PageAllocator::smallPagesPerBigPage, runs, 4, runCount));
+    ASSERT_EQ(1u, runCount);
+    ASSERT_EQ(4u, runs[0].runLength());
+
+    // The cache holds single big pages; taking the run would strand the other three.
+    impl.impl.bigPageCachesEnabled = true;
+    impl.impl.freePages(runs, 1);
+    ASSERT_EQ(0u, impl.localPools[arch::getCurrentProcessorID()]->bigPageCacheSize());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+}
+
+TEST(PAI_Runs_MagazineHandsOutSinglePages) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    impl.impl.magazinesEnabled = true;
+
+    PageRef run{};
+    size_t runCount = 0;
+    ASSERT_EQ(1u, impl.impl.allocatePageRuns(1, &run, 1, runCount));
+    ASSERT_EQ(1u, run.runLength());
+    // The refill went into the magazine page by page, not as runs.
+    ASSERT_EQ(LocalPool::magazineBatch - 1, impl.localPools[0]->magazineSize());
+    impl.impl.flushMagazine(0);
+    impl.impl.freePageRuns(&run, runCount);
+    ASSERT_EQ(2 * PageAllocator::smallPagesPerBigPage, impl.impl.countFreePages());
+}
+
+TEST(PAI_Runs_ZeroedRunsAreZeroedWhole) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0}) });
+    impl.impl.pageZeroer = recordingZeroer;
+    gZeroedRangeCount = 0;
+
+    PageRef runs[64];
+    size_t runCount = 0;
+    ASSERT_EQ(40u, impl.impl.allocatePageRuns(40, runs, 64, runCount, AllocBehavior::ZEROED));
+    ASSERT_EQ(1u, runCount);
+    ASSERT_EQ(1u, gZeroedRangeCount);
+    ASSERT_EQ(runs[0].addr().value, gZeroedRanges[0].base);
+    ASSERT_EQ(40 * arch::smallPageSize, gZeroedRanges[0].bytes);
+}
+
+// ============================================================================
+// PageAllocatorImpl — Emergency reserve and low watermarks
+// ============================================================================
+
+TEST(PAI_Reserve_AtomicRequestsDrawOnlyFromReserve) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    const size_t freeBefore = impl.impl.countFreePages();
+
+    // An empty reserve means a short count, never a panic or a trip to the pools.
+    ASSERT_EQ(0u, impl.impl.allocatePages(1, [](PageRef){}, AllocBehavior::ATOMIC_RESERVE));
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+
+    ASSERT_EQ(LocalPool::reserveCapacity, impl.impl.refillReserve(0));
+    ASSERT_EQ(freeBefore - LocalPool::reserveCapacity, impl.impl.countFreePages());
+
+    std::vector<PageRef> pages;
+    ASSERT_EQ(5u, impl.impl.allocatePages(5, [&](PageRef r){ pages.push_back(r); }, AllocBehavior::ATOMIC_RESERVE));
+    ASSERT_EQ(LocalPool::reserveCapacity - 5, impl.localPools[0]->reserveSize());
+    ASSERT_EQ(freeBefore - LocalPool::reserveCapacity, impl.impl.countFreePages());
+    for (const auto& page : pages) {
+        ASSERT_EQ(PageSize::SMALL, page.size());
+        ASSERT_TRUE(impl.impl.isPageAllocated(page));
+    }
+
+    const auto stats = impl.impl.getStatistics();
+    ASSERT_EQ(5u, stats.perCpu[0].reservePages);
+    ASSERT_EQ(1u, stats.perCpu[0].reserveShortfalls);
+
+    impl.impl.freePages(pages.data(), pages.size());
+    impl.impl.flushReserve(0);
+    ASSERT_EQ(0u, impl.localPools[0]->reserveSize());
+    ASSERT_EQ(freeBefore, impl.impl.countFreePages());
+}
+
+TEST(PAI_Reserve_RefillWaitsForLowWatermark) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    ASSERT_EQ(LocalPool::reserveCapacity, impl.impl.refillReserve(0));
+
+    const size_t aboveLow = LocalPool::reserveCapacity - LocalPool::reserveLowWatermark;
+    ASSERT_EQ(aboveLow, impl.impl.allocatePages(aboveLow, [](PageRef){}, AllocBehavior::ATOMIC_RESERVE));
+    ASSERT_EQ(0u, impl.impl.refillReserve(0));
+
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [](PageRef){}, AllocBehavior::ATOMIC_RESERVE));
+    ASSERT_EQ(aboveLow + 1, impl.impl.refillReserve(0));
+    ASSERT_EQ(LocalPool::reserveCapacity, impl.localPools[0]->reserveSize());
+}
+
+TEST(PAI_Reserve_ComesFromLongLivedPages) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0, 1, 2, 3}) });
+    ASSERT_EQ(LocalPool::reserveCapacity, impl.impl.refillReserve(0));
+
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }, AllocBehavior::ATOMIC_RESERVE));
+    ASSERT_TRUE(impl.impl.findMetadata(page.addr())->lifetime() == PageLifetime::Long);
+}
+
+TEST(PAI_Reserve_SlowPathTopsUpWhenEnabled) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1, 2, 3}) });
+    impl.impl.allocatePages(8, [](PageRef){});
+    ASSERT_EQ(0u, impl.localPools[0]->reserveSize());
+
+    impl.impl.reservesEnabled = true;
+    // A whole big page's worth cannot be served by the local pool alone.
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [](PageRef){});
+    ASSERT_EQ(LocalPool::reserveCapacity, impl.localPools[0]->reserveSize());
+}
+
+static size_t gLowWatermarkCalls = 0;
+static size_t gLowWatermarkFreeBigPages = 0;
+
+static void recordLowWatermark(kernel::numa::DomainID, size_t freeBigPages) {
+    gLowWatermarkCalls++;
+    gLowWatermarkFreeBigPages = freeBigPages;
+}
+
+TEST(PAI_Watermark_CallbacksFireOncePerCrossing) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 32, {0}) });
+    NUMAPool& pool = *impl.impl.numaPools[0];
+    pool.setWatermarks(8, 16);
+    ASSERT_TRUE(impl.impl.addLowWatermarkCallback(recordLowWatermark));
+    gLowWatermarkCalls = 0;
+
+    std::vector<PageRef> pages;
+    const auto takeBigPages = [&](size_t count) {
+        impl.impl.allocatePages(count * PageAllocator::smallPagesPerBigPage, [&](PageRef r){ pages.push_back(r); },
+                                AllocBehavior::BIG_PAGE_ONLY);
+    };
+    takeBigPages(20);
+    impl.impl.runLowWatermarkCallbacks();
+    ASSERT_EQ(0u, gLowWatermarkCalls);
+
+    takeBigPages(6);
+    impl.impl.runLowWatermarkCallbacks();
+    ASSERT_EQ(1u, gLowWatermarkCalls);
+    ASSERT_EQ(6u, gLowWatermarkFreeBigPages);
+
+    // Staying below the watermark does not fire again.
+    takeBigPages(2);
+    impl.impl.runLowWatermarkCallbacks();
+    ASSERT_EQ(1u, gLowWatermarkCalls);
+
+    // Recovering past the high watermark re-arms the callbacks for the next crossing.
+    impl.impl.freePages(pages.data(), pages.size());
+    pages.clear();
+    takeBigPages(1);
+    takeBigPages(25);
+    impl.impl.runLowWatermarkCallbacks();
+    ASSERT_EQ(2u, gLowWatermarkCalls);
+    impl.impl.freePages(pages.data(), pages.size());
+}
+
+TEST(PAI_Watermark_SlowPathRunsPendingCallbacks) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 16, {0}) });
+    impl.impl.numaPools[0]->setWatermarks(4, 8);
+    ASSERT_TRUE(impl.impl.addLowWatermarkCallback(recordLowWatermark));
+    gLowWatermarkCalls = 0;
+
+    impl.impl.allocatePages(14 * PageAllocator::smallPagesPerBigPage, [](PageRef){}, AllocBehavior::BIG_PAGE_ONLY);
+    ASSERT_EQ(0u, gLowWatermarkCalls);
+    // The next request that reaches the pools runs them before allocating.
+    impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [](PageRef){}, AllocBehavior::BIG_PAGE_ONLY);
+    ASSERT_EQ(1u, gLowWatermarkCalls);
+}
+
+TEST(PAI_Watermark_CallbackSlotsAreBounded) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 2, {0}) });
+    for (size_t i = 0; i < 8; i++) {
+        ASSERT_TRUE(impl.impl.addLowWatermarkCallback(recordLowWatermark));
+    }
+    ASSERT_FALSE(impl.impl.addLowWatermarkCallback(recordLowWatermark));
+}
+
+// ============================================================================
+// PageAllocatorImpl — Cache coloring
+// ============================================================================
+
+namespace {
+    size_t pageColorOf(PageRef page, size_t colors) {
+        return (page.addr().value / arch::smallPageSize) % colors;
+    }
+}
+
+TEST(PAI_Color_ColoredPagesSpreadDespiteOtherTraffic) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1, 2, 3}) });
+    impl.impl.setPageColors(16);
+    ASSERT_EQ(0u, impl.localPools[0]->pageColoring().next);
+    ASSERT_EQ(4u, impl.localPools[1]->pageColoring().next);
+
+    // Uncolored pages taken between the colored ones would leave the colored pages four
+    // colors apart, four to a color; the cursor keeps them in distinct colors instead.
+    std::vector<PageRef> colored;
+    std::vector<PageRef> other;
+    for (size_t i = 0; i < 16; i++) {
+        ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ colored.push_back(r); }, AllocBehavior::COLORED));
+        ASSERT_EQ(3u, impl.impl.allocatePages(3, [&](PageRef r){ other.push_back(r); }));
+    }
+    bool seen[16] = {};
+    for (const auto& page : colored) {
+        ASSERT_FALSE(seen[pageColorOf(page, 16)]);
+        seen[pageColorOf(page, 16)] = true;
+        ASSERT_TRUE(impl.impl.isPageAllocated(page));
+    }
+
+    impl.impl.freePages(colored.data(), colored.size());
+    impl.impl.freePages(other.data(), other.size());
+}
+
+TEST(PAI_Color_SubsystemCursorIsIndependent) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0}) });
+    impl.impl.setPageColors(16);
+    PageAllocator::PageColorCursor cursor;
+    cursor.next.store(10, RELAXED);
+
+    std::vector<PageRef> subsystem;
+    std::vector<PageRef> cpu;
+    for (size_t i = 0; i < 4; i++) {
+        ASSERT_EQ(2u, impl.impl.allocateColoredPages(2, [&](PageRef r){ subsystem.push_back(r); }, cursor));
+        ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ cpu.push_back(r); }, AllocBehavior::COLORED));
+    }
+    for (size_t i = 0; i < subsystem.size(); i++) {
+        ASSERT_EQ((10 + i) % 16, pageColorOf(subsystem[i], 16));
+    }
+    for (size_t i = 0; i < cpu.size(); i++) {
+        ASSERT_EQ(i, pageColorOf(cpu[i], 16));
+    }
+    ASSERT_EQ(2u, cursor.next.load(RELAXED));
+    ASSERT_EQ(4u, impl.localPools[0]->pageColoring().next);
+
+    impl.impl.freePages(subsystem.data(), subsystem.size());
+    impl.impl.freePages(cpu.data(), cpu.size());
+}
+
+TEST(PAI_Color_ColoredRequestsSkipTheMagazine) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0}) });
+    impl.impl.magazinesEnabled = true;
+    impl.impl.setPageColors(16);
+    std::vector<PageRef> pages;
+    for (size_t i = 0; i < 3; i++) {
+        ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ pages.push_back(r); }, AllocBehavior::COLORED));
+    }
+    ASSERT_EQ(0u, impl.localPools[0]->magazineSize());
+    for (size_t i = 0; i < pages.size(); i++) {
+        ASSERT_EQ(i, pageColorOf(pages[i], 16));
+    }
+    impl.impl.freePages(pages.data(), pages.size());
+}
+
+// ============================================================================
+// PageAllocatorImpl — Per-frame descriptors
+// ============================================================================
+
+TEST(PAI_Frame_SmallPagesHaveDistinctZeroedFrames) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0}) });
+    std::vector<PageRef> pages;
+    ASSERT_EQ(8u, impl.impl.allocatePages(8, [&](PageRef r){ pages.push_back(r); }));
+
+    std::vector<PageFrame*> frames;
+    for (const auto& page : pages) {
+        PageFrame* frame = impl.impl.frameFor(page.addr());
+        ASSERT_NE(nullptr, frame);
+        ASSERT_EQ(frame, impl.impl.frameFor(page.addr() + 123));
+        ASSERT_EQ(0u, frame->refCount.load());
+        ASSERT_EQ(0u, frame->mapCount.load());
+        ASSERT_EQ(0u, frame->flags.load());
+        for (const PageFrame* other : frames) ASSERT_NE(other, frame);
+        frames.push_back(frame);
+    }
+    impl.impl.freePages(pages.data(), pages.size());
+}
+
+TEST(PAI_Frame_FramesFollowPhysicalOrder) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0}), DomainSpec::simple(1, 4, {1}) });
+    PageRef big{};
+    ASSERT_EQ(PageAllocator::smallPagesPerBigPage,
+              impl.impl.allocatePages(PageAllocator::smallPagesPerBigPage, [&](PageRef r){ big = r; }, AllocBehavior::BIG_PAGE_ONLY));
+    ASSERT_EQ(PageSize::BIG, big.size());
+
+    // A big page is described by its first frame, and frames within it are laid out by address.
+    PageFrame* first = impl.impl.frameFor(big.addr());
+    ASSERT_NE(nullptr, first);
+    ASSERT_EQ(first + 1, impl.impl.frameFor(big.addr() + arch::smallPageSize));
+    ASSERT_EQ(first + PageAllocator::smallPagesPerBigPage - 1,
+              impl.impl.frameFor(big.addr() + arch::bigPageSize - arch::smallPageSize));
+
+    // The second domain's frames live beside its own metadata.
+    PageRef remote{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ remote = r; }, kernel::numa::DomainID{1}));
+    ASSERT_GE(remote.addr().value, testDomainBase(1));
+    PageFrame* remoteFrame = impl.impl.frameFor(remote.addr());
+    ASSERT_NE(nullptr, remoteFrame);
+    ASSERT_NE(first, remoteFrame);
+
+    impl.impl.freePages(&big, 1);
+    impl.impl.freePages(&remote, 1);
+}
+
+TEST(PAI_Frame_OutsidePoolsIsNull) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0}) });
+    ASSERT_EQ(nullptr, impl.impl.frameFor(phys_addr(0x1000)));
+    ASSERT_EQ(nullptr, impl.impl.frameFor(phys_addr(testDomainBase(0) - arch::smallPageSize)));
+    ASSERT_EQ(nullptr, impl.impl.frameFor(phys_addr(testDomainBase(0) + 4 * arch::bigPageSize)));
+}
+
+TEST(PAI_Frame_SharedPageRefcountAndFlags) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0}) });
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }));
+    PageFrame& frame = *impl.impl.frameFor(page.addr());
+
+    // Two address spaces share the page copy-on-write.
+    frame.addRef();
+    frame.addRef();
+    frame.addMapping();
+    frame.addMapping();
+    frame.setFlag(PageFrameFlag::SHARED);
+    frame.setFlag(PageFrameFlag::COPY_ON_WRITE);
+    ASSERT_TRUE(frame.hasFlag(PageFrameFlag::COPY_ON_WRITE));
+    ASSERT_FALSE(frame.hasFlag(PageFrameFlag::PINNED));
+
+    // The first writer copies and drops its share; the survivor owns the page exclusively.
+    ASSERT_FALSE(frame.removeMapping());
+    ASSERT_FALSE(frame.dropRef());
+    frame.clearFlag(PageFrameFlag::COPY_ON_WRITE);
+    ASSERT_TRUE(frame.hasFlag(PageFrameFlag::SHARED));
+    ASSERT_FALSE(frame.hasFlag(PageFrameFlag::COPY_ON_WRITE));
+
+    // Last reference: clear the frame and free the page.
+    ASSERT_TRUE(frame.removeMapping());
+    ASSERT_TRUE(frame.dropRef());
+    frame.clearFlag(PageFrameFlag::SHARED);
+    ASSERT_EQ(0u, frame.flags.load());
+    impl.impl.freePages(&page, 1);
+}
+
+TEST(PAI_Frame_FreeWithUnclearedFrameAsserts) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0}) });
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }));
+    PageFrame& frame = *impl.impl.frameFor(page.addr());
+    frame.setFlag(PageFrameFlag::PINNED);
+
+    bool caught = false;
+    try {
+        impl.impl.freePages(&page, 1);
+    } catch (const AssertionFailure& e) {
+        caught = true;
+        ASSERT_TRUE(std::string(e.what()).find("PageFrame was not cleared") != std::string::npos);
+    }
+    ASSERT_TRUE(caught);
+
+    // The assert fired before anything was freed, so clearing the frame lets the free through.
+    const BigPageMetadata* meta = impl.impl.findMetadata(page.addr());
+    ASSERT_TRUE(meta->isSubpageAllocated(page));
+    frame.clearFlag(PageFrameFlag::PINNED);
+    impl.impl.freePages(&page, 1);
+    ASSERT_FALSE(meta->isSubpageAllocated(page));
+}
+
+TEST(NUMAPool_Frame_DeferredChunksZeroTheirFrames) {
+    const size_t total = bigPagesPerGigantic + 4;
+    Vector<phys_memory_range> r;
+    r.push(makeBigPageRange(testDomainBase(0), total));
+    TestNUMAPool p(move(r), 1);
+    ASSERT_TRUE(p.pool->hasDeferredBigPages());
+
+    // Scribble over the unbuilt chunk's frames the way stale boot memory might look.
+    BigPageMetadata* last = p.pool->findMetadata(phys_addr(testDomainBase(0) + (total - 1) * arch::bigPageSize));
+    ASSERT_NE(nullptr, last);
+    PageFrame* frame = p.pool->frameFor(last, last->baseAddr());
+    memset(static_cast<void*>(frame), 0xa5, sizeof(PageFrame) * PageAllocator::smallPagesPerBigPage);
+
+    ASSERT_TRUE(p.pool->initializeDeferredChunk());
+    ASSERT_FALSE(p.pool->hasDeferredBigPages());
+    for (size_t i = 0; i < PageAllocator::smallPagesPerBigPage; i++) {
+        ASSERT_EQ(0u, frame[i].refCount.load());
+        ASSERT_EQ(0u, frame[i].flags.load());
+    }
+}
+
+// ============================================================================
+// PageAllocatorImpl — Deferred freeing across TLB flushes
+// ============================================================================
+
+namespace {
+    // Stands in for an IPI round: every CPU of the target flushes at the current generation.
+    PageAllocatorImpl* shootdownTarget = nullptr;
+    size_t shootdownCount = 0;
+
+    void flushEveryCpu(PageAllocatorImpl& impl) {
+        const uint64_t generation = PageAllocatorImpl::tlbFlushGeneration();
+        for (size_t cpu = 0; cpu < impl.processorCount; cpu++) {
+            impl.noteTlbFlush(static_cast<arch::ProcessorID>(cpu), generation);
+        }
+    }
+
+    void testShootdown() {
+        shootdownCount++;
+        flushEveryCpu(*shootdownTarget);
+    }
+}
+
+TEST(PAI_TlbDefer_PagesWaitForEveryCpuToFlush) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1}) });
+    impl.impl.deferredFreesEnabled = true;
+    const size_t totalPages = impl.impl.countFreePages();
+    const auto pid = arch::getCurrentProcessorID();
+
+    std::vector<PageRef> pages;
+    ASSERT_EQ(4u, impl.impl.allocatePages(4, [&](PageRef r){ pages.push_back(r); }));
+    PageRef runs[4];
+    size_t runCount = 0;
+    ASSERT_EQ(40u, impl.impl.allocatePageRuns(40, runs, 4, runCount));
+    ASSERT_EQ(pages.size(), impl.impl.freePagesAfterTlbFlush(pages.data(), pages.size()));
+    ASSERT_EQ(runCount, impl.impl.freePagesAfterTlbFlush(runs, runCount));
+    ASSERT_EQ(pages.size() + runCount, impl.localPools[pid]->deferredFreeSize());
+    ASSERT_EQ(totalPages - 44, impl.impl.countFreePages());
+
+    // One CPU flushing is not enough, even for frees that go through freePages meanwhile.
+    const uint64_t generation = PageAllocatorImpl::tlbFlushGeneration();
+    impl.impl.noteTlbFlush(0, generation);
+    PageRef other{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ other = r; }));
+    impl.impl.freePages(&other, 1);
+    ASSERT_EQ(totalPages - 44, impl.impl.countFreePages());
+
+    // Once the last CPU reports, the next freePages releases the whole queue.
+    impl.impl.noteTlbFlush(1, generation);
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ other = r; }));
+    impl.impl.freePages(&other, 1);
+    ASSERT_FALSE(impl.localPools[pid]->hasDeferredFrees());
+    ASSERT_EQ(totalPages, impl.impl.countFreePages());
+}
+
+TEST(PAI_TlbDefer_FlushBeforeTheUnmapDoesNotCount) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1}) });
+    const size_t totalPages = impl.impl.countFreePages();
+    flushEveryCpu(impl.impl);
+
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }));
+    ASSERT_EQ(1u, impl.impl.freePagesAfterTlbFlush(&page, 1));
+    ASSERT_EQ(0u, impl.impl.releaseDeferredFrees(arch::getCurrentProcessorID()));
+    ASSERT_TRUE(impl.impl.isPageAllocated(page));
+
+    flushEveryCpu(impl.impl);
+    ASSERT_EQ(1u, impl.impl.releaseDeferredFrees(arch::getCurrentProcessorID()));
+    ASSERT_EQ(totalPages, impl.impl.countFreePages());
+}
+
+TEST(PAI_TlbDefer_ReleasesOnlyTheFlushedPrefix) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1}) });
+    const auto pid = arch::getCurrentProcessorID();
+    std::vector<PageRef> early;
+    std::vector<PageRef> late;
+    ASSERT_EQ(8u, impl.impl.allocatePages(8, [&](PageRef r){ early.push_back(r); }));
+    ASSERT_EQ(8u, impl.impl.allocatePages(8, [&](PageRef r){ late.push_back(r); }));
+
+    ASSERT_EQ(early.size(), impl.impl.freePagesAfterTlbFlush(early.data(), early.size()));
+    flushEveryCpu(impl.impl);
+    ASSERT_EQ(late.size(), impl.impl.freePagesAfterTlbFlush(late.data(), late.size()));
+
+    ASSERT_EQ(8u, impl.impl.releaseDeferredFrees(pid));
+    ASSERT_EQ(8u, impl.localPools[pid]->deferredFreeSize());
+    for (const auto& page : early) ASSERT_FALSE(impl.impl.isPageAllocated(page));
+    for (const auto& page : late) ASSERT_TRUE(impl.impl.isPageAllocated(page));
+
+    flushEveryCpu(impl.impl);
+    ASSERT_EQ(8u, impl.impl.releaseDeferredFrees(pid));
+    ASSERT_FALSE(impl.localPools[pid]->hasDeferredFrees());
+}
+
+TEST(PAI_TlbDefer_FullQueueRunsShootdown) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1}) });
+    const size_t totalPages = impl.impl.countFreePages();
+    shootdownTarget = &impl.impl;
+    shootdownCount = 0;
+    impl.impl.tlbShootdown = testShootdown;
+
+    // One large unmap overflows the queue; the shootdown lets the oldest entries go.
+    constexpr size_t pageCount = LocalPool::deferredFreeCapacity + 40;
+    std::vector<PageRef> pages;
+    ASSERT_EQ(pageCount, impl.impl.allocatePages(pageCount, [&](PageRef r){ pages.push_back(r); }));
+    ASSERT_EQ(pages.size(), impl.impl.freePagesAfterTlbFlush(pages.data(), pages.size()));
+    ASSERT_EQ(1u, shootdownCount);
+    ASSERT_EQ(40u, impl.localPools[arch::getCurrentProcessorID()]->deferredFreeSize());
+    ASSERT_EQ(totalPages - 40, impl.impl.countFreePages());
+
+    flushEveryCpu(impl.impl);
+    ASSERT_EQ(40u, impl.impl.releaseDeferredFrees(arch::getCurrentProcessorID()));
+    ASSERT_EQ(totalPages, impl.impl.countFreePages());
+    shootdownTarget = nullptr;
+}
+
+TEST(PAI_TlbDefer_FullQueueFlushesOwnTlbBeforeShootdown) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1}) });
+    const auto pid = arch::getCurrentProcessorID();
+    shootdownTarget = &impl.impl;
+    shootdownCount = 0;
+    impl.impl.tlbShootdown = testShootdown;
+
+    // The other CPU is already caught up, so the queue only waits on our own flush.
+    constexpr size_t pageCount = LocalPool::deferredFreeCapacity + 40;
+    std::vector<PageRef> pages;
+    ASSERT_EQ(pageCount, impl.impl.allocatePages(pageCount, [&](PageRef r){ pages.push_back(r); }));
+    ASSERT_EQ(LocalPool::deferredFreeCapacity, impl.impl.freePagesAfterTlbFlush(pages.data(), LocalPool::deferredFreeCapacity));
+    const uint64_t generation = PageAllocatorImpl::tlbFlushGeneration();
+    for (size_t cpu = 0; cpu < impl.impl.processorCount; cpu++) {
+        if (cpu != pid) impl.impl.noteTlbFlush(static_cast<arch::ProcessorID>(cpu), generation);
+    }
+    ASSERT_EQ(40u, impl.impl.freePagesAfterTlbFlush(pages.data() + LocalPool::deferredFreeCapacity, 40));
+    ASSERT_EQ(0u, shootdownCount);
+    ASSERT_EQ(PageAllocatorImpl::tlbFlushGeneration(), impl.localPools[pid]->getFlushedGeneration());
+    ASSERT_EQ(40u, impl.localPools[pid]->deferredFreeSize());
+
+    flushEveryCpu(impl.impl);
+    ASSERT_EQ(40u, impl.impl.releaseDeferredFrees(pid));
+    shootdownTarget = nullptr;
+}
+
+TEST(PAI_TlbDefer_FullQueueWithoutShootdownReturnsTheRest) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1}) });
+    const auto pid = arch::getCurrentProcessorID();
+    impl.impl.tlbShootdown = nullptr;
+
+    // Nobody else ever flushes, so the call gives up instead of waiting forever.
+    constexpr size_t pageCount = LocalPool::deferredFreeCapacity + 40;
+    std::vector<PageRef> pages;
+    ASSERT_EQ(pageCount, impl.impl.allocatePages(pageCount, [&](PageRef r){ pages.push_back(r); }));
+    ASSERT_EQ(LocalPool::deferredFreeCapacity, impl.impl.freePagesAfterTlbFlush(pages.data(), pages.size()));
+    ASSERT_TRUE(impl.localPools[pid]->deferredFreesFull());
+    for (size_t i = LocalPool::deferredFreeCapacity; i < pageCount; i++) ASSERT_TRUE(impl.impl.isPageAllocated(pages[i]));
+
+    impl.impl.freePages(pages.data() + LocalPool::deferredFreeCapacity, 40);
+    flushEveryCpu(impl.impl);
+    ASSERT_EQ(LocalPool::deferredFreeCapacity, impl.impl.releaseDeferredFrees(pid));
+}
+
+TEST(PAI_TlbDefer_CatchUpFlushesOnlyWhenBehind) {
+    TestPageAllocatorImpl impl({ DomainSpec::simple(0, 4, {0, 1}) });
+    const auto pid = arch::getCurrentProcessorID();
+    flushEveryCpu(impl.impl);
+
+    PageRef page{};
+    ASSERT_EQ(1u, impl.impl.allocatePages(1, [&](PageRef r){ page = r; }));
+    ASSERT_EQ(1u, impl.impl.freePagesAfterTlbFlush(&page, 1));
+    const uint64_t generation = PageAllocatorImpl::tlbFlushGeneration();
+    ASSERT_TRUE(impl.localPools[1]->getFlushedGeneration() < generation);
+
+    // Each idle CPU catching up is what lets the page go without a shootdown.
+    for (size_t cpu = 0; cpu < impl.impl.processorCount; cpu++) {
+        impl.impl.catchUpTlbFlush(static_cast<arch::ProcessorID>(cpu));
+        ASSERT_EQ(generation, impl.localPools[cpu]->getFlushedGeneration());
+    }
+    ASSERT_EQ(1u, impl.impl.releaseDeferredFrees(pid));
+    ASSERT_FALSE(impl.impl.isPageAllocated(page));
+}